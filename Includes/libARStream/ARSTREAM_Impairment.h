@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Impairment.h
+ * @brief Network impairment emulation for the stream buffers
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_IMPAIRMENT_H_
+#define _ARSTREAM_IMPAIRMENT_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * ARSDK Headers
+ */
+#include <libARNetwork/ARNETWORK_Manager.h>
+#include <libARStream/ARSTREAM_Error.h>
+
+/*
+ * Macros
+ */
+
+/**
+ * @brief Default number of packets that an impairment can hold back (delayed, reordered or duplicated packets)
+ */
+#define ARSTREAM_IMPAIRMENT_DEFAULT_MAX_QUEUED_PACKETS (256)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Parameters of an ARSTREAM_Impairment_t
+ *
+ * The impairment is applied to each packet, in the order in which they are read from the network buffer:
+ * - the packet is lost with a probability of lossPercent (in the good state of the Gilbert-Elliott model)
+ *   or badStateLossPercent (in its bad state)
+ * - the packet is delivered after delayMs, plus a uniform random jitter in [0, jitterMs], plus the time
+ *   needed to go through a link of bandwidthKbps
+ * - with a probability of reorderPercent, reorderDelayMs is added to the delivery time of the packet,
+ *   so that it is delivered after the following ones
+ * - with a probability of duplicatePercent, a second copy of the packet is delivered (with its own jitter)
+ *
+ * All the random draws come from a generator seeded with seed, so that the same packet sequence gets the
+ * same impairment decisions in every run.
+ */
+typedef struct {
+    uint32_t seed; /**< Seed of the random generator */
+    float lossPercent; /**< Loss probability (percents) of the uniform model, or of the good state of the Gilbert-Elliott model */
+    float goodToBadPercent; /**< Gilbert-Elliott model : probability (percents) to switch from the good to the bad state after each packet. 0 disables the bad state */
+    float badToGoodPercent; /**< Gilbert-Elliott model : probability (percents) to switch from the bad to the good state after each packet */
+    float badStateLossPercent; /**< Gilbert-Elliott model : loss probability (percents) in the bad state */
+    float duplicatePercent; /**< Duplication probability (percents) */
+    float reorderPercent; /**< Reordering probability (percents) */
+    int reorderDelayMs; /**< Additional delay of the reordered packets */
+    int delayMs; /**< Constant delay of all packets */
+    int jitterMs; /**< Maximum random delay added to each packet */
+    uint32_t bandwidthKbps; /**< Link bandwidth (0 for unlimited) */
+    int maxQueuedPackets; /**< Maximum number of packets held back by the impairment. While it is full, the next packets wait in the network buffer */
+} ARSTREAM_Impairment_Params_t;
+
+/**
+ * @brief Counters of an ARSTREAM_Impairment_t
+ */
+typedef struct {
+    uint32_t nbPacketsIn; /**< Packets read from the network buffer */
+    uint32_t nbPacketsOut; /**< Packets given to the stream (including duplicates) */
+    uint32_t nbPacketsLost; /**< Packets dropped by the loss models */
+    uint32_t nbPacketsOverflow; /**< Duplicates dropped because the queue was full */
+    uint32_t nbPacketsDuplicated; /**< Packets delivered twice */
+    uint32_t nbPacketsReordered; /**< Packets which got the reordering delay */
+} ARSTREAM_Impairment_Counters_t;
+
+/**
+ * @brief An ARSTREAM_Impairment_t emulates a degraded network link on the packets read from one network buffer
+ *
+ * It sits between the stream and ARNETWORK_Manager_ReadDataWithTimeout() / ARNETWORK_Manager_TryReadData(),
+ * so that the packets sent by the peer are lost, delayed, reordered or duplicated before the stream sees them.
+ * Attach it to the data buffer of a reader (ARSTREAM_Reader_SetDataImpairment()) to impair the data path,
+ * and to the ack buffer of a sender (ARSTREAM_Sender_SetAckImpairment()) to impair the ack path.
+ *
+ * @note An impairment can only be used by one buffer, read by one thread at a time
+ * @warning This is a testing tool : the held back packets are copied, and delivered only when the buffer is read
+ */
+typedef struct ARSTREAM_Impairment_t ARSTREAM_Impairment_t;
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Sets an ARSTREAM_Impairment_Params_t to its default values : no impairment at all
+ * @param[out] params The parameters to set
+ */
+void ARSTREAM_Impairment_DefaultParams (ARSTREAM_Impairment_Params_t *params);
+
+/**
+ * @brief Creates a new ARSTREAM_Impairment_t
+ * @param[in] params The impairment parameters
+ * @param[in] maxPacketSize Size of the largest packet of the network buffer (dataCopyMaxSize of its ARNETWORK_IOBufferParam_t)
+ * @param[out] error Optionnal pointer to an eARSTREAM_ERROR to hold any error information
+ * @return A pointer to the new ARSTREAM_Impairment_t, or NULL if an error occured
+ */
+ARSTREAM_Impairment_t* ARSTREAM_Impairment_New (const ARSTREAM_Impairment_Params_t *params, int maxPacketSize, eARSTREAM_ERROR *error);
+
+/**
+ * @brief Deletes an ARSTREAM_Impairment_t
+ * @param[in,out] impairment Pointer to the impairment to delete. Set to NULL on success
+ * @return ARSTREAM_OK if the impairment was deleted
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if impairment is NULL
+ * @warning The stream which uses the impairment must be stopped (or must use another impairment) before
+ */
+eARSTREAM_ERROR ARSTREAM_Impairment_Delete (ARSTREAM_Impairment_t **impairment);
+
+/**
+ * @brief Reads a packet through the impairment
+ * This is a drop-in replacement of ARNETWORK_Manager_ReadDataWithTimeout() (waitMs > 0) and ARNETWORK_Manager_TryReadData() (waitMs <= 0)
+ * @param[in] impairment The impairment
+ * @param[in] manager The network manager
+ * @param[in] bufferID ID of the buffer to read from
+ * @param[out] data Buffer which will hold the packet
+ * @param[in] capacity Capacity of data
+ * @param[out] readSize Size of the packet
+ * @param[in] waitMs Maximum time to wait for a packet, in ms
+ * @return ARNETWORK_OK if a packet was read
+ * @return ARNETWORK_ERROR_BUFFER_EMPTY if no packet was due before waitMs
+ * @return Any other error of the ARNETWORK_Manager read functions
+ */
+eARNETWORK_ERROR ARSTREAM_Impairment_ReadData (ARSTREAM_Impairment_t *impairment, ARNETWORK_Manager_t *manager, int bufferID, uint8_t *data, int capacity, int *readSize, int waitMs);
+
+/**
+ * @brief Gets the counters of an impairment
+ * @param[in] impairment The impairment
+ * @param[out] counters Pointer which will hold the counters
+ * @return ARSTREAM_OK if counters was filled
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if impairment or counters is NULL
+ */
+eARSTREAM_ERROR ARSTREAM_Impairment_GetCounters (ARSTREAM_Impairment_t *impairment, ARSTREAM_Impairment_Counters_t *counters);
+
+#endif /* _ARSTREAM_IMPAIRMENT_H_ */
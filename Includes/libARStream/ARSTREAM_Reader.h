@@ -48,11 +48,24 @@
  */
 #include <libARNetwork/ARNETWORK_Manager.h>
 #include <libARStream/ARSTREAM_Error.h>
+#include <libARStream/ARSTREAM_Impairment.h>
+#include <libARStream/ARSTREAM_Thread.h>
+#include <libARStream/ARSTREAM_Recorder.h>
 
 /*
  * Macros
  */
 #define ARSTREAM_READER_MAX_ACK_INTERVAL_DEFAULT (5)
+/**
+ * @brief Default value for ARSTREAM_Reader_SetMinAckInterval calls
+ */
+#define ARSTREAM_READER_MIN_ACK_INTERVAL_DEFAULT (2)
+
+/**
+ * @brief Size of the stream encryption keys, in bytes
+ * @see ARSTREAM_Reader_SetEncryptionKey
+ */
+#define ARSTREAM_READER_ENCRYPTION_KEY_SIZE (32)
 
 /*
  * Types
@@ -66,6 +79,7 @@ typedef enum {
     ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL, /**< Frame buffer is too small for the frame on the network */
     ARSTREAM_READER_CAUSE_COPY_COMPLETE, /**< Copy of previous frame buffer is complete (called only after ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL) */
     ARSTREAM_READER_CAUSE_CANCEL, /**< Reader is closing, so buffer is no longer used */
+    ARSTREAM_READER_CAUSE_FRAME_PARTIAL, /**< Frame is incomplete, but the buffer holds its complete NAL units (only with ARSTREAM_Reader_SetPartialFrameDelivery()) */
     ARSTREAM_READER_CAUSE_MAX,
 } eARSTREAM_READER_CAUSE;
 
@@ -83,6 +97,7 @@ typedef enum {
  * @return address of a new buffer which will hold the next frame
  *
  * @note If cause is ARSTREAM_READER_CAUSE_FRAME_COMPLETE, framePointer contains a valid frame.
+ * @note If cause is ARSTREAM_READER_CAUSE_FRAME_PARTIAL, framePointer contains the complete NAL units of a frame which missed some fragments, in order. The return value and newBufferCapacity are used as for ARSTREAM_READER_CAUSE_FRAME_COMPLETE.
  * @note If cause is ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL, datas will be copied into the new frame. Old frame buffer will still be in use until the callback is called again with ARSTREAM_READER_CAUSE_COPY_COMPLETE cause. If the new frame is still too small, the callback will be called again, until a suitable buffer is provided. newBufferCapacity holds a suitable capacity for the new buffer, but still has to be updated by the application.
  * @note If cause is ARSTREAM_READER_CAUSE_COPY_COMPLETE, the return value and newBufferCapacity are unused. If numberOfSkippedFrames is non-zero, then the current frame will be skipped (usually because the buffer returned after the ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL was smaller than the previous buffer).
  * @note If cause is ARSTREAM_READER_CAUSE_CANCEL, the return value and newBufferCapacity are unused
@@ -92,6 +107,69 @@ typedef enum {
  */
 typedef uint8_t* (*ARSTREAM_Reader_FrameCompleteCallback_t) (eARSTREAM_READER_CAUSE cause, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, uint32_t *newBufferCapacity, void *custom);
 
+/**
+ * @brief A frame from the frame pool of an ARSTREAM_Reader_t
+ * @see ARSTREAM_Reader_NewWithFramePool()
+ */
+typedef struct ARSTREAM_Reader_Frame_t ARSTREAM_Reader_Frame_t;
+
+/**
+ * @brief Callback called when a new frame is ready in the frame pool
+ *
+ * @param[in] frame The frame from the frame pool
+ * @param[in] framePointer Pointer to the frame data
+ * @param[in] frameSize Size of the frame data
+ * @param[in] numberOfSkippedFrames Number of frames which were skipped between the previous call and this one. (Usually 0)
+ * @param[in] isFlushFrame Boolean-like (0-1) flag telling if the complete frame was a flush frame (typically an I-Frame) for the sender
+ * @param[in] custom Custom pointer passed during ARSTREAM_Reader_NewWithFramePool
+ *
+ * @note The frame data is only valid during the callback. To keep it longer, call ARSTREAM_Reader_FrameRef() within the callback, then ARSTREAM_Reader_FrameUnref() once the frame is no longer used.
+ * @note With ARSTREAM_Reader_SetPartialFrameDelivery(), the frame may only hold the complete NAL units of an incomplete frame, see ARSTREAM_Reader_FrameIsPartial().
+ */
+typedef void (*ARSTREAM_Reader_FrameReadyCallback_t) (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom);
+
+/**
+ * @brief Callback called when more data of the next frame is available, before the frame is complete
+ *
+ * @param[in] frameNumber Number of the frame
+ * @param[in] framePointer Pointer to the data of the frame, NULL if the frame was dropped
+ * @param[in] contiguousSize Size of the data which was received from the start of the frame, without any gap
+ * @param[in] isFlushFrame Boolean-like (0-1) flag telling if the frame is a flush frame (typically an I-Frame) for the sender
+ * @param[in] custom Custom pointer passed during ARSTREAM_Reader_New or ARSTREAM_Reader_NewWithFramePool
+ *
+ * @note Only the oldest frame in progress is reported, which is the next frame given to the application (unless it is dropped)
+ * @note framePointer is owned by the reader. The first contiguousSize bytes are never modified until the frame is given to the frame callback, or dropped. A frame is dropped when it is not given to the frame callback (or when it is given as a partial frame) after a call with a non NULL framePointer. The callback is then called again with a NULL framePointer
+ * @note For readers created with ARSTREAM_Reader_NewWithFramePool(), the frame is given to the frame callback in the same buffer
+ */
+typedef void (*ARSTREAM_Reader_FrameProgressCallback_t) (uint32_t frameNumber, uint8_t *framePointer, uint32_t contiguousSize, int isFlushFrame, void *custom);
+
+/**
+ * @brief Number of buckets of the latency histograms of ARSTREAM_Reader_Stats_t
+ * Bucket 0 counts the latencies under 1 ms, bucket n the latencies within [2^(n-1), 2^n[ ms,
+ * and the last bucket all the latencies of 1024 ms or more
+ */
+#define ARSTREAM_READER_STATS_LATENCY_NB_BUCKETS (12)
+
+/**
+ * @brief Statistics of a reader
+ * All counters are accumulated since the creation of the reader, and wrap at 2^32.
+ * @see ARSTREAM_Reader_GetStats
+ */
+typedef struct {
+    uint32_t nbFramesComplete; /**< Complete frames given to the application */
+    uint32_t nbFramesPartial; /**< Incomplete frames given to the application as partial frames */
+    uint32_t nbFramesDropped; /**< Incomplete frames which were not given to the application */
+    uint32_t nbFramesMissed; /**< Sum of the numberOfSkippedFrames given to the application */
+    uint32_t nbFragmentsReceived; /**< Data fragments received for the first time */
+    uint32_t nbFragmentsDuplicated; /**< Data fragments which were already received (retries or redundant copies) */
+    uint32_t nbFragmentsLate; /**< Fragments of frames which were already given or dropped */
+    uint32_t nbFragmentsRejected; /**< Fragments which did not authenticate, which did not match the encryption setting, or which belong to a previous session of the sender (see ARSTREAM_Reader_SetEncryptionKey) */
+    uint32_t nbParityFragmentsReceived; /**< Parity fragments received */
+    uint32_t nbFragmentsRebuilt; /**< Data fragments rebuilt from parity fragments */
+    uint32_t nbAcksSent; /**< Ack packets sent to the sender */
+    uint32_t reassemblyTime [ARSTREAM_READER_STATS_LATENCY_NB_BUCKETS]; /**< Histogram of the time from the first received fragment of a frame to its delivery (complete and partial frames) */
+} ARSTREAM_Reader_Stats_t;
+
 /**
  * @brief An ARSTREAM_Reader_t instance allow reading streamed frames from a network
  */
@@ -140,6 +218,72 @@ void ARSTREAM_Reader_InitStreamAckBuffer (ARNETWORK_IOBufferParam_t *bufferParam
  */
 ARSTREAM_Reader_t* ARSTREAM_Reader_New (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameCompleteCallback_t callback, uint8_t *frameBuffer, uint32_t frameBufferSize, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error);
 
+/**
+ * @brief Creates a new ARSTREAM_Reader_t which gives the frames from its own frame pool
+ * The frame buffers are owned by the reader, and sized from the fragments header (maxFragmentSize * number of fragments of the frame).
+ * Frames are stored directly in these buffers, and given to the application without any copy.
+ * @warning This function allocates memory. An ARSTREAM_Reader_t muse be deleted by a call to ARSTREAM_Reader_Delete
+ *
+ * @param[in] manager Pointer to a valid and connected ARNETWORK_Manager_t, which will be used to stream frames
+ * @param[in] dataBufferID ID of a StreamDataBuffer available within the manager
+ * @param[in] ackBufferID ID of a StreamAckBuffer available within the manager
+ * @param[in] callback The callback which will be called every time a new frame is available
+ * @param[in] maxHeldFrames Maximum number of frames held by the application (with ARSTREAM_Reader_FrameRef()) at the same time. New frames are skipped while all of them are held.
+ * @param[in] maxFragmentSize Maximum allowed size for a video data fragment. Video frames larger that will be fragmented.
+ * @param[in] maxAckInterval Maximum interval between sending ACKs. 0 disables only periodic ACKs. -1 disables ACKs completely.
+ * If unsure, use the default value in ARSTREAM_READER_MAX_ACK_INTERVAL_DEFAULT.
+ * @param[in] custom Custom pointer which will be passed to callback
+ * @param[out] error Optionnal pointer to an eARSTREAM_ERROR to hold any error information
+ * @return A pointer to the new ARSTREAM_Reader_t, or NULL if an error occured
+ * @see ARSTREAM_Reader_New()
+ * @see ARSTREAM_Reader_FrameRef()
+ * @see ARSTREAM_Reader_FrameUnref()
+ */
+ARSTREAM_Reader_t* ARSTREAM_Reader_NewWithFramePool (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameReadyCallback_t callback, int maxHeldFrames, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error);
+
+/**
+ * @brief Takes a reference on a frame from the frame pool
+ * The frame data stays valid until the matching ARSTREAM_Reader_FrameUnref() call
+ * @param[in] frame The frame given to the ARSTREAM_Reader_FrameReadyCallback_t
+ * @note This function can only be called on frames which are already referenced (i.e. within the callback, or before the last ARSTREAM_Reader_FrameUnref() call)
+ */
+void ARSTREAM_Reader_FrameRef (ARSTREAM_Reader_Frame_t *frame);
+
+/**
+ * @brief Releases a reference on a frame from the frame pool
+ * The frame goes back to the frame pool once all references are released
+ * @param[in] frame The frame to release
+ * @note This function can be called from any thread
+ */
+void ARSTREAM_Reader_FrameUnref (ARSTREAM_Reader_Frame_t *frame);
+
+/**
+ * @brief Tells if a frame from the frame pool is a partial frame
+ * @param[in] frame The frame given to the ARSTREAM_Reader_FrameReadyCallback_t
+ * @return 1 if the frame only holds the complete NAL units of a frame which missed some fragments
+ * @return 0 if the frame is complete (or if frame is NULL)
+ * @see ARSTREAM_Reader_SetPartialFrameDelivery()
+ */
+int ARSTREAM_Reader_FrameIsPartial (ARSTREAM_Reader_Frame_t *frame);
+
+/**
+ * @brief Gets the number of a frame from the frame pool
+ * @param[in] frame The frame given to the ARSTREAM_Reader_FrameReadyCallback_t
+ * @return The 32 bits frame number given by the sender (0 if frame is NULL)
+ * @note Senders which do not send 32 bits frame numbers are extended from their lower 16 bits
+ */
+uint32_t ARSTREAM_Reader_FrameGetNumber (ARSTREAM_Reader_Frame_t *frame);
+
+/**
+ * @brief Gets the capture timestamp of a frame from the frame pool
+ * @param[in] frame The frame given to the ARSTREAM_Reader_FrameReadyCallback_t
+ * @param[out] captureTimestamp Pointer which will hold the timestamp, in the sender application clock
+ * @return 1 if the sender gave a capture timestamp for this frame
+ * @return 0 otherwise (captureTimestamp is left untouched)
+ * @see ARSTREAM_Sender_SendNewFrameWithTimestamp()
+ */
+int ARSTREAM_Reader_FrameGetCaptureTimestamp (ARSTREAM_Reader_Frame_t *frame, uint32_t *captureTimestamp);
+
 /**
  * @brief Stops a running ARSTREAM_Reader_t
  * @warning Once stopped, an ARSTREAM_Reader_t can not be restarted
@@ -157,7 +301,7 @@ void ARSTREAM_Reader_StopReader (ARSTREAM_Reader_t *reader);
  * @param reader Pointer to the ARSTREAM_Reader_t * to delete
  *
  * @return ARSTREAM_OK if the ARSTREAM_Reader_t was deleted
- * @return ARSTREAM_ERROR_BUSY if the ARSTREAM_Reader_t is still busy and can not be stopped now (probably because ARSTREAM_Reader_StopReader() was not called yet)
+ * @return ARSTREAM_ERROR_BUSY if the ARSTREAM_Reader_t is still busy and can not be stopped now (probably because ARSTREAM_Reader_StopReader() was not called yet, or because the application still holds frames from the frame pool)
  * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader does not point to a valid ARSTREAM_Reader_t
  *
  * @note The library use a double pointer, so it can set *reader to NULL after freeing it
@@ -180,6 +324,167 @@ void* ARSTREAM_Reader_RunDataThread (void *ARSTREAM_Reader_t_Param);
  */
 void* ARSTREAM_Reader_RunAckThread (void *ARSTREAM_Reader_t_Param);
 
+/**
+ * @brief Reads all the fragments already received by the ARSTREAM_Reader_t, without blocking, then sends the ack packet if it is due
+ * This is the alternative to ARSTREAM_Reader_RunDataThread() for applications which drive the reader from their own event loop
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @return The time before the next call, in ms.
+ * @return -1 once the reader is stopped. Both loops of the reader are then ended, and it can be deleted.
+ *
+ * @note The network buffers can not notify new data, so this function must be polled. The returned delay is 2 ms after
+ * fragments were read, then doubles after each call which reads no fragment, up to 500 ms. The first fragment of a new
+ * frame after an idle period can thus wait up to that delay.
+ * @warning ARSTREAM_Reader_ProcessIncoming() and ARSTREAM_Reader_OnTimer() must be called from the same thread, and can not be mixed with ARSTREAM_Reader_RunDataThread() and ARSTREAM_Reader_RunAckThread()
+ */
+int ARSTREAM_Reader_ProcessIncoming (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Runs the acknowledge loop of the ARSTREAM_Reader_t once, without blocking : sends the ack packet if it is due
+ * This is the alternative to ARSTREAM_Reader_RunAckThread() for applications which drive the reader from their own event loop
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @return 0 if no error occured.
+ * @return -1 once the reader is stopped. Both loops of the reader are then ended, and it can be deleted.
+ *
+ * @note Call this function again once ARSTREAM_Reader_GetNextTimeout() elapsed
+ * @warning ARSTREAM_Reader_ProcessIncoming() and ARSTREAM_Reader_OnTimer() must be called from the same thread, and can not be mixed with ARSTREAM_Reader_RunDataThread() and ARSTREAM_Reader_RunAckThread()
+ */
+int ARSTREAM_Reader_OnTimer (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Gets the time before the next ARSTREAM_Reader_OnTimer() call is needed
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @return The time, in ms. Zero if the reader is stopping.
+ * @return -1 if no call is needed until new fragments are read (same convention as poll/epoll_wait)
+ *
+ * @note New fragments are not accounted, the event loop should wait for the smaller of this time and the delay returned by ARSTREAM_Reader_ProcessIncoming()
+ */
+int ARSTREAM_Reader_GetNextTimeout (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Sets the minimum interval between two ACKs of the ARSTREAM_Reader_t
+ * Received fragments are acknowledged together in a single ACK, sent at most every minAckInterval ms.
+ * Frame completions and gaps in the received fragments are still acknowledged immediately.
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] minAckInterval The minimum interval between two ACKs, in miliseconds. 0 sends an ACK for each batch of received fragments.
+ *
+ * @return ARSTREAM_OK if the new interval is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL, or if minAckInterval is negative.
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetMinAckInterval (ARSTREAM_Reader_t *reader, int32_t minAckInterval);
+
+/**
+ * @brief Enables or disables the partial frame delivery of the ARSTREAM_Reader_t
+ * Without partial frame delivery, frames which miss fragments when they are dropped (because a newer frame
+ * is complete, or because too many frames are in progress) are never given to the application.
+ * With partial frame delivery, the complete NAL units of these frames are given instead
+ * (ARSTREAM_READER_CAUSE_FRAME_PARTIAL cause, or ARSTREAM_Reader_FrameIsPartial() for the frame pool), so a lost fragment
+ * only costs the slice it belongs to.
+ * @note Only frames sent with ARSTREAM_SENDER_FRAGMENTATION_NAL_UNITS can be partially given. Other frames are still dropped.
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] enable Boolean-like (0/1) flag, active to enable the partial frame delivery (disabled by default)
+ *
+ * @return ARSTREAM_OK if the option is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL.
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetPartialFrameDelivery (ARSTREAM_Reader_t *reader, int enable);
+
+/**
+ * @brief Sets the receiver id of the ARSTREAM_Reader_t
+ * Readers of a fan-out sender (see ARSTREAM_Sender_SetFanOut()) tag their acks with their receiver id, so the sender
+ * tracks the fragments received by each reader. All the readers of a sender must use different ids.
+ * @note Tagged acks are only sent once the sender announced that it understands extended acks. They are not
+ * understood by senders without fan-out support, so the receiver id must only be set for fan-out senders.
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] receiverId The receiver id (1 to 255). 0 to send untagged acks (default)
+ *
+ * @return ARSTREAM_OK if the id is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL.
+ * @return ARSTREAM_ERROR_BUSY if the ack loop is already running.
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetReceiverId (ARSTREAM_Reader_t *reader, uint8_t receiverId);
+
+/**
+ * @brief Sets the key used to authenticate and decrypt the stream of the ARSTREAM_Reader_t
+ * Each fragment is authenticated, then decrypted in place in the receive buffer, before being copied into the frame.
+ * With a key, the fragments sent in clear or which do not authenticate are dropped. Without key, the encrypted
+ * fragments are dropped. Dropped fragments are counted in the nbFragmentsRejected statistic.
+ *
+ * The reader follows one session of the sender at a time : a session starts each time the sender is given a key, and is
+ * recognized by the nonce prefix the sender draws for it. The fragments of older frames of the current session are dropped,
+ * so replayed fragments can not rewind the reader. A new session replaces the current one (and the frames in progress are
+ * dropped), the fragments of the replaced session are then dropped too. Sessions older than the replaced one can still be
+ * replayed, so a new key should be used for each session.
+ *
+ * @warning Only the data fragments are protected : the ack packets sent by the reader are not authenticated, so a forged
+ * ack can stop the retransmission of fragments (but can not change the received data)
+ * @see ARSTREAM_Sender_SetEncryptionKey()
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] key The ARSTREAM_READER_ENCRYPTION_KEY_SIZE bytes key of the sender (copied by the reader). NULL to read a clear stream (default)
+ * @param[in] keySize The size of the key, must be ARSTREAM_READER_ENCRYPTION_KEY_SIZE
+ *
+ * @return ARSTREAM_OK if the key is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL, or if keySize is invalid.
+ * @return ARSTREAM_ERROR_BUSY if the data loop is already running.
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetEncryptionKey (ARSTREAM_Reader_t *reader, const uint8_t *key, int keySize);
+
+/**
+ * @brief Sets the frame progress callback of the ARSTREAM_Reader_t
+ * The callback is called by the data loop each time a batch of fragments extends the contiguous data of the next frame,
+ * so the application can start to decode a frame while its last fragments are still transmitted.
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] callback The new callback, NULL to disable the progress reports (default)
+ *
+ * @return ARSTREAM_OK if the callback is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL.
+ *
+ * @warning This function must be called before the reader loops are started
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetFrameProgressCallback (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_FrameProgressCallback_t callback);
+
+/**
+ * @brief Reads the data fragments of the ARSTREAM_Reader_t through a network impairment emulation
+ * The data loop then reads its buffer with ARSTREAM_Impairment_ReadData() instead of the ARNETWORK_Manager read functions.
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] impairment The impairment, created with the dataCopyMaxSize of the data buffer. NULL to read the network buffer directly (default)
+ *
+ * @return ARSTREAM_OK if the impairment is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL.
+ * @return ARSTREAM_ERROR_BUSY if the data loop is already running.
+ *
+ * @note The impairment is not owned by the reader, and must be deleted after the reader
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetDataImpairment (ARSTREAM_Reader_t *reader, ARSTREAM_Impairment_t *impairment);
+
+/**
+ * @brief Records the frames of the ARSTREAM_Reader_t
+ * Each complete (or partial) frame is queued to the recorder by the data loop, before it is given to the application.
+ * The data loop only copies the frame : the file is written by the recorder thread (see ARSTREAM_Recorder_RunThread()).
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] recorder The recorder. NULL to stop recording (default)
+ *
+ * @return ARSTREAM_OK if the recorder is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL.
+ * @return ARSTREAM_ERROR_BUSY if the data loop is already running.
+ *
+ * @note The recorder is not owned by the reader, and must be stopped and deleted after the reader
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetRecorder (ARSTREAM_Reader_t *reader, ARSTREAM_Recorder_t *recorder);
+
+/**
+ * @brief Sets the scheduling configuration of a thread of the ARSTREAM_Reader_t
+ * The configuration (affinity, priority and name) is applied by ARSTREAM_Reader_RunDataThread() or ARSTREAM_Reader_RunAckThread()
+ * when they start, whatever created the thread. To also set the stack size, create the thread with ARSTREAM_Thread_Create().
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[in] thread The thread to configure
+ * @param[in] config The configuration. NULL to keep the settings of the thread (default)
+ *
+ * @return ARSTREAM_OK if the configuration is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader is NULL, or if thread is not valid.
+ * @return ARSTREAM_ERROR_BUSY if the thread is already running.
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_SetThreadConfig (ARSTREAM_Reader_t *reader, eARSTREAM_THREAD thread, const ARSTREAM_ThreadConfig_t *config);
+
 /**
  * @brief Gets the estimated network efficiency for the ARSTREAM link
  * An efficiency of 1.0f means that we did not receive any useless packet.
@@ -189,6 +494,33 @@ void* ARSTREAM_Reader_RunAckThread (void *ARSTREAM_Reader_t_Param);
  */
 float ARSTREAM_Reader_GetEstimatedEfficiency (ARSTREAM_Reader_t *reader);
 
+/**
+ * @brief Gets the capture timestamp of the frame given to the ARSTREAM_Reader_FrameCompleteCallback_t
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[out] captureTimestamp Pointer which will hold the timestamp, in the sender application clock
+ * @return 1 if the sender gave a capture timestamp for this frame
+ * @return 0 otherwise (captureTimestamp is left untouched)
+ * @note This function must be called from within the callback, for the ARSTREAM_READER_CAUSE_FRAME_COMPLETE and ARSTREAM_READER_CAUSE_FRAME_PARTIAL causes
+ * @see ARSTREAM_Sender_SendNewFrameWithTimestamp()
+ */
+int ARSTREAM_Reader_GetCurrentFrameCaptureTimestamp (ARSTREAM_Reader_t *reader, uint32_t *captureTimestamp);
+
+/**
+ * @brief Gets a snapshot of the statistics of the reader
+ *
+ * The counters are updated without any lock by the reader threads, so this function never waits for them,
+ * and can be polled (e.g. every second) to export the stream statistics. Rates should be computed from the
+ * difference between two snapshots, with unsigned arithmetic, as the counters wrap.
+ *
+ * @param[in] reader The ARSTREAM_Reader_t
+ * @param[out] stats Pointer which will hold the statistics
+ * @return ARSTREAM_OK if stats was filled
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if reader or stats is NULL
+ *
+ * @note Counters are read one by one while the reader runs, so two counters of a snapshot may differ by the events of the last few microseconds
+ */
+eARSTREAM_ERROR ARSTREAM_Reader_GetStats (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Stats_t *stats);
+
 /**
  * @brief Gets the custom pointer associated with the reader
  * @param[in] reader The ARSTREAM_Reader_t
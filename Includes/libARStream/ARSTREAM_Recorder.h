@@ -0,0 +1,232 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Recorder.h
+ * @brief Asynchronous recording of a stream to a file, with a frame index
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_RECORDER_H_
+#define _ARSTREAM_RECORDER_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * ARSDK Headers
+ */
+#include <libARStream/ARSTREAM_Error.h>
+
+/*
+ * Macros
+ */
+
+/**
+ * @brief Alignment of the recorder buffers, and granularity of their size
+ */
+#define ARSTREAM_RECORDER_BUFFER_ALIGNMENT (4096)
+
+/**
+ * @brief Default size of a recorder buffer
+ */
+#define ARSTREAM_RECORDER_DEFAULT_BUFFER_SIZE (1024 * 1024)
+
+/**
+ * @brief Default number of recorder buffers
+ */
+#define ARSTREAM_RECORDER_DEFAULT_NB_BUFFERS (16)
+
+/**
+ * @brief Default interval between two writes of the index file
+ */
+#define ARSTREAM_RECORDER_DEFAULT_INDEX_FLUSH_INTERVAL_MS (1000)
+
+/**
+ * @brief Suffix added to the recording path to get the index file path
+ */
+#define ARSTREAM_RECORDER_INDEX_SUFFIX ".idx"
+
+/**
+ * @brief Magic number ("ARSI") and version at the start of an index file
+ */
+#define ARSTREAM_RECORDER_INDEX_MAGIC (0x49535241)
+#define ARSTREAM_RECORDER_INDEX_VERSION (1)
+
+/**
+ * @brief Flags of an index entry
+ */
+#define ARSTREAM_RECORDER_INDEX_FLAG_FLUSH_FRAME (1 << 0)
+#define ARSTREAM_RECORDER_INDEX_FLAG_PARTIAL_FRAME (1 << 1)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Parameters of an ARSTREAM_Recorder_t
+ */
+typedef struct {
+    uint32_t bufferSize; /**< Size of each buffer, multiple of ARSTREAM_RECORDER_BUFFER_ALIGNMENT. Data is written to the file one full buffer at a time */
+    int nbBuffers; /**< Number of buffers (at least 2). Frames which do not fit in the free buffers are dropped */
+    int indexFlushIntervalMs; /**< Interval between two writes of the new index entries */
+    int useDirectIO; /**< Boolean-like (0/1) flag : bypass the page cache (O_DIRECT) when the file system supports it */
+} ARSTREAM_Recorder_Params_t;
+
+/**
+ * @brief An entry of the frame index
+ *
+ * The index file starts with ARSTREAM_RECORDER_INDEX_MAGIC and ARSTREAM_RECORDER_INDEX_VERSION (32 bits each),
+ * followed by the entries in recording order. Each entry is stored on 24 bytes : offset (64 bits), size, frameNumber,
+ * flags and a reserved zero (32 bits each). All values are little endian.
+ * As the entries have a fixed size, the entry of the Nth frame is at 8 + 24 * N.
+ */
+typedef struct {
+    uint64_t offset; /**< Offset of the frame in the recording */
+    uint32_t size; /**< Size of the frame */
+    uint32_t frameNumber; /**< Frame number given by the sender */
+    uint32_t flags; /**< ARSTREAM_RECORDER_INDEX_FLAG_xxx */
+} ARSTREAM_Recorder_IndexEntry_t;
+
+/**
+ * @brief Counters of an ARSTREAM_Recorder_t
+ */
+typedef struct {
+    uint32_t nbFramesRecorded; /**< Frames queued for writing */
+    uint32_t nbFramesDropped; /**< Frames dropped because all the buffers were waiting for the file */
+    uint64_t nbBytesWritten; /**< Bytes written to the recording */
+    uint32_t nbWriteErrors; /**< Failed writes (recording or index) */
+} ARSTREAM_Recorder_Counters_t;
+
+/**
+ * @brief An ARSTREAM_Recorder_t writes frames to a file from its own I/O thread
+ *
+ * The frames are copied into large aligned buffers, which are written by ARSTREAM_Recorder_RunThread() once full :
+ * the thread which adds the frames (e.g. the data thread of a reader, see ARSTREAM_Reader_SetRecorder()) never
+ * waits for the file system. A slow storage only results in dropped frames, which are counted.
+ *
+ * The recording is the concatenation of the frames. Each frame also gets an entry in an in-memory index, and the
+ * new entries are appended to the index file (recording path + ARSTREAM_RECORDER_INDEX_SUFFIX) every
+ * indexFlushIntervalMs, once the frames they describe are written.
+ */
+typedef struct ARSTREAM_Recorder_t ARSTREAM_Recorder_t;
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Sets an ARSTREAM_Recorder_Params_t to its default values
+ * @param[out] params The parameters to set
+ */
+void ARSTREAM_Recorder_DefaultParams (ARSTREAM_Recorder_Params_t *params);
+
+/**
+ * @brief Creates a new ARSTREAM_Recorder_t, and creates (or truncates) its recording and index files
+ * @param[in] path Path of the recording
+ * @param[in] params The recorder parameters
+ * @param[out] error Optionnal pointer to an eARSTREAM_ERROR to hold any error information
+ * @return A pointer to the new ARSTREAM_Recorder_t, or NULL if an error occured
+ * @see ARSTREAM_Recorder_RunThread()
+ */
+ARSTREAM_Recorder_t* ARSTREAM_Recorder_New (const char *path, const ARSTREAM_Recorder_Params_t *params, eARSTREAM_ERROR *error);
+
+/**
+ * @brief Stops a running ARSTREAM_Recorder_t
+ * The I/O thread writes all the queued frames and the whole index before it returns.
+ * @param[in] recorder The ARSTREAM_Recorder_t to stop
+ * @warning The thread which adds the frames (e.g. the reader data thread) must be stopped before
+ *
+ * @note Calling this function multiple times has no effect
+ */
+void ARSTREAM_Recorder_Stop (ARSTREAM_Recorder_t *recorder);
+
+/**
+ * @brief Deletes an ARSTREAM_Recorder_t, and closes its files
+ * @param[in,out] recorder Pointer to the recorder to delete. Set to NULL on success
+ * @return ARSTREAM_OK if the recorder was deleted
+ * @return ARSTREAM_ERROR_BUSY if the I/O thread is still running
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if recorder is NULL
+ * @warning The reader which feeds the recorder must be stopped (or must use another recorder) before
+ */
+eARSTREAM_ERROR ARSTREAM_Recorder_Delete (ARSTREAM_Recorder_t **recorder);
+
+/**
+ * @brief Runs the I/O thread of the recorder
+ * @param ARSTREAM_Recorder_t_Param A valid (ARSTREAM_Recorder_t *) casted as a (void *)
+ * @return No meaningful value : (void *)0
+ */
+void* ARSTREAM_Recorder_RunThread (void *ARSTREAM_Recorder_t_Param);
+
+/**
+ * @brief Queues a frame for writing
+ * This function only copies the frame : it never waits for the file system.
+ * @param[in] recorder The recorder
+ * @param[in] data The frame
+ * @param[in] size Size of the frame
+ * @param[in] frameNumber Number of the frame, stored in the index
+ * @param[in] flags ARSTREAM_RECORDER_INDEX_FLAG_xxx, stored in the index
+ * @return ARSTREAM_OK if the frame was queued
+ * @return ARSTREAM_ERROR_QUEUE_FULL if the free buffers can not hold the frame (the frame is dropped)
+ * @return ARSTREAM_ERROR_ALLOC if the index can not grow (the frame is dropped)
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if recorder or data is NULL, or if the recorder is stopped
+ * @note Only one thread at a time may add frames
+ */
+eARSTREAM_ERROR ARSTREAM_Recorder_AddFrame (ARSTREAM_Recorder_t *recorder, const uint8_t *data, uint32_t size, uint32_t frameNumber, uint32_t flags);
+
+/**
+ * @brief Gets the number of frames in the in-memory index
+ * @param[in] recorder The recorder
+ * @return The number of frames, or -1 if recorder is NULL
+ */
+int ARSTREAM_Recorder_GetNbIndexEntries (ARSTREAM_Recorder_t *recorder);
+
+/**
+ * @brief Gets an entry of the in-memory index
+ * @param[in] recorder The recorder
+ * @param[in] index Index of the frame, in recording order
+ * @param[out] entry Pointer which will hold the entry
+ * @return ARSTREAM_OK if entry was filled
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if recorder or entry is NULL, or if index is out of range
+ */
+eARSTREAM_ERROR ARSTREAM_Recorder_GetIndexEntry (ARSTREAM_Recorder_t *recorder, int index, ARSTREAM_Recorder_IndexEntry_t *entry);
+
+/**
+ * @brief Gets the counters of a recorder
+ * @param[in] recorder The recorder
+ * @param[out] counters Pointer which will hold the counters
+ * @return ARSTREAM_OK if counters was filled
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if recorder or counters is NULL
+ */
+eARSTREAM_ERROR ARSTREAM_Recorder_GetCounters (ARSTREAM_Recorder_t *recorder, ARSTREAM_Recorder_Counters_t *counters);
+
+#endif /* _ARSTREAM_RECORDER_H_ */
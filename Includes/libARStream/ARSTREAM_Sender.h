@@ -42,17 +42,38 @@
  * System Headers
  */
 #include <inttypes.h>
+#include <time.h>
 
 /*
  * ARSDK Headers
  */
 #include <libARNetwork/ARNETWORK_Manager.h>
 #include <libARStream/ARSTREAM_Error.h>
+#include <libARStream/ARSTREAM_Impairment.h>
+#include <libARStream/ARSTREAM_Thread.h>
 
 /*
  * Macros
  */
 
+/**
+ * @brief Maximum number of readers of a fan-out sender
+ * @see ARSTREAM_Sender_SetFanOut
+ */
+#define ARSTREAM_SENDER_FAN_OUT_MAX_RECEIVERS (32)
+
+/**
+ * @brief Time without acks after which a reader of a fan-out sender is forgotten, in ms
+ * @see ARSTREAM_Sender_SetFanOut
+ */
+#define ARSTREAM_SENDER_FAN_OUT_RECEIVER_TIMEOUT_MS (1000)
+
+/**
+ * @brief Size of the stream encryption keys, in bytes
+ * @see ARSTREAM_Sender_SetEncryptionKey
+ */
+#define ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE (32)
+
 /*
  * Types
  */
@@ -62,11 +83,54 @@
  */
 typedef enum {
     ARSTREAM_SENDER_STATUS_FRAME_SENT = 0, /**< Frame was sent and acknowledged by peer */
-    ARSTREAM_SENDER_STATUS_FRAME_CANCEL, /**< Frame was not sent, and was cancelled by a new frame */
+    ARSTREAM_SENDER_STATUS_FRAME_CANCEL, /**< Frame was not sent, and was cancelled by a new frame, dropped at its deadline, or dropped because the link falls behind */
     ARSTREAM_SENDER_STATUS_FRAME_LATE_ACK, /**< We received a full ack for an old frame. The callback will be called with null pointer and zero size. */
     ARSTREAM_SENDER_STATUS_MAX,
 } eARSTREAM_SENDER_STATUS;
 
+/**
+ * @brief Redundancy policies of a sender
+ * @see ARSTREAM_Sender_SetRedundancy
+ */
+typedef enum {
+    ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE = 0, /**< The sender selects the redundancy from the measured loss rate (default) */
+    ARSTREAM_SENDER_REDUNDANCY_NONE, /**< Fragments are sent once, losses are only recovered by retries */
+    ARSTREAM_SENDER_REDUNDANCY_DUPLICATE, /**< Fragments are sent twice */
+    ARSTREAM_SENDER_REDUNDANCY_FEC, /**< Parity fragments are sent along with the frame, so the reader can rebuild lost fragments without retries */
+    ARSTREAM_SENDER_REDUNDANCY_MAX,
+} eARSTREAM_SENDER_REDUNDANCY;
+
+/**
+ * @brief Fragmentation modes of a sender
+ * @see ARSTREAM_Sender_SetFragmentation
+ */
+typedef enum {
+    ARSTREAM_SENDER_FRAGMENTATION_FIXED = 0, /**< Frames are cut in fragments of maxFragmentSize bytes (default) */
+    ARSTREAM_SENDER_FRAGMENTATION_NAL_UNITS, /**< Frames are H.264/H.265 Annex B byte streams, and fragments are cut on NAL units boundaries */
+    ARSTREAM_SENDER_FRAGMENTATION_MAX,
+} eARSTREAM_SENDER_FRAGMENTATION;
+
+/**
+ * @brief Behaviours of the frame queue of a sender when it is full
+ * @see ARSTREAM_Sender_SetQueuePolicy
+ */
+typedef enum {
+    ARSTREAM_SENDER_QUEUE_POLICY_FAIL_WHEN_FULL = 0, /**< New frames are refused with ARSTREAM_ERROR_QUEUE_FULL (default) */
+    ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST, /**< The oldest waiting non-reference or P-Frame is cancelled to make room for the new frame */
+    ARSTREAM_SENDER_QUEUE_POLICY_MAX,
+} eARSTREAM_SENDER_QUEUE_POLICY;
+
+/**
+ * @brief Frame classes, which tell the sender what can be dropped first
+ * @see ARSTREAM_Sender_SendNewFrameWithDeadline
+ */
+typedef enum {
+    ARSTREAM_SENDER_FRAME_CLASS_I = 0, /**< Flush frame (typically an I-Frame): the frame queue is flushed when adding it, and it is sent with high priority */
+    ARSTREAM_SENDER_FRAME_CLASS_P, /**< Reference frame (typically a P-Frame) */
+    ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE, /**< Frame which no other frame depends on: dropped when several newer frames are waiting in the queue */
+    ARSTREAM_SENDER_FRAME_CLASS_MAX,
+} eARSTREAM_SENDER_FRAME_CLASS;
+
 /**
  * @brief Callback type for sender informations
  * This callback is called when a frame pointer is no longer needed by the library.
@@ -86,6 +150,53 @@ typedef enum {
  */
 typedef void (*ARSTREAM_Sender_FrameUpdateCallback_t)(eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom);
 
+/**
+ * @brief Callback type for the sender target bitrate
+ * This callback is called by the sender data thread each time the congestion control changes the target bitrate
+ * (at most once per 100 ms). The encoder should be reconfigured to match this bitrate.
+ *
+ * @param[in] targetBitrate The new target bitrate, in bits per second
+ * @param[in] lossRate The ratio of fragments sent during the last interval which were not acknowledged (0.0 to 1.0)
+ * @param[in] rttMs The smoothed round trip time, in ms (-1 if not measured yet)
+ * @param[in] custom Custom pointer passed during ARSTREAM_Sender_New
+ * @see ARSTREAM_Sender_SetBitrateCallback
+ */
+typedef void (*ARSTREAM_Sender_BitrateCallback_t)(uint32_t targetBitrate, float lossRate, int rttMs, void *custom);
+
+/**
+ * @brief Number of buckets of the latency histograms of ARSTREAM_Sender_Stats_t
+ * Bucket 0 counts the latencies under 1 ms, bucket n the latencies within [2^(n-1), 2^n[ ms,
+ * and the last bucket all the latencies of 1024 ms or more
+ */
+#define ARSTREAM_SENDER_STATS_LATENCY_NB_BUCKETS (12)
+
+/**
+ * @brief Number of buckets of the queue depth histogram of ARSTREAM_Sender_Stats_t
+ * Bucket n counts the frames added while n frames were waiting in queue, the last bucket also counts all deeper queues
+ */
+#define ARSTREAM_SENDER_STATS_QUEUE_DEPTH_NB_BUCKETS (8)
+
+/**
+ * @brief Statistics of a sender
+ * All counters are accumulated since the creation of the sender, and wrap at 2^32.
+ * @see ARSTREAM_Sender_GetStats
+ */
+typedef struct {
+    uint32_t nbFramesQueued; /**< Frames added to the queue */
+    uint32_t nbFramesSent; /**< Frames fully acknowledged by the reader (ARSTREAM_SENDER_STATUS_FRAME_SENT) */
+    uint32_t nbFramesCancelled; /**< Frames flushed, dropped or not acknowledged in time (ARSTREAM_SENDER_STATUS_FRAME_CANCEL) */
+    uint32_t nbFramesLateAcked; /**< Cancelled frames which were acknowledged afterwards (ARSTREAM_SENDER_STATUS_FRAME_LATE_ACK) */
+    uint32_t nbFramesPreempted; /**< Frames whose send burst was interrupted by a newer flush frame */
+    uint32_t nbFramesOverwritten; /**< Waiting frames cancelled to make room for a new frame (ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST) */
+    uint32_t nbFragmentsSent; /**< Data fragments given to the network for the first time */
+    uint32_t nbFragmentsRetransmitted; /**< Data fragments given to the network again after their retransmission timeout */
+    uint32_t nbFragmentsDuplicated; /**< Redundant copies of data fragments (ARSTREAM_SENDER_REDUNDANCY_DUPLICATE) */
+    uint32_t nbParityFragmentsSent; /**< Parity fragments given to the network (ARSTREAM_SENDER_REDUNDANCY_FEC) */
+    uint32_t queueDepth [ARSTREAM_SENDER_STATS_QUEUE_DEPTH_NB_BUCKETS]; /**< Histogram of the number of frames waiting in queue when a frame is added */
+    uint32_t firstSendLatency [ARSTREAM_SENDER_STATS_LATENCY_NB_BUCKETS]; /**< Histogram of the time from the queueing of a frame to the send of its first fragment */
+    uint32_t ackLatency [ARSTREAM_SENDER_STATS_LATENCY_NB_BUCKETS]; /**< Histogram of the time from the queueing of a frame to its full acknowledge */
+} ARSTREAM_Sender_Stats_t;
+
 /**
  * @brief An ARSTREAM_Sender_t instance allow streaming frames over a network
  */
@@ -139,12 +250,16 @@ void ARSTREAM_Sender_InitStreamAckBuffer (ARNETWORK_IOBufferParam_t *bufferParam
  * @param[in] callback The status update callback which will be called every time the status of a send-frame is updated
  * @param[in] framesBufferSize Number of frames that the ARSTREAM_Sender_t instance will be able to hold in queue
  * @param[in] maxFragmentSize Maximum allowed size for a video data fragment. Video frames larger that will be fragmented.
- * @param[in] maxNumberOfFragment number maximum of fragment of one frame.
+ * @param[in] maxNumberOfFragment number maximum of fragment of one frame (at most 1024).
  * @param[in] custom Custom pointer which will be passed to callback
  * @param[out] error Optionnal pointer to an eARSTREAM_ERROR to hold any error information
  * @return A pointer to the new ARSTREAM_Sender_t, or NULL if an error occured
  *
  * @note framesBufferSize should be greater than the number of frames between two I-Frames
+ * @note The sender allocates (maxFragmentSize + 7) * maxNumberOfFragment bytes to hold the fragments of the current frame.
+ * Each fragment is copied once per frame in this storage, then given to the network without any further copy.
+ * @note Frames of more than 128 fragments are only sent once the reader answered with extended acks.
+ * Older readers only support up to 128 fragments per frame, so larger frames are cancelled when streaming to them.
  *
  * @see ARSTREAM_Sender_InitStreamDataBuffer()
  * @see ARSTREAM_Sender_InitStreamAckBuffer()
@@ -159,7 +274,9 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
  * Setting a high retry time might decrease reliability, but also reduce the network and cpu loads.
  * These rules apply to both the minimum and the maximum time.
  *
- * The library selects a wait time between the two bounds using data retrieved from the ARNETWORK_Manager_t.
+ * Each fragment is retried only once its own retransmission timeout has expired. This timeout is computed
+ * from the round trip time measured on acknowledged fragments (or from the ARNETWORK_Manager_t estimated
+ * latency until a measure is available), and bounded by the minimum and maximum wait times.
  *
  * If the minimum and maximum wait times are equal, then the library will always use this time.
  *
@@ -175,6 +292,202 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
  */
 eARSTREAM_ERROR ARSTREAM_Sender_SetTimeBetweenRetries (ARSTREAM_Sender_t *sender, int minWaitTimeMs, int maxWaitTimeMs);
 
+/**
+ * @brief Enables or disables the pacing of the sent fragments
+ *
+ * Without pacing, all fragments of a frame are given to the network at once, which can overflow the
+ * network driver queues on large frames. With pacing, the fragments go through a token bucket, which is
+ * refilled at the target bitrate (see ARSTREAM_Sender_SetBitrateCallback()), or faster if needed to send
+ * the whole frame within frameIntervalFraction of the (measured) time between two frames.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] frameIntervalFraction The fraction of the frame interval over which a frame is spread (0.0 to disable pacing, which is the default, up to 1.0)
+ *
+ * @return ARSTREAM_OK if the pacing is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if frameIntervalFraction is not within [0.0, 1.0].
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetPacing (ARSTREAM_Sender_t *sender, float frameIntervalFraction);
+
+/**
+ * @brief Default minimum target bitrate of the congestion control, in bits per second
+ */
+#define ARSTREAM_SENDER_DEFAULT_MINIMUM_BITRATE (100000)
+/**
+ * @brief Default maximum target bitrate of the congestion control, in bits per second
+ */
+#define ARSTREAM_SENDER_DEFAULT_MAXIMUM_BITRATE (10000000)
+/**
+ * @brief Default initial target bitrate of the congestion control, in bits per second
+ */
+#define ARSTREAM_SENDER_DEFAULT_START_BITRATE (1000000)
+
+/**
+ * @brief Sets the bitrate callback and the target bitrate range of the sender
+ *
+ * The sender estimates the available bitrate from the acknowledges: on overuse (growing round trip time,
+ * high retry rate, frames waiting in queue, or dropped frames), the target is set under the measured delivery rate.
+ * On a clean link, the target is raised by 5% every 100 ms, up to 1.5 times the delivery rate.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] callback The callback which receives the target bitrate updates (NULL to only poll it with ARSTREAM_Sender_GetTargetBitrate())
+ * @param[in] minBitrate The minimum target bitrate, in bits per second
+ * @param[in] maxBitrate The maximum target bitrate, in bits per second
+ * @param[in] startBitrate The initial target bitrate, in bits per second
+ *
+ * @return ARSTREAM_OK if the callback and range are set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, if minBitrate is zero, or if startBitrate is not within [minBitrate, maxBitrate].
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetBitrateCallback (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_BitrateCallback_t callback, uint32_t minBitrate, uint32_t maxBitrate, uint32_t startBitrate);
+
+/**
+ * @brief Sets the redundancy policy of the sender
+ * Redundancy only applies to frames which are not flush frames.
+ *
+ * With ARSTREAM_SENDER_REDUNDANCY_FEC, each block of nbDataFragments fragments is followed by
+ * nbParityFragments parity fragments. A block can be rebuilt by the reader if at most nbParityFragments
+ * consecutive fragments are lost.
+ *
+ * With ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE, the sender raises the redundancy (none, then FEC, then duplicate)
+ * when it needs too many retries, and lowers it again when the link is clean.
+ *
+ * @note FEC needs a reader which uses extended acks. Until the reader answers with extended acks, the sender uses ARSTREAM_SENDER_REDUNDANCY_DUPLICATE instead.
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] redundancy The new redundancy policy
+ * @param[in] nbDataFragments Number of data fragments per FEC block (1 to 255). Ignored if redundancy is not ARSTREAM_SENDER_REDUNDANCY_FEC
+ * @param[in] nbParityFragments Number of parity fragments per FEC block (1 to nbDataFragments). Ignored if redundancy is not ARSTREAM_SENDER_REDUNDANCY_FEC
+ *
+ * @return ARSTREAM_OK if the new policy is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if any parameter is out of range.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetRedundancy (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_REDUNDANCY redundancy, int nbDataFragments, int nbParityFragments);
+
+/**
+ * @brief Sets the fragmentation mode of the sender
+ *
+ * With ARSTREAM_SENDER_FRAGMENTATION_NAL_UNITS, the frames are searched for Annex B start codes. Small NAL units
+ * are packed together in a fragment, and large NAL units are split over several fragments, so a fragment
+ * never holds the end of a NAL unit and the start of another one. The reader can then give the complete
+ * NAL units (slices) of a frame which misses some fragments (see ARSTREAM_Reader_SetPartialFrameDelivery()).
+ *
+ * @note NAL units fragmentation needs a reader which uses extended acks. Until the reader answers with extended acks, or if a frame needs more than maxNumberOfFragment fragments once aligned, the frames are cut in fixed size fragments.
+ * @note FEC parity fragments are not sent for NAL units aligned frames, which use ARSTREAM_SENDER_REDUNDANCY_DUPLICATE instead.
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] fragmentation The new fragmentation mode
+ *
+ * @return ARSTREAM_OK if the new mode is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if fragmentation is not a valid mode.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetFragmentation (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_FRAGMENTATION fragmentation);
+
+/**
+ * @brief Sets the behaviour of the frame queue of the sender when it is full
+ *
+ * With ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST, adding a frame to a full queue never fails: the oldest
+ * waiting ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE frame is removed from the queue (or the oldest
+ * ARSTREAM_SENDER_FRAME_CLASS_P frame if there is none), and its callback is called with the
+ * ARSTREAM_SENDER_STATUS_FRAME_CANCEL status from within the send function. The waiting flush frame, which the
+ * other frames depend on, is only removed when no other frame is waiting. The frame which is currently sent is
+ * not affected.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] policy The new queue policy
+ *
+ * @return ARSTREAM_OK if the new policy is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if policy is not a valid policy.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetQueuePolicy (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_QUEUE_POLICY policy);
+
+/**
+ * @brief Sends the stream of the ARSTREAM_Sender_t to several readers
+ *
+ * The frames are fragmented and given to the data buffer once, whatever the number of readers. The data buffer
+ * should then reach all the readers (e.g. a multicast address, configured on the ARNETWORK_Manager_t). Each reader
+ * sends its acks with a different receiver id (see ARSTREAM_Reader_SetReceiverId()), either directly to the sender,
+ * or through a node which merges the acks of several readers under one id.
+ *
+ * The sender keeps the acks of each reader apart: a fragment is retransmitted (once, for all the readers) while any
+ * reader misses it, and a frame is reported as ARSTREAM_SENDER_STATUS_FRAME_SENT once all the readers acknowledged it.
+ * A reader is added when its first ack is received, and is forgotten after ARSTREAM_SENDER_FAN_OUT_RECEIVER_TIMEOUT_MS
+ * without acks. Untagged acks (receiver id 0) are accounted as another reader.
+ *
+ * @note Extended features (large frames, NAL units fragmentation, capture timestamps) are only used while all the readers use extended acks.
+ * @note ARSTREAM_SENDER_STATUS_FRAME_LATE_ACK is never reported by a fan-out sender.
+ * @param[in] sender The ARSTREAM_Sender_t to configure
+ * @param[in] maxReceivers Maximum number of readers (1 to ARSTREAM_SENDER_FAN_OUT_MAX_RECEIVERS). 0 to send to a single reader (default)
+ *
+ * @return ARSTREAM_OK if the fan-out mode is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if maxReceivers is out of range.
+ * @return ARSTREAM_ERROR_BUSY if the data or ack loop is already running.
+ * @return ARSTREAM_ERROR_ALLOC if the readers table could not be allocated.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetFanOut (ARSTREAM_Sender_t *sender, int maxReceivers);
+
+/**
+ * @brief Gets the number of readers of a fan-out sender
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return The number of readers which sent acks during the last ARSTREAM_SENDER_FAN_OUT_RECEIVER_TIMEOUT_MS
+ * @return 0 if the sender is not in fan-out mode
+ * @return -1 if sender is NULL
+ */
+int ARSTREAM_Sender_GetNbReceivers (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Encrypts and authenticates the stream of the ARSTREAM_Sender_t
+ *
+ * The data of each fragment is encrypted in place with ChaCha20-Poly1305 when the fragment is built, and followed by
+ * a 16 bytes authentication tag. The stream headers stay in clear, but are authenticated along with the data. The
+ * readers must be given the same key (see ARSTREAM_Reader_SetEncryptionKey()), they drop the fragments which do not
+ * authenticate. Encryption only costs the computation of each fragment : no copy, buffer or thread is added.
+ *
+ * The key is not exchanged by the library : the application must share it with the readers (e.g. over its control
+ * link). A new key should be used for each session : the readers reject the fragments replayed within a session, or from
+ * the previous session, but not from older sessions which used the same key.
+ *
+ * @warning Only the data fragments are protected : the ack packets are not authenticated, so a forged ack can make the
+ * sender consider fragments as received and stop retransmitting them (the readers then miss these fragments)
+ *
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @param[in] key The ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE bytes key (copied by the sender). NULL to send the stream in clear (default)
+ * @param[in] keySize The size of the key, must be ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE
+ *
+ * @return ARSTREAM_OK if the key is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if keySize is invalid.
+ * @return ARSTREAM_ERROR_ALLOC if the system random source (used for the nonces) is not available.
+ * @return ARSTREAM_ERROR_BUSY if the data loop is already running.
+ *
+ * @note The network buffers must be configured with ARSTREAM_Sender_InitStreamDataBuffer() / ARSTREAM_Reader_InitStreamDataBuffer(),
+ * which keep room for the tags.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetEncryptionKey (ARSTREAM_Sender_t *sender, const uint8_t *key, int keySize);
+
+/**
+ * @brief Reads the ack packets of the ARSTREAM_Sender_t through a network impairment emulation
+ * The ack loop then reads its buffer with ARSTREAM_Impairment_ReadData() instead of the ARNETWORK_Manager read functions.
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @param[in] impairment The impairment, created with the dataCopyMaxSize of the ack buffer. NULL to read the network buffer directly (default)
+ *
+ * @return ARSTREAM_OK if the impairment is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL.
+ * @return ARSTREAM_ERROR_BUSY if the ack loop is already running.
+ *
+ * @note The impairment is not owned by the sender, and must be deleted after the sender
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetAckImpairment (ARSTREAM_Sender_t *sender, ARSTREAM_Impairment_t *impairment);
+
+/**
+ * @brief Sets the scheduling configuration of a thread of the ARSTREAM_Sender_t
+ * The configuration (affinity, priority and name) is applied by ARSTREAM_Sender_RunDataThread() or ARSTREAM_Sender_RunAckThread()
+ * when they start, whatever created the thread. To also set the stack size, create the thread with ARSTREAM_Thread_Create().
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @param[in] thread The thread to configure
+ * @param[in] config The configuration. NULL to keep the settings of the thread (default)
+ *
+ * @return ARSTREAM_OK if the configuration is set.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender is NULL, or if thread is not valid.
+ * @return ARSTREAM_ERROR_BUSY if the thread is already running.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SetThreadConfig (ARSTREAM_Sender_t *sender, eARSTREAM_THREAD thread, const ARSTREAM_ThreadConfig_t *config);
+
 /**
  * @brief Stops a running ARSTREAM_Sender_t
  * @warning Once stopped, an ARSTREAM_Sender_t can not be restarted
@@ -210,10 +523,61 @@ eARSTREAM_ERROR ARSTREAM_Sender_Delete (ARSTREAM_Sender_t **sender);
  * @return ARSTREAM_OK if no error happened
  * @return ARSTREAM_ERROR_BAD_PARAMETERS if the sender or frameBuffer pointer is invalid, or if frameSize is zero
  * @return ARSTREAM_ERROR_FRAME_TOO_LARGE if the frameSize is greater that the maximum frame size of the libARStream (typically 128000 bytes)
- * @return ARSTREAM_ERROR_QUEUE_FULL if the frame can not be added to queue. This value can not happen if flushPreviousFrames is active
+ * @return ARSTREAM_ERROR_QUEUE_FULL if the frame can not be added to queue. This value can not happen if flushPreviousFrames is active, or with ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST
+ *
+ * @note This function never waits for the sender threads, so it can be called from a capture/encoding thread.
+ * When flushPreviousFrames is active, the FRAME_CANCEL callbacks of the flushed frames are called from within this function.
+ * The data thread also stops sending the fragments of the current frame at once, so the new frame is sent within one fragment's time.
  */
 eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrame (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, int flushPreviousFrames, int *nbPreviousFrames);
 
+/**
+ * @brief Sends a new frame, with a class and an optional deadline
+ *
+ * A frame which is still not acknowledged at its deadline is useless to the reader: the sender stops
+ * sending it (or never starts), and calls its callback with the ARSTREAM_SENDER_STATUS_FRAME_CANCEL status.
+ * Frames of the ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE class are also cancelled without being sent
+ * when the link falls behind.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t which will try to send the frame
+ * @param[in] frameBuffer pointer to the frame in memory
+ * @param[in] frameSize size of the frame in memory
+ * @param[in] frameClass The class of the frame. ARSTREAM_SENDER_FRAME_CLASS_I acts as the flushPreviousFrames flag of ARSTREAM_Sender_SendNewFrame()
+ * @param[in] deadline Optionnal absolute deadline of the frame, on the ARSAL_Time_GetTime() clock (NULL for no deadline)
+ * @param[out] nbPreviousFrames Optionnal int pointer which will store the number of frames previously in the buffer (even if the buffer is flushed)
+ * @return ARSTREAM_OK if no error happened
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if the sender or frameBuffer pointer is invalid, if frameSize is zero, or if frameClass is invalid
+ * @return ARSTREAM_ERROR_FRAME_TOO_LARGE if the frameSize is greater that the maximum frame size of the libARStream (typically 128000 bytes)
+ * @return ARSTREAM_ERROR_QUEUE_FULL if the frame can not be added to queue. This value can not happen for ARSTREAM_SENDER_FRAME_CLASS_I frames, or with ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST
+ *
+ * @note This function never waits for the sender threads, so it can be called from a capture/encoding thread.
+ * For ARSTREAM_SENDER_FRAME_CLASS_I frames, the FRAME_CANCEL callbacks of the flushed frames are called from within this function,
+ * and the data thread stops sending the fragments of the current frame at once.
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrameWithDeadline (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, int *nbPreviousFrames);
+
+/**
+ * @brief Sends a new frame, with a class, an optional deadline and a capture timestamp
+ *
+ * The capture timestamp is given to the reader with the frame, so the application can measure the
+ * end to end latency, or present the frames at their capture rate. Its unit and origin are up to the
+ * application (e.g. a 90 kHz clock, as for RTP). Comparisons between timestamps should use serial number
+ * arithmetic (<code>(int32_t)(a - b)</code>), as a 32 bits timestamp wraps.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t which will try to send the frame
+ * @param[in] frameBuffer pointer to the frame in memory
+ * @param[in] frameSize size of the frame in memory
+ * @param[in] frameClass The class of the frame. ARSTREAM_SENDER_FRAME_CLASS_I acts as the flushPreviousFrames flag of ARSTREAM_Sender_SendNewFrame()
+ * @param[in] deadline Optionnal absolute deadline of the frame, on the ARSAL_Time_GetTime() clock (NULL for no deadline)
+ * @param[in] captureTimestamp Capture timestamp of the frame, in the application clock
+ * @param[out] nbPreviousFrames Optionnal int pointer which will store the number of frames previously in the buffer (even if the buffer is flushed)
+ * @return Same values as ARSTREAM_Sender_SendNewFrameWithDeadline()
+ *
+ * @note The timestamp is only sent to readers which use extended acks, others readers only get the frame.
+ * @see ARSTREAM_Reader_FrameGetCaptureTimestamp()
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrameWithTimestamp (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, uint32_t captureTimestamp, int *nbPreviousFrames);
+
 /**
  * @brief Flushes all currently queued frames
  *
@@ -239,6 +603,42 @@ void* ARSTREAM_Sender_RunDataThread (void *ARSTREAM_Sender_t_Param);
  */
 void* ARSTREAM_Sender_RunAckThread (void *ARSTREAM_Sender_t_Param);
 
+/**
+ * @brief Runs the data loop of the ARSTREAM_Sender_t once, without blocking : takes the next frame if any, then sends the fragments which are due
+ * This is the alternative to ARSTREAM_Sender_RunDataThread() for applications which drive the sender from their own event loop
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return 0 if no error occured.
+ * @return -1 once the sender is stopped. Both loops of the sender are then ended, and it can be deleted.
+ *
+ * @note Call this function again once ARSTREAM_Sender_GetNextTimeout() elapsed
+ * @warning ARSTREAM_Sender_OnTimer() and ARSTREAM_Sender_ProcessAcks() must be called from the same thread, and can not be mixed with ARSTREAM_Sender_RunDataThread() and ARSTREAM_Sender_RunAckThread()
+ */
+int ARSTREAM_Sender_OnTimer (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Runs the acknowledge loop of the ARSTREAM_Sender_t once, without blocking : applies all the ack packets already received
+ * This is the alternative to ARSTREAM_Sender_RunAckThread() for applications which drive the sender from their own event loop
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return The time before the next call, in ms.
+ * @return -1 once the sender is stopped. Both loops of the sender are then ended, and it can be deleted.
+ *
+ * @note The network buffers can not notify new data, so this function must be polled. The returned delay is 2 ms after
+ * acks were read, then doubles after each call which reads no ack, up to 1000 ms. It goes back to 2 ms once
+ * ARSTREAM_Sender_OnTimer() takes a new frame : call this function again after each ARSTREAM_Sender_OnTimer() call to
+ * get the updated delay.
+ * @warning ARSTREAM_Sender_OnTimer() and ARSTREAM_Sender_ProcessAcks() must be called from the same thread, and can not be mixed with ARSTREAM_Sender_RunDataThread() and ARSTREAM_Sender_RunAckThread()
+ */
+int ARSTREAM_Sender_ProcessAcks (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Gets the time before the next ARSTREAM_Sender_OnTimer() call is needed
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return The time, in ms. Zero if a new frame is waiting, or if the sender is stopping.
+ *
+ * @note Ack packets are not accounted, the event loop should wait for the smaller of this time and the delay returned by ARSTREAM_Sender_ProcessAcks()
+ */
+int ARSTREAM_Sender_GetNextTimeout (ARSTREAM_Sender_t *sender);
+
 /**
  * @brief Gets the estimated network efficiency for the ARSTREAM link
  * An efficiency of 1.0f means that we did not do any retries
@@ -247,6 +647,14 @@ void* ARSTREAM_Sender_RunAckThread (void *ARSTREAM_Sender_t_Param);
  */
 float ARSTREAM_Sender_GetEstimatedEfficiency (ARSTREAM_Sender_t *sender);
 
+/**
+ * @brief Gets the current target bitrate of the sender congestion control
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return The target bitrate, in bits per second, or 0 if sender does not point to a valid sender
+ * @see ARSTREAM_Sender_SetBitrateCallback
+ */
+uint32_t ARSTREAM_Sender_GetTargetBitrate (ARSTREAM_Sender_t *sender);
+
 /**
  * @brief Gets the custom pointer associated with the sender
  * @param[in] sender The ARSTREAM_Sender_t
@@ -254,4 +662,28 @@ float ARSTREAM_Sender_GetEstimatedEfficiency (ARSTREAM_Sender_t *sender);
  */
 void* ARSTREAM_Sender_GetCustom (ARSTREAM_Sender_t *sender);
 
+/**
+ * @brief Gets the number of times the sender ran out of preallocated network callback params
+ * When this happens, the sender falls back to heap allocations, so this value should stay at zero
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @return The number of pool misses since the sender creation, or 0 if sender does not point to a valid sender
+ */
+uint32_t ARSTREAM_Sender_GetCallbackParamsPoolMisses (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Gets a snapshot of the statistics of the sender
+ *
+ * The counters are updated without any lock by the sender threads, so this function never waits for them,
+ * and can be polled (e.g. every second) to export the stream statistics. Rates should be computed from the
+ * difference between two snapshots, with unsigned arithmetic, as the counters wrap.
+ *
+ * @param[in] sender The ARSTREAM_Sender_t
+ * @param[out] stats Pointer which will hold the statistics
+ * @return ARSTREAM_OK if stats was filled
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if sender or stats is NULL
+ *
+ * @note Counters are read one by one while the sender runs, so two counters of a snapshot may differ by the events of the last few microseconds
+ */
+eARSTREAM_ERROR ARSTREAM_Sender_GetStats (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Stats_t *stats);
+
 #endif /* _ARSTREAM_SENDER_H_ */
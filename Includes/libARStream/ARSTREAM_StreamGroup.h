@@ -0,0 +1,168 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_StreamGroup.h
+ * @brief Runs many stream senders/readers on a fixed number of threads
+ * @date 10/14/2026
+ */
+
+#ifndef _ARSTREAM_STREAM_GROUP_H_
+#define _ARSTREAM_STREAM_GROUP_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * ARSDK Headers
+ */
+#include <libARStream/ARSTREAM_Error.h>
+#include <libARStream/ARSTREAM_Sender.h>
+#include <libARStream/ARSTREAM_Reader.h>
+
+/*
+ * Macros
+ */
+
+/**
+ * @brief Default weight of a stream in a group
+ */
+#define ARSTREAM_STREAM_GROUP_DEFAULT_WEIGHT (1)
+
+/**
+ * @brief Maximum weight of a stream in a group
+ */
+#define ARSTREAM_STREAM_GROUP_MAX_WEIGHT (64)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief An ARSTREAM_StreamGroup_t runs the data and acknowledge loops of many ARSTREAM_Sender_t and ARSTREAM_Reader_t
+ * on a pool of worker threads, instead of two threads per stream
+ *
+ * Each time a worker picks a loop, the loop may send or read up to (weight * 8) fragments (or ack packets),
+ * then the worker moves to the next loop which has work to do. The bandwidth of the streams which have more
+ * to send than the link capacity is thus shared according to their weights.
+ *
+ * @note The network buffers can not notify new data, so the loops which read from the network are polled.
+ * The poll delay starts at 2 ms and doubles after each empty read, up to the read timeout used by the dedicated threads
+ * (500 ms for the reader data, 1000 ms for the sender acks). It goes back to 2 ms when data is read, or when the stream
+ * is woken (new frame or flush on a sender, ack request on a reader, stop). The first fragment of a reader which was idle
+ * can thus wait up to 500 ms.
+ */
+typedef struct ARSTREAM_StreamGroup_t ARSTREAM_StreamGroup_t;
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Creates a new, empty, ARSTREAM_StreamGroup_t
+ * @param[in] maxNbStreams Maximum number of senders and readers in the group
+ * @param[out] error Optionnal pointer to an eARSTREAM_ERROR to hold any error information
+ * @return A pointer to the new ARSTREAM_StreamGroup_t, or NULL if an error occured
+ *
+ * @see ARSTREAM_StreamGroup_RunWorkerThread()
+ * @see ARSTREAM_StreamGroup_Stop()
+ * @see ARSTREAM_StreamGroup_Delete()
+ */
+ARSTREAM_StreamGroup_t* ARSTREAM_StreamGroup_New (int maxNbStreams, eARSTREAM_ERROR *error);
+
+/**
+ * @brief Adds an ARSTREAM_Sender_t to the group
+ * The group runs both loops of the sender, from now on, until ARSTREAM_Sender_StopSender() is called
+ *
+ * @param[in] group The group
+ * @param[in] sender The sender. Its loops must not be already running
+ * @param[in] weight Weight of the sender, from 1 to ARSTREAM_STREAM_GROUP_MAX_WEIGHT
+ * @return ARSTREAM_OK if no error occured.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if any parameter is invalid.
+ * @return ARSTREAM_ERROR_BUSY if the group is full, or stopped.
+ *
+ * @warning ARSTREAM_Sender_RunDataThread() and ARSTREAM_Sender_RunAckThread() must not be called for a sender of a group
+ * @note Once ARSTREAM_Sender_StopSender() was called, the sender leaves the group, and ARSTREAM_Sender_Delete() succeeds as soon as the group ended its loops
+ */
+eARSTREAM_ERROR ARSTREAM_StreamGroup_AddSender (ARSTREAM_StreamGroup_t *group, ARSTREAM_Sender_t *sender, int weight);
+
+/**
+ * @brief Adds an ARSTREAM_Reader_t to the group
+ * The group runs both loops of the reader, from now on, until ARSTREAM_Reader_StopReader() is called
+ *
+ * @param[in] group The group
+ * @param[in] reader The reader. Its loops must not be already running
+ * @param[in] weight Weight of the reader, from 1 to ARSTREAM_STREAM_GROUP_MAX_WEIGHT
+ * @return ARSTREAM_OK if no error occured.
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if any parameter is invalid.
+ * @return ARSTREAM_ERROR_BUSY if the group is full, or stopped.
+ *
+ * @warning ARSTREAM_Reader_RunDataThread() and ARSTREAM_Reader_RunAckThread() must not be called for a reader of a group
+ * @note Once ARSTREAM_Reader_StopReader() was called, the reader leaves the group, and ARSTREAM_Reader_Delete() succeeds as soon as the group ended its loops
+ */
+eARSTREAM_ERROR ARSTREAM_StreamGroup_AddReader (ARSTREAM_StreamGroup_t *group, ARSTREAM_Reader_t *reader, int weight);
+
+/**
+ * @brief Runs a worker of the ARSTREAM_StreamGroup_t
+ * Any number of threads can run this function for the same group
+ * @warning This function never returns until ARSTREAM_StreamGroup_Stop() is called, and all the streams of the group are stopped. Thus, it should be called on its own thread
+ * @post Stop the ARSTREAM_StreamGroup_t by calling ARSTREAM_StreamGroup_Stop() before joining the thread calling this function
+ * @param[in] ARSTREAM_StreamGroup_t_Param A valid (ARSTREAM_StreamGroup_t *) casted as a (void *)
+ */
+void* ARSTREAM_StreamGroup_RunWorkerThread (void *ARSTREAM_StreamGroup_t_Param);
+
+/**
+ * @brief Stops the workers of an ARSTREAM_StreamGroup_t
+ * The workers return once all the streams of the group are stopped
+ * @warning Once stopped, an ARSTREAM_StreamGroup_t can not be restarted, and streams can not be added
+ *
+ * @param[in] group The ARSTREAM_StreamGroup_t to stop
+ *
+ * @note Calling this function multiple times has no effect
+ */
+void ARSTREAM_StreamGroup_Stop (ARSTREAM_StreamGroup_t *group);
+
+/**
+ * @brief Deletes an ARSTREAM_StreamGroup_t
+ * @warning This function should NOT be called on a running ARSTREAM_StreamGroup_t
+ *
+ * @param group Pointer to the ARSTREAM_StreamGroup_t * to delete
+ *
+ * @return ARSTREAM_OK if the ARSTREAM_StreamGroup_t was deleted
+ * @return ARSTREAM_ERROR_BUSY if the ARSTREAM_StreamGroup_t is still busy (workers are running, or streams are not stopped)
+ * @return ARSTREAM_ERROR_BAD_PARAMETERS if group does not point to a valid ARSTREAM_StreamGroup_t
+ *
+ * @note The library use a double pointer, so it can set *group to NULL after freeing it
+ */
+eARSTREAM_ERROR ARSTREAM_StreamGroup_Delete (ARSTREAM_StreamGroup_t **group);
+
+#endif /* _ARSTREAM_STREAM_GROUP_H_ */
@@ -0,0 +1,118 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Thread.h
+ * @brief Scheduling configuration of the ARSTREAM threads
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_THREAD_H_
+#define _ARSTREAM_THREAD_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/*
+ * ARSDK Headers
+ */
+
+/*
+ * Macros
+ */
+
+/**
+ * @brief Maximum length of a thread name, including the terminating null byte (Linux limit)
+ */
+#define ARSTREAM_THREAD_NAME_MAX_LENGTH (16)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Threads of an ARSTREAM_Sender_t or ARSTREAM_Reader_t
+ */
+typedef enum {
+    ARSTREAM_THREAD_DATA = 0, /**< Thread running ARSTREAM_xxx_RunDataThread() */
+    ARSTREAM_THREAD_ACK, /**< Thread running ARSTREAM_xxx_RunAckThread() */
+    ARSTREAM_THREAD_MAX, /**< Number of threads */
+} eARSTREAM_THREAD;
+
+/**
+ * @brief Scheduling configuration of a thread
+ * All the zero values keep the settings of the thread unchanged (see ARSTREAM_ThreadConfig_Default()).
+ */
+typedef struct {
+    uint64_t cpuAffinityMask; /**< CPUs allowed to run the thread (bit n for CPU n). 0 to keep the current affinity */
+    int realtimePriority; /**< SCHED_FIFO priority of the thread. 0 to keep the current policy */
+    char name [ARSTREAM_THREAD_NAME_MAX_LENGTH]; /**< Name of the thread. Empty to keep the current name */
+    size_t stackSize; /**< Stack size of the thread. 0 for the system default. Only used by ARSTREAM_Thread_Create() */
+} ARSTREAM_ThreadConfig_t;
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Sets an ARSTREAM_ThreadConfig_t to its default values : keep the system settings
+ * @param[out] config The configuration to set
+ */
+void ARSTREAM_ThreadConfig_Default (ARSTREAM_ThreadConfig_t *config);
+
+/**
+ * @brief Applies a configuration (affinity, priority and name) to the calling thread
+ * The ARSTREAM_xxx_RunDataThread() and ARSTREAM_xxx_RunAckThread() functions call this function with the
+ * configuration given to ARSTREAM_Sender_SetThreadConfig() / ARSTREAM_Reader_SetThreadConfig(). Applications which
+ * run the event-driven loops from their own threads can call it directly.
+ * @param[in] config The configuration
+ * @return 0 if all the settings were applied
+ * @return -1 if a setting could not be applied (e.g. a realtime priority without the needed privileges). The other settings are still applied
+ * @note The stack size can only be set when the thread is created, see ARSTREAM_Thread_Create()
+ */
+int ARSTREAM_Thread_ApplyConfig (const ARSTREAM_ThreadConfig_t *config);
+
+/**
+ * @brief Creates a thread with the stack size of a configuration
+ * The other settings are applied by the thread function (e.g. ARSTREAM_Sender_RunDataThread() applies the configuration
+ * given to ARSTREAM_Sender_SetThreadConfig()), so that they also apply to threads created by other means (e.g. Java threads).
+ * @param[out] thread The new thread
+ * @param[in] config The configuration. NULL for the default stack size
+ * @param[in] routine The thread function
+ * @param[in] arg The argument of routine
+ * @return The pthread_create() return value
+ */
+int ARSTREAM_Thread_Create (pthread_t *thread, const ARSTREAM_ThreadConfig_t *config, void *(*routine) (void *), void *arg);
+
+#endif /* _ARSTREAM_THREAD_H_ */
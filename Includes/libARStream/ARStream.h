@@ -41,5 +41,10 @@
 #include <libARStream/ARSTREAM_Error.h>
 #include <libARStream/ARSTREAM_Sender.h>
 #include <libARStream/ARSTREAM_Reader.h>
+#include <libARStream/ARSTREAM_StreamGroup.h>
+#include <libARStream/ARSTREAM_Impairment.h>
+#include <libARStream/ARSTREAM_Recorder.h>
+#include <libARStream/ARSTREAM_Thread.h>
+#include <libARStream/ARSTREAM_Crypto.h>
 
 #endif /* _ARSTREAM_H_ */
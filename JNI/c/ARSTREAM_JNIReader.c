@@ -29,56 +29,78 @@
     SUCH DAMAGE.
 */
 #include <jni.h>
+#include <pthread.h>
+#include <string.h>
 #include <libARStream/ARSTREAM_Reader.h>
+#include <libARStream/ARSTREAM_Crypto.h>
 #include <libARSAL/ARSAL_Print.h>
 
 #define JNI_READER_TAG "ARSTREAM_JNIReader"
 
 static jmethodID g_cbWrapper_id = 0;
+static jfieldID g_nextBufferCapacity_id = 0;
 static JavaVM *g_vm = NULL;
+static pthread_key_t g_threadKey;
+static pthread_once_t g_threadKeyOnce = PTHREAD_ONCE_INIT;
 
-static uint8_t* internalCallback (eARSTREAM_READER_CAUSE cause, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, uint32_t *newBufferCapacity, void *thizz)
+static void detachThread (void *env)
+{
+    (*g_vm)->DetachCurrentThread(g_vm);
+}
+
+static void createThreadKey (void)
+{
+    pthread_key_create (&g_threadKey, detachThread);
+}
+
+/**
+ * Gets the JNI environment of the current thread.
+ * Native threads are attached on their first callback, and stay attached
+ * until they exit (the thread key destructor detaches them).
+ */
+static JNIEnv* getThreadEnv (void)
 {
     JNIEnv *env = NULL;
-    int wasAlreadyAttached = 1;
     int envStatus = (*g_vm)->GetEnv(g_vm, (void **)&env, JNI_VERSION_1_6);
     if (envStatus == JNI_EDETACHED)
     {
-        wasAlreadyAttached = 0;
         if ((*g_vm)->AttachCurrentThread(g_vm, &env, NULL) != 0)
         {
             ARSAL_PRINT (ARSAL_PRINT_ERROR, JNI_READER_TAG, "Unable to attach thread to VM");
-            *newBufferCapacity = 0;
             return NULL;
         }
+        pthread_once (&g_threadKeyOnce, createThreadKey);
+        pthread_setspecific (g_threadKey, env);
     }
     else if (envStatus != JNI_OK)
     {
         ARSAL_PRINT (ARSAL_PRINT_ERROR, JNI_READER_TAG, "Error %d while getting JNI Environment", envStatus);
-        *newBufferCapacity = 0;
         return NULL;
     }
+    return env;
+}
 
-    jboolean isFlush = (isFlushFrame == 1) ? JNI_TRUE : JNI_FALSE;
-    jlongArray newNativeDataInfos = (*env)->CallObjectMethod(env, (jobject)thizz, g_cbWrapper_id, (jint)cause, (jlong)(intptr_t)framePointer, (jint)frameSize, isFlush, (jint)numberOfSkippedFrames, (jint)*newBufferCapacity);
-
-    uint8_t *retVal = NULL;
-    *newBufferCapacity = 0;
-    if (newNativeDataInfos != NULL)
+static uint8_t* internalCallback (eARSTREAM_READER_CAUSE cause, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, uint32_t *newBufferCapacity, void *thizz)
+{
+    JNIEnv *env = getThreadEnv ();
+    if (env == NULL)
     {
-        jlong *array = (*env)->GetLongArrayElements(env, newNativeDataInfos, NULL);
-        retVal = (uint8_t *)(intptr_t)array[0];
-        *newBufferCapacity = (int)array[1];
-        (*env)->ReleaseLongArrayElements(env, newNativeDataInfos, array, 0);
-
-        (*env)->DeleteLocalRef (env, newNativeDataInfos);
+        *newBufferCapacity = 0;
+        return NULL;
     }
 
-    if (wasAlreadyAttached == 0)
+    /* The next buffer is returned as a pointer, and its capacity in a field : nothing is allocated on the Java heap */
+    jboolean isFlush = (isFlushFrame == 1) ? JNI_TRUE : JNI_FALSE;
+    jlong newNativeData = (*env)->CallLongMethod(env, (jobject)thizz, g_cbWrapper_id, (jint)cause, (jlong)(intptr_t)framePointer, (jint)frameSize, isFlush, (jint)numberOfSkippedFrames, (jint)*newBufferCapacity);
+    if ((*env)->ExceptionCheck(env))
     {
-        (*g_vm)->DetachCurrentThread(g_vm);
+        (*env)->ExceptionDescribe(env);
+        (*env)->ExceptionClear(env);
+        newNativeData = 0;
     }
 
+    uint8_t *retVal = (uint8_t *)(intptr_t)newNativeData;
+    *newBufferCapacity = (retVal != NULL) ? (uint32_t)(*env)->GetIntField(env, (jobject)thizz, g_nextBufferCapacity_id) : 0;
     return retVal;
 }
 
@@ -90,7 +112,8 @@ Java_com_parrot_arsdk_arstream_ARStreamReader_nativeInitClass (JNIEnv *env, jcla
     {
         ARSAL_PRINT (ARSAL_PRINT_ERROR, JNI_READER_TAG, "Unable to get JavaVM pointer");
     }
-    g_cbWrapper_id = (*env)->GetMethodID (env, clazz, "callbackWrapper", "(IJIZII)[J");
+    g_cbWrapper_id = (*env)->GetMethodID (env, clazz, "callbackWrapper", "(IJIZII)J");
+    g_nextBufferCapacity_id = (*env)->GetFieldID (env, clazz, "nextFrameBufferCapacity", "I");
 }
 
 JNIEXPORT jint JNICALL
@@ -171,3 +194,52 @@ Java_com_parrot_arsdk_arstream_ARStreamReader_nativeGetEfficiency (JNIEnv *env,
 {
     return ARSTREAM_Reader_GetEstimatedEfficiency ((ARSTREAM_Reader_t *)(intptr_t)cReader);
 }
+
+JNIEXPORT jint JNICALL
+Java_com_parrot_arsdk_arstream_ARStreamReader_nativeSetThreadConfig (JNIEnv *env, jobject thizz, jlong cReader, jint thread, jlong cpuAffinityMask, jint realtimePriority, jstring name)
+{
+    ARSTREAM_ThreadConfig_t config;
+    ARSTREAM_ThreadConfig_Default (&config);
+    config.cpuAffinityMask = (uint64_t)cpuAffinityMask;
+    config.realtimePriority = realtimePriority;
+    if (name != NULL)
+    {
+        const char *cName = (*env)->GetStringUTFChars(env, name, NULL);
+        if (cName != NULL)
+        {
+            strncpy (config.name, cName, ARSTREAM_THREAD_NAME_MAX_LENGTH - 1);
+            (*env)->ReleaseStringUTFChars(env, name, cName);
+        }
+    }
+    eARSTREAM_ERROR err = ARSTREAM_Reader_SetThreadConfig ((ARSTREAM_Reader_t *)(intptr_t)cReader, (eARSTREAM_THREAD)thread, &config);
+    return (jint)err;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_parrot_arsdk_arstream_ARStreamReader_nativeSetReceiverId (JNIEnv *env, jobject thizz, jlong cReader, jint receiverId)
+{
+    eARSTREAM_ERROR err = ARSTREAM_Reader_SetReceiverId ((ARSTREAM_Reader_t *)(intptr_t)cReader, (uint8_t)receiverId);
+    return (jint)err;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_parrot_arsdk_arstream_ARStreamReader_nativeSetEncryptionKey (JNIEnv *env, jobject thizz, jlong cReader, jbyteArray key)
+{
+    eARSTREAM_ERROR err;
+    if (key == NULL)
+    {
+        err = ARSTREAM_Reader_SetEncryptionKey ((ARSTREAM_Reader_t *)(intptr_t)cReader, NULL, 0);
+    }
+    else if ((*env)->GetArrayLength (env, key) != ARSTREAM_READER_ENCRYPTION_KEY_SIZE)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else
+    {
+        uint8_t cKey [ARSTREAM_READER_ENCRYPTION_KEY_SIZE];
+        (*env)->GetByteArrayRegion (env, key, 0, ARSTREAM_READER_ENCRYPTION_KEY_SIZE, (jbyte *)cKey);
+        err = ARSTREAM_Reader_SetEncryptionKey ((ARSTREAM_Reader_t *)(intptr_t)cReader, cKey, ARSTREAM_READER_ENCRYPTION_KEY_SIZE);
+        ARSTREAM_Crypto_Wipe (cKey, sizeof (cKey));
+    }
+    return (jint)err;
+}
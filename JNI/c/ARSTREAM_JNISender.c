@@ -29,43 +29,70 @@
     SUCH DAMAGE.
 */
 #include <jni.h>
+#include <pthread.h>
+#include <string.h>
 #include <libARStream/ARSTREAM_Sender.h>
+#include <libARStream/ARSTREAM_Crypto.h>
 #include <libARSAL/ARSAL_Print.h>
 
 #define JNI_SENDER_TAG "ARSTREAM_JNISender"
 
 static jmethodID g_cbWrapper_id = 0;
 static JavaVM *g_vm = NULL;
+static pthread_key_t g_threadKey;
+static pthread_once_t g_threadKeyOnce = PTHREAD_ONCE_INIT;
 
+static void detachThread (void *env)
+{
+    (*g_vm)->DetachCurrentThread(g_vm);
+}
 
-static void internalCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *thizz)
+static void createThreadKey (void)
+{
+    pthread_key_create (&g_threadKey, detachThread);
+}
+
+/**
+ * Gets the JNI environment of the current thread.
+ * Native threads are attached on their first callback, and stay attached
+ * until they exit (the thread key destructor detaches them).
+ */
+static JNIEnv* getThreadEnv (void)
 {
     JNIEnv *env = NULL;
-    int wasAlreadyAttached = 1;
     int envStatus = (*g_vm)->GetEnv(g_vm, (void **)&env, JNI_VERSION_1_6);
     if (envStatus == JNI_EDETACHED)
     {
-        wasAlreadyAttached = 0;
         if ((*g_vm)->AttachCurrentThread(g_vm, &env, NULL) != 0)
         {
             ARSAL_PRINT (ARSAL_PRINT_ERROR, JNI_SENDER_TAG, "Unable to attach thread to VM");
-            return;
+            return NULL;
         }
+        pthread_once (&g_threadKeyOnce, createThreadKey);
+        pthread_setspecific (g_threadKey, env);
     }
     else if (envStatus != JNI_OK)
     {
         ARSAL_PRINT (ARSAL_PRINT_ERROR, JNI_SENDER_TAG, "Error %d while getting JNI Environment", envStatus);
+        return NULL;
+    }
+    return env;
+}
+
+static void internalCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *thizz)
+{
+    JNIEnv *env = getThreadEnv ();
+    if (env == NULL)
+    {
         return;
     }
 
     (*env)->CallVoidMethod(env, (jobject)thizz, g_cbWrapper_id, (jint)status, (jlong)(intptr_t)framePointer, (jint)frameSize);
-
-    if (wasAlreadyAttached == 0)
+    if ((*env)->ExceptionCheck(env))
     {
-        (*g_vm)->DetachCurrentThread(g_vm);
+        (*env)->ExceptionDescribe(env);
+        (*env)->ExceptionClear(env);
     }
-
-    return;
 }
 
 JNIEXPORT jint JNICALL
@@ -187,3 +214,45 @@ Java_com_parrot_arsdk_arstream_ARStreamSender_nativeFlushFrameQueue (JNIEnv *env
     eARSTREAM_ERROR err = ARSTREAM_Sender_FlushFramesQueue ((ARSTREAM_Sender_t *)(intptr_t)cSender);
     return (jint)err;
 }
+
+JNIEXPORT jint JNICALL
+Java_com_parrot_arsdk_arstream_ARStreamSender_nativeSetThreadConfig (JNIEnv *env, jobject thizz, jlong cSender, jint thread, jlong cpuAffinityMask, jint realtimePriority, jstring name)
+{
+    ARSTREAM_ThreadConfig_t config;
+    ARSTREAM_ThreadConfig_Default (&config);
+    config.cpuAffinityMask = (uint64_t)cpuAffinityMask;
+    config.realtimePriority = realtimePriority;
+    if (name != NULL)
+    {
+        const char *cName = (*env)->GetStringUTFChars(env, name, NULL);
+        if (cName != NULL)
+        {
+            strncpy (config.name, cName, ARSTREAM_THREAD_NAME_MAX_LENGTH - 1);
+            (*env)->ReleaseStringUTFChars(env, name, cName);
+        }
+    }
+    eARSTREAM_ERROR err = ARSTREAM_Sender_SetThreadConfig ((ARSTREAM_Sender_t *)(intptr_t)cSender, (eARSTREAM_THREAD)thread, &config);
+    return (jint)err;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_parrot_arsdk_arstream_ARStreamSender_nativeSetEncryptionKey (JNIEnv *env, jobject thizz, jlong cSender, jbyteArray key)
+{
+    eARSTREAM_ERROR err;
+    if (key == NULL)
+    {
+        err = ARSTREAM_Sender_SetEncryptionKey ((ARSTREAM_Sender_t *)(intptr_t)cSender, NULL, 0);
+    }
+    else if ((*env)->GetArrayLength (env, key) != ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else
+    {
+        uint8_t cKey [ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE];
+        (*env)->GetByteArrayRegion (env, key, 0, ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE, (jbyte *)cKey);
+        err = ARSTREAM_Sender_SetEncryptionKey ((ARSTREAM_Sender_t *)(intptr_t)cSender, cKey, ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE);
+        ARSTREAM_Crypto_Wipe (cKey, sizeof (cKey));
+    }
+    return (jint)err;
+}
@@ -49,6 +49,12 @@ public class ARStreamReader
 {
     private static final String TAG = ARStreamReader.class.getSimpleName ();
 
+    /**
+     * Values of eARSTREAM_THREAD
+     */
+    private static final int THREAD_DATA = 0;
+    private static final int THREAD_ACK = 1;
+
     /* *********************** */
     /* INTERNAL REPRESENTATION */
     /* *********************** */
@@ -68,6 +74,11 @@ public class ARStreamReader
      */
     private ARNativeData previousFrameBuffer;
 
+    /**
+     * Capacity of the buffer returned by callbackWrapper (read by the native code)
+     */
+    private int nextFrameBufferCapacity;
+
     /**
      * Event listener
      */
@@ -188,6 +199,61 @@ public class ARStreamReader
     /* PUBLIC FUNCTIONS */
     /* **************** */
 
+    /**
+     * Sets the scheduling configuration of the data thread.<br>
+     * The configuration is applied when the Data Runnable starts, so this function must be called before.
+     * @param cpuAffinityMask CPUs allowed to run the thread (bit n for CPU n), 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority of the thread, 0 to keep the current policy
+     * @param name Name of the thread (at most 15 characters), null to keep the current name
+     * @return ARSTREAM_OK if the configuration is set, or an error if the thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setDataThreadConfig (long cpuAffinityMask, int realtimePriority, String name)
+    {
+        int err = nativeSetThreadConfig (cReader, THREAD_DATA, cpuAffinityMask, realtimePriority, name);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
+    /**
+     * Sets the scheduling configuration of the ack thread.<br>
+     * The configuration is applied when the Ack Runnable starts, so this function must be called before.
+     * @param cpuAffinityMask CPUs allowed to run the thread (bit n for CPU n), 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority of the thread, 0 to keep the current policy
+     * @param name Name of the thread (at most 15 characters), null to keep the current name
+     * @return ARSTREAM_OK if the configuration is set, or an error if the thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setAckThreadConfig (long cpuAffinityMask, int realtimePriority, String name)
+    {
+        int err = nativeSetThreadConfig (cReader, THREAD_ACK, cpuAffinityMask, realtimePriority, name);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
+    /**
+     * Sets the receiver id written in the acks of the reader.<br>
+     * Each reader of a fan-out sender must use a different id. This function must be called before the Ack Runnable starts.
+     * @param receiverId The receiver id (1 to 255), 0 to send untagged acks
+     * @return ARSTREAM_OK if the id is set, or an error if the ack thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setReceiverId (int receiverId)
+    {
+        if ((receiverId < 0) || (receiverId > 255)) {
+            return ARSTREAM_ERROR_ENUM.ARSTREAM_ERROR_BAD_PARAMETERS;
+        }
+        int err = nativeSetReceiverId (cReader, receiverId);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
+    /**
+     * Sets the key used to authenticate and decrypt the stream (the key of the sender).<br>
+     * With a key, the fragments which do not authenticate are dropped. This function must be called before the Data Runnable starts.
+     * @param key The 32 bytes key, null to read a clear stream
+     * @return ARSTREAM_OK if the key is set, or an error if the key size is invalid or the data thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setEncryptionKey (byte[] key)
+    {
+        int err = nativeSetEncryptionKey (cReader, key);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
     /**
      * Checks if the current manager is valid.<br>
      * A valid manager is a manager which can be used to receive video frames.
@@ -254,19 +320,22 @@ public class ARStreamReader
     /* ***************** */
 
     /**
-     * Callback wrapper for the listener
+     * Callback wrapper for the listener<br>
+     * Called for every frame : it must not allocate anything
+     * @return C-Pointer to the next frame buffer (0 if none). Its capacity is stored in <code>nextFrameBufferCapacity</code>
      */
-    private long[] callbackWrapper (int icause, long ndPointer, int ndSize, boolean isFlush, int nbSkip, int newBufferCapacity) {
+    private long callbackWrapper (int icause, long ndPointer, int ndSize, boolean isFlush, int nbSkip, int newBufferCapacity) {
         ARSTREAM_READER_CAUSE_ENUM cause = ARSTREAM_READER_CAUSE_ENUM.getFromValue (icause);
+        nextFrameBufferCapacity = 0;
         if (cause == null) {
             ARSALPrint.e (TAG, "Bad cause : " + icause);
-            return null;
+            return 0;
         }
 
         if ((currentFrameBuffer == null || ndPointer != currentFrameBuffer.getData()) &&
             (previousFrameBuffer == null || ndPointer != previousFrameBuffer.getData())) {
             ARSALPrint.e (TAG, "Bad frame buffer");
-            return null;
+            return 0;
         }
 
         switch (cause) {
@@ -291,11 +360,10 @@ public class ARStreamReader
             break;
         }
         if (currentFrameBuffer != null) {
-            long retVal[] = { currentFrameBuffer.getData(), currentFrameBuffer.getCapacity() };
-            return retVal;
+            nextFrameBufferCapacity = currentFrameBuffer.getCapacity();
+            return currentFrameBuffer.getData();
         } else {
-            long retVal[] = { 0, 0 };
-            return retVal;
+            return 0;
         }
     }
 
@@ -372,6 +440,30 @@ public class ARStreamReader
      */
     private native float nativeGetEfficiency (long cReader);
 
+    /**
+     * Sets the scheduling configuration of a thread
+     * @param cReader C-Pointer to the ARSTREAM_Reader C object
+     * @param thread THREAD_DATA or THREAD_ACK
+     * @param cpuAffinityMask CPU affinity mask, 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority, 0 to keep the current policy
+     * @param name Thread name, null to keep the current name
+     */
+    private native int nativeSetThreadConfig (long cReader, int thread, long cpuAffinityMask, int realtimePriority, String name);
+
+    /**
+     * Sets the receiver id written in the acks
+     * @param cReader C-Pointer to the ARSTREAM_Reader C object
+     * @param receiverId The receiver id (0 to 255)
+     */
+    private native int nativeSetReceiverId (long cReader, int receiverId);
+
+    /**
+     * Sets the stream decryption key
+     * @param cReader C-Pointer to the ARSTREAM_Reader C object
+     * @param key The 32 bytes key, null to disable the decryption
+     */
+    private native int nativeSetEncryptionKey (long cReader, byte[] key);
+
     /**
      * Initializes global static references in native code
      */
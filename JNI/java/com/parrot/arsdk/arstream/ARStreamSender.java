@@ -30,8 +30,7 @@
 */
 package com.parrot.arsdk.arstream;
 
-import java.util.Map;
-import java.util.HashMap;
+import java.util.Arrays;
 
 import com.parrot.arsdk.arsal.ARNativeData;
 import com.parrot.arsdk.arsal.ARSALPrint;
@@ -52,6 +51,12 @@ public class ARStreamSender
 {
     private static final String TAG = ARStreamSender.class.getSimpleName ();
 
+    /**
+     * Values of eARSTREAM_THREAD
+     */
+    private static final int THREAD_DATA = 0;
+    private static final int THREAD_ACK = 1;
+
     /* *********************** */
     /* INTERNAL REPRESENTATION */
     /* *********************** */
@@ -62,9 +67,16 @@ public class ARStreamSender
     private long cSender;
 
     /**
-     * Current frames buffer storage
+     * Current frames buffer storage<br>
+     * Pooled arrays indexed together (a null frame is a free slot), so that the
+     * frame callbacks do not allocate anything (no boxed keys)
+     */
+    private ARNativeData[] frames;
+
+    /**
+     * C-Pointers of the frames in <code>frames</code>
      */
-    private Map<Long, ARNativeData> frames;
+    private long[] framesPointers;
 
     /**
      * Event listener
@@ -145,8 +157,9 @@ public class ARStreamSender
         if (this.cSender != 0) {
             this.valid = true;
             this.eventListener = theEventListener;
-            // HashMap will realloc when over 75% of its capacity, so put a greater capacity than needed to avoid that
-            this.frames = new HashMap<Long, ARNativeData> (frameBufferSize * 2);
+            // The sender holds at most its queue, plus the frame being sent
+            this.frames = new ARNativeData[frameBufferSize + 1];
+            this.framesPointers = new long[frameBufferSize + 1];
             this.dataRunnable = new Runnable () {
                     public void run () {
                         nativeRunDataThread (ARStreamSender.this.cSender);
@@ -202,6 +215,46 @@ public class ARStreamSender
      * @param minTimeMs The minimum time between two retries, in miliseconds.
      * @param maxTimeMs The maximum time between two retries, in miliseconds.
      */
+    /**
+     * Sets the scheduling configuration of the data thread.<br>
+     * The configuration is applied when the Data Runnable starts, so this function must be called before.
+     * @param cpuAffinityMask CPUs allowed to run the thread (bit n for CPU n), 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority of the thread, 0 to keep the current policy
+     * @param name Name of the thread (at most 15 characters), null to keep the current name
+     * @return ARSTREAM_OK if the configuration is set, or an error if the thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setDataThreadConfig (long cpuAffinityMask, int realtimePriority, String name)
+    {
+        int err = nativeSetThreadConfig (cSender, THREAD_DATA, cpuAffinityMask, realtimePriority, name);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
+    /**
+     * Sets the scheduling configuration of the ack thread.<br>
+     * The configuration is applied when the Ack Runnable starts, so this function must be called before.
+     * @param cpuAffinityMask CPUs allowed to run the thread (bit n for CPU n), 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority of the thread, 0 to keep the current policy
+     * @param name Name of the thread (at most 15 characters), null to keep the current name
+     * @return ARSTREAM_OK if the configuration is set, or an error if the thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setAckThreadConfig (long cpuAffinityMask, int realtimePriority, String name)
+    {
+        int err = nativeSetThreadConfig (cSender, THREAD_ACK, cpuAffinityMask, realtimePriority, name);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
+    /**
+     * Encrypts and authenticates the stream with a key shared with the readers.<br>
+     * The key is not exchanged by the library. This function must be called before the Data Runnable starts.
+     * @param key The 32 bytes key, null to send the stream in clear
+     * @return ARSTREAM_OK if the key is set, or an error if the key size is invalid or the data thread is already running
+     */
+    public ARSTREAM_ERROR_ENUM setEncryptionKey (byte[] key)
+    {
+        int err = nativeSetEncryptionKey (cSender, key);
+        return ARSTREAM_ERROR_ENUM.getFromValue (err);
+    }
+
     public ARSTREAM_ERROR_ENUM setTimeBetweenRetries(int minTimeMs, int maxTimeMs)
     {
         int err = nativeSetTimeBetweenRetries(cSender, minTimeMs, maxTimeMs);
@@ -257,7 +310,7 @@ public class ARStreamSender
             err = ARSTREAM_ERROR_ENUM.getFromValue(intErr);
             if (err == ARSTREAM_ERROR_ENUM.ARSTREAM_OK)
             {
-                frames.put(frame.getData(), frame);
+                storeFrame (frame);
             }
         }
         return err;
@@ -304,6 +357,38 @@ public class ARStreamSender
     /* PRIVATE FUNCTIONS */
     /* ***************** */
 
+    /**
+     * Stores a frame in the first free slot (must be called with the object lock held)
+     */
+    private void storeFrame (ARNativeData frame) {
+        int slot = 0;
+        while (slot < frames.length && frames[slot] != null) {
+            slot++;
+        }
+        if (slot == frames.length) {
+            // Should not happen, the arrays are sized for the sender queue
+            frames = Arrays.copyOf (frames, frames.length * 2);
+            framesPointers = Arrays.copyOf (framesPointers, framesPointers.length * 2);
+        }
+        frames[slot] = frame;
+        framesPointers[slot] = frame.getData();
+    }
+
+    /**
+     * Removes a frame from its slot (must be called with the object lock held)
+     * @return The frame, or null if no frame has this C-Pointer
+     */
+    private ARNativeData removeFrame (long ndPointer) {
+        for (int slot = 0; slot < frames.length; slot++) {
+            if (frames[slot] != null && framesPointers[slot] == ndPointer) {
+                ARNativeData frame = frames[slot];
+                frames[slot] = null;
+                return frame;
+            }
+        }
+        return null;
+    }
+
     /**
      * Callback wrapper for the listener
      */
@@ -319,7 +404,7 @@ public class ARStreamSender
             ARNativeData data = null;
             synchronized (this)
             {
-                data = frames.remove (ndPointer);
+                data = removeFrame (ndPointer);
             }
             eventListener.didUpdateFrameStatus (status, data);
             break;
@@ -419,6 +504,23 @@ public class ARStreamSender
      */
     private native int nativeSetTimeBetweenRetries(long cSender, int min, int max);
 
+    /**
+     * Sets the scheduling configuration of a thread
+     * @param cSender C-Pointer to the ARSTREAM_Sender C object
+     * @param thread THREAD_DATA or THREAD_ACK
+     * @param cpuAffinityMask CPU affinity mask, 0 to keep the current affinity
+     * @param realtimePriority SCHED_FIFO priority, 0 to keep the current policy
+     * @param name Thread name, null to keep the current name
+     */
+    private native int nativeSetThreadConfig (long cSender, int thread, long cpuAffinityMask, int realtimePriority, String name);
+
+    /**
+     * Sets the stream encryption key
+     * @param cSender C-Pointer to the ARSTREAM_Sender C object
+     * @param key The 32 bytes key, null to disable the encryption
+     */
+    private native int nativeSetEncryptionKey (long cSender, byte[] key);
+
     /**
      * Initializes global static references in native code
      */
@@ -79,7 +79,7 @@ void ARSTREAM_Buffers_InitStreamDataBuffer (ARNETWORK_IOBufferParam_t *bufferPar
         bufferParams->dataType = ARSTREAM_BUFFERS_DATA_BUFFER_TYPE;
         bufferParams->sendingWaitTimeMs = ARSTREAM_BUFFERS_DATA_BUFFER_SEND_EVERY_MS;
         bufferParams->numberOfCell = maxFragmentPerFrame * 2;
-        bufferParams->dataCopyMaxSize = maxFragmentSize + sizeof (ARSTREAM_NetworkHeaders_DataHeader_t);
+        bufferParams->dataCopyMaxSize = maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE;
         bufferParams->isOverwriting = ARSTREAM_BUFFERS_DATA_BUFFER_OVERWRITE;
     }
 }
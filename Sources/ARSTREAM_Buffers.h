@@ -63,8 +63,8 @@
 
 #define ARSTREAM_BUFFERS_ACK_BUFFER_TYPE             (ARNETWORKAL_FRAME_TYPE_DATA_LOW_LATENCY)
 #define ARSTREAM_BUFFERS_ACK_BUFFER_SEND_EVERY_MS    (0) // Zero means "send every time we can"
-#define ARSTREAM_BUFFERS_ACK_BUFFER_NUMBER_OF_CELLS  (1000) // TODO: Change to 1 when mantis 115578 will be fixed
-#define ARSTREAM_BUFFERS_ACK_BUFFER_COPY_MAX_SIZE    (sizeof (ARSTREAM_NetworkHeaders_AckPacket_t))
+#define ARSTREAM_BUFFERS_ACK_BUFFER_NUMBER_OF_CELLS  (8) // Acks are coalesced by the reader. TODO: Change to 1 when mantis 115578 will be fixed
+#define ARSTREAM_BUFFERS_ACK_BUFFER_COPY_MAX_SIZE    (ARSTREAM_NETWORK_HEADERS_ACK_PACKET_MAX_NETWORK_SIZE)
 #define ARSTREAM_BUFFERS_ACK_BUFFER_OVERWRITE        (1)
 
 /*
@@ -0,0 +1,427 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Crypto.c
+ * @brief Authenticated encryption of stream data fragments
+ * @date 10/15/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Private Headers
+ */
+#include "ARSTREAM_Crypto.h"
+#include "ARSTREAM_Fec.h"
+
+/*
+ * ARSDK Headers
+ */
+
+/*
+ * Macros
+ */
+
+#define CHACHA20_BLOCK_SIZE (64)
+#define POLY1305_BLOCK_SIZE (16)
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA20_QUARTER_ROUND(a, b, c, d)              \
+    do {                                                \
+        a += b; d ^= a; d = ROTL32 (d, 16);             \
+        c += d; b ^= c; b = ROTL32 (b, 12);             \
+        a += b; d ^= a; d = ROTL32 (d, 8);              \
+        c += d; b ^= c; b = ROTL32 (b, 7);              \
+    } while (0)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Poly1305 state, with 26 bits limbs (all products fit in 64 bits)
+ */
+typedef struct {
+    uint32_t r [5];
+    uint32_t h [5];
+    uint32_t pad [4];
+} ARSTREAM_Crypto_Poly1305_t;
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Reads a little endian 32 bits word
+ */
+static uint32_t ARSTREAM_Crypto_Load32 (const uint8_t *src);
+
+/**
+ * @brief Writes a little endian 32 bits word
+ */
+static void ARSTREAM_Crypto_Store32 (uint8_t *dst, uint32_t value);
+
+/**
+ * @brief Computes a ChaCha20 keystream block
+ * @param key The encryption key
+ * @param nonce The nonce
+ * @param counter The index of the block
+ * @param[out] block The CHACHA20_BLOCK_SIZE bytes of keystream
+ */
+static void ARSTREAM_Crypto_ChaCha20Block (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, uint32_t counter, uint8_t *block);
+
+/**
+ * @brief XOR a buffer with the ChaCha20 keystream, from block 1 (block 0 gives the Poly1305 key)
+ */
+static void ARSTREAM_Crypto_ChaCha20Xor (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, uint8_t *data, int size);
+
+/**
+ * @brief Initializes a Poly1305 state with the 32 bytes one-time key
+ */
+static void ARSTREAM_Crypto_Poly1305Init (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *oneTimeKey);
+
+/**
+ * @brief Adds full 16 bytes blocks to a Poly1305 state
+ */
+static void ARSTREAM_Crypto_Poly1305Blocks (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *data, int nbBlocks);
+
+/**
+ * @brief Adds a buffer to a Poly1305 state, zero-padded to a multiple of 16 bytes
+ */
+static void ARSTREAM_Crypto_Poly1305Padded (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *data, int size);
+
+/**
+ * @brief Computes the final tag of a Poly1305 state
+ */
+static void ARSTREAM_Crypto_Poly1305Finish (ARSTREAM_Crypto_Poly1305_t *poly, uint8_t *tag);
+
+/**
+ * @brief Computes the AEAD tag of an encrypted buffer
+ */
+static void ARSTREAM_Crypto_ComputeTag (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, const uint8_t *data, int size, uint8_t *tag);
+
+/*
+ * Internal functions implementation
+ */
+
+static uint32_t ARSTREAM_Crypto_Load32 (const uint8_t *src)
+{
+    return ((uint32_t)src [0]) | ((uint32_t)src [1] << 8) | ((uint32_t)src [2] << 16) | ((uint32_t)src [3] << 24);
+}
+
+static void ARSTREAM_Crypto_Store32 (uint8_t *dst, uint32_t value)
+{
+    dst [0] = (uint8_t)value;
+    dst [1] = (uint8_t)(value >> 8);
+    dst [2] = (uint8_t)(value >> 16);
+    dst [3] = (uint8_t)(value >> 24);
+}
+
+static void ARSTREAM_Crypto_ChaCha20Block (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, uint32_t counter, uint8_t *block)
+{
+    uint32_t state [16];
+    uint32_t x [16];
+    int i;
+
+    /* "expand 32-byte k" */
+    state [0] = 0x61707865;
+    state [1] = 0x3320646e;
+    state [2] = 0x79622d32;
+    state [3] = 0x6b206574;
+    for (i = 0; i < 8; i++)
+    {
+        state [4 + i] = key->words [i];
+    }
+    state [12] = counter;
+    state [13] = ARSTREAM_Crypto_Load32 (&nonce [0]);
+    state [14] = ARSTREAM_Crypto_Load32 (&nonce [4]);
+    state [15] = ARSTREAM_Crypto_Load32 (&nonce [8]);
+
+    memcpy (x, state, sizeof (x));
+    for (i = 0; i < 10; i++)
+    {
+        /* Columns */
+        CHACHA20_QUARTER_ROUND (x [0], x [4], x [8], x [12]);
+        CHACHA20_QUARTER_ROUND (x [1], x [5], x [9], x [13]);
+        CHACHA20_QUARTER_ROUND (x [2], x [6], x [10], x [14]);
+        CHACHA20_QUARTER_ROUND (x [3], x [7], x [11], x [15]);
+        /* Diagonals */
+        CHACHA20_QUARTER_ROUND (x [0], x [5], x [10], x [15]);
+        CHACHA20_QUARTER_ROUND (x [1], x [6], x [11], x [12]);
+        CHACHA20_QUARTER_ROUND (x [2], x [7], x [8], x [13]);
+        CHACHA20_QUARTER_ROUND (x [3], x [4], x [9], x [14]);
+    }
+    for (i = 0; i < 16; i++)
+    {
+        ARSTREAM_Crypto_Store32 (&block [4 * i], x [i] + state [i]);
+    }
+}
+
+static void ARSTREAM_Crypto_ChaCha20Xor (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, uint8_t *data, int size)
+{
+    uint8_t block [CHACHA20_BLOCK_SIZE];
+    uint32_t counter = 1;
+    int offset;
+    for (offset = 0; offset < size; offset += CHACHA20_BLOCK_SIZE)
+    {
+        int blockSize = ((size - offset) < CHACHA20_BLOCK_SIZE) ? (size - offset) : CHACHA20_BLOCK_SIZE;
+        ARSTREAM_Crypto_ChaCha20Block (key, nonce, counter, block);
+        ARSTREAM_Fec_Xor (&data [offset], block, blockSize);
+        counter++;
+    }
+    ARSTREAM_Crypto_Wipe (block, sizeof (block));
+}
+
+static void ARSTREAM_Crypto_Poly1305Init (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *oneTimeKey)
+{
+    int i;
+    /* Clamped r */
+    poly->r [0] = (ARSTREAM_Crypto_Load32 (&oneTimeKey [0])) & 0x3ffffff;
+    poly->r [1] = (ARSTREAM_Crypto_Load32 (&oneTimeKey [3]) >> 2) & 0x3ffff03;
+    poly->r [2] = (ARSTREAM_Crypto_Load32 (&oneTimeKey [6]) >> 4) & 0x3ffc0ff;
+    poly->r [3] = (ARSTREAM_Crypto_Load32 (&oneTimeKey [9]) >> 6) & 0x3f03fff;
+    poly->r [4] = (ARSTREAM_Crypto_Load32 (&oneTimeKey [12]) >> 8) & 0x00fffff;
+    for (i = 0; i < 5; i++)
+    {
+        poly->h [i] = 0;
+    }
+    for (i = 0; i < 4; i++)
+    {
+        poly->pad [i] = ARSTREAM_Crypto_Load32 (&oneTimeKey [16 + (4 * i)]);
+    }
+}
+
+static void ARSTREAM_Crypto_Poly1305Blocks (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *data, int nbBlocks)
+{
+    const uint32_t hibit = (1 << 24);
+    uint32_t r0 = poly->r [0], r1 = poly->r [1], r2 = poly->r [2], r3 = poly->r [3], r4 = poly->r [4];
+    uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = poly->h [0], h1 = poly->h [1], h2 = poly->h [2], h3 = poly->h [3], h4 = poly->h [4];
+
+    while (nbBlocks > 0)
+    {
+        uint64_t d0, d1, d2, d3, d4;
+        uint32_t c;
+
+        /* h += m */
+        h0 += (ARSTREAM_Crypto_Load32 (&data [0])) & 0x3ffffff;
+        h1 += (ARSTREAM_Crypto_Load32 (&data [3]) >> 2) & 0x3ffffff;
+        h2 += (ARSTREAM_Crypto_Load32 (&data [6]) >> 4) & 0x3ffffff;
+        h3 += (ARSTREAM_Crypto_Load32 (&data [9]) >> 6) & 0x3ffffff;
+        h4 += (ARSTREAM_Crypto_Load32 (&data [12]) >> 8) | hibit;
+
+        /* h *= r (mod 2^130 - 5) */
+        d0 = ((uint64_t)h0 * r0) + ((uint64_t)h1 * s4) + ((uint64_t)h2 * s3) + ((uint64_t)h3 * s2) + ((uint64_t)h4 * s1);
+        d1 = ((uint64_t)h0 * r1) + ((uint64_t)h1 * r0) + ((uint64_t)h2 * s4) + ((uint64_t)h3 * s3) + ((uint64_t)h4 * s2);
+        d2 = ((uint64_t)h0 * r2) + ((uint64_t)h1 * r1) + ((uint64_t)h2 * r0) + ((uint64_t)h3 * s4) + ((uint64_t)h4 * s3);
+        d3 = ((uint64_t)h0 * r3) + ((uint64_t)h1 * r2) + ((uint64_t)h2 * r1) + ((uint64_t)h3 * r0) + ((uint64_t)h4 * s4);
+        d4 = ((uint64_t)h0 * r4) + ((uint64_t)h1 * r3) + ((uint64_t)h2 * r2) + ((uint64_t)h3 * r1) + ((uint64_t)h4 * r0);
+
+        /* Partial carry propagation */
+        c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+
+        data += POLY1305_BLOCK_SIZE;
+        nbBlocks--;
+    }
+
+    poly->h [0] = h0;
+    poly->h [1] = h1;
+    poly->h [2] = h2;
+    poly->h [3] = h3;
+    poly->h [4] = h4;
+}
+
+static void ARSTREAM_Crypto_Poly1305Padded (ARSTREAM_Crypto_Poly1305_t *poly, const uint8_t *data, int size)
+{
+    int nbFullBlocks = size / POLY1305_BLOCK_SIZE;
+    int remaining = size % POLY1305_BLOCK_SIZE;
+    ARSTREAM_Crypto_Poly1305Blocks (poly, data, nbFullBlocks);
+    if (remaining > 0)
+    {
+        uint8_t block [POLY1305_BLOCK_SIZE] = { 0 };
+        memcpy (block, &data [nbFullBlocks * POLY1305_BLOCK_SIZE], remaining);
+        ARSTREAM_Crypto_Poly1305Blocks (poly, block, 1);
+    }
+}
+
+static void ARSTREAM_Crypto_Poly1305Finish (ARSTREAM_Crypto_Poly1305_t *poly, uint8_t *tag)
+{
+    uint32_t h0 = poly->h [0], h1 = poly->h [1], h2 = poly->h [2], h3 = poly->h [3], h4 = poly->h [4];
+    uint32_t g0, g1, g2, g3, g4;
+    uint32_t c, mask;
+    uint64_t f;
+
+    /* Full carry propagation */
+    c = h1 >> 26; h1 &= 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+    h1 += c;
+
+    /* g = h - p, selected instead of h (without branch) if h >= p */
+    g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    g4 = h4 + c - (1 << 26);
+    mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    /* h %= 2^128, then tag = h + pad */
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+    f = (uint64_t)h0 + poly->pad [0]; ARSTREAM_Crypto_Store32 (&tag [0], (uint32_t)f);
+    f = (uint64_t)h1 + poly->pad [1] + (f >> 32); ARSTREAM_Crypto_Store32 (&tag [4], (uint32_t)f);
+    f = (uint64_t)h2 + poly->pad [2] + (f >> 32); ARSTREAM_Crypto_Store32 (&tag [8], (uint32_t)f);
+    f = (uint64_t)h3 + poly->pad [3] + (f >> 32); ARSTREAM_Crypto_Store32 (&tag [12], (uint32_t)f);
+
+    ARSTREAM_Crypto_Wipe (poly, sizeof (*poly));
+}
+
+static void ARSTREAM_Crypto_ComputeTag (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, const uint8_t *data, int size, uint8_t *tag)
+{
+    ARSTREAM_Crypto_Poly1305_t poly;
+    uint8_t block [CHACHA20_BLOCK_SIZE];
+    uint8_t lengths [POLY1305_BLOCK_SIZE];
+
+    /* The one-time Poly1305 key is the first half of the keystream block 0 */
+    ARSTREAM_Crypto_ChaCha20Block (key, nonce, 0, block);
+    ARSTREAM_Crypto_Poly1305Init (&poly, block);
+    ARSTREAM_Crypto_Wipe (block, sizeof (block));
+
+    ARSTREAM_Crypto_Poly1305Padded (&poly, aad, aadSize);
+    ARSTREAM_Crypto_Poly1305Padded (&poly, data, size);
+    ARSTREAM_Crypto_Store32 (&lengths [0], (uint32_t)aadSize);
+    ARSTREAM_Crypto_Store32 (&lengths [4], 0);
+    ARSTREAM_Crypto_Store32 (&lengths [8], (uint32_t)size);
+    ARSTREAM_Crypto_Store32 (&lengths [12], 0);
+    ARSTREAM_Crypto_Poly1305Blocks (&poly, lengths, 1);
+    ARSTREAM_Crypto_Poly1305Finish (&poly, tag);
+}
+
+/*
+ * Implementation
+ */
+
+void ARSTREAM_Crypto_SetKey (ARSTREAM_Crypto_Key_t *key, const uint8_t *keyData)
+{
+    int i;
+    for (i = 0; i < ARSTREAM_CRYPTO_KEY_SIZE / 4; i++)
+    {
+        key->words [i] = ARSTREAM_Crypto_Load32 (&keyData [4 * i]);
+    }
+}
+
+void ARSTREAM_Crypto_Wipe (void *secret, int size)
+{
+    /* Volatile, so that the compiler does not drop the writes to memory which is not read anymore */
+    volatile uint8_t *bytes = (volatile uint8_t *)secret;
+    while (size > 0)
+    {
+        *bytes++ = 0;
+        size--;
+    }
+}
+
+int ARSTREAM_Crypto_GetRandomBytes (uint8_t *buffer, int size)
+{
+    int retVal = 0;
+    int fd = open ("/dev/urandom", O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    while ((retVal == 0) &&
+           (size > 0))
+    {
+        ssize_t nbRead = read (fd, buffer, size);
+        if (nbRead > 0)
+        {
+            buffer += nbRead;
+            size -= nbRead;
+        }
+        else if ((nbRead == 0) ||
+                 (errno != EINTR))
+        {
+            retVal = -1;
+        }
+    }
+    close (fd);
+    return retVal;
+}
+
+void ARSTREAM_Crypto_Seal (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, uint8_t *data, int size, uint8_t *tag)
+{
+    ARSTREAM_Crypto_ChaCha20Xor (key, nonce, data, size);
+    ARSTREAM_Crypto_ComputeTag (key, nonce, aad, aadSize, data, size, tag);
+}
+
+int ARSTREAM_Crypto_Open (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, uint8_t *data, int size, const uint8_t *tag)
+{
+    uint8_t expectedTag [ARSTREAM_CRYPTO_TAG_SIZE];
+    uint8_t diff = 0;
+    int i;
+
+    ARSTREAM_Crypto_ComputeTag (key, nonce, aad, aadSize, data, size, expectedTag);
+    /* Constant time comparison */
+    for (i = 0; i < ARSTREAM_CRYPTO_TAG_SIZE; i++)
+    {
+        diff |= expectedTag [i] ^ tag [i];
+    }
+    if (diff != 0)
+    {
+        return -1;
+    }
+    ARSTREAM_Crypto_ChaCha20Xor (key, nonce, data, size);
+    return 0;
+}
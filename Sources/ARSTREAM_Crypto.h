@@ -0,0 +1,139 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Crypto.h
+ * @brief Authenticated encryption of stream data fragments
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_CRYPTO_PRIVATE_H_
+#define _ARSTREAM_CRYPTO_PRIVATE_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * Private Headers
+ */
+
+/*
+ * ARSDK Headers
+ */
+#include <libARStream/ARSTREAM_Crypto.h>
+
+/*
+ * Macros
+ */
+
+/**
+ * Size of the encryption keys, in bytes
+ */
+#define ARSTREAM_CRYPTO_KEY_SIZE (32)
+
+/**
+ * Size of the nonces, in bytes
+ */
+#define ARSTREAM_CRYPTO_NONCE_SIZE (12)
+
+/**
+ * Size of the authentication tags, in bytes
+ */
+#define ARSTREAM_CRYPTO_TAG_SIZE (16)
+
+/*
+ * Types
+ */
+
+/* Fragments are protected with ChaCha20-Poly1305 (RFC 8439) :
+ * the fragment data is encrypted in place, and the tag authenticates both
+ * the encrypted data and the associated data (the stream data headers).
+ *
+ * A nonce must never be used twice with the same key : the sender draws a
+ * random nonce prefix for each key, and counts the sealed fragments in the
+ * rest of the nonce.
+ */
+
+/**
+ * @brief Expanded encryption key
+ */
+typedef struct {
+    uint32_t words [ARSTREAM_CRYPTO_KEY_SIZE / 4]; /**< Key, as little endian words */
+} ARSTREAM_Crypto_Key_t;
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Loads an encryption key
+ * @param key The key to load
+ * @param keyData The ARSTREAM_CRYPTO_KEY_SIZE bytes of the key
+ */
+void ARSTREAM_Crypto_SetKey (ARSTREAM_Crypto_Key_t *key, const uint8_t *keyData);
+
+/**
+ * @brief Fills a buffer with random bytes from the system random source
+ * @param[out] buffer The buffer to fill
+ * @param size The number of bytes to draw
+ * @return 0 on success, -1 if the random source is not available
+ */
+int ARSTREAM_Crypto_GetRandomBytes (uint8_t *buffer, int size);
+
+/**
+ * @brief Encrypts a buffer in place, and computes its authentication tag
+ * @param key The encryption key
+ * @param nonce The ARSTREAM_CRYPTO_NONCE_SIZE bytes nonce, never used before with this key
+ * @param aad The associated data, authenticated but not encrypted
+ * @param aadSize The size of the associated data, in bytes
+ * @param data The buffer to encrypt
+ * @param size The size of the buffer, in bytes
+ * @param[out] tag Buffer which will hold the ARSTREAM_CRYPTO_TAG_SIZE bytes tag (may directly follow the data)
+ */
+void ARSTREAM_Crypto_Seal (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, uint8_t *data, int size, uint8_t *tag);
+
+/**
+ * @brief Checks the authentication tag of a buffer, and decrypts it in place
+ * The buffer is only decrypted if the tag is valid.
+ * @param key The encryption key
+ * @param nonce The ARSTREAM_CRYPTO_NONCE_SIZE bytes nonce used to seal the buffer
+ * @param aad The associated data
+ * @param aadSize The size of the associated data, in bytes
+ * @param data The buffer to decrypt
+ * @param size The size of the buffer, in bytes
+ * @param tag The ARSTREAM_CRYPTO_TAG_SIZE bytes tag of the buffer
+ * @return 0 if the buffer was authenticated and decrypted
+ * @return -1 if the tag does not match (the buffer is left untouched)
+ */
+int ARSTREAM_Crypto_Open (const ARSTREAM_Crypto_Key_t *key, const uint8_t *nonce, const uint8_t *aad, int aadSize, uint8_t *data, int size, const uint8_t *tag);
+
+#endif /* _ARSTREAM_CRYPTO_PRIVATE_H_ */
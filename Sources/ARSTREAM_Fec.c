@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Fec.c
+ * @brief Forward error correction of stream data fragments
+ * @date 10/14/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+#include <string.h>
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Private Headers
+ */
+#include "ARSTREAM_Fec.h"
+
+/*
+ * ARSDK Headers
+ */
+
+/*
+ * Macros
+ */
+
+/*
+ * Types
+ */
+
+/*
+ * Internal functions declarations
+ */
+
+/*
+ * Internal functions implementation
+ */
+
+/*
+ * Implementation
+ */
+int ARSTREAM_Fec_GetNbParityFragments (int nbFragments, int blockSize, int nbParity)
+{
+    int nbBlocks = 0;
+    if ((blockSize > 0) &&
+        (nbFragments > 0))
+    {
+        nbBlocks = (nbFragments + blockSize - 1) / blockSize;
+    }
+    return nbBlocks * nbParity;
+}
+
+int ARSTREAM_Fec_GetParityIndex (int fragmentIndex, int blockSize, int nbParity)
+{
+    int block = fragmentIndex / blockSize;
+    int group = (fragmentIndex % blockSize) % nbParity;
+    return (block * nbParity) + group;
+}
+
+void ARSTREAM_Fec_GetProtectedFragments (int parityIndex, int nbFragments, int blockSize, int nbParity, int *first, int *end)
+{
+    int block = parityIndex / nbParity;
+    int group = parityIndex % nbParity;
+    *first = (block * blockSize) + group;
+    *end = (block + 1) * blockSize;
+    if (*end > nbFragments)
+    {
+        *end = nbFragments;
+    }
+}
+
+void ARSTREAM_Fec_Xor (uint8_t *dst, const uint8_t *src, int size)
+{
+    int index = 0;
+    // Process vectors with the widest instruction set available for the target (unaligned loads/stores)
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+    for (; index + 32 <= size; index += 32)
+    {
+        uint8x16_t dst0 = vld1q_u8 (&dst [index]);
+        uint8x16_t dst1 = vld1q_u8 (&dst [index + 16]);
+        dst0 = veorq_u8 (dst0, vld1q_u8 (&src [index]));
+        dst1 = veorq_u8 (dst1, vld1q_u8 (&src [index + 16]));
+        vst1q_u8 (&dst [index], dst0);
+        vst1q_u8 (&dst [index + 16], dst1);
+    }
+#elif defined (__AVX2__)
+    for (; index + 32 <= size; index += 32)
+    {
+        __m256i dstVec = _mm256_loadu_si256 ((const __m256i *)&dst [index]);
+        __m256i srcVec = _mm256_loadu_si256 ((const __m256i *)&src [index]);
+        _mm256_storeu_si256 ((__m256i *)&dst [index], _mm256_xor_si256 (dstVec, srcVec));
+    }
+#elif defined (__SSE2__)
+    for (; index + 16 <= size; index += 16)
+    {
+        __m128i dstVec = _mm_loadu_si128 ((const __m128i *)&dst [index]);
+        __m128i srcVec = _mm_loadu_si128 ((const __m128i *)&src [index]);
+        _mm_storeu_si128 ((__m128i *)&dst [index], _mm_xor_si128 (dstVec, srcVec));
+    }
+#endif
+    // Process 64 bits words (memcpy avoids any alignment requirement, and is inlined by the compiler)
+    for (; index + 8 <= size; index += 8)
+    {
+        uint64_t dstWord, srcWord;
+        memcpy (&dstWord, &dst [index], sizeof (dstWord));
+        memcpy (&srcWord, &src [index], sizeof (srcWord));
+        dstWord ^= srcWord;
+        memcpy (&dst [index], &dstWord, sizeof (dstWord));
+    }
+    for (; index < size; index++)
+    {
+        dst [index] ^= src [index];
+    }
+}
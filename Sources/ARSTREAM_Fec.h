@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Fec.h
+ * @brief Forward error correction of stream data fragments
+ * @date 10/14/2026
+ */
+
+#ifndef _ARSTREAM_FEC_PRIVATE_H_
+#define _ARSTREAM_FEC_PRIVATE_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * Private Headers
+ */
+
+/*
+ * ARSDK Headers
+ */
+
+/*
+ * Macros
+ */
+
+/*
+ * Types
+ */
+
+/* Parity fragments layout :
+ * The data fragments of a frame are grouped in blocks of blockSize fragments
+ * (the last block may be shorter). Each block is protected by nbParity parity
+ * fragments. The parity fragment p of a block is the XOR of the data fragments
+ * p, p + nbParity, p + 2 * nbParity ... of this block, zero-padded to the
+ * largest of them.
+ *
+ * A block can thus rebuild up to nbParity missing fragments, as long as they
+ * belong to different parity groups (e.g. a burst of nbParity consecutive
+ * fragments).
+ *
+ * Parity fragments are numbered from 0 to (nbBlocks * nbParity) - 1, the
+ * parity fragment p of block b having the index (b * nbParity) + p.
+ */
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Gets the number of parity fragments of a frame
+ * @param nbFragments Number of data fragments in the frame
+ * @param blockSize Number of data fragments per block
+ * @param nbParity Number of parity fragments per block
+ * @return The number of parity fragments of the frame
+ */
+int ARSTREAM_Fec_GetNbParityFragments (int nbFragments, int blockSize, int nbParity);
+
+/**
+ * @brief Gets the index of the parity fragment which protects a data fragment
+ * @param fragmentIndex Index of the data fragment
+ * @param blockSize Number of data fragments per block
+ * @param nbParity Number of parity fragments per block
+ * @return The index of the parity fragment
+ */
+int ARSTREAM_Fec_GetParityIndex (int fragmentIndex, int blockSize, int nbParity);
+
+/**
+ * @brief Gets the data fragments protected by a parity fragment
+ * The protected fragments are (*first), (*first) + nbParity ... while lower than (*end)
+ * @param parityIndex Index of the parity fragment
+ * @param nbFragments Number of data fragments in the frame
+ * @param blockSize Number of data fragments per block
+ * @param nbParity Number of parity fragments per block
+ * @param[out] first Index of the first protected data fragment
+ * @param[out] end Index of the end of the block of the parity fragment (excluded)
+ */
+void ARSTREAM_Fec_GetProtectedFragments (int parityIndex, int nbFragments, int blockSize, int nbParity, int *first, int *end);
+
+/**
+ * @brief XOR a buffer into another : dst[i] ^= src[i]
+ * Uses NEON, AVX2 or SSE2 instructions when the target enables them
+ * @param dst The destination buffer
+ * @param src The source buffer
+ * @param size The number of bytes to process
+ */
+void ARSTREAM_Fec_Xor (uint8_t *dst, const uint8_t *src, int size);
+
+#endif /* _ARSTREAM_FEC_PRIVATE_H_ */
@@ -0,0 +1,454 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Impairment.c
+ * @brief Network impairment emulation for the stream buffers
+ * @date 10/15/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARStream/ARSTREAM_Impairment.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM_IMPAIRMENT_TAG "ARSTREAM_Impairment"
+
+/**
+ * Seed used instead of 0, which is a fixed point of the xorshift generator
+ */
+#define ARSTREAM_IMPAIRMENT_ZERO_SEED_REPLACEMENT (0x9E3779B9)
+
+/**
+ * Sets *PTR to VAL if PTR is not null
+ */
+#define SET_WITH_CHECK(PTR,VAL)                 \
+    do                                          \
+    {                                           \
+        if (PTR != NULL)                        \
+        {                                       \
+            *PTR = VAL;                         \
+        }                                       \
+    } while (0)
+
+/*
+ * Types
+ */
+
+struct ARSTREAM_Impairment_t {
+    ARSTREAM_Impairment_Params_t params;
+    int maxPacketSize;
+
+    /* Held back packets (size -1 for the free entries) */
+    uint8_t *packets;
+    int *packetSizes;
+    uint64_t *releaseTimesUs;
+    uint32_t *sequences; // Arrival order, to keep the packets released at the same time in order
+    uint32_t nextSequence;
+    int nbQueued;
+
+    uint8_t *recvPacket; // Packet being read from the network buffer
+
+    /* Models states */
+    uint32_t randomState;
+    int isInBadState; // Boolean-like (0/1) flag, active if the Gilbert-Elliott model is in its bad state
+    uint64_t linkFreeTimeUs; // Time at which the emulated link ends sending its previous packets
+
+    ARSTREAM_Impairment_Counters_t counters;
+};
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Gets the current time in us
+ */
+static uint64_t ARSTREAM_Impairment_NowUs (void);
+
+/**
+ * @brief Draws the next random number of the impairment
+ */
+static uint32_t ARSTREAM_Impairment_Random (ARSTREAM_Impairment_t *impairment);
+
+/**
+ * @brief Checks a random draw against a probability
+ * @return 1 if the event with a probability of percent happens for this draw, 0 otherwise
+ */
+static int ARSTREAM_Impairment_Happens (uint32_t draw, float percent);
+
+/**
+ * @brief Holds back a copy of a packet until releaseTimeUs
+ */
+static void ARSTREAM_Impairment_HoldBack (ARSTREAM_Impairment_t *impairment, uint8_t *packet, int size, uint64_t releaseTimeUs);
+
+/**
+ * @brief Applies the impairment models to a packet read from the network buffer
+ */
+static void ARSTREAM_Impairment_AddPacket (ARSTREAM_Impairment_t *impairment, uint8_t *packet, int size, uint64_t nowUs);
+
+/**
+ * @brief Gets the index of the next packet to release
+ * @return The index of the packet, or -1 if no packet is held back
+ */
+static int ARSTREAM_Impairment_GetNextPacket (ARSTREAM_Impairment_t *impairment);
+
+/*
+ * Internal functions implementation
+ */
+
+static uint64_t ARSTREAM_Impairment_NowUs (void)
+{
+    struct timespec now;
+    ARSAL_Time_GetTime (&now);
+    return ((uint64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+static uint32_t ARSTREAM_Impairment_Random (ARSTREAM_Impairment_t *impairment)
+{
+    /* xorshift32 : the same seed always gives the same sequence, on every platform */
+    uint32_t x = impairment->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    impairment->randomState = x;
+    return x;
+}
+
+static int ARSTREAM_Impairment_Happens (uint32_t draw, float percent)
+{
+    return ((draw / 4294967296.0) * 100.0 < percent) ? 1 : 0;
+}
+
+static void ARSTREAM_Impairment_HoldBack (ARSTREAM_Impairment_t *impairment, uint8_t *packet, int size, uint64_t releaseTimeUs)
+{
+    int i;
+    for (i = 0; i < impairment->params.maxQueuedPackets; i++)
+    {
+        if (impairment->packetSizes [i] < 0)
+        {
+            memcpy (&(impairment->packets [i * impairment->maxPacketSize]), packet, size);
+            impairment->packetSizes [i] = size;
+            impairment->releaseTimesUs [i] = releaseTimeUs;
+            impairment->sequences [i] = impairment->nextSequence++;
+            impairment->nbQueued++;
+            return;
+        }
+    }
+    impairment->counters.nbPacketsOverflow++;
+}
+
+static void ARSTREAM_Impairment_AddPacket (ARSTREAM_Impairment_t *impairment, uint8_t *packet, int size, uint64_t nowUs)
+{
+    ARSTREAM_Impairment_Params_t *params = &(impairment->params);
+    uint64_t sentTimeUs = nowUs;
+    uint64_t releaseTimeUs;
+
+    /* Always draw the same number of values per packet, so that the decisions of one model do not depend
+     * on the parameters of the others */
+    uint32_t stateDraw = ARSTREAM_Impairment_Random (impairment);
+    uint32_t lossDraw = ARSTREAM_Impairment_Random (impairment);
+    uint32_t reorderDraw = ARSTREAM_Impairment_Random (impairment);
+    uint32_t duplicateDraw = ARSTREAM_Impairment_Random (impairment);
+    uint32_t jitterDraw = ARSTREAM_Impairment_Random (impairment);
+    uint32_t duplicateJitterDraw = ARSTREAM_Impairment_Random (impairment);
+
+    impairment->counters.nbPacketsIn++;
+
+    if (params->goodToBadPercent > 0.f)
+    {
+        if (impairment->isInBadState == 0)
+        {
+            impairment->isInBadState = ARSTREAM_Impairment_Happens (stateDraw, params->goodToBadPercent);
+        }
+        else
+        {
+            impairment->isInBadState = 1 - ARSTREAM_Impairment_Happens (stateDraw, params->badToGoodPercent);
+        }
+    }
+    if (ARSTREAM_Impairment_Happens (lossDraw, (impairment->isInBadState == 1) ? params->badStateLossPercent : params->lossPercent) == 1)
+    {
+        impairment->counters.nbPacketsLost++;
+        return;
+    }
+
+    if (params->bandwidthKbps > 0)
+    {
+        if (impairment->linkFreeTimeUs > sentTimeUs)
+        {
+            sentTimeUs = impairment->linkFreeTimeUs;
+        }
+        sentTimeUs += ((uint64_t)size * 8000) / params->bandwidthKbps;
+        impairment->linkFreeTimeUs = sentTimeUs;
+    }
+    sentTimeUs += (uint64_t)params->delayMs * 1000;
+
+    releaseTimeUs = sentTimeUs;
+    if (params->jitterMs > 0)
+    {
+        releaseTimeUs += jitterDraw % ((uint32_t)params->jitterMs * 1000 + 1);
+    }
+    if (ARSTREAM_Impairment_Happens (reorderDraw, params->reorderPercent) == 1)
+    {
+        releaseTimeUs += (uint64_t)params->reorderDelayMs * 1000;
+        impairment->counters.nbPacketsReordered++;
+    }
+    ARSTREAM_Impairment_HoldBack (impairment, packet, size, releaseTimeUs);
+
+    if (ARSTREAM_Impairment_Happens (duplicateDraw, params->duplicatePercent) == 1)
+    {
+        releaseTimeUs = sentTimeUs;
+        if (params->jitterMs > 0)
+        {
+            releaseTimeUs += duplicateJitterDraw % ((uint32_t)params->jitterMs * 1000 + 1);
+        }
+        ARSTREAM_Impairment_HoldBack (impairment, packet, size, releaseTimeUs);
+        impairment->counters.nbPacketsDuplicated++;
+    }
+}
+
+static int ARSTREAM_Impairment_GetNextPacket (ARSTREAM_Impairment_t *impairment)
+{
+    int nextIndex = -1;
+    int i;
+    for (i = 0; i < impairment->params.maxQueuedPackets; i++)
+    {
+        if ((impairment->packetSizes [i] >= 0) &&
+            ((nextIndex < 0) ||
+             (impairment->releaseTimesUs [i] < impairment->releaseTimesUs [nextIndex]) ||
+             ((impairment->releaseTimesUs [i] == impairment->releaseTimesUs [nextIndex]) &&
+              ((int32_t)(impairment->sequences [i] - impairment->sequences [nextIndex]) < 0))))
+        {
+            nextIndex = i;
+        }
+    }
+    return nextIndex;
+}
+
+/*
+ * Implementation
+ */
+
+void ARSTREAM_Impairment_DefaultParams (ARSTREAM_Impairment_Params_t *params)
+{
+    if (params != NULL)
+    {
+        memset (params, 0, sizeof (ARSTREAM_Impairment_Params_t));
+        params->maxQueuedPackets = ARSTREAM_IMPAIRMENT_DEFAULT_MAX_QUEUED_PACKETS;
+    }
+}
+
+ARSTREAM_Impairment_t* ARSTREAM_Impairment_New (const ARSTREAM_Impairment_Params_t *params, int maxPacketSize, eARSTREAM_ERROR *error)
+{
+    ARSTREAM_Impairment_t *retImpairment = NULL;
+    eARSTREAM_ERROR internalError = ARSTREAM_OK;
+    int i;
+
+    /* ARGS Check */
+    if ((params == NULL) ||
+        (maxPacketSize <= 0) ||
+        (params->maxQueuedPackets <= 0) ||
+        (params->delayMs < 0) ||
+        (params->jitterMs < 0) ||
+        (params->reorderDelayMs < 0))
+    {
+        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
+        return retImpairment;
+    }
+
+    /* Alloc new impairment */
+    retImpairment = calloc (1, sizeof (ARSTREAM_Impairment_t));
+    if (retImpairment == NULL)
+    {
+        internalError = ARSTREAM_ERROR_ALLOC;
+    }
+
+    if (internalError == ARSTREAM_OK)
+    {
+        retImpairment->params = *params;
+        retImpairment->maxPacketSize = maxPacketSize;
+        retImpairment->randomState = (params->seed != 0) ? params->seed : ARSTREAM_IMPAIRMENT_ZERO_SEED_REPLACEMENT;
+        retImpairment->packets = malloc ((size_t)params->maxQueuedPackets * maxPacketSize);
+        retImpairment->packetSizes = malloc (params->maxQueuedPackets * sizeof (int));
+        retImpairment->releaseTimesUs = malloc (params->maxQueuedPackets * sizeof (uint64_t));
+        retImpairment->sequences = malloc (params->maxQueuedPackets * sizeof (uint32_t));
+        retImpairment->recvPacket = malloc (maxPacketSize);
+        if ((retImpairment->packets == NULL) ||
+            (retImpairment->packetSizes == NULL) ||
+            (retImpairment->releaseTimesUs == NULL) ||
+            (retImpairment->sequences == NULL) ||
+            (retImpairment->recvPacket == NULL))
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+    }
+
+    if (internalError == ARSTREAM_OK)
+    {
+        for (i = 0; i < params->maxQueuedPackets; i++)
+        {
+            retImpairment->packetSizes [i] = -1;
+        }
+    }
+
+    if ((internalError != ARSTREAM_OK) &&
+        (retImpairment != NULL))
+    {
+        ARSTREAM_Impairment_Delete (&retImpairment);
+    }
+
+    SET_WITH_CHECK (error, internalError);
+    return retImpairment;
+}
+
+eARSTREAM_ERROR ARSTREAM_Impairment_Delete (ARSTREAM_Impairment_t **impairment)
+{
+    if ((impairment == NULL) ||
+        (*impairment == NULL))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    free ((*impairment)->packets);
+    free ((*impairment)->packetSizes);
+    free ((*impairment)->releaseTimesUs);
+    free ((*impairment)->sequences);
+    free ((*impairment)->recvPacket);
+    free (*impairment);
+    *impairment = NULL;
+    return ARSTREAM_OK;
+}
+
+eARNETWORK_ERROR ARSTREAM_Impairment_ReadData (ARSTREAM_Impairment_t *impairment, ARNETWORK_Manager_t *manager, int bufferID, uint8_t *data, int capacity, int *readSize, int waitMs)
+{
+    uint64_t nowUs = ARSTREAM_Impairment_NowUs ();
+    uint64_t deadlineUs = nowUs + ((waitMs > 0) ? (uint64_t)waitMs * 1000 : 0);
+    eARNETWORK_ERROR err = ARNETWORK_OK;
+    int recvSize;
+    int nextIndex;
+
+    while (1)
+    {
+        /* Take the packets already available in the network buffer, while there is room to hold them back.
+         * The other ones wait in the network buffer */
+        err = ARNETWORK_ERROR_BUFFER_EMPTY;
+        while ((impairment->nbQueued < impairment->params.maxQueuedPackets) &&
+               ((err = ARNETWORK_Manager_TryReadData (manager, bufferID, impairment->recvPacket, impairment->maxPacketSize, &recvSize)) == ARNETWORK_OK))
+        {
+            ARSTREAM_Impairment_AddPacket (impairment, impairment->recvPacket, recvSize, nowUs);
+        }
+        if ((err != ARNETWORK_OK) &&
+            (err != ARNETWORK_ERROR_BUFFER_EMPTY))
+        {
+            return err;
+        }
+
+        /* Release the next packet if it is due */
+        nextIndex = ARSTREAM_Impairment_GetNextPacket (impairment);
+        if ((nextIndex >= 0) &&
+            (impairment->releaseTimesUs [nextIndex] <= nowUs))
+        {
+            if (impairment->packetSizes [nextIndex] > capacity)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_IMPAIRMENT_TAG, "Packet of %d bytes does not fit in %d bytes", impairment->packetSizes [nextIndex], capacity);
+                impairment->packetSizes [nextIndex] = -1;
+                impairment->nbQueued--;
+                return ARNETWORK_ERROR_BUFFER_SIZE;
+            }
+            memcpy (data, &(impairment->packets [nextIndex * impairment->maxPacketSize]), impairment->packetSizes [nextIndex]);
+            *readSize = impairment->packetSizes [nextIndex];
+            impairment->packetSizes [nextIndex] = -1;
+            impairment->nbQueued--;
+            impairment->counters.nbPacketsOut++;
+            return ARNETWORK_OK;
+        }
+
+        if (nowUs >= deadlineUs)
+        {
+            return ARNETWORK_ERROR_BUFFER_EMPTY;
+        }
+
+        /* Wait for a new packet, until the deadline or the release of the next held back packet */
+        {
+            uint64_t waitUs = deadlineUs - nowUs;
+            if ((nextIndex >= 0) &&
+                (impairment->releaseTimesUs [nextIndex] - nowUs < waitUs))
+            {
+                waitUs = impairment->releaseTimesUs [nextIndex] - nowUs;
+            }
+            if (impairment->nbQueued < impairment->params.maxQueuedPackets)
+            {
+                err = ARNETWORK_Manager_ReadDataWithTimeout (manager, bufferID, impairment->recvPacket, impairment->maxPacketSize, &recvSize, (int)((waitUs + 999) / 1000));
+            }
+            else
+            {
+                struct timespec waitTime = { (time_t)(waitUs / 1000000), (long)(waitUs % 1000000) * 1000 };
+                nanosleep (&waitTime, NULL);
+                err = ARNETWORK_ERROR_BUFFER_EMPTY;
+            }
+        }
+        nowUs = ARSTREAM_Impairment_NowUs ();
+        if (err == ARNETWORK_OK)
+        {
+            ARSTREAM_Impairment_AddPacket (impairment, impairment->recvPacket, recvSize, nowUs);
+        }
+        else if (err != ARNETWORK_ERROR_BUFFER_EMPTY)
+        {
+            return err;
+        }
+    }
+}
+
+eARSTREAM_ERROR ARSTREAM_Impairment_GetCounters (ARSTREAM_Impairment_t *impairment, ARSTREAM_Impairment_Counters_t *counters)
+{
+    if ((impairment == NULL) ||
+        (counters == NULL))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    *counters = impairment->counters;
+    return ARSTREAM_OK;
+}
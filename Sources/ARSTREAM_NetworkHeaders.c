@@ -40,6 +40,7 @@
 /*
  * System Headers
  */
+#include <string.h>
 
 /*
  * Private Headers
@@ -50,12 +51,23 @@
  * ARSDK Headers
  */
 #include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Endianness.h>
 
 /*
  * Macros
  */
 #define ARSTREAM_NETWORK_HEADERS_TAG "ARSTREAM_NetworkHeaders"
 
+/**
+ * Size on network of an extended ack packet with NB_WORDS words
+ */
+#define ARSTREAM_NETWORK_HEADERS_EXT_ACK_PACKET_SIZE(NB_WORDS) ((int)(sizeof (ARSTREAM_NetworkHeaders_ExtAckPacket_t) - ((ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS - (NB_WORDS)) * sizeof (uint64_t))))
+
+/**
+ * Size on network of a tagged ack packet with NB_WORDS words
+ */
+#define ARSTREAM_NETWORK_HEADERS_TAGGED_ACK_PACKET_SIZE(NB_WORDS) ((int)(sizeof (ARSTREAM_NetworkHeaders_TaggedAckPacket_t) - ((ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS - (NB_WORDS)) * sizeof (uint64_t))))
+
 /*
  * Types
  */
@@ -64,26 +76,10 @@
  * Internal functions declarations
  */
 
-/**
- * @brief Computes the Hamming weight of a 32 bit integer
- * The Hamming weight is the number of '1' bits in the integer binary representation
- * @param input The integer to test
- * @return The Hamming weight of the integer
- */
-uint32_t ARSTREAM_NetworkHeaders_HammingWeight32 (uint32_t input);
-
 /*
  * Internal functions implementation
  */
 
-uint32_t ARSTREAM_NetworkHeaders_HammingWeight32 (uint32_t input)
-{
-    uint32_t tst = input;
-    tst = tst - ((tst >> 1) & 0x55555555);
-    tst = (tst & 0x33333333) + ((tst >> 2) & 0x33333333);
-    return (((tst + (tst >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
-}
-
 /*
  * Implementation
  */
@@ -91,20 +87,14 @@ uint32_t ARSTREAM_NetworkHeaders_HammingWeight32 (uint32_t input)
 int ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag)
 {
     int res = 1;
-    if (0 < maxFlag && maxFlag <= 64)
-    {
-        // Check only in first packet
-        uint64_t lo_mask = (1ll << maxFlag) - 1ll;
-        res = ((packet->lowPacketsAck & lo_mask) == lo_mask) ? 1 : 0;
-    }
-    else if (64 < maxFlag && maxFlag <= 128)
+    int word;
+    if (0 < maxFlag && maxFlag <= ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
     {
-        // We need to check for the second packet also
-        uint64_t lo_mask = UINT64_MAX;
-        uint64_t hi_mask = (1ll << (maxFlag-64)) - 1ll;
-        int hi_res = ((packet->highPacketsAck & hi_mask) == hi_mask) ? 1 : 0;
-        int lo_res = ((packet->lowPacketsAck & lo_mask) == lo_mask) ? 1 : 0;
-        res = (hi_res == 1 && lo_res == 1) ? 1 : 0;
+        for (word = 0; (res == 1) && (maxFlag > 0); word++, maxFlag -= 64)
+        {
+            uint64_t mask = ARSTREAM_NetworkHeaders_WordMask (maxFlag);
+            res = ((packet->packetsAck [word] & mask) == mask) ? 1 : 0;
+        }
     }
     else
     {
@@ -114,158 +104,372 @@ int ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (ARSTREAM_NetworkHeaders_AckPac
     return res;
 }
 
-int ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag)
+void ARSTREAM_NetworkHeaders_AckPacketReset (ARSTREAM_NetworkHeaders_AckPacket_t *packet)
 {
-    int retVal = 0;
-    if (0 <= flag && flag < 64)
+    memset (packet->packetsAck, 0, sizeof (packet->packetsAck));
+}
+
+void ARSTREAM_NetworkHeaders_AckPacketResetUpTo (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag)
+{
+    int word;
+    if (0 <= maxFlag && maxFlag < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
     {
-        retVal = ((packet->lowPacketsAck & (1ll << flag)) != 0) ? 1 : 0;
+        for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+        {
+            int nbZeros = maxFlag - (64 * word);
+            packet->packetsAck [word] = (nbZeros <= 0) ? UINT64_MAX : ~ARSTREAM_NetworkHeaders_WordMask (nbZeros);
+        }
     }
-    else if (64 <= flag && flag < 128)
+    else
     {
-        retVal = ((packet->highPacketsAck & (1ll << (flag - 64))) != 0) ? 1 : 0;
+        ARSTREAM_NetworkHeaders_AckPacketReset (packet);
     }
-    return retVal;
 }
 
-void ARSTREAM_NetworkHeaders_AckPacketReset (ARSTREAM_NetworkHeaders_AckPacket_t *packet)
+void ARSTREAM_NetworkHeaders_AckPacketSetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src)
 {
-    packet->highPacketsAck = 0ll;
-    packet->lowPacketsAck = 0ll;
+    int word;
+    for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+    {
+        dst->packetsAck [word] |= src->packetsAck [word];
+    }
 }
 
-void ARSTREAM_NetworkHeaders_AckPacketResetUpTo (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag)
+void ARSTREAM_NetworkHeaders_AckPacketKeepFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src)
 {
-    if (0 <= maxFlag && maxFlag < 64)
+    int word;
+    for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
     {
-        packet->highPacketsAck = UINT64_MAX;
-        packet->lowPacketsAck = UINT64_MAX << maxFlag;
+        dst->packetsAck [word] &= src->packetsAck [word];
     }
-    else if (64 <= maxFlag && maxFlag < 128)
+}
+
+int ARSTREAM_NetworkHeaders_AckPacketUnsetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flagToRemove)
+{
+    uint64_t allWords = 0ll;
+    int word;
+    if (0 <= flagToRemove && flagToRemove < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
     {
-        packet->highPacketsAck = UINT64_MAX << (maxFlag - 64);
-        packet->lowPacketsAck = 0ll;
+        packet->packetsAck [flagToRemove / 64] &= ~(1ull << (flagToRemove % 64));
     }
-    else
+
+    for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
     {
-        packet->highPacketsAck = 0ll;
-        packet->lowPacketsAck = 0ll;
+        allWords |= packet->packetsAck [word];
     }
+    return (0ll == allWords) ? 1 : 0;
 }
 
-void ARSTREAM_NetworkHeaders_AckPacketSetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flagToSet)
+int ARSTREAM_NetworkHeaders_AckPacketUnsetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src)
 {
-    if (0 <= flagToSet && flagToSet < 64)
+    uint64_t allWords = 0ll;
+    int word;
+    for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
     {
-        packet->lowPacketsAck |= (1ll << flagToSet);
+        dst->packetsAck [word] &= ~(src->packetsAck [word]);
+        allWords |= dst->packetsAck [word];
     }
-    else if (64 <= flagToSet && flagToSet < 128)
+    return (0ll == allWords) ? 1 : 0;
+}
+
+uint32_t ARSTREAM_NetworkHeaders_AckPacketCountNotSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb)
+{
+    if (nb > ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
     {
-        packet->highPacketsAck |= (1ll << (flagToSet-64));
+        nb = ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME;
     }
+    if (nb <= 0)
+    {
+        return 0;
+    }
+    return nb - ARSTREAM_NetworkHeaders_AckPacketCountSet (packet, nb);
 }
 
-void ARSTREAM_NetworkHeaders_AckPacketSetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src)
+int32_t ARSTREAM_NetworkHeaders_FrameNumberDiff (uint32_t frameNumber, uint32_t reference)
 {
-    dst->highPacketsAck |= src->highPacketsAck;
-    dst->lowPacketsAck  |= src->lowPacketsAck;
+    return (int32_t)(frameNumber - reference);
 }
 
-int ARSTREAM_NetworkHeaders_AckPacketUnsetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flagToRemove)
+uint32_t ARSTREAM_NetworkHeaders_FrameNumberExtend (uint16_t frameNumber, uint32_t reference)
 {
-    int retVal = 0;
-    if (0 <= flagToRemove && flagToRemove < 64)
+    return reference + (int16_t)(frameNumber - (uint16_t)(reference & 0xFFFF));
+}
+
+int ARSTREAM_NetworkHeaders_DataHeaderWrite (uint8_t *buffer, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
+{
+    int retVal = sizeof (ARSTREAM_NetworkHeaders_DataHeader_t);
+    ARSTREAM_NetworkHeaders_DataHeader_t *header = (ARSTREAM_NetworkHeaders_DataHeader_t *)buffer;
+    header->frameNumber = (uint16_t)(infos->frameNumber & 0xFFFF);
+    header->frameFlags = infos->frameFlags & ~ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAGMENTS;
+    header->fragmentNumber = (uint8_t)(infos->fragmentNumber & 0xFF);
+    header->fragmentsPerFrame = (uint8_t)(infos->fragmentsPerFrame & 0xFF);
+    if ((infos->fragmentsPerFrame > ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME) ||
+        (infos->fragmentNumber > 0xFF))
     {
-        packet->lowPacketsAck &= ~(1ll << flagToRemove);
+        ARSTREAM_NetworkHeaders_DataHeaderExt_t *ext = (ARSTREAM_NetworkHeaders_DataHeaderExt_t *)&buffer [retVal];
+        header->frameFlags |= ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAGMENTS;
+        ext->fragmentNumberHigh = (uint8_t)(infos->fragmentNumber >> 8);
+        ext->fragmentsPerFrameHigh = (uint8_t)(infos->fragmentsPerFrame >> 8);
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderExt_t);
     }
-    else if (64 <= flagToRemove && flagToRemove < 128)
+    if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY) != 0)
     {
-        packet->highPacketsAck &= ~(1ll << flagToRemove);
+        ARSTREAM_NetworkHeaders_DataHeaderFec_t *fec = (ARSTREAM_NetworkHeaders_DataHeaderFec_t *)&buffer [retVal];
+        fec->blockSize = infos->fecBlockSize;
+        fec->nbParity = infos->fecNbParity;
+        fec->lastFragmentSize = htods (infos->fecLastFragmentSize);
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderFec_t);
     }
-
-    if (0ll == packet->lowPacketsAck &&
-        0ll == packet->highPacketsAck)
+    if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0)
     {
-        retVal = 1;
+        ARSTREAM_NetworkHeaders_DataHeaderNalu_t *nalu = (ARSTREAM_NetworkHeaders_DataHeaderNalu_t *)&buffer [retVal];
+        nalu->fragmentOffset = htodl (infos->fragmentOffset);
+        nalu->naluFlags = infos->naluFlags;
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderNalu_t);
+    }
+    if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t *number = (ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t *)&buffer [retVal];
+        number->frameNumberHigh = htods ((uint16_t)(infos->frameNumber >> 16));
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t);
+    }
+    if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t *timestamp = (ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t *)&buffer [retVal];
+        timestamp->captureTimestamp = htodl (infos->captureTimestamp);
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t);
+    }
+    if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderCrypto_t *crypto = (ARSTREAM_NetworkHeaders_DataHeaderCrypto_t *)&buffer [retVal];
+        memcpy (crypto->nonce, infos->nonce, ARSTREAM_CRYPTO_NONCE_SIZE);
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderCrypto_t);
     }
     return retVal;
 }
 
-int ARSTREAM_NetworkHeaders_AckPacketUnsetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src)
+int ARSTREAM_NetworkHeaders_DataHeaderRead (uint8_t *buffer, int bufferSize, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
 {
-    int retVal = 0;
-    dst->highPacketsAck &= ~(src->highPacketsAck);
-    dst->lowPacketsAck  &= ~(src->lowPacketsAck);
-    if (0ll == dst->lowPacketsAck &&
-        0ll == dst->highPacketsAck)
+    int retVal = sizeof (ARSTREAM_NetworkHeaders_DataHeader_t);
+    ARSTREAM_NetworkHeaders_DataHeader_t *header = (ARSTREAM_NetworkHeaders_DataHeader_t *)buffer;
+    if (bufferSize < retVal)
+    {
+        return -1;
+    }
+    infos->frameNumber = header->frameNumber;
+    infos->frameFlags = header->frameFlags;
+    infos->fragmentNumber = header->fragmentNumber;
+    infos->fragmentsPerFrame = header->fragmentsPerFrame;
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAGMENTS) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderExt_t *ext = (ARSTREAM_NetworkHeaders_DataHeaderExt_t *)&buffer [retVal];
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderExt_t);
+        if (bufferSize < retVal)
+        {
+            return -1;
+        }
+        infos->fragmentNumber |= ((uint16_t)ext->fragmentNumberHigh) << 8;
+        infos->fragmentsPerFrame |= ((uint16_t)ext->fragmentsPerFrameHigh) << 8;
+    }
+    if ((infos->fragmentsPerFrame == 0) ||
+        (infos->fragmentsPerFrame > ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME))
+    {
+        return -1;
+    }
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderFec_t *fec = (ARSTREAM_NetworkHeaders_DataHeaderFec_t *)&buffer [retVal];
+        int nbBlocks;
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderFec_t);
+        if (bufferSize < retVal)
+        {
+            return -1;
+        }
+        infos->fecBlockSize = fec->blockSize;
+        infos->fecNbParity = fec->nbParity;
+        infos->fecLastFragmentSize = dtohs (fec->lastFragmentSize);
+        if ((infos->fecBlockSize == 0) ||
+            (infos->fecNbParity == 0) ||
+            (infos->fecNbParity > infos->fecBlockSize))
+        {
+            return -1;
+        }
+        nbBlocks = (infos->fragmentsPerFrame + infos->fecBlockSize - 1) / infos->fecBlockSize;
+        if (infos->fragmentNumber >= (nbBlocks * infos->fecNbParity))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        infos->fecBlockSize = 0;
+        infos->fecNbParity = 0;
+        infos->fecLastFragmentSize = 0;
+        if (infos->fragmentNumber >= infos->fragmentsPerFrame)
+        {
+            return -1;
+        }
+    }
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0)
     {
-        retVal = 1;
+        ARSTREAM_NetworkHeaders_DataHeaderNalu_t *nalu = (ARSTREAM_NetworkHeaders_DataHeaderNalu_t *)&buffer [retVal];
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderNalu_t);
+        if (bufferSize < retVal)
+        {
+            return -1;
+        }
+        infos->fragmentOffset = dtohl (nalu->fragmentOffset);
+        infos->naluFlags = nalu->naluFlags;
+    }
+    else
+    {
+        infos->fragmentOffset = 0;
+        infos->naluFlags = 0;
+    }
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t *number = (ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t *)&buffer [retVal];
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t);
+        if (bufferSize < retVal)
+        {
+            return -1;
+        }
+        infos->frameNumber |= ((uint32_t)dtohs (number->frameNumberHigh)) << 16;
+    }
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t *timestamp = (ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t *)&buffer [retVal];
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t);
+        if (bufferSize < retVal)
+        {
+            return -1;
+        }
+        infos->captureTimestamp = dtohl (timestamp->captureTimestamp);
+    }
+    else
+    {
+        infos->captureTimestamp = 0;
+    }
+    if ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED) != 0)
+    {
+        ARSTREAM_NetworkHeaders_DataHeaderCrypto_t *crypto = (ARSTREAM_NetworkHeaders_DataHeaderCrypto_t *)&buffer [retVal];
+        retVal += sizeof (ARSTREAM_NetworkHeaders_DataHeaderCrypto_t);
+        // The authentication tag follows the data
+        if (bufferSize < retVal + ARSTREAM_CRYPTO_TAG_SIZE)
+        {
+            return -1;
+        }
+        memcpy (infos->nonce, crypto->nonce, ARSTREAM_CRYPTO_NONCE_SIZE);
     }
     return retVal;
 }
 
-uint32_t ARSTREAM_NetworkHeaders_AckPacketCountSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb)
+int ARSTREAM_NetworkHeaders_AckPacketToNetwork (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nbFragments, int useExtendedFormat, uint8_t receiverId, uint8_t *buffer)
 {
-    uint32_t retVal = 0;
-
-    // Get subpacket
-    uint32_t tst = (uint32_t)(packet->lowPacketsAck);
-    // Mask if needed
-    tst = (nb < 32) ? tst & ((1 << nb) - 1) : tst;
-    // Add its Hamming weight to the result
-    retVal += ARSTREAM_NetworkHeaders_HammingWeight32 (tst);
-
-    // repeat for other three subpackets (if nb is big enough to reach them)
-    if (nb > 32)
+    int retVal = 0;
+    if (useExtendedFormat == 0)
     {
-        tst = (uint32_t)(packet->lowPacketsAck >> 32);
-        tst = (nb < 64) ? tst & ((1 << (nb-32)) - 1) : tst;
-        retVal += ARSTREAM_NetworkHeaders_HammingWeight32 (tst);
+        ARSTREAM_NetworkHeaders_LegacyAckPacket_t *legacy = (ARSTREAM_NetworkHeaders_LegacyAckPacket_t *)buffer;
+        legacy->frameNumber = htods ((uint16_t)(packet->frameNumber & 0xFFFF));
+        legacy->lowPacketsAck = htodll (packet->packetsAck [0]);
+        legacy->highPacketsAck = htodll (packet->packetsAck [1]);
+        retVal = sizeof (ARSTREAM_NetworkHeaders_LegacyAckPacket_t);
     }
-    if (nb > 64)
+    else if (receiverId != 0)
     {
-        tst = (uint32_t)(packet->highPacketsAck);
-        tst = (nb < 96) ? tst & ((1 << (nb-64)) - 1) : tst;
-        retVal += ARSTREAM_NetworkHeaders_HammingWeight32 (tst);
+        ARSTREAM_NetworkHeaders_TaggedAckPacket_t *tagged = (ARSTREAM_NetworkHeaders_TaggedAckPacket_t *)buffer;
+        int nbWords = (nbFragments + 63) / 64;
+        int word;
+        if (nbWords < 1)
+        {
+            nbWords = 1;
+        }
+        else if (nbWords > ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS)
+        {
+            nbWords = ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS;
+        }
+        tagged->frameNumber = htods ((uint16_t)(packet->frameNumber & 0xFFFF));
+        tagged->nbWords = nbWords;
+        tagged->receiverId = receiverId;
+        for (word = 0; word < nbWords; word++)
+        {
+            tagged->packetsAck [word] = htodll (packet->packetsAck [word]);
+        }
+        retVal = ARSTREAM_NETWORK_HEADERS_TAGGED_ACK_PACKET_SIZE (nbWords);
     }
-    if (nb > 96)
+    else
     {
-        tst = (uint32_t)(packet->highPacketsAck >> 32);
-        tst = (nb < 128) ? tst & ((1 << (nb-96)) - 1) : tst;
-        retVal += ARSTREAM_NetworkHeaders_HammingWeight32 (tst);
+        ARSTREAM_NetworkHeaders_ExtAckPacket_t *ext = (ARSTREAM_NetworkHeaders_ExtAckPacket_t *)buffer;
+        int nbWords = (nbFragments + 63) / 64;
+        int word;
+        if (nbWords < 1)
+        {
+            nbWords = 1;
+        }
+        else if (nbWords > ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS)
+        {
+            nbWords = ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS;
+        }
+        ext->frameNumber = htods ((uint16_t)(packet->frameNumber & 0xFFFF));
+        ext->nbWords = nbWords;
+        for (word = 0; word < nbWords; word++)
+        {
+            ext->packetsAck [word] = htodll (packet->packetsAck [word]);
+        }
+        retVal = ARSTREAM_NETWORK_HEADERS_EXT_ACK_PACKET_SIZE (nbWords);
     }
     return retVal;
 }
 
-uint32_t ARSTREAM_NetworkHeaders_AckPacketCountNotSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb)
+int ARSTREAM_NetworkHeaders_AckPacketFromNetwork (ARSTREAM_NetworkHeaders_AckPacket_t *packet, uint8_t *buffer, int bufferSize, uint8_t *receiverId)
 {
-    uint32_t retVal = 0;
-
-    // Get subpacket
-    uint32_t tst = (uint32_t)(packet->lowPacketsAck);
-    // Mask if needed
-    tst = (nb < 32) ? tst | (0xFFFFFFFF << nb) : tst;
-    // Add its Hamming weight to the result
-    retVal += (32 - ARSTREAM_NetworkHeaders_HammingWeight32 (tst));
-
-    // repeat for other three subpackets (if nb is big enough to reach them)
-    if (nb > 32)
-    {
-        tst = (uint32_t)(packet->lowPacketsAck >> 32);
-        tst = (nb < 64) ? tst | (0xFFFFFFFF << (nb - 32)) : tst;
-        retVal += (32 - ARSTREAM_NetworkHeaders_HammingWeight32 (tst));
-    }
-    if (nb > 64)
+    int retVal = -1;
+    int word;
+    *receiverId = 0;
+    if (bufferSize == sizeof (ARSTREAM_NetworkHeaders_LegacyAckPacket_t))
     {
-        tst = (uint32_t)(packet->highPacketsAck);
-        tst = (nb < 96) ? tst | (0xFFFFFFFF << (nb - 64)) : tst;
-        retVal += (32 - ARSTREAM_NetworkHeaders_HammingWeight32 (tst));
+        ARSTREAM_NetworkHeaders_LegacyAckPacket_t *legacy = (ARSTREAM_NetworkHeaders_LegacyAckPacket_t *)buffer;
+        packet->frameNumber = dtohs (legacy->frameNumber);
+        packet->packetsAck [0] = dtohll (legacy->lowPacketsAck);
+        packet->packetsAck [1] = dtohll (legacy->highPacketsAck);
+        for (word = 2; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+        {
+            packet->packetsAck [word] = UINT64_MAX;
+        }
+        retVal = 0;
     }
-    if (nb > 96)
+    else if (bufferSize >= ARSTREAM_NETWORK_HEADERS_EXT_ACK_PACKET_SIZE (1))
     {
-        tst = (uint32_t)(packet->highPacketsAck >> 32);
-        tst = (nb < 128) ? tst | (0xFFFFFFFF << (nb - 96)) : tst;
-        retVal += (32 - ARSTREAM_NetworkHeaders_HammingWeight32 (tst));
+        ARSTREAM_NetworkHeaders_ExtAckPacket_t *ext = (ARSTREAM_NetworkHeaders_ExtAckPacket_t *)buffer;
+        int nbWords = ext->nbWords;
+        if ((0 < nbWords) &&
+            (nbWords <= ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS) &&
+            (bufferSize == ARSTREAM_NETWORK_HEADERS_EXT_ACK_PACKET_SIZE (nbWords)))
+        {
+            packet->frameNumber = dtohs (ext->frameNumber);
+            for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+            {
+                packet->packetsAck [word] = (word < nbWords) ? dtohll (ext->packetsAck [word]) : UINT64_MAX;
+            }
+            retVal = 1;
+        }
+        else if ((0 < nbWords) &&
+                 (nbWords <= ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS) &&
+                 (bufferSize == ARSTREAM_NETWORK_HEADERS_TAGGED_ACK_PACKET_SIZE (nbWords)))
+        {
+            ARSTREAM_NetworkHeaders_TaggedAckPacket_t *tagged = (ARSTREAM_NetworkHeaders_TaggedAckPacket_t *)buffer;
+            if (tagged->receiverId != 0)
+            {
+                packet->frameNumber = dtohs (tagged->frameNumber);
+                for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+                {
+                    packet->packetsAck [word] = (word < nbWords) ? dtohll (tagged->packetsAck [word]) : UINT64_MAX;
+                }
+                *receiverId = tagged->receiverId;
+                retVal = 1;
+            }
+        }
+        // No else : invalid packet
     }
     return retVal;
 }
@@ -279,9 +483,12 @@ void ARSTREAM_NetworkHeaders_InternalAckPacketDump (const char *prefix, ARSTREAM
     }
     else
     {
-        ARSAL_PRINT (level, ARSTREAM_NETWORK_HEADERS_TAG, " - Frame number : %d", packet->frameNumber);
-        ARSAL_PRINT (level, ARSTREAM_NETWORK_HEADERS_TAG, " - HI 64 bits : %016llX", packet->highPacketsAck);
-        ARSAL_PRINT (level, ARSTREAM_NETWORK_HEADERS_TAG, " - LO 64 bits : %016llX", packet->lowPacketsAck);
+        int word;
+        ARSAL_PRINT (level, ARSTREAM_NETWORK_HEADERS_TAG, " - Frame number : %" PRIu32, packet->frameNumber);
+        for (word = ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS - 1; word >= 0; word--)
+        {
+            ARSAL_PRINT (level, ARSTREAM_NETWORK_HEADERS_TAG, " - Bits %4d-%4d : %016" PRIX64, (64 * word) + 63, 64 * word, packet->packetsAck [word]);
+        }
     }
 }
 
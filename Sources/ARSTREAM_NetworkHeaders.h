@@ -47,6 +47,7 @@
 /*
  * Private Headers
  */
+#include "ARSTREAM_Crypto.h"
 
 /*
  * ARSDK Headers
@@ -56,9 +57,47 @@
  * Macros
  */
 
-#define ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME (128)
+/**
+ * Maximum number of fragments per frame understood by peers without extended acks
+ */
+#define ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME (128)
+
+/**
+ * Maximum number of fragments per frame when both peers use extended acks
+ */
+#define ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME (1024)
+
+/**
+ * Number of 64 bits words in an ack bitfield
+ */
+#define ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS (ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME / 64)
 
 #define ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME (1)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_EXT_ACK_CAPABLE (2)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAGMENTS (4)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY (8)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED (16)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER (32)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP (64)
+#define ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED (128)
+
+#define ARSTREAM_NETWORK_HEADERS_NALU_FLAG_START (1)
+#define ARSTREAM_NETWORK_HEADERS_NALU_FLAG_END (2)
+
+/**
+ * Maximum size of the headers in front of a stream data fragment
+ */
+#define ARSTREAM_NETWORK_HEADERS_DATA_HEADER_MAX_SIZE (sizeof (ARSTREAM_NetworkHeaders_DataHeader_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderExt_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderFec_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderNalu_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t) + sizeof (ARSTREAM_NetworkHeaders_DataHeaderCrypto_t))
+
+/**
+ * Maximum size of the headers and of the trailer around the data of a stream data fragment
+ */
+#define ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE (ARSTREAM_NETWORK_HEADERS_DATA_HEADER_MAX_SIZE + ARSTREAM_CRYPTO_TAG_SIZE)
+
+/**
+ * Maximum size of an ack packet on network
+ */
+#define ARSTREAM_NETWORK_HEADERS_ACK_PACKET_MAX_NETWORK_SIZE (sizeof (ARSTREAM_NetworkHeaders_TaggedAckPacket_t))
 
 /*
  * Types
@@ -68,7 +107,7 @@
  * @brief Header for stream data frames
  */
 typedef struct {
-    uint16_t frameNumber; /**< id of the current frame */
+    uint16_t frameNumber; /**< Lower 16 bits of the id of the current frame */
     uint8_t frameFlags; /**< Infos on the current frame */
     uint8_t fragmentNumber; /**< Index of the current fragment in current frame */
     uint8_t fragmentsPerFrame; /**< Number of fragments in current frame */
@@ -77,50 +116,194 @@ typedef struct {
 /* frameFlags structure :
  *  x x x x x x x x
  *  | | | | | | | \-> FLUSH FRAME
- *  | | | | | | \-> UNUSED
+ *  | | | | | | \-> EXT ACK CAPABLE (sender understands extended acks)
+ *  | | | | | \-> EXT FRAGMENTS (an ARSTREAM_NetworkHeaders_DataHeaderExt_t follows the header)
+ *  | | | | \-> FEC PARITY (parity fragment, an ARSTREAM_NetworkHeaders_DataHeaderFec_t follows the headers)
+ *  | | | \-> NALU ALIGNED (fragments follow NAL units boundaries, an ARSTREAM_NetworkHeaders_DataHeaderNalu_t follows the headers)
+ *  | | \-> EXT FRAME NUMBER (an ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t follows the headers)
+ *  | \-> CAPTURE TIMESTAMP (an ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t follows the headers)
+ *  \-> ENCRYPTED (an ARSTREAM_NetworkHeaders_DataHeaderCrypto_t follows the headers, an ARSTREAM_CRYPTO_TAG_SIZE bytes tag follows the data)
+ *
+ * The optional headers are written in the order of their flags
+ */
+
+/**
+ * @brief Header extension for frames with more than ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME fragments
+ *
+ * Only sent to readers which answered with extended acks
+ */
+typedef struct {
+    uint8_t fragmentNumberHigh; /**< Upper 8 bits of the fragment index */
+    uint8_t fragmentsPerFrameHigh; /**< Upper 8 bits of the number of fragments */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderExt_t;
+
+/**
+ * @brief Header extension for parity fragments
+ *
+ * For parity fragments, the fragment number is the index of the parity fragment
+ * (see ARSTREAM_Fec.h), and the number of fragments is the number of data fragments.
+ * Only sent to readers which answered with extended acks
+ */
+typedef struct {
+    uint8_t blockSize; /**< Number of data fragments per FEC block */
+    uint8_t nbParity; /**< Number of parity fragments per FEC block */
+    uint16_t lastFragmentSize; /**< Size of the last data fragment of the frame */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderFec_t;
+
+/**
+ * @brief Header extension for frames fragmented on NAL units boundaries
+ *
+ * Fragments of these frames do not have the same size, so each fragment carries its offset in the frame.
+ * Only sent to readers which answered with extended acks
+ */
+typedef struct {
+    uint32_t fragmentOffset; /**< Offset of the fragment data in the frame */
+    uint8_t naluFlags; /**< NAL units boundaries of the fragment */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderNalu_t;
+
+/* naluFlags structure :
+ *  x x x x x x x x
+ *  | | | | | | | \-> START (fragment starts with a NAL unit)
+ *  | | | | | | \-> END (fragment ends with a NAL unit)
  *  | | | | | \-> UNUSED
  *  | | | | \-> UNUSED
  *  | | | \-> UNUSED
  *  | | \-> UNUSED
  *  | \-> UNUSED
  *  \-> UNUSED
+ *
+ * A fragment with both flags holds only complete NAL units, and can be decoded without the other fragments
  */
 
 /**
- * @brief Content of stream ack frames
+ * @brief Header extension for 32 bits frame numbers
+ *
+ * Without this extension, the reader extends the 16 bits frame number from its last frame number.
+ * Only sent to readers which answered with extended acks
+ */
+typedef struct {
+    uint16_t frameNumberHigh; /**< Upper 16 bits of the id of the current frame */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderFrameNumber_t;
+
+/**
+ * @brief Header extension for frames with a capture timestamp
+ *
+ * Only sent to readers which answered with extended acks
+ */
+typedef struct {
+    uint32_t captureTimestamp; /**< Capture timestamp of the frame, in the application clock */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderTimestamp_t;
+
+/**
+ * @brief Header extension for encrypted fragments
+ *
+ * The data of the fragment is encrypted, and followed by its authentication tag (see ARSTREAM_Crypto.h).
+ * All the headers, this one included, are authenticated as associated data.
+ */
+typedef struct {
+    uint8_t nonce [ARSTREAM_CRYPTO_NONCE_SIZE]; /**< Nonce of the fragment */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_DataHeaderCrypto_t;
+
+/**
+ * @brief Decoded content of the stream data headers
+ */
+typedef struct {
+    uint32_t frameNumber; /**< id of the current frame (only the lower 16 bits are valid without ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER) */
+    uint8_t frameFlags; /**< Infos on the current frame */
+    uint16_t fragmentNumber; /**< Index of the current fragment in current frame */
+    uint16_t fragmentsPerFrame; /**< Number of fragments in current frame */
+    uint8_t fecBlockSize; /**< Number of data fragments per FEC block (parity fragments only) */
+    uint8_t fecNbParity; /**< Number of parity fragments per FEC block (parity fragments only) */
+    uint16_t fecLastFragmentSize; /**< Size of the last data fragment of the frame (parity fragments only) */
+    uint32_t fragmentOffset; /**< Offset of the fragment data in the frame (NAL units aligned frames only) */
+    uint8_t naluFlags; /**< NAL units boundaries of the fragment (NAL units aligned frames only) */
+    uint32_t captureTimestamp; /**< Capture timestamp of the frame (ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP only) */
+    uint8_t nonce [ARSTREAM_CRYPTO_NONCE_SIZE]; /**< Nonce of the fragment (ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED only) */
+} ARSTREAM_NetworkHeaders_FragmentInfos_t;
+
+/**
+ * @brief Content of legacy stream ack frames
  *
  * This struct is a 128bits bitfield
  *
  * On network, a 1 bit denotes that this packet is ACK
- *
- * This stucture is also used internally by the library to track packets that must be sent.
- * In this case, a 1 bit denotes that the packet must be sent
  */
 typedef struct {
     uint16_t frameNumber; /**< id of the current frame */
     uint64_t highPacketsAck; /**< Upper 64 packets bitfield */
     uint64_t lowPacketsAck; /**< Lower 64 packets bitfield */
-} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_AckPacket_t;
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_LegacyAckPacket_t;
+
+/**
+ * @brief Content of extended stream ack frames
+ *
+ * Only the first nbWords words are sent on network, lower packets first.
+ * The size of an extended ack (3 + 8 * nbWords) never matches the size
+ * of a legacy ack, so both formats can share the same buffer.
+ */
+typedef struct {
+    uint16_t frameNumber; /**< id of the current frame */
+    uint8_t nbWords; /**< Number of 64 packets words in the bitfield */
+    uint64_t packetsAck [ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS]; /**< Packets bitfield */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_ExtAckPacket_t;
+
+/**
+ * @brief Content of extended stream ack frames tagged with the id of their reader
+ *
+ * Sent by the readers of a fan-out sender, which keeps the acks of each reader apart.
+ * Only the first nbWords words are sent on network, lower packets first.
+ * The size of a tagged ack (4 + 8 * nbWords) never matches the size of a legacy
+ * or of an extended ack, so all formats can share the same buffer.
+ */
+typedef struct {
+    uint16_t frameNumber; /**< id of the current frame */
+    uint8_t nbWords; /**< Number of 64 packets words in the bitfield */
+    uint8_t receiverId; /**< id of the reader (never 0) */
+    uint64_t packetsAck [ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS]; /**< Packets bitfield */
+} __attribute__ ((packed)) ARSTREAM_NetworkHeaders_TaggedAckPacket_t;
+
+/**
+ * @brief Internal representation of stream acks
+ *
+ * This struct is a ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME bits bitfield
+ *
+ * A 1 bit denotes that this packet is ACK
+ *
+ * This stucture is also used internally by the library to track packets that must be sent.
+ * In this case, a 1 bit denotes that the packet must be sent
+ */
+typedef struct {
+    uint32_t frameNumber; /**< id of the current frame (only the lower 16 bits are sent on network) */
+    uint64_t packetsAck [ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS]; /**< Packets bitfield, word 0 holds packets 0 to 63 */
+} ARSTREAM_NetworkHeaders_AckPacket_t;
 
 /*
  * Functions declarations
  */
 
 /**
- * @brief Tests if all flags between 0 and maxFlag are set
- * @param packet The packet to test
- * @param maxFlag The maximum index (inclusive) to test
- * @return 1 if all flags with index [0;maxFlag] are set, 0 otherwise
+ * @brief Computes the distance between two frame numbers, with serial number arithmetic (RFC 1982)
+ * @param frameNumber The frame number to compare
+ * @param reference The reference frame number
+ * @return A negative value if frameNumber is older than reference, a positive value if it is newer, 0 if they are equal
  */
-int ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag);
+int32_t ARSTREAM_NetworkHeaders_FrameNumberDiff (uint32_t frameNumber, uint32_t reference);
 
 /**
- * @brief Tests if a flag is set in the packet
+ * @brief Extends a 16 bits frame number to the closest 32 bits frame number of a reference
+ * @param frameNumber The lower 16 bits of the frame number (as received on network)
+ * @param reference A known frame number, less than 32768 frames away from the actual one
+ * @return The 32 bits frame number
+ */
+uint32_t ARSTREAM_NetworkHeaders_FrameNumberExtend (uint16_t frameNumber, uint32_t reference);
+
+/**
+ * @brief Tests if all flags between 0 and maxFlag are set
  * @param packet The packet to test
- * @param flag The index of the flag to test
- * @return 1 if the flag is set, 0 otherwise
+ * @param maxFlag The number of flags to test
+ * @return 1 if all flags with index [0;maxFlag[ are set, 0 otherwise
  */
-int ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag);
+int ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag);
 
 /**
  * @brief Resets all flags in a packet to zero
@@ -135,14 +318,6 @@ void ARSTREAM_NetworkHeaders_AckPacketReset (ARSTREAM_NetworkHeaders_AckPacket_t
  */
 void ARSTREAM_NetworkHeaders_AckPacketResetUpTo (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int maxFlag);
 
-/**
- * @brief Sets a flag in a packet
- * This function has no effect if the flag was already set
- * @param packet The packet to modify
- * @param flag The index of the flag to set
- */
-void ARSTREAM_NetworkHeaders_AckPacketSetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag);
-
 /**
  * @brief Sets all flags from packet src into packet dst
  * @param dst the packet to modify
@@ -150,6 +325,13 @@ void ARSTREAM_NetworkHeaders_AckPacketSetFlag (ARSTREAM_NetworkHeaders_AckPacket
  */
 void ARSTREAM_NetworkHeaders_AckPacketSetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src);
 
+/**
+ * @brief Unsets all flags of packet dst which are not set in packet src
+ * @param dst the packet to modify
+ * @param src the packet which contains the flags to keep
+ */
+void ARSTREAM_NetworkHeaders_AckPacketKeepFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src);
+
 /**
  * @brief Unsets a flag in a packet
  * @param packet The packet to modify
@@ -168,14 +350,6 @@ int ARSTREAM_NetworkHeaders_AckPacketUnsetFlag (ARSTREAM_NetworkHeaders_AckPacke
  */
 int ARSTREAM_NetworkHeaders_AckPacketUnsetFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src);
 
-/**
- * @brief Count the number of flags set in range [0;nb[
- * @param packet The packet to test
- * @param nb the number of flags to test
- * @return The number of flags set (=1) in the packet for the range [0:nb[
- */
-uint32_t ARSTREAM_NetworkHeaders_AckPacketCountSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb);
-
 /**
  * @brief Count the number of flags unset in range [0;nb[
  * @param packet The packet to test
@@ -185,6 +359,60 @@ uint32_t ARSTREAM_NetworkHeaders_AckPacketCountSet (ARSTREAM_NetworkHeaders_AckP
 uint32_t ARSTREAM_NetworkHeaders_AckPacketCountNotSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb);
 
 
+/**
+ * @brief Writes the stream data headers of a fragment
+ * The ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAGMENTS flag is automatically added
+ * for frames with more than ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME fragments
+ * (or fragment numbers which do not fit in 8 bits).
+ * If infos->frameFlags contains ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY, the fec fields of infos are also written
+ * If infos->frameFlags contains ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED, the fragment offset and NAL units flags are also written
+ * If infos->frameFlags contains ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER, the upper bits of the frame number are also written
+ * If infos->frameFlags contains ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP, the capture timestamp is also written
+ * If infos->frameFlags contains ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED, the nonce is also written (the data must then be sealed by the caller)
+ * @param buffer The buffer to write into (at least ARSTREAM_NETWORK_HEADERS_DATA_HEADER_MAX_SIZE bytes)
+ * @param infos The fragment infos to write
+ * @return The size of the written headers, in bytes
+ */
+int ARSTREAM_NetworkHeaders_DataHeaderWrite (uint8_t *buffer, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Reads the stream data headers of a fragment
+ * @param buffer The fragment received from network
+ * @param bufferSize The size of the fragment
+ * @param infos Pointer in which the function will save the fragment infos
+ * @return The size of the headers, in bytes
+ * @return -1 if the headers are invalid
+ * @note Without ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER, only the lower 16 bits of infos->frameNumber are read, see ARSTREAM_NetworkHeaders_FrameNumberExtend()
+ */
+int ARSTREAM_NetworkHeaders_DataHeaderRead (uint8_t *buffer, int bufferSize, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Converts an ack packet to its network representation
+ * @param packet The packet to convert
+ * @param nbFragments The number of fragments of the acknowledged frame
+ * @param useExtendedFormat Boolean-like (0/1) flag, active if the peer understands extended acks
+ * @param receiverId id of the reader, written in a tagged ack. 0 for untagged acks. Ignored if useExtendedFormat is not active
+ * @param buffer The buffer to write into (at least ARSTREAM_NETWORK_HEADERS_ACK_PACKET_MAX_NETWORK_SIZE bytes)
+ * @return The size of the network packet, in bytes
+ * @note Legacy acks can only carry the first ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME flags
+ */
+int ARSTREAM_NetworkHeaders_AckPacketToNetwork (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nbFragments, int useExtendedFormat, uint8_t receiverId, uint8_t *buffer);
+
+/**
+ * @brief Converts a network ack packet to its internal representation
+ * Words which are not present in the network packet are set to all ones
+ * (same as ARSTREAM_NetworkHeaders_AckPacketResetUpTo on the peer side)
+ * Only the lower 16 bits of packet->frameNumber are read, see ARSTREAM_NetworkHeaders_FrameNumberExtend()
+ * @param packet Pointer in which the function will save the packet
+ * @param buffer The packet received from network
+ * @param bufferSize The size of the received packet
+ * @param receiverId Pointer in which the function will save the id of the reader (0 for untagged acks)
+ * @return 1 if the packet used the extended or the tagged format
+ * @return 0 if the packet used the legacy format
+ * @return -1 if the packet is invalid
+ */
+int ARSTREAM_NetworkHeaders_AckPacketFromNetwork (ARSTREAM_NetworkHeaders_AckPacket_t *packet, uint8_t *buffer, int bufferSize, uint8_t *receiverId);
+
 /**
  * @brief Dump an ack packet
  * @param prefix prefix of the dump
@@ -192,4 +420,122 @@ uint32_t ARSTREAM_NetworkHeaders_AckPacketCountNotSet (ARSTREAM_NetworkHeaders_A
  */
 void ARSTREAM_NetworkHeaders_AckPacketDump (const char *prefix, ARSTREAM_NetworkHeaders_AckPacket_t *packet);
 
+/*
+ * Inline functions
+ * These functions are used for each fragment by the data loops, so they are inlined in the callers
+ */
+
+/**
+ * @brief Computes the mask of the flags [0;nb[ of a word
+ * @param nb The number of flags in the word (0 to 64, values out of range are clamped)
+ * @return The mask of the flags
+ */
+static inline uint64_t ARSTREAM_NetworkHeaders_WordMask (int nb)
+{
+    return (nb >= 64) ? UINT64_MAX : ((nb <= 0) ? 0ull : ((1ull << nb) - 1ull));
+}
+
+/**
+ * @brief Tests if a flag is set in the packet
+ * @param packet The packet to test
+ * @param flag The index of the flag to test
+ * @return 1 if the flag is set, 0 otherwise
+ */
+static inline int ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag)
+{
+    int retVal = 0;
+    // A single unsigned comparison checks both bounds
+    if ((unsigned int)flag < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
+    {
+        retVal = (int)((packet->packetsAck [flag / 64] >> (flag % 64)) & 1ull);
+    }
+    return retVal;
+}
+
+/**
+ * @brief Sets a flag in a packet
+ * This function has no effect if the flag was already set
+ * @param packet The packet to modify
+ * @param flagToSet The index of the flag to set
+ */
+static inline void ARSTREAM_NetworkHeaders_AckPacketSetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flagToSet)
+{
+    if ((unsigned int)flagToSet < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
+    {
+        packet->packetsAck [flagToSet / 64] |= (1ull << (flagToSet % 64));
+    }
+}
+
+/**
+ * @brief Sets in packet dst the flags [0;nb[ which are not set in packet src, and unsets all the other flags
+ * With src the acks of a frame of nb fragments, dst holds the fragments which still need to be sent.
+ * @param dst the packet to modify (the frame number is not modified)
+ * @param src the packet which contains the flags to invert
+ * @param nb the number of flags to invert
+ */
+static inline void ARSTREAM_NetworkHeaders_AckPacketSetMissingFlags (ARSTREAM_NetworkHeaders_AckPacket_t *dst, ARSTREAM_NetworkHeaders_AckPacket_t *src, int nb)
+{
+    int word;
+    for (word = 0; word < ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS; word++)
+    {
+        dst->packetsAck [word] = ~(src->packetsAck [word]) & ARSTREAM_NetworkHeaders_WordMask (nb - (64 * word));
+    }
+}
+
+/**
+ * @brief Count the number of flags set in range [0;nb[
+ * @param packet The packet to test
+ * @param nb the number of flags to test
+ * @return The number of flags set (=1) in the packet for the range [0:nb[
+ */
+static inline uint32_t ARSTREAM_NetworkHeaders_AckPacketCountSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int nb)
+{
+    uint32_t retVal = 0;
+    int word;
+    if (nb > ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
+    {
+        nb = ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME;
+    }
+    for (word = 0; nb > 0; word++, nb -= 64)
+    {
+        retVal += (uint32_t)__builtin_popcountll (packet->packetsAck [word] & ARSTREAM_NetworkHeaders_WordMask (nb));
+    }
+    return retVal;
+}
+
+/**
+ * @brief Gets the index of the first flag set in the packet, starting at a given index
+ * Iterating over the flags set with this function skips the words without flags at once.
+ * @param packet The packet to test
+ * @param from The first index to test
+ * @return The index of the first flag set in range [from;ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME[
+ * @return -1 if no flag is set in this range
+ */
+static inline int ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int from)
+{
+    int word;
+    uint64_t bits;
+    if (from < 0)
+    {
+        from = 0;
+    }
+    if (from >= ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME)
+    {
+        return -1;
+    }
+    word = from / 64;
+    // Ignore the flags before 'from' in the first word
+    bits = packet->packetsAck [word] & ~ARSTREAM_NetworkHeaders_WordMask (from % 64);
+    while (bits == 0ull)
+    {
+        word++;
+        if (word >= ARSTREAM_NETWORK_HEADERS_ACK_PACKET_NB_WORDS)
+        {
+            return -1;
+        }
+        bits = packet->packetsAck [word];
+    }
+    return (64 * word) + __builtin_ctzll (bits);
+}
+
 #endif /* _ARSTREAM_NETWORK_HEADERS_PRIVATE_H_ */
@@ -51,7 +51,11 @@
  */
 
 #include "ARSTREAM_Buffers.h"
+#include "ARSTREAM_Crypto.h"
 #include "ARSTREAM_NetworkHeaders.h"
+#include "ARSTREAM_Fec.h"
+#include "ARSTREAM_Stats.h"
+#include "ARSTREAM_StreamTasks.h"
 
 /*
  * ARSDK Headers
@@ -71,6 +75,29 @@
 
 #define ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES (15)
 
+/**
+ * Maximum number of fragments read from the data IOBuffer before the ack packet is updated
+ */
+#define ARSTREAM_READER_MAX_FRAGMENTS_PER_BATCH (64)
+
+/**
+ * Number of frames which can be reassembled at the same time
+ * Fragments of a frame may then arrive after fragments of the next frames
+ */
+#define ARSTREAM_READER_NB_REASSEMBLY_SLOTS (4)
+
+/**
+ * Fragments of frames up to this number of frames older than the last completed frame are ignored
+ * Older frame numbers mean that the sender restarted (clear streams only : the restarts of an encrypted
+ * stream are recognized by a new nonce prefix, so replayed fragments can not rewind the reader)
+ */
+#define ARSTREAM_READER_MAX_LATE_FRAMES (64)
+
+/**
+ * Maximum number of parity fragments kept while waiting for the data fragments they protect
+ */
+#define ARSTREAM_READER_FEC_MAX_PENDING_PARITY (16)
+
 /**
  * Sets *PTR to VAL if PTR is not null
  */
@@ -87,6 +114,61 @@
  * Types
  */
 
+/**
+ * Ack packet send requests from the data thread to the ack thread
+ */
+typedef enum {
+    ARSTREAM_READER_ACK_REQUEST_NONE = 0,
+    ARSTREAM_READER_ACK_REQUEST_COALESCED, // Sent once minAckInterval elapsed since the previous ack
+    ARSTREAM_READER_ACK_REQUEST_IMMEDIATE, // Frame completion or gap in the received fragments
+} eARSTREAM_READER_ACK_REQUEST;
+
+typedef struct {
+    int isUsed; // Boolean-like (0/1) flag
+    uint32_t frameNumber;
+    int parityIndex;
+    int size;
+    uint8_t *data; // maxFragmentSize bytes, in reader->fecParityBuffer
+} ARSTREAM_Reader_FecParity_t;
+
+struct ARSTREAM_Reader_Frame_t {
+    int refCount;                    // Zero if the frame is free in the pool (atomic)
+    uint8_t *buffer;
+    uint32_t bufferSize;
+    int isPartial;                   // Boolean-like (0/1) flag, active if the frame only holds the complete NAL units of an incomplete frame
+    uint32_t frameNumber;
+    int hasCaptureTimestamp;         // Boolean-like (0/1) flag, active if the sender gave a capture timestamp
+    uint32_t captureTimestamp;
+};
+
+typedef struct {
+    uint32_t offset;                 // Offset of the fragment data in the frame
+    uint16_t size;
+    uint8_t naluFlags;               // ARSTREAM_NETWORK_HEADERS_NALU_FLAG_xxx
+} ARSTREAM_Reader_FragmentLayout_t;
+
+typedef struct {
+    int isUsed;                      // Boolean-like (0/1) flag
+    uint32_t frameNumber;
+    uint8_t frameFlags;
+    int nbFragments;
+    ARSTREAM_NetworkHeaders_AckPacket_t fragmentsReceived;
+    int highestFragmentReceived;     // -1 until a data fragment is received
+    int isSkipped;                   // Boolean-like (0/1) flag, active if the frame can not be stored (fragments are still acknowledged)
+    ARSTREAM_Reader_Frame_t *frame;  // Holds maxFragmentSize * nbFragments bytes, NULL if the frame is skipped
+    uint32_t frameSize;
+    uint32_t captureTimestamp;       // Only valid with ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP
+    int nbContiguousFragments;       // Fragments received from the start of the frame, without any gap
+    uint32_t progressSize;           // Contiguous size given to the progress callback, 0 if none
+    struct timespec startTime;       // Reception time of the first fragment, for the statistics
+    ARSTREAM_Reader_FragmentLayout_t fragmentsLayout [ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME]; // Received fragments of NAL units aligned frames
+
+    /* FEC scheme of the frame */
+    int fecBlockSize;                // Zero until a parity fragment was received for the frame
+    int fecNbParity;
+    int fecLastFragmentSize;
+} ARSTREAM_Reader_Slot_t;
+
 struct ARSTREAM_Reader_t {
     /* Configuration on New */
     ARNETWORK_Manager_t *manager;
@@ -94,29 +176,77 @@ struct ARSTREAM_Reader_t {
     int ackBufferID;
     uint32_t maxFragmentSize;
     int32_t maxAckInterval;
-    ARSTREAM_Reader_FrameCompleteCallback_t callback;
+    int32_t minAckInterval;
+    int partialFrameDelivery;        // Boolean-like (0/1) flag, active if the complete NAL units of dropped frames are given to the application
+    ARSTREAM_Reader_FrameCompleteCallback_t callback;           // NULL if frames are given from the frame pool
+    ARSTREAM_Reader_FrameReadyCallback_t frameReadyCallback;    // NULL if frames are copied into the application buffers
+    ARSTREAM_Reader_FrameProgressCallback_t progressCallback;   // NULL if the progress is not reported
     void *custom;
 
     /* Current frame storage */
     uint32_t currentFrameBufferSize; // Usable length of the buffer
     uint32_t currentFrameSize;       // Actual data length
     uint8_t *currentFrameBuffer;
+    uint32_t currentFrameNumber;
+    int currentFrameHasCaptureTimestamp; // Boolean-like (0/1) flag
+    uint32_t currentFrameCaptureTimestamp;
+    uint32_t previousFNum;           // Number of the last completed frame
+    int senderUsesLongFrameNumbers;  // Boolean-like (0/1) flag, active once a 32 bits frame number was received
+
+    /* Decryption (set before the data loop starts) */
+    int isEncrypted; // Boolean-like (0/1) flag, active if only authenticated fragments are accepted
+    ARSTREAM_Crypto_Key_t cryptoKey;
+
+    /* Sender sessions of an encrypted stream (data thread only) */
+    uint8_t cryptoNoncePrefix [ARSTREAM_CRYPTO_NONCE_SIZE - sizeof (uint64_t)]; // Drawn by the sender for each key, read from the authenticated fragments
+    uint8_t cryptoPreviousNoncePrefix [ARSTREAM_CRYPTO_NONCE_SIZE - sizeof (uint64_t)]; // Session replaced by the current one, its fragments are dropped
+    int cryptoNbSessions; // Sessions seen since the key was set (capped to 2) : the prefixes are only valid once seen
+
+    /* Reassembly of the frames in progress (data thread only) */
+    ARSTREAM_Reader_Slot_t slots [ARSTREAM_READER_NB_REASSEMBLY_SLOTS];
+    ARSTREAM_Reader_Frame_t *framePool;
+    int framePoolSize;
+    ARSTREAM_Reader_Slot_t *ackPendingSlot; // Slot updated since the last ack packet copy, or NULL
+    int ackPendingIsImmediate;       // Boolean-like (0/1) flag, active if a gap was found in the fragments of ackPendingSlot
+    uint8_t *fecParityBuffer;
+    ARSTREAM_Reader_FecParity_t fecPendingParity [ARSTREAM_READER_FEC_MAX_PENDING_PARITY];
 
     /* Acknowledge storage */
     ARSAL_Mutex_t ackPacketMutex;
     ARSTREAM_NetworkHeaders_AckPacket_t ackPacket;
+    int ackPacketNbFragments;
+    int ackPacketUseExtendedFormat; // Boolean-like (0/1) flag, active if the sender understands extended acks
+    uint8_t receiverId; // Written in the acks if not 0 (fan-out senders)
     ARSAL_Mutex_t ackSendMutex;
     ARSAL_Cond_t ackSendCond;
+    eARSTREAM_READER_ACK_REQUEST ackSendRequest;
+    eARSTREAM_READER_ACK_REQUEST ackLoopSeenRequest; // Protected by ackSendMutex, request left pending by the last ack loop step
+    struct timespec lastAckTime; // Ack loop only, start time of the loop until the first ack is sent
+    int hasSentAck; // Ack loop only
+    int ackLoopNextStepMs; // Result of the last event-driven API ack loop step
+    struct timespec ackLoopLastStepTime;
 
     /* Thread status */
     int threadsShouldStop;
     int dataThreadStarted;
     int ackThreadStarted;
+    uint8_t *recvData; // Data loop only, maxFragmentSize + header and tag bytes
+    ARSTREAM_Impairment_t *dataImpairment; // Data loop only, NULL to read the network buffer directly
+    int dataPollDelayMs; // Event-driven API only, returned by the next ARSTREAM_Reader_ProcessIncoming() call which reads no fragment
+    ARSTREAM_Recorder_t *recorder;   // Data loop only, NULL if the frames are not recorded
+    ARSTREAM_ThreadConfig_t threadConfigs [ARSTREAM_THREAD_MAX]; // Applied by the RunDataThread / RunAckThread functions
+    ARSTREAM_StreamTasks_WakeupCallback_t wakeupCallback; // Called when the ack loop is not run by its own thread
+    void *wakeupCustom;
 
     /* Efficiency calculations */
     int efficiency_nbUseful [ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES];
     int efficiency_nbTotal  [ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES];
     int efficiency_index;
+    int efficiency_pendingNbUseful;  // Counted by the data thread, added to the arrays with the ack packet copy
+    int efficiency_pendingNbTotal;
+
+    /* Statistics (updated with atomic adds, see ARSTREAM_Stats.h) */
+    ARSTREAM_Reader_Stats_t stats;
 };
 
 /*
@@ -133,6 +263,207 @@ struct ARSTREAM_Reader_t {
  */
 eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Reader_NetworkCallback (int IoBufferId, uint8_t *dataPtr, void *customData, eARNETWORK_MANAGER_CALLBACK_STATUS status);
 
+/**
+ * @brief Gets the reassembly slot of the frame of a fragment
+ * If the frame has no slot yet, a free slot (or the slot of the oldest frame) is initialized for it
+ * @param reader The reader
+ * @param infos The infos of the received fragment
+ * @return The slot of the frame, or NULL if the fragment is late and should be ignored
+ */
+static ARSTREAM_Reader_Slot_t* ARSTREAM_Reader_GetSlot (ARSTREAM_Reader_t *reader, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Forgets the frames in progress after a restart of the sender
+ * @param reader The reader
+ * @param frameNumber The frame number of the first fragment received from the restarted sender
+ */
+static void ARSTREAM_Reader_Restart (ARSTREAM_Reader_t *reader, uint32_t frameNumber);
+
+/**
+ * @brief Initializes a reassembly slot for a new frame
+ * @param reader The reader
+ * @param slot The slot to initialize
+ * @param infos The infos of the first received fragment of the new frame
+ */
+static void ARSTREAM_Reader_InitSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Releases a reassembly slot, and the parity fragments kept for its frame
+ * @param reader The reader
+ * @param slot The slot to release
+ */
+static void ARSTREAM_Reader_ReleaseSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot);
+
+/**
+ * @brief Takes a free frame from the frame pool
+ * @param reader The reader
+ * @param size The required size of the frame buffer
+ * @return A frame with a reference count of 1, or NULL if no frame is free (or if the buffer can not be allocated)
+ */
+static ARSTREAM_Reader_Frame_t* ARSTREAM_Reader_GetFreeFrame (ARSTREAM_Reader_t *reader, uint32_t size);
+
+/**
+ * @brief Creates a new ARSTREAM_Reader_t
+ * @see ARSTREAM_Reader_New()
+ * @see ARSTREAM_Reader_NewWithFramePool()
+ */
+static ARSTREAM_Reader_t* ARSTREAM_Reader_NewInternal (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameCompleteCallback_t callback, ARSTREAM_Reader_FrameReadyCallback_t frameReadyCallback, uint8_t *frameBuffer, uint32_t frameBufferSize, int framePoolSize, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error);
+
+/**
+ * @brief Stores a received data fragment into the slot of its frame
+ * @param reader The reader
+ * @param slot The slot of the frame
+ * @param infos The infos of the data fragment
+ * @param data The data of the fragment
+ * @param size The size of the data
+ */
+static void ARSTREAM_Reader_AddDataFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, uint8_t *data, int size);
+
+/**
+ * @brief Marks the ack packet as outdated after an update of a slot
+ * The ack packet is copied on the next ARSTREAM_Reader_SendAckPacket call
+ * @param reader The reader
+ * @param slot The slot which was updated
+ */
+static void ARSTREAM_Reader_UpdateAckPacket (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot);
+
+/**
+ * @brief Copies the received fragments of the last updated slot into the ack packet, and wakes up the ack thread
+ * Does nothing if no slot was updated since the last call
+ * @param reader The reader
+ * @param isImmediate Boolean-like (0/1) flag, active if the ack should not wait for the minimum ack interval
+ */
+static void ARSTREAM_Reader_SendAckPacket (ARSTREAM_Reader_t *reader, int isImmediate);
+
+/**
+ * @brief Handles a fragment read from the data IOBuffer
+ * @param reader The reader
+ * @param recvData The received fragment, with its header
+ * @param recvSize The size of the received fragment
+ */
+static void ARSTREAM_Reader_ProcessFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int recvSize);
+
+/**
+ * @brief Authenticates and decrypts in place the data of a received fragment
+ * Without encryption key, only checks that the fragment is not encrypted.
+ * @param reader The reader
+ * @param recvData The received fragment, with its header
+ * @param headerSize The size of the headers of the fragment
+ * @param[in,out] recvSize The size of the received fragment, without the tag on return
+ * @param infos The infos read from the headers
+ * @return 0 if the fragment can be used, -1 if it must be dropped
+ */
+static int ARSTREAM_Reader_OpenFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int headerSize, int *recvSize, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Reads a fragment from the data IOBuffer, through the data impairment if any
+ * @param reader The reader
+ * @param recvData Buffer which will hold the fragment
+ * @param recvDataLen Capacity of recvData
+ * @param recvSize Pointer which will hold the size of the fragment
+ * @param waitMs Maximum time to wait for a fragment, 0 to return immediately
+ * @return The ARNETWORK_Manager read functions error
+ */
+static eARNETWORK_ERROR ARSTREAM_Reader_ReadFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int recvDataLen, int *recvSize, int waitMs);
+
+/**
+ * @brief Moves all the frame numbers of the reader by a fixed offset
+ * Called when the sender starts sending 32 bits frame numbers, if they do not match the numbers which were extended from 16 bits
+ * @param reader The reader
+ * @param offset The offset to add
+ */
+static void ARSTREAM_Reader_RebaseFrameNumbers (ARSTREAM_Reader_t *reader, uint32_t offset);
+
+/**
+ * @brief Asks the application for a bigger frame buffer until it can hold size bytes
+ * @param reader The reader
+ * @param size The required size of the frame buffer
+ * @param fragmentsPerFrame The number of fragments of the frame
+ * @return 0 if the frame buffer is big enough
+ * @return -1 if the application did not give a big enough buffer
+ */
+static int ARSTREAM_Reader_GrowFrameBuffer (ARSTREAM_Reader_t *reader, uint32_t size, int fragmentsPerFrame);
+
+/**
+ * @brief Gives the frame of a slot to the application if all its fragments were received
+ * Frames older than a completed frame are dropped, so the frames are always given in order
+ * @param reader The reader
+ * @param slot The slot to check
+ */
+static void ARSTREAM_Reader_CheckFrameComplete (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot);
+
+/**
+ * @brief Gives the frame of a slot to the application, then releases the slot
+ * @param reader The reader
+ * @param slot The slot of the frame
+ * @param isPartial Boolean-like (0/1) flag, active if the slot only holds the complete NAL units of the frame
+ */
+static void ARSTREAM_Reader_GiveFrame (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int isPartial);
+
+/**
+ * @brief Drops an incomplete frame
+ * With partial frame delivery, the complete NAL units of the frame are given to the application before the slot is released
+ * @param reader The reader
+ * @param slot The slot of the frame
+ */
+static void ARSTREAM_Reader_DropSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot);
+
+/**
+ * @brief Moves the complete NAL units of a NAL units aligned frame at the start of its buffer
+ * @param slot The slot of the frame
+ * @return The size of the complete NAL units, in bytes
+ */
+static uint32_t ARSTREAM_Reader_CompactCompleteNalUnits (ARSTREAM_Reader_Slot_t *slot);
+
+/**
+ * @brief Gives the contiguous data of the oldest frame in progress to the progress callback, if it grew since the last call
+ * @param reader The reader
+ */
+static void ARSTREAM_Reader_ReportProgress (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Rebuilds the missing data fragment protected by a parity fragment, if it is the only missing one
+ * @param reader The reader
+ * @param slot The slot of the frame
+ * @param parityIndex The index of the parity fragment
+ * @param parityData The parity fragment data
+ * @param paritySize The size of the parity fragment data
+ * @return 1 if the parity fragment is no longer needed
+ * @return 0 if more than one fragment is missing
+ */
+static int ARSTREAM_Reader_FecRebuild (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int parityIndex, uint8_t *parityData, int paritySize);
+
+/**
+ * @brief Handles a received parity fragment
+ * The parity fragment is either used immediately, or kept until the other fragments of its group are received
+ * @param reader The reader
+ * @param slot The slot of the frame
+ * @param infos The infos of the parity fragment
+ * @param parityData The parity fragment data
+ * @param paritySize The size of the parity fragment data
+ */
+static void ARSTREAM_Reader_FecAddParityFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, uint8_t *parityData, int paritySize);
+
+/**
+ * @brief Uses the kept parity fragment of a newly received data fragment, if any
+ * @param reader The reader
+ * @param slot The slot of the frame
+ * @param fragmentIndex The index of the data fragment
+ */
+static void ARSTREAM_Reader_FecAddDataFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int fragmentIndex);
+
+/**
+ * @brief Starts both loops of the reader on the first call of the event-driven API
+ * @param reader The reader
+ */
+static void ARSTREAM_Reader_StartEventLoops (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Ends both loops of the reader once the event-driven API detected the stop
+ * @param reader The reader
+ */
+static void ARSTREAM_Reader_EndEventLoops (ARSTREAM_Reader_t *reader);
+
 /*
  * Internal functions implementation
  */
@@ -150,195 +481,1213 @@ eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Reader_NetworkCallback (int IoBuffer
     return ARNETWORK_MANAGER_CALLBACK_RETURN_DEFAULT;
 }
 
-/*
- * Implementation
- */
-
-void ARSTREAM_Reader_InitStreamDataBuffer (ARNETWORK_IOBufferParam_t *bufferParams, int bufferID, int maxFragmentSize, uint32_t maxNumberOfFragment)
-{
-    ARSTREAM_Buffers_InitStreamDataBuffer (bufferParams, bufferID, maxFragmentSize, maxNumberOfFragment);
-}
-
-void ARSTREAM_Reader_InitStreamAckBuffer (ARNETWORK_IOBufferParam_t *bufferParams, int bufferID)
+static ARSTREAM_Reader_Slot_t* ARSTREAM_Reader_GetSlot (ARSTREAM_Reader_t *reader, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
 {
-    ARSTREAM_Buffers_InitStreamAckBuffer (bufferParams, bufferID);
-}
+    ARSTREAM_Reader_Slot_t *retSlot = NULL;
+    ARSTREAM_Reader_Slot_t *oldestSlot = NULL;
+    int32_t ageFromLastFrame = ARSTREAM_NetworkHeaders_FrameNumberDiff (infos->frameNumber, reader->previousFNum);
+    int i;
 
-ARSTREAM_Reader_t* ARSTREAM_Reader_New (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameCompleteCallback_t callback, uint8_t *frameBuffer, uint32_t frameBufferSize, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error)
-{
-    ARSTREAM_Reader_t *retReader = NULL;
-    int ackPacketMutexWasInit = 0;
-    int ackSendMutexWasInit = 0;
-    int ackSendCondWasInit = 0;
-    eARSTREAM_ERROR internalError = ARSTREAM_OK;
-    /* ARGS Check */
-    if ((manager == NULL) ||
-        (callback == NULL) ||
-        (frameBuffer == NULL) ||
-        (frameBufferSize == 0) ||
-        (maxFragmentSize == 0) ||
-        (maxAckInterval < -1))
+    for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
     {
-        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
-        return retReader;
+        ARSTREAM_Reader_Slot_t *slot = &(reader->slots [i]);
+        if (slot->isUsed == 0)
+        {
+            if (retSlot == NULL)
+            {
+                retSlot = slot;
+            }
+        }
+        else if (slot->frameNumber == infos->frameNumber)
+        {
+            return slot;
+        }
+        else if ((oldestSlot == NULL) ||
+                 (ARSTREAM_NetworkHeaders_FrameNumberDiff (slot->frameNumber, oldestSlot->frameNumber) < 0))
+        {
+            oldestSlot = slot;
+        }
     }
 
-    /* Alloc new reader */
-    retReader = malloc (sizeof (ARSTREAM_Reader_t));
-    if (retReader == NULL)
+    if ((ageFromLastFrame <= -ARSTREAM_READER_MAX_LATE_FRAMES) &&
+        (reader->isEncrypted == 0))
     {
-        internalError = ARSTREAM_ERROR_ALLOC;
+        /* The sender restarted its frame numbers, forget the frames in progress */
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Frame number went from %" PRIu32 " to %" PRIu32 ", restarting", reader->previousFNum, infos->frameNumber);
+        ARSTREAM_Reader_Restart (reader, infos->frameNumber);
+        retSlot = &(reader->slots [0]);
     }
-
-    /* Copy parameters */
-    if (internalError == ARSTREAM_OK)
+    else if (ageFromLastFrame <= 0)
     {
-        retReader->manager = manager;
-        retReader->dataBufferID = dataBufferID;
-        retReader->ackBufferID = ackBufferID;
-        retReader->maxFragmentSize = maxFragmentSize;
-        retReader->maxAckInterval = maxAckInterval;
-        retReader->callback = callback;
-        retReader->custom = custom;
-        retReader->currentFrameBufferSize = frameBufferSize;
-        retReader->currentFrameBuffer = frameBuffer;
+        /* Fragment of an already completed (or dropped) frame, or replayed fragment of an encrypted stream */
+        return NULL;
     }
-
-    /* Setup internal mutexes/conditions */
-    if (internalError == ARSTREAM_OK)
+    else if (retSlot == NULL)
     {
-        int mutexInitRet = ARSAL_Mutex_Init (&(retReader->ackPacketMutex));
-        if (mutexInitRet != 0)
-        {
-            internalError = ARSTREAM_ERROR_ALLOC;
-        }
-        else
+        if (ARSTREAM_NetworkHeaders_FrameNumberDiff (infos->frameNumber, oldestSlot->frameNumber) < 0)
         {
-            ackPacketMutexWasInit = 1;
+            /* Older than all frames in progress */
+            return NULL;
         }
+        ARSTREAM_Reader_DropSlot (reader, oldestSlot);
+        retSlot = oldestSlot;
     }
-    if (internalError == ARSTREAM_OK)
+
+    ARSTREAM_Reader_InitSlot (reader, retSlot, infos);
+    return retSlot;
+}
+
+static void ARSTREAM_Reader_Restart (ARSTREAM_Reader_t *reader, uint32_t frameNumber)
+{
+    int i;
+    for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
     {
-        int mutexInitRet = ARSAL_Mutex_Init (&(retReader->ackSendMutex));
-        if (mutexInitRet != 0)
-        {
-            internalError = ARSTREAM_ERROR_ALLOC;
-        }
-        else
+        if (reader->slots [i].isUsed == 1)
         {
-            ackSendMutexWasInit = 1;
+            ARSTREAM_Stats_Add (&(reader->stats.nbFramesDropped), 1);
+            ARSTREAM_Reader_ReleaseSlot (reader, &(reader->slots [i]));
         }
     }
-    if (internalError == ARSTREAM_OK)
+    reader->previousFNum = frameNumber - 1;
+}
+
+static void ARSTREAM_Reader_InitSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
+{
+    ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
+    reader->efficiency_nbTotal [reader->efficiency_index] += reader->efficiency_pendingNbTotal;
+    reader->efficiency_nbUseful [reader->efficiency_index] += reader->efficiency_pendingNbUseful;
+    reader->efficiency_pendingNbTotal = 0;
+    reader->efficiency_pendingNbUseful = 0;
+    reader->efficiency_index ++;
+    reader->efficiency_index %= ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES;
+    reader->efficiency_nbTotal [reader->efficiency_index] = 0;
+    reader->efficiency_nbUseful [reader->efficiency_index] = 0;
+    ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
+
+    slot->isUsed = 1;
+    slot->frameNumber = infos->frameNumber;
+    slot->frameFlags = infos->frameFlags & ~ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY;
+    slot->nbFragments = infos->fragmentsPerFrame;
+    slot->fragmentsReceived.frameNumber = infos->frameNumber;
+    ARSTREAM_NetworkHeaders_AckPacketReset (&(slot->fragmentsReceived));
+    slot->highestFragmentReceived = -1;
+    slot->frame = ARSTREAM_Reader_GetFreeFrame (reader, reader->maxFragmentSize * slot->nbFragments);
+    slot->isSkipped = (slot->frame == NULL) ? 1 : 0;
+    slot->frameSize = 0;
+    slot->captureTimestamp = infos->captureTimestamp;
+    slot->nbContiguousFragments = 0;
+    slot->progressSize = 0;
+    ARSAL_Time_GetTime (&(slot->startTime));
+    slot->fecBlockSize = 0;
+    slot->fecNbParity = 0;
+    slot->fecLastFragmentSize = 0;
+}
+
+static void ARSTREAM_Reader_ReleaseSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot)
+{
+    int i;
+#ifdef DEBUG
+    uint32_t nackPackets = ARSTREAM_NetworkHeaders_AckPacketCountNotSet (&(slot->fragmentsReceived), slot->nbFragments);
+    if (nackPackets != 0)
     {
-        int condInitRet = ARSAL_Cond_Init (&(retReader->ackSendCond));
-        if (condInitRet != 0)
-        {
-            internalError = ARSTREAM_ERROR_ALLOC;
-        }
-        else
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Dropping frame %d (missing %d fragments)", slot->frameNumber, nackPackets);
+    }
+#endif
+    for (i = 0; i < ARSTREAM_READER_FEC_MAX_PENDING_PARITY; i++)
+    {
+        if ((reader->fecPendingParity [i].isUsed == 1) &&
+            (reader->fecPendingParity [i].frameNumber == slot->frameNumber))
         {
-            ackSendCondWasInit = 1;
+            reader->fecPendingParity [i].isUsed = 0;
         }
     }
+    if (reader->ackPendingSlot == slot)
+    {
+        reader->ackPendingSlot = NULL;
+        reader->ackPendingIsImmediate = 0;
+    }
+    if ((slot->progressSize > 0) &&
+        (reader->progressCallback != NULL))
+    {
+        /* Frame was reported, but will never be given */
+        reader->progressCallback (slot->frameNumber, NULL, 0, ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME) != 0) ? 1 : 0, reader->custom);
+    }
+    slot->progressSize = 0;
+    if (slot->frame != NULL)
+    {
+        ARSTREAM_Reader_FrameUnref (slot->frame);
+        slot->frame = NULL;
+    }
+    slot->isUsed = 0;
+}
 
-    /* Setup internal variables */
-    if (internalError == ARSTREAM_OK)
+static ARSTREAM_Reader_Frame_t* ARSTREAM_Reader_GetFreeFrame (ARSTREAM_Reader_t *reader, uint32_t size)
+{
+    int i;
+    for (i = 0; i < reader->framePoolSize; i++)
     {
-        int i;
-        retReader->currentFrameSize = 0;
-        retReader->threadsShouldStop = 0;
-        retReader->dataThreadStarted = 0;
-        retReader->ackThreadStarted = 0;
-        retReader->efficiency_index = 0;
-        for (i = 0; i < ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES; i++)
+        ARSTREAM_Reader_Frame_t *frame = &(reader->framePool [i]);
+        /* Only the data thread takes frames from the pool, so a free frame can not be taken meanwhile */
+        if (__atomic_load_n (&(frame->refCount), __ATOMIC_ACQUIRE) == 0)
         {
-            retReader->efficiency_nbTotal [i] = 0;
-            retReader->efficiency_nbUseful [i] = 0;
+            if (frame->bufferSize < size)
+            {
+                /* No data to keep, don't pay for a realloc copy */
+                free (frame->buffer);
+                frame->buffer = malloc (size);
+                frame->bufferSize = (frame->buffer != NULL) ? size : 0;
+                if (frame->buffer == NULL)
+                {
+                    ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Unable to alloc %d bytes for a frame", size);
+                    return NULL;
+                }
+            }
+            frame->isPartial = 0;
+            __atomic_store_n (&(frame->refCount), 1, __ATOMIC_RELAXED);
+            return frame;
         }
     }
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "No free frame in the frame pool");
+    return NULL;
+}
 
-    if ((internalError != ARSTREAM_OK) &&
-        (retReader != NULL))
+static void ARSTREAM_Reader_AddDataFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, uint8_t *data, int size)
+{
+    int packetWasAlreadyAck = ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(slot->fragmentsReceived), infos->fragmentNumber);
+    ARSTREAM_NetworkHeaders_AckPacketSetFlag (&(slot->fragmentsReceived), infos->fragmentNumber);
+    if (infos->fragmentNumber > slot->highestFragmentReceived)
     {
-        if (ackPacketMutexWasInit == 1)
+        if (infos->fragmentNumber > slot->highestFragmentReceived + 1)
         {
-            ARSAL_Mutex_Destroy (&(retReader->ackPacketMutex));
+            /* Some fragments were skipped, let the sender know without waiting */
+            reader->ackPendingIsImmediate = 1;
         }
-        if (ackSendMutexWasInit == 1)
+        slot->highestFragmentReceived = infos->fragmentNumber;
+    }
+
+    reader->efficiency_pendingNbTotal ++;
+    if (packetWasAlreadyAck == 0)
+    {
+        reader->efficiency_pendingNbUseful ++;
+    }
+    ARSTREAM_Stats_Add ((packetWasAlreadyAck == 0) ? &(reader->stats.nbFragmentsReceived) : &(reader->stats.nbFragmentsDuplicated), 1);
+
+    ARSTREAM_Reader_UpdateAckPacket (reader, slot);
+
+    if ((packetWasAlreadyAck == 0) &&
+        (slot->isSkipped == 0))
+    {
+        uint32_t cpIndex = reader->maxFragmentSize * infos->fragmentNumber;
+        uint32_t endIndex;
+        if ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0)
         {
-            ARSAL_Mutex_Destroy (&(retReader->ackSendMutex));
+            ARSTREAM_Reader_FragmentLayout_t *layout = &(slot->fragmentsLayout [infos->fragmentNumber]);
+            cpIndex = infos->fragmentOffset;
+            layout->offset = cpIndex;
+            layout->size = size;
+            layout->naluFlags = infos->naluFlags;
         }
-        if (ackSendCondWasInit == 1)
+        endIndex = cpIndex + size;
+        memcpy (&(slot->frame->buffer)[cpIndex], data, size);
+        if (endIndex > slot->frameSize)
         {
-            ARSAL_Cond_Destroy (&(retReader->ackSendCond));
+            slot->frameSize = endIndex;
         }
-        free (retReader);
-        retReader = NULL;
+        ARSTREAM_Reader_FecAddDataFragment (reader, slot, infos->fragmentNumber);
+        ARSTREAM_Reader_CheckFrameComplete (reader, slot);
     }
-
-    SET_WITH_CHECK (error, internalError);
-    return retReader;
 }
 
-void ARSTREAM_Reader_StopReader (ARSTREAM_Reader_t *reader)
+static void ARSTREAM_Reader_UpdateAckPacket (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot)
 {
-    if (reader != NULL)
-    {
-        reader->threadsShouldStop = 1;
-        /* Force unblock the ACK thread to allow it to shutdown quickly.
-         * This is necessary if maxAckInterval is set to -1, 0 or a large value.
-         * If maxAckInterval >= 0, an ACK packet will be sent as a side-effect. */
-        if (reader->ackThreadStarted == 1)
-        {
-            ARSAL_Mutex_Lock (&(reader->ackSendMutex));
-            ARSAL_Cond_Signal (&(reader->ackSendCond));
-            ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
-        }
-    }
+    reader->ackPendingSlot = slot;
 }
 
-eARSTREAM_ERROR ARSTREAM_Reader_Delete (ARSTREAM_Reader_t **reader)
+static void ARSTREAM_Reader_SendAckPacket (ARSTREAM_Reader_t *reader, int isImmediate)
 {
-    eARSTREAM_ERROR retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
-    if ((reader != NULL) &&
-        (*reader != NULL))
+    ARSTREAM_Reader_Slot_t *slot = reader->ackPendingSlot;
+    eARSTREAM_READER_ACK_REQUEST request;
+    if (slot == NULL)
+    {
+        return;
+    }
+    request = ((isImmediate == 1) || (reader->ackPendingIsImmediate == 1)) ? ARSTREAM_READER_ACK_REQUEST_IMMEDIATE : ARSTREAM_READER_ACK_REQUEST_COALESCED;
+    reader->ackPendingSlot = NULL;
+    reader->ackPendingIsImmediate = 0;
+
+    ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
+    memcpy (&(reader->ackPacket), &(slot->fragmentsReceived), sizeof (reader->ackPacket));
+    reader->ackPacketNbFragments = slot->nbFragments;
+    reader->ackPacketUseExtendedFormat = ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_ACK_CAPABLE) != 0) ? 1 : 0;
+    reader->efficiency_nbTotal [reader->efficiency_index] += reader->efficiency_pendingNbTotal;
+    reader->efficiency_nbUseful [reader->efficiency_index] += reader->efficiency_pendingNbUseful;
+    reader->efficiency_pendingNbTotal = 0;
+    reader->efficiency_pendingNbUseful = 0;
+    ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
+
+    ARSAL_Mutex_Lock (&(reader->ackSendMutex));
+    if (request > reader->ackSendRequest)
+    {
+        reader->ackSendRequest = request;
+    }
+    ARSAL_Cond_Signal (&(reader->ackSendCond));
+    ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+    if (reader->wakeupCallback != NULL)
+    {
+        reader->wakeupCallback (reader->wakeupCustom);
+    }
+}
+
+static void ARSTREAM_Reader_ProcessFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int recvSize)
+{
+    ARSTREAM_NetworkHeaders_FragmentInfos_t infos;
+    ARSTREAM_Reader_Slot_t *slot;
+    int headerSize = ARSTREAM_NetworkHeaders_DataHeaderRead (recvData, recvSize, &infos);
+    if ((headerSize >= 0) &&
+        (ARSTREAM_Reader_OpenFragment (reader, recvData, headerSize, &recvSize, &infos) != 0))
+    {
+        // Forged or corrupted fragments must not change the state of the reader
+        return;
+    }
+    if ((headerSize >= 0) &&
+        ((infos.frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER) == 0))
+    {
+        /* Legacy senders (or senders which did not receive extended acks yet) only send 16 bits frame numbers */
+        infos.frameNumber = ARSTREAM_NetworkHeaders_FrameNumberExtend ((uint16_t)(infos.frameNumber & 0xFFFF), reader->previousFNum);
+    }
+    else if ((headerSize >= 0) &&
+             (reader->senderUsesLongFrameNumbers == 0))
+    {
+        uint32_t extended = ARSTREAM_NetworkHeaders_FrameNumberExtend ((uint16_t)(infos.frameNumber & 0xFFFF), reader->previousFNum);
+        reader->senderUsesLongFrameNumbers = 1;
+        if (extended != infos.frameNumber)
+        {
+            ARSTREAM_Reader_RebaseFrameNumbers (reader, infos.frameNumber - extended);
+        }
+    }
+    if (headerSize < 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Received an invalid stream data fragment (%d octets)", recvSize);
+    }
+    else if ((recvSize - headerSize) > (int)reader->maxFragmentSize)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Received a too big stream data fragment (%d octets)", recvSize - headerSize);
+    }
+    else if ((slot = ARSTREAM_Reader_GetSlot (reader, &infos)) == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ignoring late fragment %d of frame %d", infos.fragmentNumber, infos.frameNumber);
+        ARSTREAM_Stats_Add (&(reader->stats.nbFragmentsLate), 1);
+    }
+    else if (infos.fragmentsPerFrame != slot->nbFragments)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Fragment %d of frame %d does not match the frame size (%d != %d fragments)", infos.fragmentNumber, infos.frameNumber, infos.fragmentsPerFrame, slot->nbFragments);
+    }
+    else if (((infos.frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != (slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED)) ||
+             (infos.fragmentOffset > (reader->maxFragmentSize * slot->nbFragments) - (recvSize - headerSize)))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Fragment %d of frame %d does not fit in the frame (offset %d)", infos.fragmentNumber, infos.frameNumber, infos.fragmentOffset);
+    }
+    else if ((infos.frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY) != 0)
+    {
+        ARSTREAM_Stats_Add (&(reader->stats.nbParityFragmentsReceived), 1);
+        ARSTREAM_Reader_FecAddParityFragment (reader, slot, &infos, &recvData[headerSize], recvSize - headerSize);
+    }
+    else
+    {
+        ARSTREAM_Reader_AddDataFragment (reader, slot, &infos, &recvData[headerSize], recvSize - headerSize);
+    }
+}
+
+static int ARSTREAM_Reader_OpenFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int headerSize, int *recvSize, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
+{
+    int retVal = 0;
+    int isEncrypted = ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED) != 0) ? 1 : 0;
+    if (isEncrypted != reader->isEncrypted)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Received %s fragment %d of frame %d, dropping it", (isEncrypted == 1) ? "an encrypted" : "a clear", infos->fragmentNumber, infos->frameNumber);
+        retVal = -1;
+    }
+    else if ((isEncrypted == 1) &&
+             ((infos->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER) == 0))
+    {
+        // 16 bits frame numbers wrap, an old fragment could then be taken for a new one
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Received an encrypted fragment without 32 bits frame number, dropping it");
+        retVal = -1;
+    }
+    else if (isEncrypted == 1)
+    {
+        // The headers read the tag size, so the data size can not be negative
+        int dataSize = *recvSize - headerSize - ARSTREAM_CRYPTO_TAG_SIZE;
+        size_t prefixSize = sizeof (reader->cryptoNoncePrefix);
+        if (ARSTREAM_Crypto_Open (&(reader->cryptoKey), infos->nonce, recvData, headerSize, &recvData [headerSize], dataSize, &recvData [headerSize + dataSize]) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Fragment %d of frame %d does not authenticate, dropping it", infos->fragmentNumber, infos->frameNumber);
+            retVal = -1;
+        }
+        else if ((reader->cryptoNbSessions > 0) &&
+                 (memcmp (infos->nonce, reader->cryptoNoncePrefix, prefixSize) == 0))
+        {
+            *recvSize -= ARSTREAM_CRYPTO_TAG_SIZE;
+        }
+        else if ((reader->cryptoNbSessions > 1) &&
+                 (memcmp (infos->nonce, reader->cryptoPreviousNoncePrefix, prefixSize) == 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Fragment %d of frame %d belongs to a previous session of the sender, dropping it", infos->fragmentNumber, infos->frameNumber);
+            retVal = -1;
+        }
+        else
+        {
+            /* New nonce prefix : the sender restarted with this key */
+            if (reader->cryptoNbSessions > 0)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "New sender session at frame %" PRIu32 ", restarting", infos->frameNumber);
+                memcpy (reader->cryptoPreviousNoncePrefix, reader->cryptoNoncePrefix, prefixSize);
+                ARSTREAM_Reader_Restart (reader, infos->frameNumber);
+            }
+            memcpy (reader->cryptoNoncePrefix, infos->nonce, prefixSize);
+            reader->cryptoNbSessions = (reader->cryptoNbSessions < 2) ? reader->cryptoNbSessions + 1 : 2;
+            *recvSize -= ARSTREAM_CRYPTO_TAG_SIZE;
+        }
+    }
+    // No else : clear fragment, without encryption key
+
+    if (retVal != 0)
+    {
+        ARSTREAM_Stats_Add (&(reader->stats.nbFragmentsRejected), 1);
+    }
+    return retVal;
+}
+
+static void ARSTREAM_Reader_RebaseFrameNumbers (ARSTREAM_Reader_t *reader, uint32_t offset)
+{
+    int i;
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Sender uses 32 bits frame numbers, moving frame numbers by %" PRIu32, offset);
+    reader->previousFNum += offset;
+    for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
+    {
+        reader->slots [i].frameNumber += offset;
+        reader->slots [i].fragmentsReceived.frameNumber += offset;
+    }
+    for (i = 0; i < ARSTREAM_READER_FEC_MAX_PENDING_PARITY; i++)
+    {
+        reader->fecPendingParity [i].frameNumber += offset;
+    }
+    ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
+    reader->ackPacket.frameNumber += offset;
+    ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
+}
+
+static int ARSTREAM_Reader_GrowFrameBuffer (ARSTREAM_Reader_t *reader, uint32_t size, int fragmentsPerFrame)
+{
+    int retVal = 0;
+    while ((size > reader->currentFrameBufferSize) &&
+           (retVal == 0))
+    {
+        uint32_t nextFrameBufferSize = reader->maxFragmentSize * fragmentsPerFrame;
+        uint32_t dummy;
+        uint8_t *nextFrameBuffer = reader->callback (ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL, reader->currentFrameBuffer, reader->currentFrameSize, 0, 0, &nextFrameBufferSize, reader->custom);
+        if (nextFrameBufferSize >= reader->currentFrameSize && nextFrameBufferSize > 0)
+        {
+            memcpy (nextFrameBuffer, reader->currentFrameBuffer, reader->currentFrameSize);
+        }
+        else
+        {
+            retVal = -1;
+        }
+        //TODO: Add "SKIP_FRAME"
+        reader->callback (ARSTREAM_READER_CAUSE_COPY_COMPLETE, reader->currentFrameBuffer, reader->currentFrameSize, 0, (retVal == 0) ? 0 : 1, &dummy, reader->custom);
+        reader->currentFrameBuffer = nextFrameBuffer;
+        reader->currentFrameBufferSize = nextFrameBufferSize;
+    }
+    return retVal;
+}
+
+static void ARSTREAM_Reader_CheckFrameComplete (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot)
+{
+    ARSTREAM_Reader_Slot_t *oldestSlot;
+    int i;
+
+    if ((slot->isUsed == 0) ||
+        (slot->isSkipped == 1) ||
+        (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&(slot->fragmentsReceived), slot->nbFragments) == 0))
+    {
+        return;
+    }
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack all in frame %d (isFlush : %d)", slot->frameNumber, ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME) != 0) ? 1 : 0);
+    /* Older frames can not be given in order anymore, drop them from the oldest one */
+    do
+    {
+        oldestSlot = NULL;
+        for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
+        {
+            ARSTREAM_Reader_Slot_t *other = &(reader->slots [i]);
+            if ((other->isUsed == 1) &&
+                (ARSTREAM_NetworkHeaders_FrameNumberDiff (other->frameNumber, slot->frameNumber) < 0) &&
+                ((oldestSlot == NULL) ||
+                 (ARSTREAM_NetworkHeaders_FrameNumberDiff (other->frameNumber, oldestSlot->frameNumber) < 0)))
+            {
+                oldestSlot = other;
+            }
+        }
+        if (oldestSlot != NULL)
+        {
+            ARSTREAM_Reader_DropSlot (reader, oldestSlot);
+        }
+    } while (oldestSlot != NULL);
+
+    /* Don't wait for the end of the batch to tell the sender */
+    ARSTREAM_Reader_UpdateAckPacket (reader, slot);
+    ARSTREAM_Reader_SendAckPacket (reader, 1);
+
+    ARSTREAM_Reader_GiveFrame (reader, slot, 0);
+}
+
+static void ARSTREAM_Reader_GiveFrame (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int isPartial)
+{
+    uint32_t expectedFNum = reader->previousFNum + 1;
+    int nbMissedFrame = 0;
+    int isFlushFrame = ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME) != 0) ? 1 : 0;
+    int hasCaptureTimestamp = ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP) != 0) ? 1 : 0;
+
+    if (slot->frameNumber != expectedFNum)
+    {
+        /* Slots never hold frames older than previousFNum, so the distance is positive */
+        nbMissedFrame = ARSTREAM_NetworkHeaders_FrameNumberDiff (slot->frameNumber, expectedFNum);
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Missed %d frames !", nbMissedFrame);
+    }
+    if (reader->recorder != NULL)
+    {
+        /* Only a copy : the file is written by the recorder thread */
+        uint32_t recordFlags = (isFlushFrame == 1) ? ARSTREAM_RECORDER_INDEX_FLAG_FLUSH_FRAME : 0;
+        recordFlags |= (isPartial == 1) ? ARSTREAM_RECORDER_INDEX_FLAG_PARTIAL_FRAME : 0;
+        ARSTREAM_Recorder_AddFrame (reader->recorder, slot->frame->buffer, slot->frameSize, slot->frameNumber, recordFlags);
+    }
+    reader->previousFNum = slot->frameNumber;
+    ARSTREAM_Stats_Add ((isPartial == 1) ? &(reader->stats.nbFramesPartial) : &(reader->stats.nbFramesComplete), 1);
+    ARSTREAM_Stats_Add (&(reader->stats.nbFramesMissed), nbMissedFrame);
+    ARSTREAM_Stats_AddLatency (reader->stats.reassemblyTime, ARSTREAM_READER_STATS_LATENCY_NB_BUCKETS, &(slot->startTime));
+    if (isPartial == 0)
+    {
+        /* No drop report for the progress callback */
+        slot->progressSize = 0;
+    }
+
+    /* Give the frame to the application */
+    if (reader->frameReadyCallback != NULL)
+    {
+        /* The application takes its own reference if it keeps the frame after the callback */
+        slot->frame->isPartial = isPartial;
+        slot->frame->frameNumber = slot->frameNumber;
+        slot->frame->hasCaptureTimestamp = hasCaptureTimestamp;
+        slot->frame->captureTimestamp = slot->captureTimestamp;
+        reader->frameReadyCallback (slot->frame, slot->frame->buffer, slot->frameSize, nbMissedFrame, isFlushFrame, reader->custom);
+        ARSTREAM_Reader_ReleaseSlot (reader, slot);
+        return;
+    }
+    reader->currentFrameSize = 0;
+    if (ARSTREAM_Reader_GrowFrameBuffer (reader, slot->frameSize, slot->nbFragments) == 0)
+    {
+        memcpy (reader->currentFrameBuffer, slot->frame->buffer, slot->frameSize);
+        reader->currentFrameSize = slot->frameSize;
+        reader->currentFrameNumber = slot->frameNumber;
+        reader->currentFrameHasCaptureTimestamp = hasCaptureTimestamp;
+        reader->currentFrameCaptureTimestamp = slot->captureTimestamp;
+        reader->currentFrameBuffer = reader->callback ((isPartial == 1) ? ARSTREAM_READER_CAUSE_FRAME_PARTIAL : ARSTREAM_READER_CAUSE_FRAME_COMPLETE, reader->currentFrameBuffer, reader->currentFrameSize, nbMissedFrame, isFlushFrame, &(reader->currentFrameBufferSize), reader->custom);
+        reader->currentFrameSize = 0;
+    }
+    ARSTREAM_Reader_ReleaseSlot (reader, slot);
+}
+
+static void ARSTREAM_Reader_DropSlot (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot)
+{
+    if ((reader->partialFrameDelivery == 1) &&
+        (slot->isSkipped == 0) &&
+        ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0))
+    {
+        uint32_t partialSize = ARSTREAM_Reader_CompactCompleteNalUnits (slot);
+        if (partialSize > 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Giving %d of %d bytes of incomplete frame %d", partialSize, slot->frameSize, slot->frameNumber);
+            slot->frameSize = partialSize;
+            ARSTREAM_Reader_GiveFrame (reader, slot, 1);
+            return;
+        }
+    }
+    ARSTREAM_Stats_Add (&(reader->stats.nbFramesDropped), 1);
+    ARSTREAM_Reader_ReleaseSlot (reader, slot);
+}
+
+static uint32_t ARSTREAM_Reader_CompactCompleteNalUnits (ARSTREAM_Reader_Slot_t *slot)
+{
+    uint8_t *buffer = slot->frame->buffer;
+    uint32_t writeIndex = 0;
+    int firstFragment = -1;
+    int i;
+
+    /* Each run of received fragments from a START flag to an END flag holds complete NAL units */
+    for (i = 0; i < slot->nbFragments; i++)
+    {
+        ARSTREAM_Reader_FragmentLayout_t *layout = &(slot->fragmentsLayout [i]);
+        if (0 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(slot->fragmentsReceived), i))
+        {
+            firstFragment = -1;
+            continue;
+        }
+        if ((layout->naluFlags & ARSTREAM_NETWORK_HEADERS_NALU_FLAG_START) != 0)
+        {
+            firstFragment = i;
+        }
+        if ((firstFragment != -1) &&
+            ((layout->naluFlags & ARSTREAM_NETWORK_HEADERS_NALU_FLAG_END) != 0))
+        {
+            uint32_t runOffset = slot->fragmentsLayout [firstFragment].offset;
+            if ((runOffset >= writeIndex) &&
+                (runOffset <= layout->offset))
+            {
+                uint32_t runSize = layout->offset + layout->size - runOffset;
+                memmove (&buffer [writeIndex], &buffer [runOffset], runSize);
+                writeIndex += runSize;
+            }
+            firstFragment = -1;
+        }
+    }
+    return writeIndex;
+}
+
+static void ARSTREAM_Reader_ReportProgress (ARSTREAM_Reader_t *reader)
+{
+    ARSTREAM_Reader_Slot_t *slot = NULL;
+    uint32_t contiguousSize;
+    int i;
+
+    for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
+    {
+        ARSTREAM_Reader_Slot_t *other = &(reader->slots [i]);
+        if ((other->isUsed == 1) &&
+            ((slot == NULL) ||
+             (ARSTREAM_NetworkHeaders_FrameNumberDiff (other->frameNumber, slot->frameNumber) < 0)))
+        {
+            slot = other;
+        }
+    }
+    if ((slot == NULL) ||
+        (slot->isSkipped == 1))
+    {
+        return;
+    }
+
+    while ((slot->nbContiguousFragments < slot->nbFragments) &&
+           (1 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(slot->fragmentsReceived), slot->nbContiguousFragments)))
+    {
+        slot->nbContiguousFragments++;
+    }
+    if (slot->nbContiguousFragments == 0)
+    {
+        return;
+    }
+    if ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0)
+    {
+        ARSTREAM_Reader_FragmentLayout_t *layout = &(slot->fragmentsLayout [slot->nbContiguousFragments - 1]);
+        contiguousSize = layout->offset + layout->size;
+    }
+    else
+    {
+        // Complete frames are already given, so the last fragment is not part of the contiguous data
+        contiguousSize = reader->maxFragmentSize * slot->nbContiguousFragments;
+    }
+
+    if (contiguousSize > slot->progressSize)
+    {
+        slot->progressSize = contiguousSize;
+        reader->progressCallback (slot->frameNumber, slot->frame->buffer, contiguousSize, ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME) != 0) ? 1 : 0, reader->custom);
+    }
+}
+
+static int ARSTREAM_Reader_FecRebuild (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int parityIndex, uint8_t *parityData, int paritySize)
+{
+    int nbFragments = slot->nbFragments;
+    int first, end, index;
+    int missingIndex = -1;
+    int missingSize;
+    uint32_t endIndex;
+    uint8_t *missingData;
+
+    ARSTREAM_Fec_GetProtectedFragments (parityIndex, nbFragments, slot->fecBlockSize, slot->fecNbParity, &first, &end);
+    for (index = first; index < end; index += slot->fecNbParity)
+    {
+        if (0 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(slot->fragmentsReceived), index))
+        {
+            if (missingIndex != -1)
+            {
+                // More than one missing fragment, keep the parity for later
+                return 0;
+            }
+            missingIndex = index;
+        }
+    }
+    if (missingIndex == -1)
+    {
+        // All fragments of the group are already there
+        return 1;
+    }
+
+    missingSize = (missingIndex == nbFragments - 1) ? slot->fecLastFragmentSize : (int)reader->maxFragmentSize;
+    if ((missingSize <= 0) ||
+        (missingSize > paritySize))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Parity fragment %d is too small to rebuild fragment %d (%d < %d)", parityIndex, missingIndex, paritySize, missingSize);
+        return 1;
+    }
+
+    endIndex = (reader->maxFragmentSize * missingIndex) + missingSize;
+
+    /* missing = parity ^ (all other fragments of the group) */
+    missingData = &(slot->frame->buffer)[reader->maxFragmentSize * missingIndex];
+    memcpy (missingData, parityData, missingSize);
+    for (index = first; index < end; index += slot->fecNbParity)
+    {
+        if (index != missingIndex)
+        {
+            int fragmentSize = (index == nbFragments - 1) ? slot->fecLastFragmentSize : (int)reader->maxFragmentSize;
+            ARSTREAM_Fec_Xor (missingData, &(slot->frame->buffer)[reader->maxFragmentSize * index], (fragmentSize < missingSize) ? fragmentSize : missingSize);
+        }
+    }
+    if (endIndex > slot->frameSize)
+    {
+        slot->frameSize = endIndex;
+    }
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Rebuilt fragment %d of frame %d from parity fragment %d", missingIndex, slot->frameNumber, parityIndex);
+
+    ARSTREAM_NetworkHeaders_AckPacketSetFlag (&(slot->fragmentsReceived), missingIndex);
+    ARSTREAM_Stats_Add (&(reader->stats.nbFragmentsRebuilt), 1);
+    ARSTREAM_Reader_UpdateAckPacket (reader, slot);
+    ARSTREAM_Reader_CheckFrameComplete (reader, slot);
+    return 1;
+}
+
+static void ARSTREAM_Reader_FecAddParityFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, uint8_t *parityData, int paritySize)
+{
+    int i;
+    int freeIndex = -1;
+    if ((slot->isSkipped != 0) ||
+        ((slot->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0))
+    {
+        // Parity fragments can not protect NAL units aligned fragments
+        return;
+    }
+    if (slot->fecBlockSize == 0)
+    {
+        if (infos->fecLastFragmentSize > reader->maxFragmentSize)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Invalid last fragment size in parity fragment (%d)", infos->fecLastFragmentSize);
+            return;
+        }
+        slot->fecBlockSize = infos->fecBlockSize;
+        slot->fecNbParity = infos->fecNbParity;
+        slot->fecLastFragmentSize = infos->fecLastFragmentSize;
+    }
+    else if ((slot->fecBlockSize != infos->fecBlockSize) ||
+             (slot->fecNbParity != infos->fecNbParity) ||
+             (slot->fecLastFragmentSize != infos->fecLastFragmentSize))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Parity fragment %d does not match the FEC scheme of frame %d", infos->fragmentNumber, infos->frameNumber);
+        return;
+    }
+
+    for (i = 0; i < ARSTREAM_READER_FEC_MAX_PENDING_PARITY; i++)
+    {
+        ARSTREAM_Reader_FecParity_t *parity = &(reader->fecPendingParity [i]);
+        if (parity->isUsed == 0)
+        {
+            if (freeIndex == -1)
+            {
+                freeIndex = i;
+            }
+        }
+        else if ((parity->frameNumber == slot->frameNumber) &&
+                 (parity->parityIndex == infos->fragmentNumber))
+        {
+            // Duplicate parity fragment
+            return;
+        }
+    }
+
+    if ((ARSTREAM_Reader_FecRebuild (reader, slot, infos->fragmentNumber, parityData, paritySize) == 0) &&
+        (freeIndex != -1))
+    {
+        ARSTREAM_Reader_FecParity_t *parity = &(reader->fecPendingParity [freeIndex]);
+        memcpy (parity->data, parityData, paritySize);
+        parity->size = paritySize;
+        parity->frameNumber = slot->frameNumber;
+        parity->parityIndex = infos->fragmentNumber;
+        parity->isUsed = 1;
+    }
+}
+
+static void ARSTREAM_Reader_FecAddDataFragment (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Slot_t *slot, int fragmentIndex)
+{
+    int parityIndex;
+    int i;
+    if (slot->fecBlockSize == 0)
+    {
+        return;
+    }
+    parityIndex = ARSTREAM_Fec_GetParityIndex (fragmentIndex, slot->fecBlockSize, slot->fecNbParity);
+    for (i = 0; i < ARSTREAM_READER_FEC_MAX_PENDING_PARITY; i++)
+    {
+        ARSTREAM_Reader_FecParity_t *parity = &(reader->fecPendingParity [i]);
+        if ((parity->isUsed == 1) &&
+            (parity->frameNumber == slot->frameNumber) &&
+            (parity->parityIndex == parityIndex))
+        {
+            if (ARSTREAM_Reader_FecRebuild (reader, slot, parityIndex, parity->data, parity->size) == 1)
+            {
+                parity->isUsed = 0;
+            }
+            break;
+        }
+    }
+}
+
+static void ARSTREAM_Reader_StartEventLoops (ARSTREAM_Reader_t *reader)
+{
+    if ((reader->threadsShouldStop == 0) &&
+        (reader->dataThreadStarted == 0))
+    {
+        ARSTREAM_Reader_StartDataLoop (reader);
+        ARSTREAM_Reader_StartAckLoop (reader);
+    }
+}
+
+static void ARSTREAM_Reader_EndEventLoops (ARSTREAM_Reader_t *reader)
+{
+    if (reader->dataThreadStarted == 1)
+    {
+        ARSTREAM_Reader_EndDataLoop (reader);
+    }
+    if (reader->ackThreadStarted == 1)
+    {
+        ARSTREAM_Reader_EndAckLoop (reader);
+    }
+}
+
+static ARSTREAM_Reader_t* ARSTREAM_Reader_NewInternal (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameCompleteCallback_t callback, ARSTREAM_Reader_FrameReadyCallback_t frameReadyCallback, uint8_t *frameBuffer, uint32_t frameBufferSize, int framePoolSize, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error)
+{
+    ARSTREAM_Reader_t *retReader = NULL;
+    int ackPacketMutexWasInit = 0;
+    int ackSendMutexWasInit = 0;
+    int ackSendCondWasInit = 0;
+    int fecParityBufferWasCreated = 0;
+    int framePoolWasCreated = 0;
+    int recvDataWasCreated = 0;
+    eARSTREAM_ERROR internalError = ARSTREAM_OK;
+
+    /* Alloc new reader */
+    retReader = malloc (sizeof (ARSTREAM_Reader_t));
+    if (retReader == NULL)
+    {
+        internalError = ARSTREAM_ERROR_ALLOC;
+    }
+
+    /* Copy parameters */
+    if (internalError == ARSTREAM_OK)
+    {
+        retReader->manager = manager;
+        retReader->dataBufferID = dataBufferID;
+        retReader->ackBufferID = ackBufferID;
+        retReader->maxFragmentSize = maxFragmentSize;
+        retReader->maxAckInterval = maxAckInterval;
+        retReader->minAckInterval = ARSTREAM_READER_MIN_ACK_INTERVAL_DEFAULT;
+        retReader->partialFrameDelivery = 0;
+        retReader->callback = callback;
+        retReader->frameReadyCallback = frameReadyCallback;
+        retReader->progressCallback = NULL;
+        retReader->custom = custom;
+        retReader->currentFrameBufferSize = frameBufferSize;
+        retReader->currentFrameBuffer = frameBuffer;
+    }
+
+    /* Setup internal mutexes/conditions */
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retReader->ackPacketMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            ackPacketMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retReader->ackSendMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            ackSendMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int condInitRet = ARSAL_Cond_Init (&(retReader->ackSendCond));
+        if (condInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            ackSendCondWasInit = 1;
+        }
+    }
+
+    /* Alloc the parity fragments storage */
+    if (internalError == ARSTREAM_OK)
+    {
+        retReader->fecParityBuffer = malloc (ARSTREAM_READER_FEC_MAX_PENDING_PARITY * maxFragmentSize);
+        if (retReader->fecParityBuffer == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            fecParityBufferWasCreated = 1;
+        }
+    }
+
+    /* Alloc the frame pool (buffers are allocated when the size of the first frames is known) */
+    if (internalError == ARSTREAM_OK)
+    {
+        retReader->framePool = calloc (framePoolSize, sizeof (ARSTREAM_Reader_Frame_t));
+        if (retReader->framePool == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            retReader->framePoolSize = framePoolSize;
+            framePoolWasCreated = 1;
+        }
+    }
+
+    /* Alloc the data loop receive buffer */
+    if (internalError == ARSTREAM_OK)
+    {
+        retReader->recvData = malloc (maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE);
+        if (retReader->recvData == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            recvDataWasCreated = 1;
+        }
+    }
+
+    /* Setup internal variables */
+    if (internalError == ARSTREAM_OK)
+    {
+        int i;
+        retReader->currentFrameSize = 0;
+        retReader->currentFrameNumber = 0;
+        retReader->currentFrameHasCaptureTimestamp = 0;
+        retReader->currentFrameCaptureTimestamp = 0;
+        retReader->previousFNum = UINT32_MAX;
+        retReader->senderUsesLongFrameNumbers = 0;
+        memset (&(retReader->stats), 0, sizeof (retReader->stats));
+        for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
+        {
+            retReader->slots [i].isUsed = 0;
+            retReader->slots [i].frame = NULL;
+        }
+        retReader->ackPendingSlot = NULL;
+        retReader->ackPendingIsImmediate = 0;
+        retReader->ackSendRequest = ARSTREAM_READER_ACK_REQUEST_NONE;
+        retReader->ackLoopSeenRequest = ARSTREAM_READER_ACK_REQUEST_NONE;
+        retReader->hasSentAck = 0;
+        retReader->ackLoopNextStepMs = 0;
+        retReader->dataPollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        for (i = 0; i < ARSTREAM_READER_FEC_MAX_PENDING_PARITY; i++)
+        {
+            retReader->fecPendingParity [i].isUsed = 0;
+            retReader->fecPendingParity [i].frameNumber = 0;
+            retReader->fecPendingParity [i].parityIndex = 0;
+            retReader->fecPendingParity [i].size = 0;
+            retReader->fecPendingParity [i].data = &(retReader->fecParityBuffer [i * maxFragmentSize]);
+        }
+        retReader->ackPacket.frameNumber = UINT32_MAX;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(retReader->ackPacket));
+        retReader->ackPacketNbFragments = 0;
+        retReader->ackPacketUseExtendedFormat = 0;
+        retReader->receiverId = 0;
+        retReader->isEncrypted = 0;
+        retReader->cryptoNbSessions = 0;
+        retReader->threadsShouldStop = 0;
+        retReader->dataThreadStarted = 0;
+        retReader->ackThreadStarted = 0;
+        retReader->dataImpairment = NULL;
+        retReader->recorder = NULL;
+        ARSTREAM_ThreadConfig_Default (&(retReader->threadConfigs [ARSTREAM_THREAD_DATA]));
+        ARSTREAM_ThreadConfig_Default (&(retReader->threadConfigs [ARSTREAM_THREAD_ACK]));
+        retReader->wakeupCallback = NULL;
+        retReader->wakeupCustom = NULL;
+        retReader->efficiency_index = 0;
+        retReader->efficiency_pendingNbUseful = 0;
+        retReader->efficiency_pendingNbTotal = 0;
+        for (i = 0; i < ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES; i++)
+        {
+            retReader->efficiency_nbTotal [i] = 0;
+            retReader->efficiency_nbUseful [i] = 0;
+        }
+    }
+
+    if ((internalError != ARSTREAM_OK) &&
+        (retReader != NULL))
+    {
+        if (ackPacketMutexWasInit == 1)
+        {
+            ARSAL_Mutex_Destroy (&(retReader->ackPacketMutex));
+        }
+        if (ackSendMutexWasInit == 1)
+        {
+            ARSAL_Mutex_Destroy (&(retReader->ackSendMutex));
+        }
+        if (ackSendCondWasInit == 1)
+        {
+            ARSAL_Cond_Destroy (&(retReader->ackSendCond));
+        }
+        if (fecParityBufferWasCreated == 1)
+        {
+            free (retReader->fecParityBuffer);
+        }
+        if (framePoolWasCreated == 1)
+        {
+            free (retReader->framePool);
+        }
+        if (recvDataWasCreated == 1)
+        {
+            free (retReader->recvData);
+        }
+        free (retReader);
+        retReader = NULL;
+    }
+
+    SET_WITH_CHECK (error, internalError);
+    return retReader;
+}
+
+/*
+ * Implementation
+ */
+
+void ARSTREAM_Reader_InitStreamDataBuffer (ARNETWORK_IOBufferParam_t *bufferParams, int bufferID, int maxFragmentSize, uint32_t maxNumberOfFragment)
+{
+    ARSTREAM_Buffers_InitStreamDataBuffer (bufferParams, bufferID, maxFragmentSize, maxNumberOfFragment);
+}
+
+void ARSTREAM_Reader_InitStreamAckBuffer (ARNETWORK_IOBufferParam_t *bufferParams, int bufferID)
+{
+    ARSTREAM_Buffers_InitStreamAckBuffer (bufferParams, bufferID);
+}
+
+ARSTREAM_Reader_t* ARSTREAM_Reader_New (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameCompleteCallback_t callback, uint8_t *frameBuffer, uint32_t frameBufferSize, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error)
+{
+    /* ARGS Check */
+    if ((manager == NULL) ||
+        (callback == NULL) ||
+        (frameBuffer == NULL) ||
+        (frameBufferSize == 0) ||
+        (maxFragmentSize == 0) ||
+        (maxAckInterval < -1))
+    {
+        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
+        return NULL;
+    }
+    /* Frames are copied into the application buffers on completion, the pool only holds the frames in progress */
+    return ARSTREAM_Reader_NewInternal (manager, dataBufferID, ackBufferID, callback, NULL, frameBuffer, frameBufferSize, ARSTREAM_READER_NB_REASSEMBLY_SLOTS, maxFragmentSize, maxAckInterval, custom, error);
+}
+
+ARSTREAM_Reader_t* ARSTREAM_Reader_NewWithFramePool (ARNETWORK_Manager_t *manager, int dataBufferID, int ackBufferID, ARSTREAM_Reader_FrameReadyCallback_t callback, int maxHeldFrames, uint32_t maxFragmentSize, int32_t maxAckInterval, void *custom, eARSTREAM_ERROR *error)
+{
+    /* ARGS Check */
+    if ((manager == NULL) ||
+        (callback == NULL) ||
+        (maxHeldFrames < 0) ||
+        (maxFragmentSize == 0) ||
+        (maxAckInterval < -1))
+    {
+        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
+        return NULL;
+    }
+    return ARSTREAM_Reader_NewInternal (manager, dataBufferID, ackBufferID, NULL, callback, NULL, 0, ARSTREAM_READER_NB_REASSEMBLY_SLOTS + maxHeldFrames, maxFragmentSize, maxAckInterval, custom, error);
+}
+
+void ARSTREAM_Reader_StopReader (ARSTREAM_Reader_t *reader)
+{
+    if (reader != NULL)
+    {
+        reader->threadsShouldStop = 1;
+        /* Force unblock the ACK thread to allow it to shutdown quickly.
+         * This is necessary if maxAckInterval is set to -1, 0 or a large value. */
+        if (reader->ackThreadStarted == 1)
+        {
+            ARSAL_Mutex_Lock (&(reader->ackSendMutex));
+            ARSAL_Cond_Signal (&(reader->ackSendCond));
+            ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+        }
+        if (reader->wakeupCallback != NULL)
+        {
+            reader->wakeupCallback (reader->wakeupCustom);
+        }
+    }
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_Delete (ARSTREAM_Reader_t **reader)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    if ((reader != NULL) &&
+        (*reader != NULL))
     {
         int canDelete = 0;
+        int nbHeldFrames = 0;
+        int i;
+        for (i = 0; i < (*reader)->framePoolSize; i++)
+        {
+            if (__atomic_load_n (&((*reader)->framePool [i].refCount), __ATOMIC_ACQUIRE) != 0)
+            {
+                nbHeldFrames++;
+            }
+        }
         if (((*reader)->dataThreadStarted == 0) &&
-            ((*reader)->ackThreadStarted == 0))
+            ((*reader)->ackThreadStarted == 0) &&
+            (nbHeldFrames == 0))
         {
             canDelete = 1;
         }
 
         if (canDelete == 1)
         {
+            for (i = 0; i < (*reader)->framePoolSize; i++)
+            {
+                free ((*reader)->framePool [i].buffer);
+            }
+            free ((*reader)->framePool);
             ARSAL_Mutex_Destroy (&((*reader)->ackPacketMutex));
             ARSAL_Mutex_Destroy (&((*reader)->ackSendMutex));
             ARSAL_Cond_Destroy (&((*reader)->ackSendCond));
+            free ((*reader)->fecParityBuffer);
+            free ((*reader)->recvData);
+            ARSTREAM_Crypto_Wipe (&((*reader)->cryptoKey), sizeof ((*reader)->cryptoKey));
             free (*reader);
             *reader = NULL;
             retVal = ARSTREAM_OK;
         }
+        else if (nbHeldFrames != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "%d frames are still held, call ARSTREAM_Reader_FrameUnref on them before calling this function", nbHeldFrames);
+            retVal = ARSTREAM_ERROR_BUSY;
+        }
         else
         {
-            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Call ARSTREAM_Reader_StopReader before calling this function");
-            retVal = ARSTREAM_ERROR_BUSY;
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Call ARSTREAM_Reader_StopReader before calling this function");
+            retVal = ARSTREAM_ERROR_BUSY;
+        }
+    }
+    return retVal;
+}
+
+void ARSTREAM_Reader_StartDataLoop (ARSTREAM_Reader_t *reader)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Stream reader thread running");
+    reader->dataThreadStarted = 1;
+}
+
+static eARNETWORK_ERROR ARSTREAM_Reader_ReadFragment (ARSTREAM_Reader_t *reader, uint8_t *recvData, int recvDataLen, int *recvSize, int waitMs)
+{
+    if (reader->dataImpairment != NULL)
+    {
+        return ARSTREAM_Impairment_ReadData (reader->dataImpairment, reader->manager, reader->dataBufferID, recvData, recvDataLen, recvSize, waitMs);
+    }
+    if (waitMs > 0)
+    {
+        return ARNETWORK_Manager_ReadDataWithTimeout (reader->manager, reader->dataBufferID, recvData, recvDataLen, recvSize, waitMs);
+    }
+    return ARNETWORK_Manager_TryReadData (reader->manager, reader->dataBufferID, recvData, recvDataLen, recvSize);
+}
+
+int ARSTREAM_Reader_StepDataLoop (ARSTREAM_Reader_t *reader, int waitMs, int maxFragments)
+{
+    uint8_t *recvData = reader->recvData;
+    int recvDataLen = reader->maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE;
+    int recvSize;
+    int nbFragmentsInBatch = 0;
+    eARNETWORK_ERROR err;
+
+    if (reader->threadsShouldStop != 0)
+    {
+        return -1;
+    }
+
+    /* Wait for a first fragment, then drain the fragments already available */
+    err = ARSTREAM_Reader_ReadFragment (reader, recvData, recvDataLen, &recvSize, waitMs);
+    while ((ARNETWORK_OK == err) &&
+           (nbFragmentsInBatch < maxFragments))
+    {
+        ARSTREAM_Reader_ProcessFragment (reader, recvData, recvSize);
+        nbFragmentsInBatch++;
+        if (nbFragmentsInBatch < maxFragments)
+        {
+            err = ARSTREAM_Reader_ReadFragment (reader, recvData, recvDataLen, &recvSize, 0);
+        }
+    }
+    if ((ARNETWORK_OK != err) &&
+        (ARNETWORK_ERROR_BUFFER_EMPTY != err))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Error while reading stream data: %s", ARNETWORK_Error_ToString (err));
+    }
+
+    /* One ack packet update for the whole batch */
+    ARSTREAM_Reader_SendAckPacket (reader, 0);
+
+    if ((nbFragmentsInBatch > 0) &&
+        (reader->progressCallback != NULL))
+    {
+        ARSTREAM_Reader_ReportProgress (reader);
+    }
+
+    return nbFragmentsInBatch;
+}
+
+void ARSTREAM_Reader_EndDataLoop (ARSTREAM_Reader_t *reader)
+{
+    int i;
+
+    /* Give the frames in progress back to the frame pool */
+    for (i = 0; i < ARSTREAM_READER_NB_REASSEMBLY_SLOTS; i++)
+    {
+        if (reader->slots [i].isUsed == 1)
+        {
+            ARSTREAM_Reader_ReleaseSlot (reader, &(reader->slots [i]));
         }
     }
-    return retVal;
+
+    if (reader->callback != NULL)
+    {
+        reader->callback (ARSTREAM_READER_CAUSE_CANCEL, reader->currentFrameBuffer, reader->currentFrameSize, 0, 0, &(reader->currentFrameBufferSize), reader->custom);
+    }
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Stream reader thread ended");
+    reader->dataThreadStarted = 0;
 }
 
 void* ARSTREAM_Reader_RunDataThread (void *ARSTREAM_Reader_t_Param)
 {
-    uint8_t *recvData = NULL;
-    int recvSize;
-    uint16_t previousFNum = UINT16_MAX;
-    int skipCurrentFrame = 0;
-    int packetWasAlreadyAck = 0;
     ARSTREAM_Reader_t *reader = (ARSTREAM_Reader_t *)ARSTREAM_Reader_t_Param;
-    ARSTREAM_NetworkHeaders_DataHeader_t *header = NULL;
-    int recvDataLen = reader->maxFragmentSize + sizeof (ARSTREAM_NetworkHeaders_DataHeader_t);
 
     /* Parameters check */
     if (reader == NULL)
@@ -347,177 +1696,432 @@ void* ARSTREAM_Reader_RunDataThread (void *ARSTREAM_Reader_t_Param)
         return (void *)0;
     }
 
-    /* Alloc and check */
-    recvData = malloc (recvDataLen);
-    if (recvData == NULL)
+    ARSTREAM_Thread_ApplyConfig (&(reader->threadConfigs [ARSTREAM_THREAD_DATA]));
+    ARSTREAM_Reader_StartDataLoop (reader);
+    while (ARSTREAM_Reader_StepDataLoop (reader, ARSTREAM_READER_DATAREAD_TIMEOUT_MS, ARSTREAM_READER_MAX_FRAGMENTS_PER_BATCH) >= 0);
+    ARSTREAM_Reader_EndDataLoop (reader);
+
+    return (void *)0;
+}
+
+void ARSTREAM_Reader_StartAckLoop (ARSTREAM_Reader_t *reader)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack sender thread running");
+    ARSAL_Time_GetTime (&(reader->lastAckTime));
+    reader->hasSentAck = 0;
+    reader->ackThreadStarted = 1;
+}
+
+int ARSTREAM_Reader_StepAckLoop (ARSTREAM_Reader_t *reader)
+{
+    uint8_t sendPacket [ARSTREAM_NETWORK_HEADERS_ACK_PACKET_MAX_NETWORK_SIZE];
+    int sendSize = 0;
+    int doSend = 0;
+    int retVal = ARSTREAM_STREAM_TASKS_NO_TIMEOUT;
+    struct timespec now;
+    int32_t sinceLastAck;
+
+    if (reader->threadsShouldStop != 0)
     {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Error while starting %s, can not alloc memory", __FUNCTION__);
-        return (void *)0;
+        return -1;
     }
-    header = (ARSTREAM_NetworkHeaders_DataHeader_t *)recvData;
-
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Stream reader thread running");
-    reader->dataThreadStarted = 1;
 
-    while (reader->threadsShouldStop == 0)
+    ARSAL_Time_GetTime (&now);
+    sinceLastAck = ARSAL_Time_ComputeTimespecMsTimeDiff (&(reader->lastAckTime), &now);
+    ARSAL_Mutex_Lock (&(reader->ackSendMutex));
+    if (reader->ackSendRequest == ARSTREAM_READER_ACK_REQUEST_IMMEDIATE)
+    {
+        doSend = 1;
+    }
+    else if (reader->ackSendRequest == ARSTREAM_READER_ACK_REQUEST_COALESCED)
     {
-        eARNETWORK_ERROR err = ARNETWORK_Manager_ReadDataWithTimeout (reader->manager, reader->dataBufferID, recvData, recvDataLen, &recvSize, ARSTREAM_READER_DATAREAD_TIMEOUT_MS);
-        if (ARNETWORK_OK != err)
+        /* Coalesce the non urgent requests until minAckInterval elapsed since the previous ack */
+        if ((reader->hasSentAck == 0) ||
+            (sinceLastAck >= reader->minAckInterval))
         {
-            if (ARNETWORK_ERROR_BUFFER_EMPTY != err)
-            {
-                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_READER_TAG, "Error while reading stream data: %s", ARNETWORK_Error_ToString (err));
-            }
+            doSend = 1;
         }
         else
         {
-            int cpIndex, cpSize, endIndex;
-            ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
-            if (header->frameNumber != reader->ackPacket.frameNumber)
-            {
-                reader->efficiency_index ++;
-                reader->efficiency_index %= ARSTREAM_READER_EFFICIENCY_AVERAGE_NB_FRAMES;
-                reader->efficiency_nbTotal [reader->efficiency_index] = 0;
-                reader->efficiency_nbUseful [reader->efficiency_index] = 0;
-                skipCurrentFrame = 0;
-                reader->currentFrameSize = 0;
-                reader->ackPacket.frameNumber = header->frameNumber;
-#ifdef DEBUG
-                uint32_t nackPackets = ARSTREAM_NetworkHeaders_AckPacketCountNotSet (&(reader->ackPacket), header->fragmentsPerFrame);
-                if (nackPackets != 0)
-                {
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Dropping a frame (missing %d fragments)", nackPackets);
-                }
-#endif
-                ARSTREAM_NetworkHeaders_AckPacketResetUpTo (&(reader->ackPacket), header->fragmentsPerFrame);
-            }
-            packetWasAlreadyAck = ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(reader->ackPacket), header->fragmentNumber);
-            ARSTREAM_NetworkHeaders_AckPacketSetFlag (&(reader->ackPacket), header->fragmentNumber);
+            retVal = reader->minAckInterval - sinceLastAck;
+        }
+    }
+    else if (reader->maxAckInterval > 0)
+    {
+        /* Periodic ack if nothing was sent during maxAckInterval */
+        if (sinceLastAck >= reader->maxAckInterval)
+        {
+            doSend = 1;
+        }
+        else
+        {
+            retVal = reader->maxAckInterval - sinceLastAck;
+        }
+    }
+    // No else : only send on request
+    if (doSend == 1)
+    {
+        reader->ackSendRequest = ARSTREAM_READER_ACK_REQUEST_NONE;
+    }
+    reader->ackLoopSeenRequest = reader->ackSendRequest;
+    ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
 
-            reader->efficiency_nbTotal [reader->efficiency_index] ++;
-            if (packetWasAlreadyAck == 0)
-            {
-                reader->efficiency_nbUseful [reader->efficiency_index] ++;
-            }
+    /* Only send an ACK if the maxAckInterval value allows it. */
+    if ((doSend == 1) &&
+        (reader->maxAckInterval >= 0))
+    {
+        ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
+        sendSize = ARSTREAM_NetworkHeaders_AckPacketToNetwork (&(reader->ackPacket), reader->ackPacketNbFragments, reader->ackPacketUseExtendedFormat, reader->receiverId, sendPacket);
+        ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
+        if (ARNETWORK_Manager_SendData (reader->manager, reader->ackBufferID, sendPacket, sendSize, NULL, ARSTREAM_Reader_NetworkCallback, 1) == ARNETWORK_OK)
+        {
+            ARSTREAM_Stats_Add (&(reader->stats.nbAcksSent), 1);
+        }
+        ARSAL_Time_GetTime (&(reader->lastAckTime));
+        reader->hasSentAck = 1;
+        retVal = (reader->maxAckInterval > 0) ? reader->maxAckInterval : ARSTREAM_STREAM_TASKS_NO_TIMEOUT;
+    }
 
-            ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
+    return retVal;
+}
 
-            ARSAL_Mutex_Lock (&(reader->ackSendMutex));
-            ARSAL_Cond_Signal (&(reader->ackSendCond));
-            ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+void ARSTREAM_Reader_EndAckLoop (ARSTREAM_Reader_t *reader)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack sender thread ended");
+    reader->ackThreadStarted = 0;
+}
 
+void* ARSTREAM_Reader_RunAckThread (void *ARSTREAM_Reader_t_Param)
+{
+    ARSTREAM_Reader_t *reader = (ARSTREAM_Reader_t *)ARSTREAM_Reader_t_Param;
+    int waitMs;
 
-            cpIndex = reader->maxFragmentSize * header->fragmentNumber;
-            cpSize = recvSize - sizeof (ARSTREAM_NetworkHeaders_DataHeader_t);
-            endIndex = cpIndex + cpSize;
-            while ((endIndex > reader->currentFrameBufferSize) &&
-                   (skipCurrentFrame == 0) &&
-                   (packetWasAlreadyAck == 0))
+    ARSTREAM_Thread_ApplyConfig (&(reader->threadConfigs [ARSTREAM_THREAD_ACK]));
+    ARSTREAM_Reader_StartAckLoop (reader);
+    while ((waitMs = ARSTREAM_Reader_StepAckLoop (reader)) >= 0)
+    {
+        /* Sleep until the next step is due, or until a new request arrives */
+        ARSAL_Mutex_Lock (&(reader->ackSendMutex));
+        if ((reader->ackSendRequest == reader->ackLoopSeenRequest) &&
+            (reader->threadsShouldStop == 0))
+        {
+            if (waitMs == ARSTREAM_STREAM_TASKS_NO_TIMEOUT)
             {
-                uint32_t nextFrameBufferSize = reader->maxFragmentSize * header->fragmentsPerFrame;
-                uint32_t dummy;
-                uint8_t *nextFrameBuffer = reader->callback (ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL, reader->currentFrameBuffer, reader->currentFrameSize, 0, 0, &nextFrameBufferSize, reader->custom);
-                if (nextFrameBufferSize >= reader->currentFrameSize && nextFrameBufferSize > 0)
-                {
-                    memcpy (nextFrameBuffer, reader->currentFrameBuffer, reader->currentFrameSize);
-                }
-                else
-                {
-                    skipCurrentFrame = 1;
-                }
-                //TODO: Add "SKIP_FRAME"
-                reader->callback (ARSTREAM_READER_CAUSE_COPY_COMPLETE, reader->currentFrameBuffer, reader->currentFrameSize, 0, skipCurrentFrame, &dummy, reader->custom);
-                reader->currentFrameBuffer = nextFrameBuffer;
-                reader->currentFrameBufferSize = nextFrameBufferSize;
+                ARSAL_Cond_Wait (&(reader->ackSendCond), &(reader->ackSendMutex));
             }
-
-            if (skipCurrentFrame == 0)
+            else
             {
-                if (packetWasAlreadyAck == 0)
-                {
-                    memcpy (&(reader->currentFrameBuffer)[cpIndex], &recvData[sizeof (ARSTREAM_NetworkHeaders_DataHeader_t)], recvSize - sizeof (ARSTREAM_NetworkHeaders_DataHeader_t));
-                }
+                ARSAL_Cond_Timedwait (&(reader->ackSendCond), &(reader->ackSendMutex), waitMs);
+            }
+        }
+        ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+    }
+    ARSTREAM_Reader_EndAckLoop (reader);
 
-                if (endIndex > reader->currentFrameSize)
-                {
-                    reader->currentFrameSize = endIndex;
-                }
+    return (void *)0;
+}
 
-                ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
-                if (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&(reader->ackPacket), header->fragmentsPerFrame))
-                {
-                    if (header->frameNumber != previousFNum)
-                    {
-                        int nbMissedFrame = 0;
-                        int isFlushFrame = ((header->frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME) != 0) ? 1 : 0;
-                        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack all in frame %d (isFlush : %d)", header->frameNumber, isFlushFrame);
-                        if (header->frameNumber != previousFNum + 1)
-                        {
-                            nbMissedFrame = header->frameNumber - previousFNum - 1;
-                            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Missed %d frames !", nbMissedFrame);
-                        }
-                        previousFNum = header->frameNumber;
-                        skipCurrentFrame = 1;
-                        reader->currentFrameBuffer = reader->callback (ARSTREAM_READER_CAUSE_FRAME_COMPLETE, reader->currentFrameBuffer, reader->currentFrameSize, nbMissedFrame, isFlushFrame, &(reader->currentFrameBufferSize), reader->custom);
-                    }
-                }
-                ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
-            }
+int ARSTREAM_Reader_ProcessIncoming (ARSTREAM_Reader_t *reader)
+{
+    int retVal = -1;
+    if (reader != NULL)
+    {
+        int nbFragments;
+        int nbRead = 0;
+        ARSTREAM_Reader_StartEventLoops (reader);
+        do
+        {
+            nbFragments = ARSTREAM_Reader_StepDataLoop (reader, 0, ARSTREAM_READER_MAX_FRAGMENTS_PER_BATCH);
+            nbRead += (nbFragments > 0) ? nbFragments : 0;
+        } while (nbFragments == ARSTREAM_READER_MAX_FRAGMENTS_PER_BATCH);
+        if ((nbFragments < 0) ||
+            (ARSTREAM_Reader_OnTimer (reader) < 0))
+        {
+            ARSTREAM_Reader_EndEventLoops (reader);
+            retVal = -1;
+        }
+        else if (nbRead > 0)
+        {
+            reader->dataPollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+            retVal = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        }
+        else
+        {
+            // Back off exponentially while no fragment is received
+            retVal = reader->dataPollDelayMs;
+            reader->dataPollDelayMs = ARSTREAM_StreamTasks_NextPollDelay (reader->dataPollDelayMs, ARSTREAM_STREAM_TASKS_READER_DATA_POLL_MAX_MS);
         }
     }
+    return retVal;
+}
 
-    free (recvData);
+int ARSTREAM_Reader_OnTimer (ARSTREAM_Reader_t *reader)
+{
+    int retVal = -1;
+    if (reader != NULL)
+    {
+        ARSTREAM_Reader_StartEventLoops (reader);
+        retVal = ARSTREAM_Reader_StepAckLoop (reader);
+        if (retVal < 0)
+        {
+            ARSTREAM_Reader_EndEventLoops (reader);
+        }
+        else
+        {
+            reader->ackLoopNextStepMs = retVal;
+            ARSAL_Time_GetTime (&(reader->ackLoopLastStepTime));
+            retVal = 0;
+        }
+    }
+    return retVal;
+}
 
-    reader->callback (ARSTREAM_READER_CAUSE_CANCEL, reader->currentFrameBuffer, reader->currentFrameSize, 0, 0, &(reader->currentFrameBufferSize), reader->custom);
+int ARSTREAM_Reader_GetNextTimeout (ARSTREAM_Reader_t *reader)
+{
+    int retVal = 0;
+    // Due now if the ack loop never ran, if a new ack was requested, or if the reader is stopping
+    if ((reader != NULL) &&
+        (reader->threadsShouldStop == 0) &&
+        (reader->ackThreadStarted == 1))
+    {
+        int hasNewRequest;
+        ARSAL_Mutex_Lock (&(reader->ackSendMutex));
+        hasNewRequest = (reader->ackSendRequest != reader->ackLoopSeenRequest) ? 1 : 0;
+        ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+        if (hasNewRequest == 1)
+        {
+            retVal = 0;
+        }
+        else if (reader->ackLoopNextStepMs == ARSTREAM_STREAM_TASKS_NO_TIMEOUT)
+        {
+            retVal = -1;
+        }
+        else
+        {
+            struct timespec now;
+            ARSAL_Time_GetTime (&now);
+            retVal = reader->ackLoopNextStepMs - ARSAL_Time_ComputeTimespecMsTimeDiff (&(reader->ackLoopLastStepTime), &now);
+            retVal = (retVal < 0) ? 0 : retVal;
+        }
+    }
+    return retVal;
+}
 
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Stream reader thread ended");
-    reader->dataThreadStarted = 0;
-    return (void *)0;
+void ARSTREAM_Reader_SetWakeupCallback (ARSTREAM_Reader_t *reader, ARSTREAM_StreamTasks_WakeupCallback_t callback, void *custom)
+{
+    reader->wakeupCustom = custom;
+    reader->wakeupCallback = callback;
 }
 
-void* ARSTREAM_Reader_RunAckThread (void *ARSTREAM_Reader_t_Param)
+eARSTREAM_ERROR ARSTREAM_Reader_SetMinAckInterval (ARSTREAM_Reader_t *reader, int32_t minAckInterval)
 {
-    ARSTREAM_NetworkHeaders_AckPacket_t sendPacket = {0};
-    ARSTREAM_Reader_t *reader = (ARSTREAM_Reader_t *)ARSTREAM_Reader_t_Param;
-    memset(&sendPacket, 0, sizeof(sendPacket));
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if ((reader == NULL) ||
+        (minAckInterval < 0))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
 
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack sender thread running");
-    reader->ackThreadStarted = 1;
+    if (err == ARSTREAM_OK)
+    {
+        reader->minAckInterval = minAckInterval;
+    }
+    return err;
+}
 
-    while (reader->threadsShouldStop == 0)
+eARSTREAM_ERROR ARSTREAM_Reader_SetPartialFrameDelivery (ARSTREAM_Reader_t *reader, int enable)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL)
     {
-        int isPeriodicAck = 0;
-        ARSAL_Mutex_Lock (&(reader->ackSendMutex));
-        if (reader->maxAckInterval <= 0)
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        reader->partialFrameDelivery = (enable != 0) ? 1 : 0;
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetReceiverId (ARSTREAM_Reader_t *reader, uint8_t receiverId)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (reader->ackThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        reader->receiverId = receiverId;
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetEncryptionKey (ARSTREAM_Reader_t *reader, const uint8_t *key, int keySize)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL ||
+        (key != NULL && keySize != ARSTREAM_READER_ENCRYPTION_KEY_SIZE))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (reader->dataThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSTREAM_Crypto_Wipe (&(reader->cryptoKey), sizeof (reader->cryptoKey));
+        reader->isEncrypted = 0;
+        reader->cryptoNbSessions = 0;
+        if (key != NULL)
+        {
+            ARSTREAM_Crypto_SetKey (&(reader->cryptoKey), key);
+            reader->isEncrypted = 1;
+        }
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetDataImpairment (ARSTREAM_Reader_t *reader, ARSTREAM_Impairment_t *impairment)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (reader->dataThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        reader->dataImpairment = impairment;
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetRecorder (ARSTREAM_Reader_t *reader, ARSTREAM_Recorder_t *recorder)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (reader->dataThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        reader->recorder = recorder;
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetThreadConfig (ARSTREAM_Reader_t *reader, eARSTREAM_THREAD thread, const ARSTREAM_ThreadConfig_t *config)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if ((reader == NULL) ||
+        (thread < 0) ||
+        (thread >= ARSTREAM_THREAD_MAX))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (((thread == ARSTREAM_THREAD_DATA) && (reader->dataThreadStarted == 1)) ||
+             ((thread == ARSTREAM_THREAD_ACK) && (reader->ackThreadStarted == 1)))
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        if (config != NULL)
         {
-            ARSAL_Cond_Wait (&(reader->ackSendCond), &(reader->ackSendMutex));
+            reader->threadConfigs [thread] = *config;
         }
         else
         {
-            int retval = ARSAL_Cond_Timedwait (&(reader->ackSendCond), &(reader->ackSendMutex), reader->maxAckInterval);
-            if (retval == -1 && errno == ETIMEDOUT)
-            {
-                isPeriodicAck = 1;
-            }
+            ARSTREAM_ThreadConfig_Default (&(reader->threadConfigs [thread]));
         }
-        ARSAL_Mutex_Unlock (&(reader->ackSendMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Reader_SetFrameProgressCallback (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_FrameProgressCallback_t callback)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (reader == NULL)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        reader->progressCallback = callback;
+    }
+    return err;
+}
+
+int ARSTREAM_Reader_FrameIsPartial (ARSTREAM_Reader_Frame_t *frame)
+{
+    int retVal = 0;
+    if (frame != NULL)
+    {
+        retVal = frame->isPartial;
+    }
+    return retVal;
+}
+
+uint32_t ARSTREAM_Reader_FrameGetNumber (ARSTREAM_Reader_Frame_t *frame)
+{
+    uint32_t retVal = 0;
+    if (frame != NULL)
+    {
+        retVal = frame->frameNumber;
+    }
+    return retVal;
+}
 
-        /* Only send an ACK if the maxAckInterval value allows it. */
-        if ((reader->maxAckInterval > 0) ||
-            ((reader->maxAckInterval == 0) && (isPeriodicAck == 0)))
+int ARSTREAM_Reader_FrameGetCaptureTimestamp (ARSTREAM_Reader_Frame_t *frame, uint32_t *captureTimestamp)
+{
+    int retVal = 0;
+    if ((frame != NULL) &&
+        (frame->hasCaptureTimestamp == 1))
+    {
+        retVal = 1;
+        if (captureTimestamp != NULL)
         {
-            ARSAL_Mutex_Lock (&(reader->ackPacketMutex));
-            sendPacket.frameNumber = htods  (reader->ackPacket.frameNumber);
-            sendPacket.highPacketsAck = htodll (reader->ackPacket.highPacketsAck);
-            sendPacket.lowPacketsAck  = htodll (reader->ackPacket.lowPacketsAck);
-            ARSAL_Mutex_Unlock (&(reader->ackPacketMutex));
-            ARNETWORK_Manager_SendData (reader->manager, reader->ackBufferID, (uint8_t *)&sendPacket, sizeof (sendPacket), NULL, ARSTREAM_Reader_NetworkCallback, 1);
+            *captureTimestamp = frame->captureTimestamp;
         }
     }
+    return retVal;
+}
 
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_READER_TAG, "Ack sender thread ended");
-    reader->ackThreadStarted = 0;
-    return (void *)0;
+void ARSTREAM_Reader_FrameRef (ARSTREAM_Reader_Frame_t *frame)
+{
+    if (frame != NULL)
+    {
+        __sync_fetch_and_add (&(frame->refCount), 1);
+    }
+}
+
+void ARSTREAM_Reader_FrameUnref (ARSTREAM_Reader_Frame_t *frame)
+{
+    if (frame != NULL)
+    {
+        /* The frame goes back to the pool when the count reaches zero */
+        __sync_fetch_and_sub (&(frame->refCount), 1);
+    }
 }
 
 float ARSTREAM_Reader_GetEstimatedEfficiency (ARSTREAM_Reader_t *reader)
@@ -553,6 +2157,37 @@ float ARSTREAM_Reader_GetEstimatedEfficiency (ARSTREAM_Reader_t *reader)
     return retVal;
 }
 
+eARSTREAM_ERROR ARSTREAM_Reader_GetStats (ARSTREAM_Reader_t *reader, ARSTREAM_Reader_Stats_t *stats)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_OK;
+    if ((reader == NULL) ||
+        (stats == NULL))
+    {
+        retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else
+    {
+        ARSTREAM_Stats_Snapshot (stats, &(reader->stats), sizeof (ARSTREAM_Reader_Stats_t));
+    }
+    return retVal;
+}
+
+int ARSTREAM_Reader_GetCurrentFrameCaptureTimestamp (ARSTREAM_Reader_t *reader, uint32_t *captureTimestamp)
+{
+    int retVal = 0;
+    if ((reader != NULL) &&
+        (reader->currentFrameSize > 0) &&
+        (reader->currentFrameHasCaptureTimestamp == 1))
+    {
+        retVal = 1;
+        if (captureTimestamp != NULL)
+        {
+            *captureTimestamp = reader->currentFrameCaptureTimestamp;
+        }
+    }
+    return retVal;
+}
+
 void* ARSTREAM_Reader_GetCustom (ARSTREAM_Reader_t *reader)
 {
     void *ret = NULL;
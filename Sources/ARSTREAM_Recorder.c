@@ -0,0 +1,675 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Recorder.c
+ * @brief Asynchronous recording of a stream to a file, with a frame index
+ * @date 10/15/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARStream/ARSTREAM_Recorder.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM_RECORDER_TAG "ARSTREAM_Recorder"
+
+/**
+ * Size of an index file header, and of an index file entry
+ */
+#define ARSTREAM_RECORDER_INDEX_HEADER_SIZE (8)
+#define ARSTREAM_RECORDER_INDEX_ENTRY_SIZE (24)
+
+/**
+ * Initial number of entries of the in-memory index
+ */
+#define ARSTREAM_RECORDER_INDEX_INITIAL_CAPACITY (1024)
+
+/**
+ * Sets *PTR to VAL if PTR is not null
+ */
+#define SET_WITH_CHECK(PTR,VAL)                 \
+    do                                          \
+    {                                           \
+        if (PTR != NULL)                        \
+        {                                       \
+            *PTR = VAL;                         \
+        }                                       \
+    } while (0)
+
+/*
+ * Types
+ */
+
+struct ARSTREAM_Recorder_t {
+    /* Configuration on New */
+    ARSTREAM_Recorder_Params_t params;
+    int dataFd;
+    int indexFd;
+    int isDirectIO;                  // Boolean-like (0/1) flag, active if dataFd was opened with O_DIRECT
+
+    /* Buffers, used in a circular way. The buffer being filled follows the full ones */
+    uint8_t *buffers;                // nbBuffers * bufferSize bytes, ARSTREAM_RECORDER_BUFFER_ALIGNMENT aligned
+    uint32_t fillSize;               // AddFrame only (and I/O thread once stopped), bytes in the buffer being filled
+    uint64_t nextOffset;             // AddFrame only, offset of the next frame in the recording
+
+    /* Shared state (protected by mutex) */
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;               // Signaled when a buffer is full, and on stop
+    int firstFullBuffer;
+    int nbFullBuffers;
+    ARSTREAM_Recorder_IndexEntry_t *index;
+    int nbIndexEntries;
+    int indexCapacity;
+    ARSTREAM_Recorder_Counters_t counters;
+    int shouldStop;
+    int threadStarted;
+
+    /* I/O thread only */
+    int nbIndexEntriesWritten;
+    uint8_t *indexWriteBuffer;
+    int indexWriteBufferCapacity;    // In entries
+};
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Writes a buffer to a file, retrying on partial writes
+ * @return 0 on success, -1 on error
+ */
+static int ARSTREAM_Recorder_Write (int fd, const uint8_t *data, uint32_t size, uint64_t offset);
+
+/**
+ * @brief Stores a 32/64 bits value as little endian
+ */
+static void ARSTREAM_Recorder_StoreU32 (uint8_t *ptr, uint32_t value);
+static void ARSTREAM_Recorder_StoreU64 (uint8_t *ptr, uint64_t value);
+
+/**
+ * @brief Appends the entries of the frames already written to the index file
+ * @param recorder The recorder
+ * @param bytesWritten Size of the recording already written
+ * @note Called from the I/O thread, without the mutex
+ */
+static void ARSTREAM_Recorder_FlushIndex (ARSTREAM_Recorder_t *recorder, uint64_t bytesWritten);
+
+/*
+ * Internal functions implementation
+ */
+
+static int ARSTREAM_Recorder_Write (int fd, const uint8_t *data, uint32_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t res = pwrite (fd, data, size, (off_t)offset);
+        if (res < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_RECORDER_TAG, "Write error : %s", strerror (errno));
+            return -1;
+        }
+        data += res;
+        size -= res;
+        offset += res;
+    }
+    return 0;
+}
+
+static void ARSTREAM_Recorder_StoreU32 (uint8_t *ptr, uint32_t value)
+{
+    ptr [0] = value & 0xFF;
+    ptr [1] = (value >> 8) & 0xFF;
+    ptr [2] = (value >> 16) & 0xFF;
+    ptr [3] = (value >> 24) & 0xFF;
+}
+
+static void ARSTREAM_Recorder_StoreU64 (uint8_t *ptr, uint64_t value)
+{
+    ARSTREAM_Recorder_StoreU32 (ptr, (uint32_t)value);
+    ARSTREAM_Recorder_StoreU32 (&ptr [4], (uint32_t)(value >> 32));
+}
+
+static void ARSTREAM_Recorder_FlushIndex (ARSTREAM_Recorder_t *recorder, uint64_t bytesWritten)
+{
+    int first = recorder->nbIndexEntriesWritten;
+    int nbEntries = 0;
+    int i;
+
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    /* Entries are in offset order : stop at the first frame not fully written */
+    while ((first + nbEntries < recorder->nbIndexEntries) &&
+           (recorder->index [first + nbEntries].offset + recorder->index [first + nbEntries].size <= bytesWritten))
+    {
+        nbEntries++;
+    }
+    if (nbEntries > recorder->indexWriteBufferCapacity)
+    {
+        uint8_t *newBuffer = realloc (recorder->indexWriteBuffer, (size_t)nbEntries * ARSTREAM_RECORDER_INDEX_ENTRY_SIZE);
+        if (newBuffer != NULL)
+        {
+            recorder->indexWriteBuffer = newBuffer;
+            recorder->indexWriteBufferCapacity = nbEntries;
+        }
+        else
+        {
+            /* Retry the remaining entries on the next flush */
+            nbEntries = recorder->indexWriteBufferCapacity;
+        }
+    }
+    for (i = 0; i < nbEntries; i++)
+    {
+        ARSTREAM_Recorder_IndexEntry_t *entry = &(recorder->index [first + i]);
+        uint8_t *dst = &(recorder->indexWriteBuffer [i * ARSTREAM_RECORDER_INDEX_ENTRY_SIZE]);
+        ARSTREAM_Recorder_StoreU64 (dst, entry->offset);
+        ARSTREAM_Recorder_StoreU32 (&dst [8], entry->size);
+        ARSTREAM_Recorder_StoreU32 (&dst [12], entry->frameNumber);
+        ARSTREAM_Recorder_StoreU32 (&dst [16], entry->flags);
+        ARSTREAM_Recorder_StoreU32 (&dst [20], 0);
+    }
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+
+    if (nbEntries > 0)
+    {
+        uint64_t fileOffset = ARSTREAM_RECORDER_INDEX_HEADER_SIZE + (uint64_t)first * ARSTREAM_RECORDER_INDEX_ENTRY_SIZE;
+        if (ARSTREAM_Recorder_Write (recorder->indexFd, recorder->indexWriteBuffer, nbEntries * ARSTREAM_RECORDER_INDEX_ENTRY_SIZE, fileOffset) == 0)
+        {
+            recorder->nbIndexEntriesWritten += nbEntries;
+        }
+        else
+        {
+            ARSAL_Mutex_Lock (&(recorder->mutex));
+            recorder->counters.nbWriteErrors++;
+            ARSAL_Mutex_Unlock (&(recorder->mutex));
+        }
+    }
+}
+
+/*
+ * Implementation
+ */
+
+void ARSTREAM_Recorder_DefaultParams (ARSTREAM_Recorder_Params_t *params)
+{
+    if (params != NULL)
+    {
+        params->bufferSize = ARSTREAM_RECORDER_DEFAULT_BUFFER_SIZE;
+        params->nbBuffers = ARSTREAM_RECORDER_DEFAULT_NB_BUFFERS;
+        params->indexFlushIntervalMs = ARSTREAM_RECORDER_DEFAULT_INDEX_FLUSH_INTERVAL_MS;
+        params->useDirectIO = 1;
+    }
+}
+
+ARSTREAM_Recorder_t* ARSTREAM_Recorder_New (const char *path, const ARSTREAM_Recorder_Params_t *params, eARSTREAM_ERROR *error)
+{
+    ARSTREAM_Recorder_t *retRecorder = NULL;
+    eARSTREAM_ERROR internalError = ARSTREAM_OK;
+    int mutexWasInit = 0;
+    int condWasInit = 0;
+
+    /* ARGS Check */
+    if ((path == NULL) ||
+        (params == NULL) ||
+        (params->bufferSize == 0) ||
+        ((params->bufferSize % ARSTREAM_RECORDER_BUFFER_ALIGNMENT) != 0) ||
+        (params->nbBuffers < 2) ||
+        (params->indexFlushIntervalMs <= 0))
+    {
+        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
+        return retRecorder;
+    }
+
+    /* Alloc new recorder */
+    retRecorder = calloc (1, sizeof (ARSTREAM_Recorder_t));
+    if (retRecorder == NULL)
+    {
+        internalError = ARSTREAM_ERROR_ALLOC;
+    }
+
+    if (internalError == ARSTREAM_OK)
+    {
+        retRecorder->params = *params;
+        retRecorder->dataFd = -1;
+        retRecorder->indexFd = -1;
+        if (posix_memalign ((void **)&(retRecorder->buffers), ARSTREAM_RECORDER_BUFFER_ALIGNMENT, (size_t)params->nbBuffers * params->bufferSize) != 0)
+        {
+            retRecorder->buffers = NULL;
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        retRecorder->index = malloc (ARSTREAM_RECORDER_INDEX_INITIAL_CAPACITY * sizeof (ARSTREAM_Recorder_IndexEntry_t));
+        if (retRecorder->index == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        retRecorder->indexCapacity = ARSTREAM_RECORDER_INDEX_INITIAL_CAPACITY;
+    }
+
+    /* Setup internal mutexes/conditions */
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retRecorder->mutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            mutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int condInitRet = ARSAL_Cond_Init (&(retRecorder->cond));
+        if (condInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            condWasInit = 1;
+        }
+    }
+
+    /* Open the files */
+    if (internalError == ARSTREAM_OK)
+    {
+#ifdef O_DIRECT
+        if (params->useDirectIO == 1)
+        {
+            retRecorder->dataFd = open (path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+            if (retRecorder->dataFd >= 0)
+            {
+                retRecorder->isDirectIO = 1;
+            }
+            else
+            {
+                ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSTREAM_RECORDER_TAG, "Direct I/O not available for %s (%s), using the page cache", path, strerror (errno));
+            }
+        }
+#endif
+        if (retRecorder->dataFd < 0)
+        {
+            retRecorder->dataFd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        if (retRecorder->dataFd < 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_RECORDER_TAG, "Unable to open %s : %s", path, strerror (errno));
+            internalError = ARSTREAM_ERROR_BAD_PARAMETERS;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        uint8_t header [ARSTREAM_RECORDER_INDEX_HEADER_SIZE];
+        size_t pathLen = strlen (path);
+        char *indexPath = malloc (pathLen + sizeof (ARSTREAM_RECORDER_INDEX_SUFFIX));
+        if (indexPath == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            memcpy (indexPath, path, pathLen);
+            memcpy (&indexPath [pathLen], ARSTREAM_RECORDER_INDEX_SUFFIX, sizeof (ARSTREAM_RECORDER_INDEX_SUFFIX));
+            retRecorder->indexFd = open (indexPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (retRecorder->indexFd < 0)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_RECORDER_TAG, "Unable to open %s : %s", indexPath, strerror (errno));
+                internalError = ARSTREAM_ERROR_BAD_PARAMETERS;
+            }
+            free (indexPath);
+        }
+        if (internalError == ARSTREAM_OK)
+        {
+            ARSTREAM_Recorder_StoreU32 (header, ARSTREAM_RECORDER_INDEX_MAGIC);
+            ARSTREAM_Recorder_StoreU32 (&header [4], ARSTREAM_RECORDER_INDEX_VERSION);
+            if (ARSTREAM_Recorder_Write (retRecorder->indexFd, header, sizeof (header), 0) != 0)
+            {
+                internalError = ARSTREAM_ERROR_BAD_PARAMETERS;
+            }
+        }
+    }
+
+    if ((internalError != ARSTREAM_OK) &&
+        (retRecorder != NULL))
+    {
+        if (mutexWasInit == 1)
+        {
+            ARSAL_Mutex_Destroy (&(retRecorder->mutex));
+        }
+        if (condWasInit == 1)
+        {
+            ARSAL_Cond_Destroy (&(retRecorder->cond));
+        }
+        if (retRecorder->dataFd >= 0)
+        {
+            close (retRecorder->dataFd);
+        }
+        if (retRecorder->indexFd >= 0)
+        {
+            close (retRecorder->indexFd);
+        }
+        free (retRecorder->buffers);
+        free (retRecorder->index);
+        free (retRecorder);
+        retRecorder = NULL;
+    }
+
+    SET_WITH_CHECK (error, internalError);
+    return retRecorder;
+}
+
+void ARSTREAM_Recorder_Stop (ARSTREAM_Recorder_t *recorder)
+{
+    if (recorder != NULL)
+    {
+        ARSAL_Mutex_Lock (&(recorder->mutex));
+        recorder->shouldStop = 1;
+        ARSAL_Cond_Signal (&(recorder->cond));
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+    }
+}
+
+eARSTREAM_ERROR ARSTREAM_Recorder_Delete (ARSTREAM_Recorder_t **recorder)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    if ((recorder != NULL) &&
+        (*recorder != NULL))
+    {
+        int canDelete;
+        ARSAL_Mutex_Lock (&((*recorder)->mutex));
+        canDelete = ((*recorder)->threadStarted == 0) ? 1 : 0;
+        ARSAL_Mutex_Unlock (&((*recorder)->mutex));
+
+        if (canDelete == 1)
+        {
+            ARSAL_Mutex_Destroy (&((*recorder)->mutex));
+            ARSAL_Cond_Destroy (&((*recorder)->cond));
+            close ((*recorder)->dataFd);
+            close ((*recorder)->indexFd);
+            free ((*recorder)->buffers);
+            free ((*recorder)->index);
+            free ((*recorder)->indexWriteBuffer);
+            free (*recorder);
+            *recorder = NULL;
+            retVal = ARSTREAM_OK;
+        }
+        else
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_RECORDER_TAG, "Call ARSTREAM_Recorder_Stop before calling this function");
+            retVal = ARSTREAM_ERROR_BUSY;
+        }
+    }
+    return retVal;
+}
+
+void* ARSTREAM_Recorder_RunThread (void *ARSTREAM_Recorder_t_Param)
+{
+    ARSTREAM_Recorder_t *recorder = (ARSTREAM_Recorder_t *)ARSTREAM_Recorder_t_Param;
+    uint32_t bufferSize;
+    uint64_t bytesWritten = 0;
+    struct timespec lastIndexFlush, now;
+
+    /* Parameters check */
+    if (recorder == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_RECORDER_TAG, "Error while starting %s, bad parameters", __FUNCTION__);
+        return (void *)0;
+    }
+    bufferSize = recorder->params.bufferSize;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_RECORDER_TAG, "Recorder thread running");
+    ARSAL_Time_GetTime (&lastIndexFlush);
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    recorder->threadStarted = 1;
+    while (1)
+    {
+        int elapsedMs;
+        if (recorder->nbFullBuffers > 0)
+        {
+            /* The buffer is not touched by AddFrame until it is given back */
+            uint8_t *buffer = &(recorder->buffers [(size_t)recorder->firstFullBuffer * bufferSize]);
+            int writeRes;
+            ARSAL_Mutex_Unlock (&(recorder->mutex));
+            writeRes = ARSTREAM_Recorder_Write (recorder->dataFd, buffer, bufferSize, bytesWritten);
+            ARSAL_Mutex_Lock (&(recorder->mutex));
+            /* Keep the offsets of the next frames even if the write failed */
+            bytesWritten += bufferSize;
+            recorder->firstFullBuffer = (recorder->firstFullBuffer + 1) % recorder->params.nbBuffers;
+            recorder->nbFullBuffers--;
+            if (writeRes == 0)
+            {
+                recorder->counters.nbBytesWritten += bufferSize;
+            }
+            else
+            {
+                recorder->counters.nbWriteErrors++;
+            }
+            continue;
+        }
+        if (recorder->shouldStop == 1)
+        {
+            break;
+        }
+        ARSAL_Time_GetTime (&now);
+        elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff (&lastIndexFlush, &now);
+        if (elapsedMs >= recorder->params.indexFlushIntervalMs)
+        {
+            ARSAL_Mutex_Unlock (&(recorder->mutex));
+            ARSTREAM_Recorder_FlushIndex (recorder, bytesWritten);
+            lastIndexFlush = now;
+            ARSAL_Mutex_Lock (&(recorder->mutex));
+            continue;
+        }
+        ARSAL_Cond_Timedwait (&(recorder->cond), &(recorder->mutex), recorder->params.indexFlushIntervalMs - elapsedMs);
+    }
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+
+    /* Write the last, partially filled, buffer. Its size is not aligned, so go through the page cache */
+    if (recorder->fillSize > 0)
+    {
+        uint8_t *buffer = &(recorder->buffers [(size_t)recorder->firstFullBuffer * bufferSize]);
+#ifdef O_DIRECT
+        if (recorder->isDirectIO == 1)
+        {
+            int flags = fcntl (recorder->dataFd, F_GETFL);
+            fcntl (recorder->dataFd, F_SETFL, flags & ~O_DIRECT);
+            recorder->isDirectIO = 0;
+        }
+#endif
+        ARSAL_Mutex_Lock (&(recorder->mutex));
+        if (ARSTREAM_Recorder_Write (recorder->dataFd, buffer, recorder->fillSize, bytesWritten) == 0)
+        {
+            recorder->counters.nbBytesWritten += recorder->fillSize;
+        }
+        else
+        {
+            recorder->counters.nbWriteErrors++;
+        }
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+        bytesWritten += recorder->fillSize;
+        recorder->fillSize = 0;
+    }
+    ARSTREAM_Recorder_FlushIndex (recorder, bytesWritten);
+
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    recorder->threadStarted = 0;
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_RECORDER_TAG, "Recorder thread ended");
+    return (void *)0;
+}
+
+eARSTREAM_ERROR ARSTREAM_Recorder_AddFrame (ARSTREAM_Recorder_t *recorder, const uint8_t *data, uint32_t size, uint32_t frameNumber, uint32_t flags)
+{
+    uint32_t bufferSize;
+    uint64_t freeSize;
+    int fillBuffer;
+    uint32_t copied = 0;
+    ARSTREAM_Recorder_IndexEntry_t *entry;
+
+    if ((recorder == NULL) ||
+        (data == NULL))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    bufferSize = recorder->params.bufferSize;
+
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    if (recorder->shouldStop == 1)
+    {
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    /* The I/O thread only frees buffers : the free size can only grow until the copy is done */
+    fillBuffer = (recorder->firstFullBuffer + recorder->nbFullBuffers) % recorder->params.nbBuffers;
+    freeSize = (bufferSize - recorder->fillSize) + (uint64_t)(recorder->params.nbBuffers - recorder->nbFullBuffers - 1) * bufferSize;
+    if (size > freeSize)
+    {
+        recorder->counters.nbFramesDropped++;
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+        return ARSTREAM_ERROR_QUEUE_FULL;
+    }
+    if (recorder->nbIndexEntries == recorder->indexCapacity)
+    {
+        ARSTREAM_Recorder_IndexEntry_t *newIndex = realloc (recorder->index, 2 * (size_t)recorder->indexCapacity * sizeof (ARSTREAM_Recorder_IndexEntry_t));
+        if (newIndex == NULL)
+        {
+            recorder->counters.nbFramesDropped++;
+            ARSAL_Mutex_Unlock (&(recorder->mutex));
+            return ARSTREAM_ERROR_ALLOC;
+        }
+        recorder->index = newIndex;
+        recorder->indexCapacity *= 2;
+    }
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+
+    /* Copy the frame, handing each filled buffer to the I/O thread */
+    while (copied < size)
+    {
+        uint32_t chunk = bufferSize - recorder->fillSize;
+        if (chunk > size - copied)
+        {
+            chunk = size - copied;
+        }
+        memcpy (&(recorder->buffers [(size_t)fillBuffer * bufferSize + recorder->fillSize]), &data [copied], chunk);
+        recorder->fillSize += chunk;
+        copied += chunk;
+        if (recorder->fillSize == bufferSize)
+        {
+            ARSAL_Mutex_Lock (&(recorder->mutex));
+            recorder->nbFullBuffers++;
+            ARSAL_Cond_Signal (&(recorder->cond));
+            ARSAL_Mutex_Unlock (&(recorder->mutex));
+            fillBuffer = (fillBuffer + 1) % recorder->params.nbBuffers;
+            recorder->fillSize = 0;
+        }
+    }
+
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    entry = &(recorder->index [recorder->nbIndexEntries]);
+    entry->offset = recorder->nextOffset;
+    entry->size = size;
+    entry->frameNumber = frameNumber;
+    entry->flags = flags;
+    recorder->nbIndexEntries++;
+    recorder->counters.nbFramesRecorded++;
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+    recorder->nextOffset += size;
+    return ARSTREAM_OK;
+}
+
+int ARSTREAM_Recorder_GetNbIndexEntries (ARSTREAM_Recorder_t *recorder)
+{
+    int retVal = -1;
+    if (recorder != NULL)
+    {
+        ARSAL_Mutex_Lock (&(recorder->mutex));
+        retVal = recorder->nbIndexEntries;
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+    }
+    return retVal;
+}
+
+eARSTREAM_ERROR ARSTREAM_Recorder_GetIndexEntry (ARSTREAM_Recorder_t *recorder, int index, ARSTREAM_Recorder_IndexEntry_t *entry)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    if ((recorder != NULL) &&
+        (entry != NULL))
+    {
+        ARSAL_Mutex_Lock (&(recorder->mutex));
+        if ((index >= 0) &&
+            (index < recorder->nbIndexEntries))
+        {
+            *entry = recorder->index [index];
+            retVal = ARSTREAM_OK;
+        }
+        ARSAL_Mutex_Unlock (&(recorder->mutex));
+    }
+    return retVal;
+}
+
+eARSTREAM_ERROR ARSTREAM_Recorder_GetCounters (ARSTREAM_Recorder_t *recorder, ARSTREAM_Recorder_Counters_t *counters)
+{
+    if ((recorder == NULL) ||
+        (counters == NULL))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    ARSAL_Mutex_Lock (&(recorder->mutex));
+    *counters = recorder->counters;
+    ARSAL_Mutex_Unlock (&(recorder->mutex));
+    return ARSTREAM_OK;
+}
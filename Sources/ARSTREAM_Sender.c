@@ -51,7 +51,11 @@
  */
 
 #include "ARSTREAM_Buffers.h"
+#include "ARSTREAM_Crypto.h"
 #include "ARSTREAM_NetworkHeaders.h"
+#include "ARSTREAM_Fec.h"
+#include "ARSTREAM_Stats.h"
+#include "ARSTREAM_StreamTasks.h"
 
 /*
  * ARSDK Headers
@@ -105,11 +109,109 @@
  */
 #define ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES (15)
 
+/**
+ * Adaptive redundancy : loss rate (unacknowledged fragments after redundancy) above which the redundancy is raised
+ */
+#define ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_RAISE_LOSS (0.02f)
+
+/**
+ * Adaptive redundancy : loss rate under which the link is considered clean
+ */
+#define ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_CLEAN_LOSS (0.005f)
+
+/**
+ * Adaptive redundancy : minimum number of fragments accounted before selecting a new level
+ */
+#define ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_MIN_NB_FRAGMENTS (64)
+
+/**
+ * Adaptive redundancy : number of consecutive clean windows before lowering the redundancy
+ * This is higher than one, as a lower redundancy level will raise the loss rate again
+ */
+#define ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_CLEAN_NB_WINDOWS (4)
+
+/**
+ * Congestion control : time between two updates of the target bitrate
+ */
+#define ARSTREAM_SENDER_CONGESTION_UPDATE_INTERVAL_MS (100)
+
+/**
+ * Congestion control : number of update intervals used to compute the base (minimum) round trip time
+ * The base round trip time is the minimum sample of the last 10 seconds, so it follows route changes
+ */
+#define ARSTREAM_SENDER_CONGESTION_RTT_HISTORY_NB_INTERVALS (100)
+
+/**
+ * Congestion control : minimum number of fragments sent during an interval to compute a loss rate
+ */
+#define ARSTREAM_SENDER_CONGESTION_MIN_NB_FRAGMENTS (32)
+
+/**
+ * Congestion control : queuing delay (round trip time minus base round trip time) above which the link is overused
+ */
+#define ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUING_DELAY_MS (30.f)
+
+/**
+ * Congestion control : retry rate above which the link is overused
+ */
+#define ARSTREAM_SENDER_CONGESTION_OVERUSE_LOSS (0.10f)
+
+/**
+ * Congestion control : retry rate under which the target bitrate can be raised
+ */
+#define ARSTREAM_SENDER_CONGESTION_UNDERUSE_LOSS (0.02f)
+
+/**
+ * Congestion control : number of frames waiting in queue above which the link is overused
+ */
+#define ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUE_DEPTH (1)
+
+/**
+ * Congestion control : multiplicative decrease, applied to the delivery rate on overuse
+ */
+#define ARSTREAM_SENDER_CONGESTION_DECREASE_FACTOR (0.85f)
+
+/**
+ * Congestion control : multiplicative increase, applied to the target bitrate on each clean interval
+ */
+#define ARSTREAM_SENDER_CONGESTION_INCREASE_FACTOR (1.05f)
+
+/**
+ * Congestion control : maximum ratio between the target bitrate and the delivery rate
+ * This keeps the target bitrate from growing forever when the encoder uses less than the target
+ */
+#define ARSTREAM_SENDER_CONGESTION_MAX_DELIVERY_RATIO (1.5f)
+
+/**
+ * Pacing : minimum size of the token bucket, in fragments
+ * The bucket also holds at least ARSTREAM_SENDER_PACING_BURST_MS of traffic, as the data thread
+ * can not wait less than one millisecond
+ */
+#define ARSTREAM_SENDER_PACING_BURST_NB_FRAGMENTS (4)
+
+/**
+ * Pacing : minimum duration of traffic held by the token bucket, in ms
+ */
+#define ARSTREAM_SENDER_PACING_BURST_MS (2.f)
+
+/**
+ * Pacing : maximum time between two frames used to compute the frame interval, in ms
+ * Longer gaps (e.g. a paused encoder) are not accounted
+ */
+#define ARSTREAM_SENDER_PACING_MAX_FRAME_INTERVAL_MS (1000)
+
 /**
  * Number of previous frames to memorize
  */
 #define ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE (10)
 
+/**
+ * Number of network callback params preallocated by a sender
+ * The data IOBuffer holds at most 2 * maxNumberOfFragment cells (see ARSTREAM_Buffers),
+ * and the data thread can hold one more param while a cell is overwritten in ARNETWORK_Manager_SendData
+ */
+#define ARSTREAM_SENDER_CALLBACK_PARAMS_POOL_SIZE(NB_FRAGMENTS) ((2 * (NB_FRAGMENTS)) + 2)
+
 /**
  * Sets *PTR to VAL if PTR is not null
  */
@@ -132,8 +234,96 @@ typedef struct {
     uint32_t frameSize;
     uint8_t *frameBuffer;
     int isHighPriority;
+    eARSTREAM_SENDER_FRAME_CLASS frameClass;
+    int hasDeadline;
+    struct timespec deadline;
+    int hasCaptureTimestamp;
+    uint32_t captureTimestamp;
+    struct timespec queueTime; // Time of the ARSTREAM_Sender_SendNewFrame call, for the statistics
 } ARSTREAM_Sender_Frame_t;
 
+typedef struct {
+    eARSTREAM_SENDER_REDUNDANCY redundancy;
+    int fecBlockSize;
+    int fecNbParity;
+} ARSTREAM_Sender_RedundancyLevel_t;
+
+/**
+ * Redundancy levels used by ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE, from the lowest to the highest
+ */
+static const ARSTREAM_Sender_RedundancyLevel_t ARSTREAM_Sender_AdaptiveRedundancyLevels [] = {
+    { ARSTREAM_SENDER_REDUNDANCY_NONE, 0, 0 },
+    { ARSTREAM_SENDER_REDUNDANCY_FEC, 8, 1 },
+    { ARSTREAM_SENDER_REDUNDANCY_FEC, 4, 1 },
+    { ARSTREAM_SENDER_REDUNDANCY_DUPLICATE, 0, 0 },
+};
+#define ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_NB_LEVELS (sizeof (ARSTREAM_Sender_AdaptiveRedundancyLevels) / sizeof (ARSTREAM_Sender_AdaptiveRedundancyLevels [0]))
+
+typedef struct {
+    int nbPending; // Network cells of the current frame which were not sent yet
+    int nbSendPasses; // Number of times the fragment was given to the network for the current frame
+    int wasSent; // Boolean-like (0/1) flag, active if the network sent the fragment since its last send pass
+    struct timespec lastSentTime; // Time of the last network "SENT" status of the fragment
+} ARSTREAM_Sender_FragmentStatus_t;
+
+typedef struct {
+    int isActive; // Boolean-like (0/1) flag, active from the first ack of the reader until it times out
+    uint8_t receiverId;
+    int usesExtendedAcks; // Boolean-like (0/1) flag, format of the last ack of the reader
+    struct timespec lastAckTime;
+    ARSTREAM_NetworkHeaders_AckPacket_t ackPacket; // Fragments acknowledged by the reader, for the frame ackPacket.frameNumber
+} ARSTREAM_Sender_Receiver_t;
+
+typedef struct {
+    uint32_t offset; // Offset of the fragment data in the frame
+    uint32_t size; // Size of the fragment data
+    uint8_t naluFlags; // ARSTREAM_NETWORK_HEADERS_NALU_FLAG_xxx, only used on NAL units aligned frames
+} ARSTREAM_Sender_FragmentLayout_t;
+
+typedef struct {
+    float rateBytesPerMs; // Pacing rate of the current frame, 0 if pacing is disabled
+    float tokens; // Bytes which can be sent now (negative if the last send overdrew the bucket)
+    float burstBytes; // Size of the bucket
+    struct timespec lastRefill;
+    float frameIntervalMs; // Smoothed time between two new frames, 0 if unknown
+    struct timespec lastFrameTime;
+    int hasLastFrameTime;
+} ARSTREAM_Sender_Pacing_t;
+
+typedef struct {
+    uint8_t *sendFragment; // Scratch buffer for the fragments which can not be prebuilt
+    uint32_t sendSize;
+    uint16_t nbPackets;
+    int numbersOfFragmentsSentForCurrentFrame;
+    int lastFragmentSize;
+    int headerSize;
+    int tagSize; // Size of the authentication tag which follows the data of the fragments, 0 if the stream is not encrypted
+    ARSTREAM_NetworkHeaders_FragmentInfos_t fragmentInfos;
+    ARSTREAM_Sender_Frame_t nextFrame;
+    int firstFrame; // Boolean-like (0/1) flag, active until the first frame is popped
+    int firstSendWasAccounted; // Boolean-like (0/1) flag, active once the first send of the current frame is in the statistics
+    int nextRetryMs;
+    eARSTREAM_SENDER_REDUNDANCY frameRedundancy;
+    int fecBlockSize;
+    int fecNbParity;
+    int parityToSend;
+    int sendStartIndex; // Fragment where the previous send pass was interrupted (pacing or step budget)
+    uint32_t lastPoppedFrameNumber; // Number of the last frame taken from the queue, even if it was dropped
+    ARSTREAM_Sender_Pacing_t pacing;
+    int nextStepMs; // Result of the last ARSTREAM_Sender_OnTimer step
+    struct timespec lastStepTime;
+} ARSTREAM_Sender_DataLoop_t;
+
+typedef struct ARSTREAM_Sender_NetworkCallbackParam_t {
+    ARSTREAM_Sender_t *sender;
+    uint32_t frameNumber;
+    int fragmentIndex;
+    int isPrebuiltFragment; // Boolean-like (0/1) flag, active if the network references sender->fragmentsBuffer
+    int isParityFragment; // Boolean-like (0/1) flag, active if fragmentIndex is the index of a parity fragment
+    int isFromPool; // Boolean-like (0/1) flag, active if the param is part of sender->cbParamsPool
+    struct ARSTREAM_Sender_NetworkCallbackParam_t *nextFree;
+} ARSTREAM_Sender_NetworkCallbackParam_t;
+
 struct ARSTREAM_Sender_t {
     /* Configuration on New */
     ARNETWORK_Manager_t *manager;
@@ -148,26 +338,63 @@ struct ARSTREAM_Sender_t {
     /* Other configuration */
     int minRetryTimeMs;
     int maxRetryTimeMs;
+    float pacingFrameIntervalFraction; // Protected by ackMutex, 0 if pacing is disabled
+    eARSTREAM_SENDER_FRAGMENTATION fragmentation; // Protected by ackMutex
+    eARSTREAM_SENDER_QUEUE_POLICY queuePolicy; // Protected by nextFrameMutex
 
     /* Current frame storage */
     ARSTREAM_Sender_Frame_t currentFrame;
     int currentFrameNbFragments;
     int currentFrameCbWasCalled;
-    ARSAL_Mutex_t packetsToSendMutex;
+    ARSTREAM_Sender_FragmentLayout_t *fragmentsLayout; // maxNumberOfFragment entries, layout of the current frame
+    ARSAL_Mutex_t packetsToSendMutex; // When both are needed, ackMutex must be locked first
     ARSTREAM_NetworkHeaders_AckPacket_t packetsToSend;
 
+    /* Prebuilt fragments storage (header + data, given to the network without copy) */
+    uint8_t *fragmentsBuffer;
+    uint32_t fragmentsBufferStride;
+    ARSTREAM_NetworkHeaders_AckPacket_t fragmentsBuilt;
+    int *fragmentsInFlight; // Protected by packetsToSendMutex
+    int nbFragmentsInFlight; // Protected by packetsToSendMutex
+
+    /* Retransmission timers (protected by packetsToSendMutex) */
+    ARSTREAM_Sender_FragmentStatus_t *fragmentsStatus;
+    float rttSmoothedMs;
+    float rttVarianceMs;
+    int rttNbSamples;
+
+    /* Network callback params pool */
+    ARSTREAM_Sender_NetworkCallbackParam_t *cbParamsPool;
+    ARSTREAM_Sender_NetworkCallbackParam_t *cbParamsFreeList; // Popped only by the data thread, pushed by any thread
+    uint32_t cbParamsPoolMisses;
+
     /* Acknowledge storage */
-    ARSAL_Mutex_t ackMutex;
+    ARSAL_Mutex_t ackMutex; // Locked before packetsToSendMutex when both are needed (data loop, congestion update)
     ARSTREAM_NetworkHeaders_AckPacket_t ackPacket;
+    int peerUsesExtendedAcks; // Protected by ackMutex
+
+    /* Encryption (set before the data loop starts, then only used by the data loop) */
+    int isEncrypted; // Boolean-like (0/1) flag
+    ARSTREAM_Crypto_Key_t cryptoKey;
+    uint8_t cryptoNoncePrefix [ARSTREAM_CRYPTO_NONCE_SIZE - sizeof (uint64_t)]; // Random, drawn for each key
+    uint64_t cryptoNonceCounter; // Number of fragments sealed with the current key
+
+    /* Fan-out readers (protected by ackMutex) */
+    ARSTREAM_Sender_Receiver_t *receivers; // NULL if the sender has a single reader
+    int maxNumberOfReceivers;
+
+    /* Next frame storage (ring between the producers and the data thread) */
+    ARSAL_Mutex_t nextFrameMutex; // Serializes the producers, never taken by the data thread
+    uint32_t nextFrameNumber; // Protected by nextFrameMutex
+    uint32_t nextFramesWriteIndex; // Only modified by the producers
+    uint32_t nextFramesReadIndex; // Advanced with CAS by the data thread (pop) and by the producers (flush, overwrite)
+    uint32_t preemptFrameNumber; // Number of the last flush frame added, read by the data thread between fragments
+    ARSTREAM_Sender_Frame_t *nextFrames;
 
-    /* Next frame storage */
-    ARSAL_Mutex_t nextFrameMutex;
+    /* Data thread wakeup (only used when the data thread is idle) */
+    ARSAL_Mutex_t nextFrameCondMutex;
     ARSAL_Cond_t  nextFrameCond;
-    uint32_t nextFrameNumber;
-    uint32_t indexAddNextFrame;
-    uint32_t indexGetNextFrame;
-    uint32_t numberOfWaitingFrames;
-    ARSTREAM_Sender_Frame_t *nextFrames;
+    int dataThreadIsWaiting;
 
     /* Previous frame storage (for LATE_ACKs) */
     int *previousFramesStatus;
@@ -177,18 +404,46 @@ struct ARSTREAM_Sender_t {
     int threadsShouldStop;
     int dataThreadStarted;
     int ackThreadStarted;
+    ARSTREAM_Sender_DataLoop_t dataLoop; // Only used by the data loop
+    ARSTREAM_Impairment_t *ackImpairment; // Ack loop only, NULL to read the network buffer directly
+    int ackPollDelayMs; // Event-driven API only, returned by the next ARSTREAM_Sender_ProcessAcks() call which reads no ack
+    ARSTREAM_ThreadConfig_t threadConfigs [ARSTREAM_THREAD_MAX]; // Applied by the RunDataThread / RunAckThread functions
+    ARSTREAM_StreamTasks_WakeupCallback_t wakeupCallback; // Called when the data loop is not run by its own thread
+    void *wakeupCustom;
 
     /* Efficiency calculations */
     int efficiency_nbFragments [ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES];
     int efficiency_nbSent [ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES];
     int efficiency_index;
-};
 
-typedef struct {
-    ARSTREAM_Sender_t *sender;
-    uint32_t frameNumber;
-    int fragmentIndex;
-} ARSTREAM_Sender_NetworkCallbackParam_t;
+    /* Redundancy (protected by ackMutex) */
+    eARSTREAM_SENDER_REDUNDANCY redundancy;
+    int fecBlockSize;
+    int fecNbParity;
+    int adaptiveRedundancyLevel;
+    int adaptiveRedundancyNbFrames;
+    int adaptiveRedundancyNbChecked;
+    int adaptiveRedundancyNbLost;
+    int adaptiveRedundancyNbCleanWindows;
+
+    /* Congestion control (protected by ackMutex) */
+    ARSTREAM_Sender_BitrateCallback_t bitrateCallback;
+    uint32_t minBitrate;
+    uint32_t maxBitrate;
+    uint32_t targetBitrate;
+    struct timespec congestionLastUpdate;
+    int congestionNbSent; // Data fragments given to the network during the interval
+    int congestionNbAcked; // Data fragments acknowledged during the interval
+    uint64_t congestionNbAckedBytes; // Data bytes of the fragments acknowledged during the interval
+    int congestionNbDropped; // Frames cancelled or dropped during the interval
+    uint32_t congestionMaxQueueDepth;
+    float congestionIntervalMinRttMs; // Protected by packetsToSendMutex, negative if no sample
+    float congestionRttHistory [ARSTREAM_SENDER_CONGESTION_RTT_HISTORY_NB_INTERVALS]; // Protected by packetsToSendMutex
+    int congestionRttHistoryIndex; // Protected by packetsToSendMutex
+
+    /* Statistics (updated with atomic adds, see ARSTREAM_Stats.h) */
+    ARSTREAM_Sender_Stats_t stats;
+};
 
 /*
  * Internal functions declarations
@@ -201,24 +456,224 @@ typedef struct {
  */
 static void ARSTREAM_Sender_FlushQueue (ARSTREAM_Sender_t *sender);
 
+/**
+ * @brief Wakes up the data thread if it is waiting for a new frame
+ * @param sender The sender
+ */
+static void ARSTREAM_Sender_WakeDataThread (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Cancel a frame of a full new frame queue, to make room for a new frame
+ * The oldest non-reference frame is cancelled, or the oldest P-Frame if there is none, so that the
+ * frames which stay in the queue can still be decoded. The flush frame is only cancelled when no
+ * other frame is waiting.
+ * @param sender The sender
+ * @warning Must be called with nextFrameMutex held
+ */
+static void ARSTREAM_Sender_OverwriteOldestFrame (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Check if a flush frame was added to the queue after the current frame was popped
+ * The data thread then stops sending the current frame, which the flush frame will cancel.
+ * @param sender The sender
+ * @return 1 if the current frame send should be interrupted, 0 otherwise
+ * @warning Must only be called from the data thread
+ */
+static int ARSTREAM_Sender_IsPreempted (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Get the next fragment flagged in packetsToSend, for a send pass which starts at a given fragment
+ * The pass visits the fragments from startIndex to the end of the frame, then from the start of the frame to startIndex.
+ * @param sender The sender
+ * @param startIndex The first fragment of the pass
+ * @param previous The fragment returned by the previous call, -1 to start the pass
+ * @return The index of the next fragment to send, -1 at the end of the pass
+ * @warning Must be called with packetsToSendMutex held
+ */
+static int ARSTREAM_Sender_NextFragmentToSend (ARSTREAM_Sender_t *sender, int startIndex, int previous);
+
+/**
+ * @brief Pop a frame from the new frame queue, without waiting
+ * @param sender The sender
+ * @param newFrame Pointer in which the function will save the new frame infos
+ * @return 1 if a new frame is available
+ * @return 0 if no new frame should be sent (queue is empty, or filled with low-priority frame)
+ * @warning Must only be called from the data thread
+ */
+static int ARSTREAM_Sender_TryPopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame);
+
+/**
+ * @brief Checks a new frame from the application and adds it to the new frame queue
+ * @see ARSTREAM_Sender_SendNewFrameWithTimestamp()
+ * @param captureTimestamp Capture timestamp sent with the frame (NULL if the frame has no timestamp)
+ */
+static eARSTREAM_ERROR ARSTREAM_Sender_QueueNewFrame (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, const uint32_t *captureTimestamp, int *nbPreviousFrames);
+
 /**
  * @brief Add a frame to the new frame queue
  * @param sender The sender which should send the frame
  * @param size The frame size, in bytes
  * @param buffer Pointer to the buffer which contains the frame
- * @param wasFlushFrame Boolean-like (0/1) flag, active if the frame is added after a flush (high priority frame)
+ * @param frameClass The frame class (ARSTREAM_SENDER_FRAME_CLASS_I frames flush the queue and are high priority)
+ * @param deadline Absolute time after which the frame is useless (NULL if the frame has no deadline)
+ * @param captureTimestamp Capture timestamp sent with the frame (NULL if the frame has no timestamp)
  * @return the number of frames previously in queue (-1 if queue is full)
  */
-static int ARSTREAM_Sender_AddToQueue (ARSTREAM_Sender_t *sender, uint32_t size, uint8_t *buffer, int wasFlushFrame);
+static int ARSTREAM_Sender_AddToQueue (ARSTREAM_Sender_t *sender, uint32_t size, uint8_t *buffer, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, const uint32_t *captureTimestamp);
+
+/**
+ * @brief Gets the time left before the deadline of a frame
+ * @param frame The frame
+ * @return The number of milliseconds left before the deadline (0 or negative if the deadline has passed)
+ * @return INT32_MAX if the frame has no deadline
+ */
+static int ARSTREAM_Sender_GetMsBeforeDeadline (ARSTREAM_Sender_Frame_t *frame);
+
+/**
+ * @brief Checks if a frame popped from the queue is still worth sending
+ * Frames which missed their deadline are dropped. Non-reference frames are also
+ * dropped while the link falls behind, i.e. when more than ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUE_DEPTH
+ * newer frames are waiting in the queue. An unacknowledged previous frame is not a backlog : it is
+ * the normal state of a link whose round trip time is longer than the frame interval
+ * @param sender The sender
+ * @param frame The popped frame
+ * @param isFirstFrame Boolean-like (0/1) flag, active if no frame was sent yet
+ * @return 1 if the frame should be sent
+ * @return 0 if the frame was dropped (its callback was called with the ARSTREAM_SENDER_STATUS_FRAME_CANCEL status)
+ * @warning Must only be called from the data thread, with the ackMutex held
+ */
+static int ARSTREAM_Sender_AcceptPoppedFrame (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *frame, int isFirstFrame);
+
+/**
+ * @brief Updates the target bitrate of the sender, once per ARSTREAM_SENDER_CONGESTION_UPDATE_INTERVAL_MS
+ * The link is overused if the queuing delay, the retry rate or the frame queue depth is too high, or if
+ * frames were dropped. On overuse, the target bitrate is set under the delivery rate. When the link is clean,
+ * the target bitrate is slowly raised.
+ * @param sender The sender
+ * @param lossRate Pointer in which the function will save the retry rate of the interval
+ * @param rttMs Pointer in which the function will save the smoothed round trip time
+ * @return 1 if the target bitrate changed (the bitrate callback should be called), 0 otherwise
+ * @warning Must only be called from the data thread, with the ackMutex held
+ */
+static int ARSTREAM_Sender_UpdateCongestion (ARSTREAM_Sender_t *sender, float *lossRate, int *rttMs);
+
+/**
+ * @brief Updates the pacing rate for a new frame
+ * The rate is the target bitrate, or the rate needed to send the whole frame within
+ * the configured fraction of the frame interval if it is higher
+ * @param sender The sender
+ * @param pacing The data thread pacing state
+ * @param nbBytes The number of bytes of the first send pass of the frame (including headers and redundancy)
+ * @warning Must only be called from the data thread, with the ackMutex held
+ */
+static void ARSTREAM_Sender_PacingNewFrame (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Pacing_t *pacing, uint32_t nbBytes);
+
+/**
+ * @brief Checks if the token bucket allows a new fragment to be sent now
+ * @param pacing The data thread pacing state
+ * @return 1 if a fragment can be sent (or if pacing is disabled), 0 otherwise
+ */
+static int ARSTREAM_Sender_PacingCanSend (ARSTREAM_Sender_Pacing_t *pacing);
+
+/**
+ * @brief Gets the time to wait before the token bucket allows a new fragment to be sent
+ * @param pacing The data thread pacing state
+ * @return The time to wait, in ms (at least 1)
+ */
+static int ARSTREAM_Sender_PacingGetWaitMs (ARSTREAM_Sender_Pacing_t *pacing);
 
 /**
  * @brief Pop a frame from the new frame queue
  * @param sender The sender
  * @param newFrame Pointer in which the function will save the new frame infos
+ * @param waitTimeMs Maximum time to wait for a new frame, in miliseconds
  * @return 1 if a new frame is available
  * @return 0 if no new frame should be sent (queue is empty, or filled with low-priority frame)
  */
-static int ARSTREAM_Sender_PopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame);
+static int ARSTREAM_Sender_PopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame, int waitTimeMs);
+
+/**
+ * @brief Gets the current retransmission timeout of the fragments
+ * The timeout is computed from the measured round trip time (or the network
+ * estimated latency if no measure is available yet), bounded by the values
+ * given to ARSTREAM_Sender_SetTimeBetweenRetries
+ * @param sender The sender
+ * @return The retransmission timeout, in miliseconds
+ * @warning Must be called within a sender->packetsToSendMutex lock
+ */
+static int ARSTREAM_Sender_GetRetransmissionTimeout (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Updates the round trip time estimation with newly acknowledged fragments
+ * Only fragments which were given once to the network are used (Karn's algorithm)
+ * @param sender The sender
+ * @param frameNumber The frame number of the ack packet
+ * @param newAcks The fragments acknowledged by the last ack packet, which were not acknowledged before
+ * @param nbFragments The number of fragments of the frame
+ */
+static void ARSTREAM_Sender_UpdateRtt (ARSTREAM_Sender_t *sender, uint32_t frameNumber, ARSTREAM_NetworkHeaders_AckPacket_t *newAcks, int nbFragments);
+
+/**
+ * @brief Accounts the acknowledge status of the finished frame, and updates the adaptive redundancy level
+ * The loss rate is the ratio of sent fragments which were not acknowledged when the frame was replaced.
+ * Fragments sent less than a round trip time before are not accounted, as their ack could not come back yet.
+ * @param sender The sender
+ * @warning Must be called within sender->ackMutex and sender->packetsToSendMutex locks, once per new frame,
+ * before resetting the status of the previous frame
+ */
+static void ARSTREAM_Sender_UpdateAdaptiveRedundancy (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Gets the redundancy to apply to the current frame
+ * @param sender The sender
+ * @param[out] fecBlockSize Number of data fragments per FEC block (only set for ARSTREAM_SENDER_REDUNDANCY_FEC)
+ * @param[out] fecNbParity Number of parity fragments per FEC block (only set for ARSTREAM_SENDER_REDUNDANCY_FEC)
+ * @return The redundancy to apply (never ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE)
+ * @warning Must be called within a sender->ackMutex lock
+ */
+static eARSTREAM_SENDER_REDUNDANCY ARSTREAM_Sender_GetFrameRedundancy (ARSTREAM_Sender_t *sender, int *fecBlockSize, int *fecNbParity);
+
+/**
+ * @brief Finds the next NAL unit of an Annex B byte stream
+ * @param frame The frame to search
+ * @param size The size of the frame
+ * @param from The offset of the current NAL unit (the start code at this offset is skipped)
+ * @return The offset of the start code of the next NAL unit, or size if there is no other NAL unit
+ */
+static uint32_t ARSTREAM_Sender_FindNextNalUnit (uint8_t *frame, uint32_t size, uint32_t from);
+
+/**
+ * @brief Computes the fragments of the current frame into sender->fragmentsLayout
+ * @param sender The sender
+ * @param alignOnNalUnits Boolean-like (0/1) flag, active if the fragments should follow the NAL units boundaries
+ * @return The number of fragments of the frame
+ * @return -1 if alignOnNalUnits is active and the aligned frame needs more than maxNumberOfFragment fragments
+ * (the layout is then invalid)
+ */
+static int ARSTREAM_Sender_ComputeFragmentsLayout (ARSTREAM_Sender_t *sender, int alignOnNalUnits);
+
+/**
+ * @brief Builds and sends the parity fragments of the current frame
+ * Parity fragments are copied by the network, and never retried
+ * @param sender The sender
+ * @param parityFragment Scratch buffer (at least maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE bytes)
+ * @param infos Headers infos of the current frame
+ * @param nbFragments Number of data fragments of the current frame
+ * @param lastFragmentSize Size of the last data fragment of the current frame
+ * @param fecBlockSize Number of data fragments per FEC block
+ * @param fecNbParity Number of parity fragments per FEC block
+ * @warning Must be called within a sender->packetsToSendMutex lock
+ */
+static void ARSTREAM_Sender_SendParityFragments (ARSTREAM_Sender_t *sender, uint8_t *parityFragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int nbFragments, int lastFragmentSize, int fecBlockSize, int fecNbParity);
+
+/**
+ * @brief Updates the retransmission status of a fragment when the network releases one of its cells
+ * @param sender The sender
+ * @param cbParams The callback params of the network cell
+ * @param wasSent Boolean-like (0/1) flag, active if the network actually sent the cell
+ * @warning Must be called within a sender->packetsToSendMutex lock
+ */
+static void ARSTREAM_Sender_FragmentCellDone (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams, int wasSent);
 
 /**
  * @brief ARNETWORK_Manager_Callback_t for ARNETWORK_... calls
@@ -228,10 +683,68 @@ static int ARSTREAM_Sender_PopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sen
  * @param status Network information
  * @return ARNETWORK_MANAGER_CALLBACK_RETURN_DEFAULT
  *
- * @warning customData is a malloc'd pointer, and must be freed within this callback, during last call
+ * @warning customData comes from ARSTREAM_Sender_AllocCallbackParam, and must be released within this callback, during last call
  */
 eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Sender_NetworkCallback (int IoBufferId, uint8_t *dataPtr, void *customData, eARNETWORK_MANAGER_CALLBACK_STATUS status);
 
+/**
+ * @brief Gets a network callback param from the sender pool
+ * If the pool is exhausted, the param is malloc'd, and sender->cbParamsPoolMisses is incremented
+ * @param sender The sender
+ * @return A callback param, or NULL if the pool is exhausted and the allocation failed
+ * @warning Must only be called from the data thread
+ */
+static ARSTREAM_Sender_NetworkCallbackParam_t* ARSTREAM_Sender_AllocCallbackParam (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Gives back a network callback param to the sender pool
+ * @param sender The sender
+ * @param cbParams The callback param to release
+ * @note Can be called from any thread
+ */
+static void ARSTREAM_Sender_FreeCallbackParam (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams);
+
+/**
+ * @brief Releases the network reference on a prebuilt fragment
+ * @param sender The sender
+ * @param cbParams The callback params of the network cell which is no longer used
+ * @warning Must be called within a sender->packetsToSendMutex lock
+ */
+static void ARSTREAM_Sender_ReleasePrebuiltFragment (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams);
+
+/**
+ * @brief Gets the prebuilt fragment (header + data) for a fragment of the current frame
+ * The fragment is built in sender->fragmentsBuffer the first time it is requested for a frame,
+ * and reused for all retries of the same frame.
+ * @param sender The sender
+ * @param infos Headers infos of the fragment (infos->fragmentNumber is the index of the fragment in the current frame)
+ * @param fragmentSize Size of the fragment data, without header
+ * @return A pointer to the prebuilt fragment, or NULL if the storage is still referenced by the network for an old frame
+ * @warning Must be called within a sender->packetsToSendMutex lock
+ */
+static uint8_t* ARSTREAM_Sender_GetPrebuiltFragment (ARSTREAM_Sender_t *sender, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int fragmentSize);
+
+/**
+ * @brief Writes the stream data headers of a fragment, with a new nonce if the stream is encrypted
+ * @param sender The sender
+ * @param fragment The fragment buffer
+ * @param infos The fragment infos (the nonce is updated)
+ * @return The size of the headers
+ */
+static int ARSTREAM_Sender_WriteFragmentHeader (ARSTREAM_Sender_t *sender, uint8_t *fragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos);
+
+/**
+ * @brief Encrypts the data of a fragment in place, and writes its authentication tag after the data
+ * Does nothing if the stream is not encrypted
+ * @param sender The sender
+ * @param fragment The fragment buffer, with the headers written by ARSTREAM_Sender_WriteFragmentHeader
+ * @param infos The fragment infos given to ARSTREAM_Sender_WriteFragmentHeader
+ * @param headerSize The size of the headers
+ * @param dataSize The size of the fragment data
+ * @return The size of the tag written after the data (0 if the stream is not encrypted)
+ */
+static int ARSTREAM_Sender_SealFragment (ARSTREAM_Sender_t *sender, uint8_t *fragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int headerSize, int dataSize);
+
 /**
  * @brief Signals that the current frame of the sender was acknowledged
  * @param sender The sender
@@ -245,7 +758,7 @@ static void ARSTREAM_Sender_FrameWasAck (ARSTREAM_Sender_t *sender);
  * @return 1 if the function called the callback with LATE_ACK
  * @return 0 if the LATE_ACK was already sent for this frame, or if any other error occured
  */
-static int ARSTREAM_Sender_SendLateAck (ARSTREAM_Sender_t *sender, uint16_t frameId);
+static int ARSTREAM_Sender_SendLateAck (ARSTREAM_Sender_t *sender, uint32_t frameId);
 
 /**
  * @brief Internal wrapper around the callback calls
@@ -258,141 +771,857 @@ static int ARSTREAM_Sender_SendLateAck (ARSTREAM_Sender_t *sender, uint16_t fram
  */
 static void ARSTREAM_Sender_CallCallback (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize);
 
+/**
+ * @brief Applies an ack packet read from the network
+ * @param sender The sender
+ * @param recvData The ack packet, in network format
+ * @param recvSize The size of the ack packet
+ */
+static void ARSTREAM_Sender_ProcessAckData (ARSTREAM_Sender_t *sender, uint8_t *recvData, int recvSize);
+
+/**
+ * @brief Save the acks of a reader of a fan-out sender, and replace them by the acks of all the readers
+ * @param sender The sender
+ * @param receiverId The id of the reader which sent the ack packet
+ * @param isExtended Boolean-like (0/1) flag, active if the ack packet used the extended format
+ * @param packet The received ack packet, replaced by the fragments acknowledged by all the readers.
+ * Acks of other frames than the current one are cleared
+ * @warning Must be called with ackMutex held
+ */
+static void ARSTREAM_Sender_MergeReceiverAck (ARSTREAM_Sender_t *sender, uint8_t receiverId, int isExtended, ARSTREAM_NetworkHeaders_AckPacket_t *packet);
+
+/**
+ * @brief Starts both loops of the sender on the first call of the event-driven API
+ * @param sender The sender
+ */
+static void ARSTREAM_Sender_StartEventLoops (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Ends both loops of the sender once the event-driven API detected the stop
+ * @param sender The sender
+ */
+static void ARSTREAM_Sender_EndEventLoops (ARSTREAM_Sender_t *sender);
+
 /*
  * Internal functions implementation
  */
 
 static void ARSTREAM_Sender_FlushQueue (ARSTREAM_Sender_t *sender)
 {
-    while (sender->numberOfWaitingFrames > 0)
+    uint32_t writeIndex = sender->nextFramesWriteIndex;
+    uint32_t readIndex;
+    // Take all the waiting frames at once, so the data thread can not pop any of them
+    do
     {
-        ARSTREAM_Sender_Frame_t *nextFrame = &(sender->nextFrames [sender->indexGetNextFrame]);
+        readIndex = __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    } while (! __sync_bool_compare_and_swap (&(sender->nextFramesReadIndex), readIndex, writeIndex));
+
+    while (readIndex != writeIndex)
+    {
+        ARSTREAM_Sender_Frame_t *nextFrame = &(sender->nextFrames [readIndex % sender->maxNumberOfNextFrames]);
         ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, nextFrame->frameBuffer, nextFrame->frameSize);
-        sender->indexGetNextFrame++;
-        sender->indexGetNextFrame %= sender->maxNumberOfNextFrames;
-        sender->numberOfWaitingFrames--;
+        readIndex++;
     }
 }
 
-static int ARSTREAM_Sender_AddToQueue (ARSTREAM_Sender_t *sender, uint32_t size, uint8_t *buffer, int wasFlushFrame)
+static void ARSTREAM_Sender_WakeDataThread (ARSTREAM_Sender_t *sender)
 {
-    int retVal;
-    ARSAL_Mutex_Lock (&(sender->nextFrameMutex));
-    retVal = sender->numberOfWaitingFrames;
-    if (sender->currentFrameCbWasCalled == 0)
+    // Pairs with ARSTREAM_Sender_PopFromQueue: either we see dataThreadIsWaiting,
+    // or the data thread sees our changes before waiting
+    if (__atomic_load_n (&(sender->dataThreadIsWaiting), __ATOMIC_SEQ_CST) == 1)
     {
-        retVal++;
+        ARSAL_Mutex_Lock (&(sender->nextFrameCondMutex));
+        ARSAL_Cond_Signal (&(sender->nextFrameCond));
+        ARSAL_Mutex_Unlock (&(sender->nextFrameCondMutex));
     }
-    if (wasFlushFrame == 1)
+    if (sender->wakeupCallback != NULL)
     {
-        ARSTREAM_Sender_FlushQueue (sender);
+        sender->wakeupCallback (sender->wakeupCustom);
     }
-    if (sender->numberOfWaitingFrames < sender->maxNumberOfNextFrames)
-    {
-        ARSTREAM_Sender_Frame_t *nextFrame = &(sender->nextFrames [sender->indexAddNextFrame]);
-        sender->nextFrameNumber++;
-        nextFrame->frameNumber = sender->nextFrameNumber;
-        nextFrame->frameBuffer = buffer;
-        nextFrame->frameSize   = size;
-        nextFrame->isHighPriority = wasFlushFrame;
-
-        sender->indexAddNextFrame++;
-        sender->indexAddNextFrame %= sender->maxNumberOfNextFrames;
+}
 
-        sender->numberOfWaitingFrames++;
+static void ARSTREAM_Sender_OverwriteOldestFrame (ARSTREAM_Sender_t *sender)
+{
+    uint32_t writeIndex = sender->nextFramesWriteIndex;
+    uint32_t readIndex;
+    uint32_t victimIndex = writeIndex;
+    uint32_t index;
+    ARSTREAM_Sender_Frame_t *victimFrame;
+    // Take all the waiting frames at once, so the data thread can not pop them while they are moved
+    do
+    {
+        readIndex = __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    } while (! __sync_bool_compare_and_swap (&(sender->nextFramesReadIndex), readIndex, writeIndex));
 
-        ARSAL_Cond_Signal (&(sender->nextFrameCond));
-    }
-    else
+    if (readIndex == writeIndex)
     {
-        retVal = -1;
+        // The data thread emptied the queue, which made room
+        return;
     }
-    ARSAL_Mutex_Unlock (&(sender->nextFrameMutex));
-    return retVal;
-}
 
-static int ARSTREAM_Sender_PopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame)
-{
-    int retVal = 0;
-    int hadTimeout = 0;
-    ARSAL_Mutex_Lock (&(sender->nextFrameMutex));
-    // Check if a frame is ready and of good priority
-    if (sender->numberOfWaitingFrames > 0)
+    for (index = readIndex; (victimIndex == writeIndex) && (index != writeIndex); index++)
     {
-#if ENABLE_ACK_WAIT == 1
-        ARSTREAM_Sender_Frame_t *frame = &(sender->nextFrames [sender->indexGetNextFrame]);
-        // Give the next frame only if :
-        // 1> It's an high priority frame
-        // 2> The previous frame was fully acknowledged
-        if ((frame->isHighPriority == 1) ||
-            (sender->currentFrameCbWasCalled == 1))
-#endif
+        if (sender->nextFrames [index % sender->maxNumberOfNextFrames].frameClass == ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE)
         {
-            retVal = 1;
-            sender->numberOfWaitingFrames--;
+            victimIndex = index;
         }
     }
-    // If not, wait for a frame ready event
-    if (retVal == 0)
+    for (index = readIndex; (victimIndex == writeIndex) && (index != writeIndex); index++)
     {
-        struct timespec start, end;
-        int timewaited = 0;
-        int waitTime = ARNETWORK_Manager_GetEstimatedLatency (sender->manager);
-        if (waitTime < 0) // Unable to get latency
+        if (sender->nextFrames [index % sender->maxNumberOfNextFrames].frameClass == ARSTREAM_SENDER_FRAME_CLASS_P)
         {
-            waitTime = ARSTREAM_SENDER_DEFAULT_ESTIMATED_LATENCY_MS;
+            victimIndex = index;
         }
-        waitTime += 5; // Add some time to avoid optimistic waitTime, and 0ms waitTime
-        if (waitTime > sender->maxRetryTimeMs)
-            waitTime = sender->maxRetryTimeMs;
-        if (waitTime < sender->minRetryTimeMs)
-            waitTime = sender->minRetryTimeMs;
-#if ENABLE_RETRIES == 0
-        waitTime = 100000; // Put an extremely long wait time (100 sec) to simulate a "no retry" case
-#endif
+    }
+    if (victimIndex == writeIndex)
+    {
+        // Only the flush frame is waiting (adding a flush frame empties the queue) : no waiting frame depends on it
+        victimIndex = readIndex;
+    }
 
-        while ((retVal == 0) &&
-               (hadTimeout == 0))
-        {
-            ARSAL_Time_GetTime(&start);
-            int err = ARSAL_Cond_Timedwait (&(sender->nextFrameCond), &(sender->nextFrameMutex), waitTime - timewaited);
-            ARSAL_Time_GetTime(&end);
-            timewaited += ARSAL_Time_ComputeTimespecMsTimeDiff (&start, &end);
+    victimFrame = &(sender->nextFrames [victimIndex % sender->maxNumberOfNextFrames]);
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Queue is full, overwriting frame %d", victimFrame->frameNumber);
+    ARSTREAM_Stats_Add (&(sender->stats.nbFramesOverwritten), 1);
+    ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, victimFrame->frameBuffer, victimFrame->frameSize);
+
+    // Move the older frames over the cancelled one, keeping their order
+    for (index = victimIndex; index != readIndex; index--)
+    {
+        sender->nextFrames [index % sender->maxNumberOfNextFrames] = sender->nextFrames [(index - 1) % sender->maxNumberOfNextFrames];
+    }
+
+    // Give the remaining frames back to the data thread. A pop which read the index before the
+    // exchange above can not succeed, as the index never goes back to its old value
+    __atomic_store_n (&(sender->nextFramesReadIndex), readIndex + 1, __ATOMIC_RELEASE);
+}
+
+static int ARSTREAM_Sender_IsPreempted (ARSTREAM_Sender_t *sender)
+{
+    int retVal = 0;
+    uint32_t preemptFrameNumber = __atomic_load_n (&(sender->preemptFrameNumber), __ATOMIC_RELAXED);
+    // Frame numbers wrap, compare them with serial number arithmetic.
+    // The flush frame may also have been removed from the queue (flush, overwrite) : only
+    // preempt if the next step will pop a newer frame
+    if (((int32_t)(preemptFrameNumber - sender->dataLoop.lastPoppedFrameNumber) > 0) &&
+        (__atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE) != __atomic_load_n (&(sender->nextFramesWriteIndex), __ATOMIC_ACQUIRE)))
+    {
+        retVal = 1;
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Sender_NextFragmentToSend (ARSTREAM_Sender_t *sender, int startIndex, int previous)
+{
+    int nbPackets = sender->dataLoop.nbPackets;
+    int next;
+    if ((previous >= 0) &&
+        (previous < startIndex))
+    {
+        // Second part of the pass
+        next = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&(sender->packetsToSend), previous + 1);
+        return ((next >= 0) && (next < startIndex)) ? next : -1;
+    }
+    next = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&(sender->packetsToSend), (previous < 0) ? startIndex : previous + 1);
+    if ((next < 0) ||
+        (next >= nbPackets))
+    {
+        // End of the frame, continue from its first fragment
+        next = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&(sender->packetsToSend), 0);
+        next = ((next >= 0) && (next < startIndex)) ? next : -1;
+    }
+    return next;
+}
+
+static int ARSTREAM_Sender_AddToQueue (ARSTREAM_Sender_t *sender, uint32_t size, uint8_t *buffer, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, const uint32_t *captureTimestamp)
+{
+    int retVal;
+    uint32_t writeIndex;
+    int wasFlushFrame = (frameClass == ARSTREAM_SENDER_FRAME_CLASS_I) ? 1 : 0;
+    ARSAL_Mutex_Lock (&(sender->nextFrameMutex));
+    writeIndex = sender->nextFramesWriteIndex;
+    retVal = writeIndex - __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    if (buffer != NULL)
+    {
+        ARSTREAM_Stats_AddToHistogram (sender->stats.queueDepth, ARSTREAM_SENDER_STATS_QUEUE_DEPTH_NB_BUCKETS, retVal);
+    }
+    if (sender->currentFrameCbWasCalled == 0)
+    {
+        retVal++;
+    }
+    if (wasFlushFrame == 1)
+    {
+        ARSTREAM_Sender_FlushQueue (sender);
+    }
+    else if ((sender->queuePolicy == ARSTREAM_SENDER_QUEUE_POLICY_OVERWRITE_OLDEST) &&
+             ((writeIndex - __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE)) >= sender->maxNumberOfNextFrames))
+    {
+        ARSTREAM_Sender_OverwriteOldestFrame (sender);
+    }
+    // No else : the queue has room, or the frame is refused
+    if ((writeIndex - __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE)) < sender->maxNumberOfNextFrames)
+    {
+        ARSTREAM_Sender_Frame_t *nextFrame = &(sender->nextFrames [writeIndex % sender->maxNumberOfNextFrames]);
+        sender->nextFrameNumber++;
+        nextFrame->frameNumber = sender->nextFrameNumber;
+        nextFrame->frameBuffer = buffer;
+        nextFrame->frameSize   = size;
+        nextFrame->isHighPriority = wasFlushFrame;
+        nextFrame->frameClass = frameClass;
+        nextFrame->hasDeadline = (deadline != NULL) ? 1 : 0;
+        if (deadline != NULL)
+        {
+            nextFrame->deadline = *deadline;
+        }
+        nextFrame->hasCaptureTimestamp = (captureTimestamp != NULL) ? 1 : 0;
+        nextFrame->captureTimestamp = (captureTimestamp != NULL) ? *captureTimestamp : 0;
+        ARSAL_Time_GetTime (&(nextFrame->queueTime));
+        if (buffer != NULL)
+        {
+            ARSTREAM_Stats_Add (&(sender->stats.nbFramesQueued), 1);
+        }
+
+        // Publish the frame only once its content is written
+        __atomic_store_n (&(sender->nextFramesWriteIndex), writeIndex + 1, __ATOMIC_SEQ_CST);
+        if (wasFlushFrame == 1)
+        {
+            // Interrupt the send of the current frame, without waiting for the end of its burst
+            __atomic_store_n (&(sender->preemptFrameNumber), nextFrame->frameNumber, __ATOMIC_RELEASE);
+        }
+
+        ARSTREAM_Sender_WakeDataThread (sender);
+    }
+    else
+    {
+        retVal = -1;
+    }
+    ARSAL_Mutex_Unlock (&(sender->nextFrameMutex));
+    return retVal;
+}
+
+static int ARSTREAM_Sender_TryPopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame)
+{
+    int retVal = 0;
+    uint32_t readIndex = __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    while ((retVal == 0) &&
+           (readIndex != __atomic_load_n (&(sender->nextFramesWriteIndex), __ATOMIC_SEQ_CST)))
+    {
+        ARSTREAM_Sender_Frame_t frame = sender->nextFrames [readIndex % sender->maxNumberOfNextFrames];
+#if ENABLE_ACK_WAIT == 1
+        // Give the next frame only if :
+        // 1> It's an high priority frame
+        // 2> The previous frame was fully acknowledged
+        if ((frame.isHighPriority == 0) &&
+            (sender->currentFrameCbWasCalled == 0))
+        {
+            break;
+        }
+#endif
+        if (__sync_bool_compare_and_swap (&(sender->nextFramesReadIndex), readIndex, readIndex + 1))
+        {
+            retVal = 1;
+            newFrame->frameNumber = frame.frameNumber;
+            newFrame->frameBuffer = frame.frameBuffer;
+            newFrame->frameSize   = frame.frameSize;
+            newFrame->isHighPriority = frame.isHighPriority;
+            newFrame->frameClass = frame.frameClass;
+            newFrame->hasDeadline = frame.hasDeadline;
+            newFrame->deadline = frame.deadline;
+            newFrame->hasCaptureTimestamp = frame.hasCaptureTimestamp;
+            newFrame->captureTimestamp = frame.captureTimestamp;
+            newFrame->queueTime = frame.queueTime;
+        }
+        else
+        {
+            // A producer flushed the queue, our copy may be outdated
+            readIndex = __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+        }
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Sender_GetMsBeforeDeadline (ARSTREAM_Sender_Frame_t *frame)
+{
+    int retVal = INT32_MAX;
+    if (frame->hasDeadline == 1)
+    {
+        struct timespec now;
+        ARSAL_Time_GetTime (&now);
+        retVal = ARSAL_Time_ComputeTimespecMsTimeDiff (&now, &(frame->deadline));
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Sender_AcceptPoppedFrame (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *frame, int isFirstFrame)
+{
+    int retVal = 1;
+    uint32_t queueDepth = __atomic_load_n (&(sender->nextFramesWriteIndex), __ATOMIC_ACQUIRE) - __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    if (ARSTREAM_Sender_GetMsBeforeDeadline (frame) <= 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Frame %d missed its deadline before being sent, dropping it", frame->frameNumber);
+        retVal = 0;
+    }
+    else if ((frame->frameClass == ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE) &&
+             (isFirstFrame == 0) &&
+             (queueDepth > ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUE_DEPTH))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Link is falling behind (%d frames waiting), dropping non-reference frame %d", queueDepth, frame->frameNumber);
+        retVal = 0;
+    }
+    // No else : frame is still useful
+
+    if (retVal == 0)
+    {
+        sender->congestionNbDropped++;
+        ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, frame->frameBuffer, frame->frameSize);
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Sender_PopFromQueue (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Frame_t *newFrame, int waitTimeMs)
+{
+    int retVal = 0;
+    int hadTimeout = 0;
+    // Check if a frame is ready and of good priority
+    retVal = ARSTREAM_Sender_TryPopFromQueue (sender, newFrame);
+    // If not, wait for a frame ready event
+    if ((retVal == 0) &&
+        (waitTimeMs > 0))
+    {
+        struct timespec start, end;
+        int timewaited = 0;
+
+        ARSAL_Mutex_Lock (&(sender->nextFrameCondMutex));
+        // Pairs with ARSTREAM_Sender_WakeDataThread
+        __atomic_store_n (&(sender->dataThreadIsWaiting), 1, __ATOMIC_SEQ_CST);
+        retVal = ARSTREAM_Sender_TryPopFromQueue (sender, newFrame);
+        while ((retVal == 0) &&
+               (hadTimeout == 0))
+        {
+            ARSAL_Time_GetTime(&start);
+            int err = ARSAL_Cond_Timedwait (&(sender->nextFrameCond), &(sender->nextFrameCondMutex), waitTimeMs - timewaited);
+            ARSAL_Time_GetTime(&end);
+            timewaited += ARSAL_Time_ComputeTimespecMsTimeDiff (&start, &end);
             if (err == ETIMEDOUT)
             {
-                hadTimeout = 1;
+                hadTimeout = 1;
+            }
+            retVal = ARSTREAM_Sender_TryPopFromQueue (sender, newFrame);
+        }
+        __atomic_store_n (&(sender->dataThreadIsWaiting), 0, __ATOMIC_SEQ_CST);
+        ARSAL_Mutex_Unlock (&(sender->nextFrameCondMutex));
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Sender_GetRetransmissionTimeout (ARSTREAM_Sender_t *sender)
+{
+    int rto;
+    if (sender->rttNbSamples == 0)
+    {
+        rto = ARNETWORK_Manager_GetEstimatedLatency (sender->manager);
+        if (rto < 0) // Unable to get latency
+        {
+            rto = ARSTREAM_SENDER_DEFAULT_ESTIMATED_LATENCY_MS;
+        }
+        rto += 5; // Add some time to avoid optimistic rto, and 0ms rto
+    }
+    else
+    {
+        // RFC 6298 : RTO = SRTT + 4 * RTTVAR (+1 ms for clock granularity)
+        rto = (int)(sender->rttSmoothedMs + (4.f * sender->rttVarianceMs)) + 1;
+    }
+    if (rto > sender->maxRetryTimeMs)
+        rto = sender->maxRetryTimeMs;
+    if (rto < sender->minRetryTimeMs)
+        rto = sender->minRetryTimeMs;
+#if ENABLE_RETRIES == 0
+    rto = 100000; // Put an extremely long wait time (100 sec) to simulate a "no retry" case
+#endif
+    return rto;
+}
+
+static void ARSTREAM_Sender_UpdateRtt (ARSTREAM_Sender_t *sender, uint32_t frameNumber, ARSTREAM_NetworkHeaders_AckPacket_t *newAcks, int nbFragments)
+{
+    struct timespec now;
+    int index;
+    ARSAL_Time_GetTime (&now);
+    ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+    if (sender->packetsToSend.frameNumber == frameNumber)
+    {
+        for (index = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (newAcks, 0);
+             (index >= 0) && (index < nbFragments);
+             index = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (newAcks, index + 1))
+        {
+            ARSTREAM_Sender_FragmentStatus_t *status = &(sender->fragmentsStatus [index]);
+            if ((status->nbSendPasses == 1) &&
+                (status->wasSent == 1))
+            {
+                float sample = (float)ARSAL_Time_ComputeTimespecMsTimeDiff (&(status->lastSentTime), &now);
+                if (sender->rttNbSamples == 0)
+                {
+                    sender->rttSmoothedMs = sample;
+                    sender->rttVarianceMs = sample / 2.f;
+                }
+                else
+                {
+                    float delta = sender->rttSmoothedMs - sample;
+                    delta = (delta < 0.f) ? -delta : delta;
+                    sender->rttVarianceMs = (0.75f * sender->rttVarianceMs) + (0.25f * delta);
+                    sender->rttSmoothedMs = (0.875f * sender->rttSmoothedMs) + (0.125f * sample);
+                }
+                sender->rttNbSamples++;
+                if ((sender->congestionIntervalMinRttMs < 0.f) ||
+                    (sample < sender->congestionIntervalMinRttMs))
+                {
+                    sender->congestionIntervalMinRttMs = sample;
+                }
+            }
+        }
+    }
+    ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+}
+
+static int ARSTREAM_Sender_UpdateCongestion (ARSTREAM_Sender_t *sender, float *lossRate, int *rttMs)
+{
+    struct timespec now;
+    int elapsedMs;
+    int retVal = 0;
+    uint32_t queueDepth;
+
+    queueDepth = __atomic_load_n (&(sender->nextFramesWriteIndex), __ATOMIC_ACQUIRE) - __atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE);
+    if (queueDepth > sender->congestionMaxQueueDepth)
+    {
+        sender->congestionMaxQueueDepth = queueDepth;
+    }
+
+    ARSAL_Time_GetTime (&now);
+    elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff (&(sender->congestionLastUpdate), &now);
+    if (elapsedMs >= ARSTREAM_SENDER_CONGESTION_UPDATE_INTERVAL_MS)
+    {
+        float loss = 0.f;
+        float baseRttMs = -1.f;
+        float smoothedRttMs;
+        int cnt;
+
+        /* Push the interval minimum round trip time into the history */
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        sender->congestionRttHistory [sender->congestionRttHistoryIndex] = sender->congestionIntervalMinRttMs;
+        sender->congestionRttHistoryIndex = (sender->congestionRttHistoryIndex + 1) % ARSTREAM_SENDER_CONGESTION_RTT_HISTORY_NB_INTERVALS;
+        sender->congestionIntervalMinRttMs = -1.f;
+        for (cnt = 0; cnt < ARSTREAM_SENDER_CONGESTION_RTT_HISTORY_NB_INTERVALS; cnt++)
+        {
+            float sample = sender->congestionRttHistory [cnt];
+            if ((sample >= 0.f) &&
+                ((baseRttMs < 0.f) || (sample < baseRttMs)))
+            {
+                baseRttMs = sample;
+            }
+        }
+        smoothedRttMs = (sender->rttNbSamples > 0) ? sender->rttSmoothedMs : -1.f;
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+
+        /* Do not update the target while the sender is idle */
+        if ((sender->congestionNbSent > 0) ||
+            (sender->congestionNbDropped > 0))
+        {
+            uint32_t newBitrate = sender->targetBitrate;
+            float deliveredBitrate = (8000.f * sender->congestionNbAckedBytes) / (1.f * elapsedMs);
+            float queuingDelayMs = ((baseRttMs >= 0.f) && (smoothedRttMs >= 0.f)) ? smoothedRttMs - baseRttMs : 0.f;
+            if (sender->congestionNbSent >= ARSTREAM_SENDER_CONGESTION_MIN_NB_FRAGMENTS)
+            {
+                loss = 1.f - ((1.f * sender->congestionNbAcked) / (1.f * sender->congestionNbSent));
+                loss = (loss < 0.f) ? 0.f : loss;
+            }
+
+            if ((loss > ARSTREAM_SENDER_CONGESTION_OVERUSE_LOSS) ||
+                (queuingDelayMs > ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUING_DELAY_MS) ||
+                (sender->congestionMaxQueueDepth > ARSTREAM_SENDER_CONGESTION_OVERUSE_QUEUE_DEPTH) ||
+                (sender->congestionNbDropped > 0))
+            {
+                float reference = (deliveredBitrate < sender->targetBitrate) ? deliveredBitrate : sender->targetBitrate;
+                newBitrate = (uint32_t)(ARSTREAM_SENDER_CONGESTION_DECREASE_FACTOR * reference);
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Link overused (loss %f, queuing delay %f ms, queue depth %d, %d frames dropped)", loss, queuingDelayMs, sender->congestionMaxQueueDepth, sender->congestionNbDropped);
+            }
+            else if (loss < ARSTREAM_SENDER_CONGESTION_UNDERUSE_LOSS)
+            {
+                float maxBitrate = ARSTREAM_SENDER_CONGESTION_MAX_DELIVERY_RATIO * deliveredBitrate;
+                float raisedBitrate = ARSTREAM_SENDER_CONGESTION_INCREASE_FACTOR * sender->targetBitrate;
+                if (raisedBitrate > maxBitrate)
+                {
+                    // Encoder does not use the current target, do not raise it
+                    raisedBitrate = (maxBitrate > sender->targetBitrate) ? maxBitrate : sender->targetBitrate;
+                }
+                newBitrate = (raisedBitrate < (1.f * sender->maxBitrate)) ? (uint32_t)raisedBitrate : sender->maxBitrate;
+            }
+            // No else : keep the current target
+
+            if (newBitrate < sender->minBitrate)
+            {
+                newBitrate = sender->minBitrate;
+            }
+            if (newBitrate > sender->maxBitrate)
+            {
+                newBitrate = sender->maxBitrate;
+            }
+            if (newBitrate != sender->targetBitrate)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Target bitrate %d -> %d (delivery rate %f)", sender->targetBitrate, newBitrate, deliveredBitrate);
+                __atomic_store_n (&(sender->targetBitrate), newBitrate, __ATOMIC_RELAXED);
+                retVal = 1;
+            }
+        }
+
+        *lossRate = loss;
+        *rttMs = (smoothedRttMs >= 0.f) ? (int)smoothedRttMs : -1;
+        sender->congestionLastUpdate = now;
+        sender->congestionNbSent = 0;
+        sender->congestionNbAcked = 0;
+        sender->congestionNbAckedBytes = 0;
+        sender->congestionNbDropped = 0;
+        sender->congestionMaxQueueDepth = 0;
+    }
+    return retVal;
+}
+
+static void ARSTREAM_Sender_PacingNewFrame (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Pacing_t *pacing, uint32_t nbBytes)
+{
+    struct timespec now;
+    float fraction = sender->pacingFrameIntervalFraction;
+    ARSAL_Time_GetTime (&now);
+    if (pacing->hasLastFrameTime == 1)
+    {
+        int sample = ARSAL_Time_ComputeTimespecMsTimeDiff (&(pacing->lastFrameTime), &now);
+        if ((sample > 0) &&
+            (sample <= ARSTREAM_SENDER_PACING_MAX_FRAME_INTERVAL_MS))
+        {
+            pacing->frameIntervalMs = (pacing->frameIntervalMs == 0.f) ? sample : (0.875f * pacing->frameIntervalMs) + (0.125f * sample);
+        }
+    }
+    pacing->lastFrameTime = now;
+    pacing->hasLastFrameTime = 1;
+
+    if (fraction > 0.f)
+    {
+        float rate = sender->targetBitrate / 8000.f;
+        int wasDisabled = (pacing->rateBytesPerMs == 0.f) ? 1 : 0;
+        if (pacing->frameIntervalMs > 0.f)
+        {
+            float frameRate = nbBytes / (fraction * pacing->frameIntervalMs);
+            rate = (frameRate > rate) ? frameRate : rate;
+        }
+        pacing->rateBytesPerMs = rate;
+        pacing->burstBytes = ARSTREAM_SENDER_PACING_BURST_MS * rate;
+        if (pacing->burstBytes < (1.f * ARSTREAM_SENDER_PACING_BURST_NB_FRAGMENTS * sender->maxFragmentSize))
+        {
+            pacing->burstBytes = 1.f * ARSTREAM_SENDER_PACING_BURST_NB_FRAGMENTS * sender->maxFragmentSize;
+        }
+        if (wasDisabled == 1)
+        {
+            // Pacing was just enabled, start with a full bucket
+            pacing->tokens = pacing->burstBytes;
+            pacing->lastRefill = now;
+        }
+    }
+    else
+    {
+        pacing->rateBytesPerMs = 0.f;
+    }
+}
+
+static int ARSTREAM_Sender_PacingCanSend (ARSTREAM_Sender_Pacing_t *pacing)
+{
+    struct timespec now;
+    int elapsedMs;
+    if (pacing->rateBytesPerMs == 0.f)
+    {
+        return 1;
+    }
+    ARSAL_Time_GetTime (&now);
+    elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff (&(pacing->lastRefill), &now);
+    if (elapsedMs > 0)
+    {
+        pacing->tokens += elapsedMs * pacing->rateBytesPerMs;
+        if (pacing->tokens > pacing->burstBytes)
+        {
+            pacing->tokens = pacing->burstBytes;
+        }
+        // Only account whole milliseconds, so the sub-millisecond part is not lost
+        pacing->lastRefill.tv_sec += elapsedMs / 1000;
+        pacing->lastRefill.tv_nsec += (elapsedMs % 1000) * 1000000L;
+        if (pacing->lastRefill.tv_nsec >= 1000000000L)
+        {
+            pacing->lastRefill.tv_sec++;
+            pacing->lastRefill.tv_nsec -= 1000000000L;
+        }
+    }
+    return (pacing->tokens > 0.f) ? 1 : 0;
+}
+
+static int ARSTREAM_Sender_PacingGetWaitMs (ARSTREAM_Sender_Pacing_t *pacing)
+{
+    int retVal = 1;
+    if ((pacing->rateBytesPerMs > 0.f) &&
+        (pacing->tokens <= 0.f))
+    {
+        retVal = (int)((-pacing->tokens) / pacing->rateBytesPerMs) + 1;
+    }
+    return retVal;
+}
+
+static void ARSTREAM_Sender_FragmentCellDone (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams, int wasSent)
+{
+    if ((cbParams->isParityFragment == 0) &&
+        (cbParams->frameNumber == sender->packetsToSend.frameNumber) &&
+        (cbParams->fragmentIndex >= 0) &&
+        ((uint32_t)cbParams->fragmentIndex < sender->maxNumberOfFragment))
+    {
+        ARSTREAM_Sender_FragmentStatus_t *status = &(sender->fragmentsStatus [cbParams->fragmentIndex]);
+        status->nbPending--;
+        if (wasSent == 1)
+        {
+            status->wasSent = 1;
+            ARSAL_Time_GetTime (&(status->lastSentTime));
+        }
+    }
+}
+
+static void ARSTREAM_Sender_UpdateAdaptiveRedundancy (ARSTREAM_Sender_t *sender)
+{
+    struct timespec now;
+    int minElapsedMs = (sender->rttNbSamples > 0) ? (int)sender->rttSmoothedMs : 0;
+    int cnt;
+    float loss;
+
+    ARSAL_Time_GetTime (&now);
+    for (cnt = 0; cnt < sender->currentFrameNbFragments; cnt++)
+    {
+        ARSTREAM_Sender_FragmentStatus_t *status = &(sender->fragmentsStatus [cnt]);
+        if ((status->wasSent == 1) &&
+            (ARSAL_Time_ComputeTimespecMsTimeDiff (&(status->lastSentTime), &now) >= minElapsedMs))
+        {
+            sender->adaptiveRedundancyNbChecked++;
+            if (0 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(sender->ackPacket), cnt))
+            {
+                sender->adaptiveRedundancyNbLost++;
+            }
+        }
+    }
+
+    sender->adaptiveRedundancyNbFrames++;
+    if ((sender->adaptiveRedundancyNbFrames < ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES) ||
+        (sender->adaptiveRedundancyNbChecked < ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_MIN_NB_FRAGMENTS))
+    {
+        return;
+    }
+    loss = (1.f * sender->adaptiveRedundancyNbLost) / (1.f * sender->adaptiveRedundancyNbChecked);
+    sender->adaptiveRedundancyNbFrames = 0;
+    sender->adaptiveRedundancyNbChecked = 0;
+    sender->adaptiveRedundancyNbLost = 0;
+
+    if (loss > ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_RAISE_LOSS)
+    {
+        sender->adaptiveRedundancyNbCleanWindows = 0;
+        if (sender->adaptiveRedundancyLevel < (int)ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_NB_LEVELS - 1)
+        {
+            sender->adaptiveRedundancyLevel++;
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Loss rate is %f, raising redundancy to level %d", loss, sender->adaptiveRedundancyLevel);
+        }
+    }
+    else if (loss < ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_CLEAN_LOSS)
+    {
+        sender->adaptiveRedundancyNbCleanWindows++;
+        if ((sender->adaptiveRedundancyNbCleanWindows >= ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_CLEAN_NB_WINDOWS) &&
+            (sender->adaptiveRedundancyLevel > 0))
+        {
+            sender->adaptiveRedundancyNbCleanWindows = 0;
+            sender->adaptiveRedundancyLevel--;
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Loss rate is %f, lowering redundancy to level %d", loss, sender->adaptiveRedundancyLevel);
+        }
+    }
+    else
+    {
+        sender->adaptiveRedundancyNbCleanWindows = 0;
+    }
+}
+
+static eARSTREAM_SENDER_REDUNDANCY ARSTREAM_Sender_GetFrameRedundancy (ARSTREAM_Sender_t *sender, int *fecBlockSize, int *fecNbParity)
+{
+    eARSTREAM_SENDER_REDUNDANCY retVal = sender->redundancy;
+    *fecBlockSize = sender->fecBlockSize;
+    *fecNbParity = sender->fecNbParity;
+    if (retVal == ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE)
+    {
+        const ARSTREAM_Sender_RedundancyLevel_t *level = &(ARSTREAM_Sender_AdaptiveRedundancyLevels [sender->adaptiveRedundancyLevel]);
+        retVal = level->redundancy;
+        *fecBlockSize = level->fecBlockSize;
+        *fecNbParity = level->fecNbParity;
+    }
+    if ((retVal == ARSTREAM_SENDER_REDUNDANCY_FEC) &&
+        (sender->peerUsesExtendedAcks == 0))
+    {
+        // Legacy readers would take parity fragments for data fragments
+        retVal = ARSTREAM_SENDER_REDUNDANCY_DUPLICATE;
+    }
+    return retVal;
+}
+
+static uint32_t ARSTREAM_Sender_FindNextNalUnit (uint8_t *frame, uint32_t size, uint32_t from)
+{
+    uint32_t index = from + 3;
+    while (index + 2 < size)
+    {
+        // Look at the third byte first, so most positions are skipped 3 bytes at a time
+        if (frame [index + 2] > 1)
+        {
+            index += 3;
+        }
+        else if (frame [index + 2] == 0)
+        {
+            index++;
+        }
+        else if ((frame [index] == 0) &&
+                 (frame [index + 1] == 0))
+        {
+            // Include the leading zero of a 4 bytes start code
+            return ((index > from + 3) && (frame [index - 1] == 0)) ? index - 1 : index;
+        }
+        else
+        {
+            index += 3;
+        }
+    }
+    return size;
+}
+
+static int ARSTREAM_Sender_ComputeFragmentsLayout (ARSTREAM_Sender_t *sender, int alignOnNalUnits)
+{
+    uint8_t *frame = sender->currentFrame.frameBuffer;
+    uint32_t size = sender->currentFrame.frameSize;
+    uint32_t maxFragSize = sender->maxFragmentSize;
+    uint32_t offset = 0;
+    int nbFragments = 0;
+
+    if (alignOnNalUnits == 0)
+    {
+        for (offset = 0; offset < size; offset += maxFragSize)
+        {
+            sender->fragmentsLayout [nbFragments].offset = offset;
+            sender->fragmentsLayout [nbFragments].size = ((size - offset) < maxFragSize) ? (size - offset) : maxFragSize;
+            sender->fragmentsLayout [nbFragments].naluFlags = 0;
+            nbFragments++;
+        }
+        return nbFragments;
+    }
+
+    {
+        uint32_t nextNalUnit = ARSTREAM_Sender_FindNextNalUnit (frame, size, 0);
+        int isNalUnitStart = 1;
+        while (offset < size)
+        {
+            ARSTREAM_Sender_FragmentLayout_t *layout;
+            uint32_t end;
+            if (nbFragments >= (int)sender->maxNumberOfFragment)
+            {
+                return -1;
             }
-            if (sender->numberOfWaitingFrames > 0)
+            layout = &(sender->fragmentsLayout [nbFragments]);
+            layout->naluFlags = (isNalUnitStart == 1) ? ARSTREAM_NETWORK_HEADERS_NALU_FLAG_START : 0;
+            if ((nextNalUnit - offset) > maxFragSize)
             {
-#if ENABLE_ACK_WAIT == 1
-                ARSTREAM_Sender_Frame_t *frame = &(sender->nextFrames [sender->indexGetNextFrame]);
-                // Give the next frame only if :
-                // 1> It's an high priority frame
-                // 2> The previous frame was fully acknowledged
-                if ((frame->isHighPriority == 1) ||
-                    (sender->currentFrameCbWasCalled == 1))
-#endif
+                // NAL unit does not fit, split it over several fragments
+                end = offset + maxFragSize;
+                isNalUnitStart = 0;
+            }
+            else
+            {
+                // End of the NAL unit, followed by as many complete NAL units as possible
+                end = nextNalUnit;
+                nextNalUnit = ARSTREAM_Sender_FindNextNalUnit (frame, size, end);
+                while ((isNalUnitStart == 1) &&
+                       (end < size) &&
+                       ((nextNalUnit - offset) <= maxFragSize))
                 {
-                    retVal = 1;
-                    sender->numberOfWaitingFrames--;
+                    end = nextNalUnit;
+                    nextNalUnit = ARSTREAM_Sender_FindNextNalUnit (frame, size, end);
                 }
+                layout->naluFlags |= ARSTREAM_NETWORK_HEADERS_NALU_FLAG_END;
+                isNalUnitStart = 1;
             }
+            layout->offset = offset;
+            layout->size = end - offset;
+            nbFragments++;
+            offset = end;
         }
     }
-    // If we got a new frame, copy it
-    if (retVal == 1)
+    return nbFragments;
+}
+
+static void ARSTREAM_Sender_SendParityFragments (ARSTREAM_Sender_t *sender, uint8_t *parityFragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int nbFragments, int lastFragmentSize, int fecBlockSize, int fecNbParity)
+{
+    ARSTREAM_NetworkHeaders_FragmentInfos_t parityInfos = *infos;
+    int nbParityFragments = ARSTREAM_Fec_GetNbParityFragments (nbFragments, fecBlockSize, fecNbParity);
+    int parityIndex;
+
+    parityInfos.frameFlags |= ARSTREAM_NETWORK_HEADERS_FLAG_FEC_PARITY;
+    parityInfos.fecBlockSize = fecBlockSize;
+    parityInfos.fecNbParity = fecNbParity;
+    parityInfos.fecLastFragmentSize = lastFragmentSize;
+
+    for (parityIndex = 0; parityIndex < nbParityFragments; parityIndex++)
     {
-        ARSTREAM_Sender_Frame_t *frame = &(sender->nextFrames [sender->indexGetNextFrame]);
-        sender->indexGetNextFrame++;
-        sender->indexGetNextFrame %= sender->maxNumberOfNextFrames;
+        eARNETWORK_ERROR netError = ARNETWORK_OK;
+        ARSTREAM_Sender_NetworkCallbackParam_t *cbParams = NULL;
+        int headerSize, paritySize = 0, tagSize;
+        int first, end, index;
+
+        parityInfos.fragmentNumber = parityIndex;
+        headerSize = ARSTREAM_Sender_WriteFragmentHeader (sender, parityFragment, &parityInfos);
+        ARSTREAM_Fec_GetProtectedFragments (parityIndex, nbFragments, fecBlockSize, fecNbParity, &first, &end);
+        for (index = first; index < end; index += fecNbParity)
+        {
+            int fragmentSize = (index == nbFragments - 1) ? lastFragmentSize : (int)sender->maxFragmentSize;
+            uint8_t *fragmentData = &(sender->currentFrame.frameBuffer)[sender->maxFragmentSize * index];
+            // Only the last fragment can be shorter, and it is always the last one of its parity group
+            if (index == first)
+            {
+                memcpy (&parityFragment [headerSize], fragmentData, fragmentSize);
+                paritySize = fragmentSize;
+            }
+            else
+            {
+                ARSTREAM_Fec_Xor (&parityFragment [headerSize], fragmentData, fragmentSize);
+            }
+        }
+        if (paritySize == 0)
+        {
+            continue;
+        }
+        tagSize = ARSTREAM_Sender_SealFragment (sender, parityFragment, &parityInfos, headerSize, paritySize);
 
-        newFrame->frameNumber = frame->frameNumber;
-        newFrame->frameBuffer = frame->frameBuffer;
-        newFrame->frameSize   = frame->frameSize;
-        newFrame->isHighPriority = frame->isHighPriority;
+        cbParams = ARSTREAM_Sender_AllocCallbackParam (sender);
+        if (cbParams == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Unable to allocate network callback params for parity fragment %d", parityIndex);
+            continue;
+        }
+        cbParams->sender = sender;
+        cbParams->fragmentIndex = parityIndex;
+        cbParams->frameNumber = sender->packetsToSend.frameNumber;
+        cbParams->isPrebuiltFragment = 0;
+        cbParams->isParityFragment = 1;
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+        netError = ARNETWORK_Manager_SendData (sender->manager, sender->dataBufferID, parityFragment, paritySize + headerSize + tagSize, (void *)cbParams, ARSTREAM_Sender_NetworkCallback, 1);
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        if (netError != ARNETWORK_OK)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error occurred during sending of the parity fragment ; error: %d : %s", netError, ARNETWORK_Error_ToString(netError));
+            ARSTREAM_Sender_FreeCallbackParam (sender, cbParams);
+        }
+        else
+        {
+            ARSTREAM_Stats_Add (&(sender->stats.nbParityFragmentsSent), 1);
+        }
     }
-    ARSAL_Mutex_Unlock (&(sender->nextFrameMutex));
-    return retVal;
 }
 
 eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Sender_NetworkCallback (int IoBufferId, uint8_t *dataPtr, void *customData, eARNETWORK_MANAGER_CALLBACK_STATUS status)
@@ -419,8 +1648,14 @@ eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Sender_NetworkCallback (int IoBuffer
     {
     case ARNETWORK_MANAGER_CALLBACK_STATUS_SENT:
         ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        ARSTREAM_Sender_ReleasePrebuiltFragment (sender, cbParams);
+        ARSTREAM_Sender_FragmentCellDone (sender, cbParams, 1);
         // Modify packetsToSend only if it refers to the frame we're sending
-        if (frameNumber == sender->packetsToSend.frameNumber)
+        if (cbParams->isParityFragment == 1)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Sent parity packet %d", packetIndex);
+        }
+        else if (frameNumber == sender->packetsToSend.frameNumber)
         {
             ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Sent packet %d", packetIndex);
             if (1 == ARSTREAM_NetworkHeaders_AckPacketUnsetFlag (&(sender->packetsToSend), packetIndex))
@@ -434,11 +1669,15 @@ eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Sender_NetworkCallback (int IoBuffer
         }
         ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
         /* Free cbParams */
-        free (cbParams);
+        ARSTREAM_Sender_FreeCallbackParam (sender, cbParams);
         break;
     case ARNETWORK_MANAGER_CALLBACK_STATUS_CANCEL:
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        ARSTREAM_Sender_ReleasePrebuiltFragment (sender, cbParams);
+        ARSTREAM_Sender_FragmentCellDone (sender, cbParams, 0);
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
         /* Free cbParams */
-        free (cbParams);
+        ARSTREAM_Sender_FreeCallbackParam (sender, cbParams);
         break;
     default:
         break;
@@ -446,21 +1685,125 @@ eARNETWORK_MANAGER_CALLBACK_RETURN ARSTREAM_Sender_NetworkCallback (int IoBuffer
     return retVal;
 }
 
+static ARSTREAM_Sender_NetworkCallbackParam_t* ARSTREAM_Sender_AllocCallbackParam (ARSTREAM_Sender_t *sender)
+{
+    ARSTREAM_Sender_NetworkCallbackParam_t *retParam = __atomic_load_n (&(sender->cbParamsFreeList), __ATOMIC_ACQUIRE);
+    // As the data thread is the only one to pop from the list, retParam can not
+    // be popped and pushed back by someone else, so retParam->nextFree is stable (no ABA)
+    while ((retParam != NULL) &&
+           (! __sync_bool_compare_and_swap (&(sender->cbParamsFreeList), retParam, retParam->nextFree)))
+    {
+        retParam = __atomic_load_n (&(sender->cbParamsFreeList), __ATOMIC_ACQUIRE);
+    }
+
+    if (retParam == NULL)
+    {
+        __sync_fetch_and_add (&(sender->cbParamsPoolMisses), 1);
+        retParam = malloc (sizeof (ARSTREAM_Sender_NetworkCallbackParam_t));
+        if (retParam != NULL)
+        {
+            retParam->isFromPool = 0;
+        }
+    }
+    return retParam;
+}
+
+static void ARSTREAM_Sender_FreeCallbackParam (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams)
+{
+    if (cbParams->isFromPool == 1)
+    {
+        ARSTREAM_Sender_NetworkCallbackParam_t *head;
+        do
+        {
+            head = __atomic_load_n (&(sender->cbParamsFreeList), __ATOMIC_ACQUIRE);
+            cbParams->nextFree = head;
+        } while (! __sync_bool_compare_and_swap (&(sender->cbParamsFreeList), head, cbParams));
+    }
+    else
+    {
+        free (cbParams);
+    }
+}
+
+static void ARSTREAM_Sender_ReleasePrebuiltFragment (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_NetworkCallbackParam_t *cbParams)
+{
+    if (cbParams->isPrebuiltFragment == 1)
+    {
+        sender->fragmentsInFlight [cbParams->fragmentIndex]--;
+        sender->nbFragmentsInFlight--;
+    }
+}
+
+static uint8_t* ARSTREAM_Sender_GetPrebuiltFragment (ARSTREAM_Sender_t *sender, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int fragmentSize)
+{
+    int fragmentIndex = infos->fragmentNumber;
+    uint8_t *fragment = &(sender->fragmentsBuffer [sender->fragmentsBufferStride * fragmentIndex]);
+    if (0 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(sender->fragmentsBuilt), fragmentIndex))
+    {
+        int headerSize;
+        if (sender->fragmentsInFlight [fragmentIndex] != 0)
+        {
+            // A network cell of a previous frame still points to this storage
+            return NULL;
+        }
+        headerSize = ARSTREAM_Sender_WriteFragmentHeader (sender, fragment, infos);
+        memcpy (&fragment [headerSize], &(sender->currentFrame.frameBuffer)[sender->fragmentsLayout [fragmentIndex].offset], fragmentSize);
+        // Sealed once, the retransmissions send the same bytes
+        ARSTREAM_Sender_SealFragment (sender, fragment, infos, headerSize, fragmentSize);
+        ARSTREAM_NetworkHeaders_AckPacketSetFlag (&(sender->fragmentsBuilt), fragmentIndex);
+    }
+    return fragment;
+}
+
+static int ARSTREAM_Sender_WriteFragmentHeader (ARSTREAM_Sender_t *sender, uint8_t *fragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos)
+{
+    if (sender->isEncrypted == 1)
+    {
+        // Random prefix, then the little endian fragment counter : a nonce is never used twice with a key
+        uint64_t counter = sender->cryptoNonceCounter++;
+        size_t index;
+        memcpy (infos->nonce, sender->cryptoNoncePrefix, sizeof (sender->cryptoNoncePrefix));
+        for (index = sizeof (sender->cryptoNoncePrefix); index < ARSTREAM_CRYPTO_NONCE_SIZE; index++)
+        {
+            infos->nonce [index] = (uint8_t)counter;
+            counter >>= 8;
+        }
+    }
+    return ARSTREAM_NetworkHeaders_DataHeaderWrite (fragment, infos);
+}
+
+static int ARSTREAM_Sender_SealFragment (ARSTREAM_Sender_t *sender, uint8_t *fragment, ARSTREAM_NetworkHeaders_FragmentInfos_t *infos, int headerSize, int dataSize)
+{
+    int retVal = 0;
+    if (sender->isEncrypted == 1)
+    {
+        // The headers are authenticated, but stay readable by the network
+        ARSTREAM_Crypto_Seal (&(sender->cryptoKey), infos->nonce, fragment, headerSize, &fragment [headerSize], dataSize, &fragment [headerSize + dataSize]);
+        retVal = ARSTREAM_CRYPTO_TAG_SIZE;
+    }
+    return retVal;
+}
 
 static void ARSTREAM_Sender_FrameWasAck (ARSTREAM_Sender_t *sender)
 {
+    ARSTREAM_Stats_AddLatency (sender->stats.ackLatency, ARSTREAM_SENDER_STATS_LATENCY_NB_BUCKETS, &(sender->currentFrame.queueTime));
     ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_SENT, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
     sender->currentFrameCbWasCalled = 1;
-    ARSAL_Mutex_Lock (&(sender->nextFrameMutex));
-    ARSAL_Cond_Signal (&(sender->nextFrameCond));
-    ARSAL_Mutex_Unlock (&(sender->nextFrameMutex));
+    ARSTREAM_Sender_WakeDataThread (sender);
 }
 
-static int ARSTREAM_Sender_SendLateAck (ARSTREAM_Sender_t *sender, uint16_t frameId)
+static int ARSTREAM_Sender_SendLateAck (ARSTREAM_Sender_t *sender, uint32_t frameId)
 {
     int retVal = 0;
-    int deltaNum = sender->currentFrame.frameNumber - frameId;
-    int index = (ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE + sender->previousFrameIndex - deltaNum) % ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE;
+    int32_t deltaNum = ARSTREAM_NetworkHeaders_FrameNumberDiff (sender->currentFrame.frameNumber, frameId);
+    int index;
+    if ((deltaNum < 0) ||
+        (deltaNum >= ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE))
+    {
+        // Too old (or reordered) ack, we don't keep the status of this frame anymore
+        return retVal;
+    }
+    index = (ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE + sender->previousFrameIndex - deltaNum) % ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE;
     if (sender->previousFramesStatus[index] == 0)
     {
         sender->previousFramesStatus[index] = 1;
@@ -481,10 +1824,207 @@ static void ARSTREAM_Sender_CallCallback (ARSTREAM_Sender_t *sender, eARSTREAM_S
 
     if (needToCall == 1)
     {
+        switch (status)
+        {
+        case ARSTREAM_SENDER_STATUS_FRAME_SENT:
+            ARSTREAM_Stats_Add (&(sender->stats.nbFramesSent), 1);
+            break;
+        case ARSTREAM_SENDER_STATUS_FRAME_CANCEL:
+            ARSTREAM_Stats_Add (&(sender->stats.nbFramesCancelled), 1);
+            break;
+        case ARSTREAM_SENDER_STATUS_FRAME_LATE_ACK:
+            ARSTREAM_Stats_Add (&(sender->stats.nbFramesLateAcked), 1);
+            break;
+        default:
+            break;
+        }
         sender->callback(status, framePointer, frameSize, sender->custom);
     }
 }
 
+static void ARSTREAM_Sender_MergeReceiverAck (ARSTREAM_Sender_t *sender, uint8_t receiverId, int isExtended, ARSTREAM_NetworkHeaders_AckPacket_t *packet)
+{
+    ARSTREAM_Sender_Receiver_t *receiver = NULL;
+    ARSTREAM_Sender_Receiver_t *freeReceiver = NULL;
+    struct timespec now;
+    int allUseExtendedAcks = 1;
+    int index;
+
+    /* Find the reader, and forget the readers which stopped sending acks */
+    ARSAL_Time_GetTime (&now);
+    for (index = 0; index < sender->maxNumberOfReceivers; index++)
+    {
+        ARSTREAM_Sender_Receiver_t *current = &(sender->receivers [index]);
+        if ((current->isActive == 1) &&
+            (current->receiverId != receiverId) &&
+            (ARSAL_Time_ComputeTimespecMsTimeDiff (&(current->lastAckTime), &now) > ARSTREAM_SENDER_FAN_OUT_RECEIVER_TIMEOUT_MS))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Reader %d timed out", current->receiverId);
+            current->isActive = 0;
+        }
+        if (current->isActive == 1)
+        {
+            if (current->receiverId == receiverId)
+            {
+                receiver = current;
+            }
+        }
+        else if (freeReceiver == NULL)
+        {
+            freeReceiver = current;
+        }
+        // No else : keep the first free entry
+    }
+    if ((receiver == NULL) &&
+        (freeReceiver != NULL))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "New reader %d", receiverId);
+        receiver = freeReceiver;
+        receiver->isActive = 1;
+        receiver->receiverId = receiverId;
+        receiver->ackPacket.frameNumber = packet->frameNumber;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(receiver->ackPacket));
+    }
+
+    if (receiver != NULL)
+    {
+        receiver->usesExtendedAcks = isExtended;
+        receiver->lastAckTime = now;
+        if (packet->frameNumber == sender->ackPacket.frameNumber)
+        {
+            if (receiver->ackPacket.frameNumber != packet->frameNumber)
+            {
+                receiver->ackPacket.frameNumber = packet->frameNumber;
+                ARSTREAM_NetworkHeaders_AckPacketReset (&(receiver->ackPacket));
+            }
+            ARSTREAM_NetworkHeaders_AckPacketSetFlags (&(receiver->ackPacket), packet);
+        }
+    }
+    else
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Too many readers, ignoring the acks of reader %d", receiverId);
+    }
+
+    /* Only keep the fragments acknowledged by all the readers */
+    ARSTREAM_NetworkHeaders_AckPacketResetUpTo (packet, 0);
+    for (index = 0; index < sender->maxNumberOfReceivers; index++)
+    {
+        ARSTREAM_Sender_Receiver_t *current = &(sender->receivers [index]);
+        if (current->isActive == 0)
+        {
+            continue;
+        }
+        if (current->ackPacket.frameNumber == sender->ackPacket.frameNumber)
+        {
+            ARSTREAM_NetworkHeaders_AckPacketKeepFlags (packet, &(current->ackPacket));
+        }
+        else
+        {
+            // The reader did not acknowledge any fragment of the current frame yet
+            ARSTREAM_NetworkHeaders_AckPacketReset (packet);
+        }
+        allUseExtendedAcks &= current->usesExtendedAcks;
+    }
+    if (packet->frameNumber != sender->ackPacket.frameNumber)
+    {
+        ARSTREAM_NetworkHeaders_AckPacketReset (packet);
+    }
+
+    if (sender->peerUsesExtendedAcks != allUseExtendedAcks)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "%s readers use extended acks, allowing up to %d fragments per frame", (allUseExtendedAcks == 1) ? "All" : "Not all",
+                     (allUseExtendedAcks == 1) ? ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME : ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME);
+        sender->peerUsesExtendedAcks = allUseExtendedAcks;
+    }
+}
+
+static void ARSTREAM_Sender_ProcessAckData (ARSTREAM_Sender_t *sender, uint8_t *recvData, int recvSize)
+{
+    ARSTREAM_NetworkHeaders_AckPacket_t recvPacket;
+    ARSTREAM_NetworkHeaders_AckPacket_t newAcks;
+    int recvFormat;
+    uint8_t receiverId;
+
+    ARSTREAM_NetworkHeaders_AckPacketReset (&recvPacket);
+    if ((recvFormat = ARSTREAM_NetworkHeaders_AckPacketFromNetwork (&recvPacket, recvData, recvSize, &receiverId)) < 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Read %d octets, which is not a valid ack packet", recvSize);
+    }
+    else
+    {
+        int nbNewAcks = 0;
+        int index;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&newAcks);
+        /* Apply recvPacket to sender->ackPacket if frame numbers are the same */
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        /* Acks only carry the lower 16 bits, and always refer to a frame close to the current one */
+        recvPacket.frameNumber = ARSTREAM_NetworkHeaders_FrameNumberExtend ((uint16_t)(recvPacket.frameNumber & 0xFFFF), sender->currentFrame.frameNumber);
+        if (sender->receivers != NULL)
+        {
+            /* Fan-out : only the fragments received by all the readers are acknowledged */
+            ARSTREAM_Sender_MergeReceiverAck (sender, receiverId, recvFormat, &recvPacket);
+        }
+        else if ((recvFormat == 1) &&
+                 (sender->peerUsesExtendedAcks == 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Reader uses extended acks, allowing up to %d fragments per frame", ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME);
+            sender->peerUsesExtendedAcks = 1;
+        }
+        if (sender->ackPacket.frameNumber == recvPacket.frameNumber)
+        {
+            /* Save the newly acknowledged fragments for the RTT estimation */
+            memcpy (&newAcks, &recvPacket, sizeof (newAcks));
+            ARSTREAM_NetworkHeaders_AckPacketUnsetFlags (&newAcks, &(sender->ackPacket));
+            nbNewAcks = sender->currentFrameNbFragments;
+            sender->congestionNbAcked += ARSTREAM_NetworkHeaders_AckPacketCountSet (&newAcks, nbNewAcks);
+            /* The last fragment of a frame is usually shorter : account the real sizes for the delivery rate */
+            for (index = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&newAcks, 0);
+                 (index >= 0) && (index < nbNewAcks);
+                 index = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&newAcks, index + 1))
+            {
+                sender->congestionNbAckedBytes += sender->fragmentsLayout [index].size;
+            }
+            ARSTREAM_NetworkHeaders_AckPacketSetFlags (&(sender->ackPacket), &recvPacket);
+            if ((sender->currentFrameCbWasCalled == 0) &&
+                (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&(sender->ackPacket), sender->currentFrameNbFragments) == 1))
+            {
+                ARSTREAM_Sender_FrameWasAck (sender);
+            }
+        }
+        else if (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&recvPacket, sender->maxNumberOfFragment) == 1)
+        {
+            ARSTREAM_Sender_SendLateAck (sender, recvPacket.frameNumber);
+        }
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+        if (nbNewAcks > 0)
+        {
+            ARSTREAM_Sender_UpdateRtt (sender, recvPacket.frameNumber, &newAcks, nbNewAcks);
+        }
+    }
+}
+
+static void ARSTREAM_Sender_StartEventLoops (ARSTREAM_Sender_t *sender)
+{
+    if ((sender->threadsShouldStop == 0) &&
+        (sender->dataThreadStarted == 0))
+    {
+        ARSTREAM_Sender_StartDataLoop (sender);
+        ARSTREAM_Sender_StartAckLoop (sender);
+    }
+}
+
+static void ARSTREAM_Sender_EndEventLoops (ARSTREAM_Sender_t *sender)
+{
+    if (sender->dataThreadStarted == 1)
+    {
+        ARSTREAM_Sender_EndDataLoop (sender);
+    }
+    if (sender->ackThreadStarted == 1)
+    {
+        ARSTREAM_Sender_EndAckLoop (sender);
+    }
+}
+
 /*
  * Implementation
  */
@@ -505,9 +2045,16 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
     int packetsToSendMutexWasInit = 0;
     int ackMutexWasInit = 0;
     int nextFrameMutexWasInit = 0;
+    int nextFrameCondMutexWasInit = 0;
     int nextFrameCondWasInit = 0;
     int nextFramesArrayWasCreated = 0;
     int previousFramesArrayWasCreated = 0;
+    int fragmentsBufferWasCreated = 0;
+    int fragmentsInFlightArrayWasCreated = 0;
+    int fragmentsStatusArrayWasCreated = 0;
+    int fragmentsLayoutArrayWasCreated = 0;
+    int cbParamsPoolWasCreated = 0;
+    int sendFragmentWasCreated = 0;
     eARSTREAM_ERROR internalError = ARSTREAM_OK;
     /* ARGS Check */
     if ((manager == NULL) ||
@@ -526,101 +2073,192 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
         internalError = ARSTREAM_ERROR_ALLOC;
     }
 
-    /* Copy parameters */
+    /* Copy parameters */
+    if (internalError == ARSTREAM_OK)
+    {
+        retSender->manager = manager;
+        retSender->dataBufferID = dataBufferID;
+        retSender->ackBufferID = ackBufferID;
+        retSender->callback = callback;
+        retSender->custom = custom;
+        retSender->maxNumberOfFragment = maxNumberOfFragment;
+        retSender->maxNumberOfNextFrames = framesBufferSize;
+        retSender->maxFragmentSize = maxFragmentSize;
+    }
+
+    /* Initialize internal config */
+    if (internalError == ARSTREAM_OK)
+    {
+        retSender->minRetryTimeMs = ARSTREAM_SENDER_DEFAULT_MINIMUM_TIME_BETWEEN_RETRIES_MS;
+        retSender->maxRetryTimeMs = ARSTREAM_SENDER_DEFAULT_MAXIMUM_TIME_BETWEEN_RETRIES_MS;
+    }
+
+    /* Setup internal mutexes/sems */
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->packetsToSendMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            packetsToSendMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->ackMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            ackMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->nextFrameMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            nextFrameMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->nextFrameCondMutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            nextFrameCondMutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int condInitRet = ARSAL_Cond_Init (&(retSender->nextFrameCond));
+        if (condInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            nextFrameCondWasInit = 1;
+        }
+    }
+
+    /* Allocate next frame storage */
     if (internalError == ARSTREAM_OK)
     {
-        retSender->manager = manager;
-        retSender->dataBufferID = dataBufferID;
-        retSender->ackBufferID = ackBufferID;
-        retSender->callback = callback;
-        retSender->custom = custom;
-        retSender->maxNumberOfFragment = maxNumberOfFragment;
-        retSender->maxNumberOfNextFrames = framesBufferSize;
-        retSender->maxFragmentSize = maxFragmentSize;
+        retSender->nextFrames = malloc (framesBufferSize * sizeof (ARSTREAM_Sender_Frame_t));
+        if (retSender->nextFrames == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            nextFramesArrayWasCreated = 1;
+        }
     }
 
-    /* Initialize internal config */
+    /* Allocate previous frame storage */
     if (internalError == ARSTREAM_OK)
     {
-        retSender->minRetryTimeMs = ARSTREAM_SENDER_DEFAULT_MINIMUM_TIME_BETWEEN_RETRIES_MS;
-        retSender->maxRetryTimeMs = ARSTREAM_SENDER_DEFAULT_MAXIMUM_TIME_BETWEEN_RETRIES_MS;
+        retSender->previousFramesStatus = calloc (ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE, sizeof (int));
+        if (retSender->previousFramesStatus == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            previousFramesArrayWasCreated = 1;
+        }
     }
 
-    /* Setup internal mutexes/sems */
+    /* Allocate prebuilt fragments storage */
     if (internalError == ARSTREAM_OK)
     {
-        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->packetsToSendMutex));
-        if (mutexInitRet != 0)
+        retSender->fragmentsBufferStride = maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE;
+        retSender->fragmentsBuffer = malloc (maxNumberOfFragment * retSender->fragmentsBufferStride);
+        if ((retSender->fragmentsBuffer == NULL) && (maxNumberOfFragment != 0))
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            packetsToSendMutexWasInit = 1;
+            fragmentsBufferWasCreated = 1;
         }
     }
     if (internalError == ARSTREAM_OK)
     {
-        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->ackMutex));
-        if (mutexInitRet != 0)
+        retSender->fragmentsInFlight = calloc (maxNumberOfFragment, sizeof (int));
+        if ((retSender->fragmentsInFlight == NULL) && (maxNumberOfFragment != 0))
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            ackMutexWasInit = 1;
+            fragmentsInFlightArrayWasCreated = 1;
         }
     }
     if (internalError == ARSTREAM_OK)
     {
-        int mutexInitRet = ARSAL_Mutex_Init (&(retSender->nextFrameMutex));
-        if (mutexInitRet != 0)
+        retSender->fragmentsStatus = calloc (maxNumberOfFragment, sizeof (ARSTREAM_Sender_FragmentStatus_t));
+        if ((retSender->fragmentsStatus == NULL) && (maxNumberOfFragment != 0))
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            nextFrameMutexWasInit = 1;
+            fragmentsStatusArrayWasCreated = 1;
         }
     }
     if (internalError == ARSTREAM_OK)
     {
-        int condInitRet = ARSAL_Cond_Init (&(retSender->nextFrameCond));
-        if (condInitRet != 0)
+        retSender->fragmentsLayout = calloc (maxNumberOfFragment, sizeof (ARSTREAM_Sender_FragmentLayout_t));
+        if ((retSender->fragmentsLayout == NULL) && (maxNumberOfFragment != 0))
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            nextFrameCondWasInit = 1;
+            fragmentsLayoutArrayWasCreated = 1;
         }
     }
 
-    /* Allocate next frame storage */
+    /* Allocate network callback params pool */
     if (internalError == ARSTREAM_OK)
     {
-        retSender->nextFrames = malloc (framesBufferSize * sizeof (ARSTREAM_Sender_Frame_t));
-        if (retSender->nextFrames == NULL)
+        retSender->cbParamsPool = malloc (ARSTREAM_SENDER_CALLBACK_PARAMS_POOL_SIZE (maxNumberOfFragment) * sizeof (ARSTREAM_Sender_NetworkCallbackParam_t));
+        if (retSender->cbParamsPool == NULL)
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            nextFramesArrayWasCreated = 1;
+            cbParamsPoolWasCreated = 1;
         }
     }
 
-    /* Allocate previous frame storage */
+    /* Allocate data loop scratch buffer */
     if (internalError == ARSTREAM_OK)
     {
-        retSender->previousFramesStatus = calloc (ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE, sizeof (int));
-        if (retSender->previousFramesStatus == NULL)
+        retSender->dataLoop.sendFragment = malloc (maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE);
+        if (retSender->dataLoop.sendFragment == NULL)
         {
             internalError = ARSTREAM_ERROR_ALLOC;
         }
         else
         {
-            previousFramesArrayWasCreated = 1;
+            sendFragmentWasCreated = 1;
         }
     }
 
@@ -632,16 +2270,94 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
         retSender->currentFrame.frameBuffer = NULL;
         retSender->currentFrame.frameSize   = 0;
         retSender->currentFrame.isHighPriority = 0;
+        retSender->currentFrame.frameClass = ARSTREAM_SENDER_FRAME_CLASS_P;
+        retSender->currentFrame.hasDeadline = 0;
+        retSender->currentFrame.hasCaptureTimestamp = 0;
+        retSender->currentFrame.captureTimestamp = 0;
+        memset (&(retSender->currentFrame.queueTime), 0, sizeof (retSender->currentFrame.queueTime));
         retSender->currentFrameNbFragments = 0;
         retSender->currentFrameCbWasCalled = 0;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(retSender->fragmentsBuilt));
+        retSender->peerUsesExtendedAcks = 0;
+        retSender->receivers = NULL;
+        retSender->maxNumberOfReceivers = 0;
+        retSender->isEncrypted = 0;
+        retSender->cryptoNonceCounter = 0;
+        retSender->nbFragmentsInFlight = 0;
+        retSender->rttSmoothedMs = 0.f;
+        retSender->rttVarianceMs = 0.f;
+        retSender->rttNbSamples = 0;
+        retSender->redundancy = ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE;
+        retSender->fragmentation = ARSTREAM_SENDER_FRAGMENTATION_FIXED;
+        retSender->queuePolicy = ARSTREAM_SENDER_QUEUE_POLICY_FAIL_WHEN_FULL;
+        retSender->fecBlockSize = 0;
+        retSender->fecNbParity = 0;
+        // Start with the highest level, which is the legacy behaviour
+        retSender->adaptiveRedundancyLevel = ARSTREAM_SENDER_ADAPTIVE_REDUNDANCY_NB_LEVELS - 1;
+        retSender->adaptiveRedundancyNbFrames = 0;
+        retSender->adaptiveRedundancyNbChecked = 0;
+        retSender->adaptiveRedundancyNbLost = 0;
+        retSender->adaptiveRedundancyNbCleanWindows = 0;
+        retSender->pacingFrameIntervalFraction = 0.f;
+        retSender->bitrateCallback = NULL;
+        retSender->minBitrate = ARSTREAM_SENDER_DEFAULT_MINIMUM_BITRATE;
+        retSender->maxBitrate = ARSTREAM_SENDER_DEFAULT_MAXIMUM_BITRATE;
+        retSender->targetBitrate = ARSTREAM_SENDER_DEFAULT_START_BITRATE;
+        ARSAL_Time_GetTime (&(retSender->congestionLastUpdate));
+        retSender->congestionNbSent = 0;
+        retSender->congestionNbAcked = 0;
+        retSender->congestionNbAckedBytes = 0;
+        retSender->congestionNbDropped = 0;
+        retSender->congestionMaxQueueDepth = 0;
+        retSender->congestionIntervalMinRttMs = -1.f;
+        for (i = 0; i < ARSTREAM_SENDER_CONGESTION_RTT_HISTORY_NB_INTERVALS; i++)
+        {
+            retSender->congestionRttHistory [i] = -1.f;
+        }
+        retSender->congestionRttHistoryIndex = 0;
+        retSender->cbParamsFreeList = NULL;
+        for (i = 0; i < (int)ARSTREAM_SENDER_CALLBACK_PARAMS_POOL_SIZE (maxNumberOfFragment); i++)
+        {
+            retSender->cbParamsPool [i].isFromPool = 1;
+            retSender->cbParamsPool [i].nextFree = retSender->cbParamsFreeList;
+            retSender->cbParamsFreeList = &(retSender->cbParamsPool [i]);
+        }
+        retSender->cbParamsPoolMisses = 0;
+        memset (&(retSender->stats), 0, sizeof (retSender->stats));
         retSender->nextFrameNumber = 0;
-        retSender->indexAddNextFrame = 0;
-        retSender->indexGetNextFrame = 0;
-        retSender->numberOfWaitingFrames = 0;
+        retSender->nextFramesWriteIndex = 0;
+        retSender->nextFramesReadIndex = 0;
+        retSender->preemptFrameNumber = 0;
+        retSender->dataThreadIsWaiting = 0;
         retSender->previousFrameIndex = 0;
         retSender->threadsShouldStop = 0;
         retSender->dataThreadStarted = 0;
         retSender->ackThreadStarted = 0;
+        retSender->ackImpairment = NULL;
+        ARSTREAM_ThreadConfig_Default (&(retSender->threadConfigs [ARSTREAM_THREAD_DATA]));
+        ARSTREAM_ThreadConfig_Default (&(retSender->threadConfigs [ARSTREAM_THREAD_ACK]));
+        retSender->dataLoop.sendSize = 0;
+        retSender->dataLoop.nbPackets = 0;
+        retSender->dataLoop.numbersOfFragmentsSentForCurrentFrame = 0;
+        retSender->dataLoop.lastFragmentSize = 0;
+        retSender->dataLoop.headerSize = 0;
+        retSender->dataLoop.tagSize = 0;
+        memset (&(retSender->dataLoop.fragmentInfos), 0, sizeof (retSender->dataLoop.fragmentInfos));
+        memset (&(retSender->dataLoop.nextFrame), 0, sizeof (retSender->dataLoop.nextFrame));
+        retSender->dataLoop.firstFrame = 1;
+        retSender->dataLoop.firstSendWasAccounted = 0;
+        retSender->dataLoop.nextRetryMs = 0;
+        retSender->dataLoop.frameRedundancy = ARSTREAM_SENDER_REDUNDANCY_NONE;
+        retSender->dataLoop.fecBlockSize = 0;
+        retSender->dataLoop.fecNbParity = 0;
+        retSender->dataLoop.parityToSend = 0;
+        retSender->dataLoop.sendStartIndex = 0;
+        retSender->dataLoop.lastPoppedFrameNumber = 0;
+        retSender->dataLoop.nextStepMs = 0;
+        retSender->ackPollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        memset (&(retSender->dataLoop.pacing), 0, sizeof (retSender->dataLoop.pacing));
+        retSender->wakeupCallback = NULL;
+        retSender->wakeupCustom = NULL;
         retSender->efficiency_index = 0;
         for (i = 0; i < ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES; i++)
         {
@@ -665,6 +2381,10 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
         {
             ARSAL_Mutex_Destroy (&(retSender->nextFrameMutex));
         }
+        if (nextFrameCondMutexWasInit == 1)
+        {
+            ARSAL_Mutex_Destroy (&(retSender->nextFrameCondMutex));
+        }
         if (nextFrameCondWasInit == 1)
         {
             ARSAL_Cond_Destroy (&(retSender->nextFrameCond));
@@ -677,6 +2397,30 @@ ARSTREAM_Sender_t* ARSTREAM_Sender_New (ARNETWORK_Manager_t *manager, int dataBu
         {
             free (retSender->previousFramesStatus);
         }
+        if (fragmentsBufferWasCreated == 1)
+        {
+            free (retSender->fragmentsBuffer);
+        }
+        if (fragmentsInFlightArrayWasCreated == 1)
+        {
+            free (retSender->fragmentsInFlight);
+        }
+        if (fragmentsStatusArrayWasCreated == 1)
+        {
+            free (retSender->fragmentsStatus);
+        }
+        if (fragmentsLayoutArrayWasCreated == 1)
+        {
+            free (retSender->fragmentsLayout);
+        }
+        if (cbParamsPoolWasCreated == 1)
+        {
+            free (retSender->cbParamsPool);
+        }
+        if (sendFragmentWasCreated == 1)
+        {
+            free (retSender->dataLoop.sendFragment);
+        }
         free (retSender);
         retSender = NULL;
     }
@@ -704,18 +2448,276 @@ eARSTREAM_ERROR ARSTREAM_Sender_SetTimeBetweenRetries (ARSTREAM_Sender_t *sender
     return err;
 }
 
+eARSTREAM_ERROR ARSTREAM_Sender_SetPacing (ARSTREAM_Sender_t *sender, float frameIntervalFraction)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL ||
+        !(frameIntervalFraction >= 0.f) ||
+        frameIntervalFraction > 1.f)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        sender->pacingFrameIntervalFraction = frameIntervalFraction;
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetBitrateCallback (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_BitrateCallback_t callback, uint32_t minBitrate, uint32_t maxBitrate, uint32_t startBitrate)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL ||
+        minBitrate == 0 ||
+        maxBitrate < minBitrate ||
+        startBitrate < minBitrate ||
+        startBitrate > maxBitrate)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        sender->bitrateCallback = callback;
+        sender->minBitrate = minBitrate;
+        sender->maxBitrate = maxBitrate;
+        __atomic_store_n (&(sender->targetBitrate), startBitrate, __ATOMIC_RELAXED);
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetRedundancy (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_REDUNDANCY redundancy, int nbDataFragments, int nbParityFragments)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL ||
+        redundancy < ARSTREAM_SENDER_REDUNDANCY_ADAPTIVE ||
+        redundancy >= ARSTREAM_SENDER_REDUNDANCY_MAX)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (redundancy == ARSTREAM_SENDER_REDUNDANCY_FEC &&
+             (nbDataFragments < 1 ||
+              nbDataFragments > UINT8_MAX ||
+              nbParityFragments < 1 ||
+              nbParityFragments > nbDataFragments))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        sender->redundancy = redundancy;
+        if (redundancy == ARSTREAM_SENDER_REDUNDANCY_FEC)
+        {
+            sender->fecBlockSize = nbDataFragments;
+            sender->fecNbParity = nbParityFragments;
+        }
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetFragmentation (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_FRAGMENTATION fragmentation)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL ||
+        fragmentation < ARSTREAM_SENDER_FRAGMENTATION_FIXED ||
+        fragmentation >= ARSTREAM_SENDER_FRAGMENTATION_MAX)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        sender->fragmentation = fragmentation;
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetQueuePolicy (ARSTREAM_Sender_t *sender, eARSTREAM_SENDER_QUEUE_POLICY policy)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL ||
+        policy < ARSTREAM_SENDER_QUEUE_POLICY_FAIL_WHEN_FULL ||
+        policy >= ARSTREAM_SENDER_QUEUE_POLICY_MAX)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->nextFrameMutex));
+        sender->queuePolicy = policy;
+        ARSAL_Mutex_Unlock (&(sender->nextFrameMutex));
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetFanOut (ARSTREAM_Sender_t *sender, int maxReceivers)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    ARSTREAM_Sender_Receiver_t *receivers = NULL;
+    if (sender == NULL ||
+        maxReceivers < 0 ||
+        maxReceivers > ARSTREAM_SENDER_FAN_OUT_MAX_RECEIVERS)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if ((sender->dataThreadStarted == 1) ||
+             (sender->ackThreadStarted == 1))
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if ((err == ARSTREAM_OK) &&
+        (maxReceivers > 0))
+    {
+        receivers = calloc (maxReceivers, sizeof (ARSTREAM_Sender_Receiver_t));
+        if (receivers == NULL)
+        {
+            err = ARSTREAM_ERROR_ALLOC;
+        }
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        free (sender->receivers);
+        sender->receivers = receivers;
+        sender->maxNumberOfReceivers = maxReceivers;
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return err;
+}
+
+int ARSTREAM_Sender_GetNbReceivers (ARSTREAM_Sender_t *sender)
+{
+    int retVal = -1;
+    if (sender != NULL)
+    {
+        struct timespec now;
+        int index;
+        retVal = 0;
+        ARSAL_Time_GetTime (&now);
+        ARSAL_Mutex_Lock (&(sender->ackMutex));
+        for (index = 0; index < sender->maxNumberOfReceivers; index++)
+        {
+            if ((sender->receivers [index].isActive == 1) &&
+                (ARSAL_Time_ComputeTimespecMsTimeDiff (&(sender->receivers [index].lastAckTime), &now) <= ARSTREAM_SENDER_FAN_OUT_RECEIVER_TIMEOUT_MS))
+            {
+                retVal++;
+            }
+        }
+        ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    }
+    return retVal;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetEncryptionKey (ARSTREAM_Sender_t *sender, const uint8_t *key, int keySize)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    uint8_t noncePrefix [sizeof (sender->cryptoNoncePrefix)];
+    if (sender == NULL ||
+        (key != NULL && keySize != ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (sender->dataThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if ((err == ARSTREAM_OK) &&
+        (key != NULL) &&
+        (ARSTREAM_Crypto_GetRandomBytes (noncePrefix, sizeof (noncePrefix)) != 0))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Unable to draw a random nonce prefix");
+        err = ARSTREAM_ERROR_ALLOC;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        ARSTREAM_Crypto_Wipe (&(sender->cryptoKey), sizeof (sender->cryptoKey));
+        sender->isEncrypted = 0;
+        if (key != NULL)
+        {
+            ARSTREAM_Crypto_SetKey (&(sender->cryptoKey), key);
+            memcpy (sender->cryptoNoncePrefix, noncePrefix, sizeof (noncePrefix));
+            sender->cryptoNonceCounter = 0;
+            sender->isEncrypted = 1;
+        }
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetAckImpairment (ARSTREAM_Sender_t *sender, ARSTREAM_Impairment_t *impairment)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if (sender == NULL)
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (sender->ackThreadStarted == 1)
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        sender->ackImpairment = impairment;
+    }
+    return err;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SetThreadConfig (ARSTREAM_Sender_t *sender, eARSTREAM_THREAD thread, const ARSTREAM_ThreadConfig_t *config)
+{
+    eARSTREAM_ERROR err = ARSTREAM_OK;
+    if ((sender == NULL) ||
+        (thread < 0) ||
+        (thread >= ARSTREAM_THREAD_MAX))
+    {
+        err = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else if (((thread == ARSTREAM_THREAD_DATA) && (sender->dataThreadStarted == 1)) ||
+             ((thread == ARSTREAM_THREAD_ACK) && (sender->ackThreadStarted == 1)))
+    {
+        err = ARSTREAM_ERROR_BUSY;
+    }
+
+    if (err == ARSTREAM_OK)
+    {
+        if (config != NULL)
+        {
+            sender->threadConfigs [thread] = *config;
+        }
+        else
+        {
+            ARSTREAM_ThreadConfig_Default (&(sender->threadConfigs [thread]));
+        }
+    }
+    return err;
+}
+
 void ARSTREAM_Sender_StopSender (ARSTREAM_Sender_t *sender)
 {
     if (sender != NULL)
     {
         sender->threadsShouldStop = 1;
+        // When stopping the sender, add a dummy flush frame in the queue
+        // in order to unlock the data thread. Without this, the thread might
+        // stop after sender->maxRetryTimeMs, instead of immediately. When this
+        // time is set to ARSTREAM_SENDER_INFINITE_TIME_BETWEEN_RETRIES, it means
+        // That the thread will be joinable 100 seconds after this call.
+        ARSTREAM_Sender_AddToQueue(sender, 0, NULL, ARSTREAM_SENDER_FRAME_CLASS_I, NULL, NULL);
     }
-    // When stopping the sender, add a dummy flush frame in the queue
-    // in order to unlock the data thread. Without this, the thread might
-    // stop after sender->maxRetryTimeMs, instead of immediately. When this
-    // time is set to ARSTREAM_SENDER_INFINITE_TIME_BETWEEN_RETRIES, it means
-    // That the thread will be joinable 100 seconds after this call.
-    ARSTREAM_Sender_AddToQueue(sender, 0, NULL, 1);
 }
 
 eARSTREAM_ERROR ARSTREAM_Sender_Delete (ARSTREAM_Sender_t **sender)
@@ -737,9 +2739,18 @@ eARSTREAM_ERROR ARSTREAM_Sender_Delete (ARSTREAM_Sender_t **sender)
             ARSAL_Mutex_Destroy (&((*sender)->packetsToSendMutex));
             ARSAL_Mutex_Destroy (&((*sender)->ackMutex));
             ARSAL_Mutex_Destroy (&((*sender)->nextFrameMutex));
+            ARSAL_Mutex_Destroy (&((*sender)->nextFrameCondMutex));
             ARSAL_Cond_Destroy (&((*sender)->nextFrameCond));
             free ((*sender)->nextFrames);
             free ((*sender)->previousFramesStatus);
+            free ((*sender)->fragmentsBuffer);
+            free ((*sender)->fragmentsInFlight);
+            free ((*sender)->fragmentsStatus);
+            free ((*sender)->fragmentsLayout);
+            free ((*sender)->cbParamsPool);
+            free ((*sender)->receivers);
+            free ((*sender)->dataLoop.sendFragment);
+            ARSTREAM_Crypto_Wipe (&((*sender)->cryptoKey), sizeof ((*sender)->cryptoKey));
             free (*sender);
             *sender = NULL;
             retVal = ARSTREAM_OK;
@@ -750,18 +2761,39 @@ eARSTREAM_ERROR ARSTREAM_Sender_Delete (ARSTREAM_Sender_t **sender)
             retVal = ARSTREAM_ERROR_BUSY;
         }
     }
-    return retVal;
+    return retVal;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrame (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, int flushPreviousFrames, int *nbPreviousFrames)
+{
+    // Args check
+    if ((flushPreviousFrames != 0) &&
+        (flushPreviousFrames != 1))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    return ARSTREAM_Sender_SendNewFrameWithDeadline (sender, frameBuffer, frameSize, (flushPreviousFrames == 1) ? ARSTREAM_SENDER_FRAME_CLASS_I : ARSTREAM_SENDER_FRAME_CLASS_P, NULL, nbPreviousFrames);
 }
 
-eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrame (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, int flushPreviousFrames, int *nbPreviousFrames)
+eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrameWithDeadline (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, int *nbPreviousFrames)
+{
+    return ARSTREAM_Sender_QueueNewFrame (sender, frameBuffer, frameSize, frameClass, deadline, NULL, nbPreviousFrames);
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrameWithTimestamp (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, uint32_t captureTimestamp, int *nbPreviousFrames)
+{
+    return ARSTREAM_Sender_QueueNewFrame (sender, frameBuffer, frameSize, frameClass, deadline, &captureTimestamp, nbPreviousFrames);
+}
+
+static eARSTREAM_ERROR ARSTREAM_Sender_QueueNewFrame (ARSTREAM_Sender_t *sender, uint8_t *frameBuffer, uint32_t frameSize, eARSTREAM_SENDER_FRAME_CLASS frameClass, const struct timespec *deadline, const uint32_t *captureTimestamp, int *nbPreviousFrames)
 {
     eARSTREAM_ERROR retVal = ARSTREAM_OK;
     // Args check
     if ((sender == NULL) ||
         (frameBuffer == NULL) ||
         (frameSize == 0) ||
-        ((flushPreviousFrames != 0) &&
-         (flushPreviousFrames != 1)))
+        (frameClass < ARSTREAM_SENDER_FRAME_CLASS_I) ||
+        (frameClass >= ARSTREAM_SENDER_FRAME_CLASS_MAX))
     {
         retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
     }
@@ -773,7 +2805,7 @@ eARSTREAM_ERROR ARSTREAM_Sender_SendNewFrame (ARSTREAM_Sender_t *sender, uint8_t
 
     if (retVal == ARSTREAM_OK)
     {
-        int res = ARSTREAM_Sender_AddToQueue (sender, frameSize, frameBuffer, flushPreviousFrames);
+        int res = ARSTREAM_Sender_AddToQueue (sender, frameSize, frameBuffer, frameClass, deadline, captureTimestamp);
         if (res < 0)
         {
             retVal = ARSTREAM_ERROR_QUEUE_FULL;
@@ -803,258 +2835,622 @@ eARSTREAM_ERROR ARSTREAM_Sender_FlushFramesQueue (ARSTREAM_Sender_t *sender)
     return retVal;
 }
 
-void* ARSTREAM_Sender_RunDataThread (void *ARSTREAM_Sender_t_Param)
+void ARSTREAM_Sender_StartDataLoop (ARSTREAM_Sender_t *sender)
 {
-    /* Local declarations */
-    ARSTREAM_Sender_t *sender = (ARSTREAM_Sender_t *)ARSTREAM_Sender_t_Param;
-    uint8_t *sendFragment = NULL;
-    uint32_t sendSize = 0;
-    uint16_t nbPackets = 0;
-    int cnt;
-    int numbersOfFragmentsSentForCurrentFrame = 0;
-    int lastFragmentSize = 0;
-    ARSTREAM_NetworkHeaders_DataHeader_t *header = NULL;
-    ARSTREAM_Sender_Frame_t nextFrame = {0};
-    int firstFrame = 1;
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Sender thread running");
+    sender->dataThreadStarted = 1;
+}
 
-    /* Parameters check */
-    if (sender == NULL)
+int ARSTREAM_Sender_StepDataLoop (ARSTREAM_Sender_t *sender, int waitMs, int maxFragments)
+{
+    ARSTREAM_Sender_DataLoop_t *loop = &(sender->dataLoop);
+    int cnt;
+    int startIndex;
+    int waitRes;
+    int isPaced;
+    int isOverBudget;
+    int isPreempted;
+    int firstPassIsOverBudget;
+    int nbSentInStep = 0;
+    int bitrateChanged;
+    ARSTREAM_Sender_BitrateCallback_t bitrateCallback;
+    uint32_t bitrateTarget;
+    float bitrateLossRate = 0.f;
+    int bitrateRttMs = -1;
+
+    if (sender->threadsShouldStop != 0)
     {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error while starting %s, bad parameters", __FUNCTION__);
-        return (void *)0;
+        return -1;
     }
-
-    /* Alloc and check */
-    sendFragment = malloc (sender->maxFragmentSize + sizeof (ARSTREAM_NetworkHeaders_DataHeader_t));
-    if (sendFragment == NULL)
+    waitRes = ARSTREAM_Sender_PopFromQueue (sender, &(loop->nextFrame), waitMs);
+    // Check again if we should be stopping (after the wait).
+    // If we're trying to send the dummy frame from ARSTREAM_Sender_StopSender
+    // we need to make sure that we never dereference the pointer, as its NULL
+    if (sender->threadsShouldStop != 0)
     {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error while starting %s, can not alloc memory", __FUNCTION__);
-        return (void *)0;
+        return -1;
     }
-    header = (ARSTREAM_NetworkHeaders_DataHeader_t *)sendFragment;
-
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Sender thread running");
-    sender->dataThreadStarted = 1;
-
-    while (sender->threadsShouldStop == 0)
+    if (waitRes == 1)
+    {
+        loop->lastPoppedFrameNumber = loop->nextFrame.frameNumber;
+    }
+    ARSAL_Mutex_Lock (&(sender->ackMutex));
+    if ((waitRes == 1) &&
+        (ARSTREAM_Sender_AcceptPoppedFrame (sender, &(loop->nextFrame), loop->firstFrame) == 0))
+    {
+        waitRes = 0;
+    }
+    if (waitRes == 1)
     {
-        int waitRes;
-        waitRes = ARSTREAM_Sender_PopFromQueue (sender, &nextFrame);
-        // Check again if we should be stopping (after the wait).
-        // If we're trying to send the dummy frame from ARSTREAM_Sender_StopSender
-        // we need to make sure that we never dereference the pointer, as its NULL
-        if (sender->threadsShouldStop != 0)
+        int previousWasAck = 1;
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Previous frame was sent in %d packets. Frame size was %d packets", loop->numbersOfFragmentsSentForCurrentFrame, loop->nbPackets);
+        sender->efficiency_nbFragments [sender->efficiency_index ] = loop->nbPackets;
+        sender->efficiency_nbSent [sender->efficiency_index] = loop->numbersOfFragmentsSentForCurrentFrame;
+        loop->numbersOfFragmentsSentForCurrentFrame = 0;
+        /* We have a new frame to send */
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "New frame needs to be sent");
+        sender->efficiency_index ++;
+        sender->efficiency_index %= ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES;
+        sender->efficiency_nbSent [sender->efficiency_index] = 0;
+        sender->efficiency_nbFragments [sender->efficiency_index] = 0;
+
+        /* Cancel current frame if it was not already sent */
+        /* Do not do it for the first "NULL" frame that is in the
+         * ARStream Sender before any call to SendNewFrame */
+        if (sender->currentFrameCbWasCalled == 0 && loop->firstFrame == 0)
         {
-            break;
-        }
-        ARSAL_Mutex_Lock (&(sender->ackMutex));
-        if (waitRes == 1)
-        {
-            int previousWasAck = 1;
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Previous frame was sent in %d packets. Frame size was %d packets", numbersOfFragmentsSentForCurrentFrame, nbPackets);
-            sender->efficiency_nbFragments [sender->efficiency_index ] = nbPackets;
-            sender->efficiency_nbSent [sender->efficiency_index] = numbersOfFragmentsSentForCurrentFrame;
-            numbersOfFragmentsSentForCurrentFrame = 0;
-            /* We have a new frame to send */
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "New frame needs to be sent");
-            sender->efficiency_index ++;
-            sender->efficiency_index %= ARSTREAM_SENDER_EFFICIENCY_AVERAGE_NB_FRAMES;
-            sender->efficiency_nbSent [sender->efficiency_index] = 0;
-            sender->efficiency_nbFragments [sender->efficiency_index] = 0;
-
-            /* Cancel current frame if it was not already sent */
-            /* Do not do it for the first "NULL" frame that is in the
-             * ARStream Sender before any call to SendNewFrame */
-            if (sender->currentFrameCbWasCalled == 0 && firstFrame == 0)
-            {
 #ifdef DEBUG
-                ARSTREAM_NetworkHeaders_AckPacketDump ("Cancel frame:", &(sender->ackPacket));
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Receiver acknowledged %d of %d packets", ARSTREAM_NetworkHeaders_AckPacketCountSet (&(sender->ackPacket), nbPackets), nbPackets);
+            ARSTREAM_NetworkHeaders_AckPacketDump ("Cancel frame:", &(sender->ackPacket));
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Receiver acknowledged %d of %d packets", ARSTREAM_NetworkHeaders_AckPacketCountSet (&(sender->ackPacket), loop->nbPackets), loop->nbPackets);
 #endif
 
-                previousWasAck = 0;
-                ARNETWORK_Manager_FlushInputBuffer (sender->manager, sender->dataBufferID);
+            previousWasAck = 0;
+            sender->congestionNbDropped++;
+            ARNETWORK_Manager_FlushInputBuffer (sender->manager, sender->dataBufferID);
 
-                ARSTREAM_Sender_CallCallback(sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
-            }
-            sender->currentFrameCbWasCalled = 0; // New frame
-            firstFrame = 0;
-
-            /* Save next frame data into current frame data */
-            sender->currentFrame.frameNumber = nextFrame.frameNumber;
-            sender->currentFrame.frameBuffer = nextFrame.frameBuffer;
-            sender->currentFrame.frameSize   = nextFrame.frameSize;
-            sender->currentFrame.isHighPriority = nextFrame.isHighPriority;
-            sendSize = nextFrame.frameSize;
-
-            sender->previousFramesStatus[sender->previousFrameIndex] = previousWasAck;
-            sender->previousFrameIndex = (sender->previousFrameIndex + 1) % ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE;
+            ARSTREAM_Sender_CallCallback(sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
+        }
+        sender->currentFrameCbWasCalled = 0; // New frame
+        loop->firstFrame = 0;
+
+        /* Save next frame data into current frame data */
+        sender->currentFrame.frameNumber = loop->nextFrame.frameNumber;
+        sender->currentFrame.frameBuffer = loop->nextFrame.frameBuffer;
+        sender->currentFrame.frameSize   = loop->nextFrame.frameSize;
+        sender->currentFrame.isHighPriority = loop->nextFrame.isHighPriority;
+        sender->currentFrame.frameClass = loop->nextFrame.frameClass;
+        sender->currentFrame.hasDeadline = loop->nextFrame.hasDeadline;
+        sender->currentFrame.deadline = loop->nextFrame.deadline;
+        sender->currentFrame.hasCaptureTimestamp = loop->nextFrame.hasCaptureTimestamp;
+        sender->currentFrame.captureTimestamp = loop->nextFrame.captureTimestamp;
+        sender->currentFrame.queueTime = loop->nextFrame.queueTime;
+        loop->firstSendWasAccounted = 0;
+        loop->sendSize = loop->nextFrame.frameSize;
+
+        sender->previousFramesStatus[sender->previousFrameIndex] = previousWasAck;
+        sender->previousFrameIndex = (sender->previousFrameIndex + 1) % ARSTREAM_SENDER_PREVIOUS_FRAME_NB_SAVE;
+
+
+        /* Account the losses of the previous frame before forgetting its acks */
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        ARSTREAM_Sender_UpdateAdaptiveRedundancy (sender);
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
 
+        /* Reset ack packet - No packets are ack on the new frame */
+        sender->ackPacket.frameNumber = sender->currentFrame.frameNumber;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->ackPacket));
 
-            /* Reset ack packet - No packets are ack on the new frame */
-            sender->ackPacket.frameNumber = sender->currentFrame.frameNumber;
-            ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->ackPacket));
+        /* Drop any network cell of the previous frame, as it can't be useful anymore
+         * This also allows the new frame to reuse the prebuilt fragments storage */
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        int needFlush = (sender->nbFragmentsInFlight > 0) ? 1 : 0;
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+        if ((needFlush == 1) && (previousWasAck == 1))
+        {
+            ARNETWORK_Manager_FlushInputBuffer (sender->manager, sender->dataBufferID);
+        }
 
-            /* Reset packetsToSend - update frame number */
-            ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
-            sender->packetsToSend.frameNumber = sender->currentFrame.frameNumber;
-            ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->packetsToSend));
-            ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+        /* Reset packetsToSend - update frame number */
+        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+        sender->packetsToSend.frameNumber = sender->currentFrame.frameNumber;
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->packetsToSend));
+        ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->fragmentsBuilt));
+        memset (sender->fragmentsStatus, 0, sender->currentFrameNbFragments * sizeof (ARSTREAM_Sender_FragmentStatus_t));
+        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
 
-            /* Update stream data header with the new frame number */
-            header->frameNumber = sender->currentFrame.frameNumber;
-            header->frameFlags = 0;
-            header->frameFlags |= (sender->currentFrame.isHighPriority != 0) ? ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME : 0;
+        /* Update stream data header with the new frame number */
+        loop->fragmentInfos.frameNumber = sender->currentFrame.frameNumber;
+        loop->fragmentInfos.frameFlags = ARSTREAM_NETWORK_HEADERS_FLAG_EXT_ACK_CAPABLE;
+        loop->fragmentInfos.frameFlags |= (sender->currentFrame.isHighPriority != 0) ? ARSTREAM_NETWORK_HEADERS_FLAG_FLUSH_FRAME : 0;
+        loop->fragmentInfos.frameFlags |= (sender->isEncrypted == 1) ? ARSTREAM_NETWORK_HEADERS_FLAG_ENCRYPTED : 0;
+        loop->tagSize = (sender->isEncrypted == 1) ? ARSTREAM_CRYPTO_TAG_SIZE : 0;
+        loop->fragmentInfos.captureTimestamp = sender->currentFrame.captureTimestamp;
+        if ((sender->peerUsesExtendedAcks == 1) ||
+            (sender->isEncrypted == 1))
+        {
+            /* Header extensions are only understood by readers with extended acks (which all readers of an encrypted stream are)
+             * The 32 bits frame numbers of an encrypted stream never wrap, so the readers can reject the replayed fragments */
+            loop->fragmentInfos.frameFlags |= ARSTREAM_NETWORK_HEADERS_FLAG_EXT_FRAME_NUMBER;
+            loop->fragmentInfos.frameFlags |= (sender->currentFrame.hasCaptureTimestamp == 1) ? ARSTREAM_NETWORK_HEADERS_FLAG_CAPTURE_TIMESTAMP : 0;
+        }
 
-            /* Compute number of fragments / size of the last fragment */
-            if (0 < sendSize)
+        /* Compute the fragments / size of the last fragment
+         * NAL units aligned fragments use a header extension, which is only understood by readers with extended acks */
+        if (0 < loop->sendSize)
+        {
+            int nbFragments = -1;
+            if ((sender->fragmentation == ARSTREAM_SENDER_FRAGMENTATION_NAL_UNITS) &&
+                (sender->peerUsesExtendedAcks == 1))
             {
-                uint32_t maxFragSize = sender->maxFragmentSize;
-                lastFragmentSize = maxFragSize;
-                nbPackets = sendSize / maxFragSize;
-                if (sendSize % maxFragSize)
+                nbFragments = ARSTREAM_Sender_ComputeFragmentsLayout (sender, 1);
+                if (nbFragments < 0)
+                {
+                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Frame %d needs too many fragments once aligned on NAL units, using fixed size fragments", sender->currentFrame.frameNumber);
+                }
+                else
                 {
-                    nbPackets++;
-                    lastFragmentSize = sendSize % maxFragSize;
+                    loop->fragmentInfos.frameFlags |= ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED;
                 }
             }
-            sender->currentFrameNbFragments = nbPackets;
+            if (nbFragments < 0)
+            {
+                nbFragments = ARSTREAM_Sender_ComputeFragmentsLayout (sender, 0);
+            }
+            loop->nbPackets = nbFragments;
+            loop->lastFragmentSize = sender->fragmentsLayout [nbFragments - 1].size;
+        }
+        /* Frames with more than 128 fragments can only be sent to readers which use extended acks */
+        if ((loop->nbPackets > ARSTREAM_NETWORK_HEADERS_LEGACY_MAX_FRAGMENTS_PER_FRAME) &&
+            (sender->peerUsesExtendedAcks == 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSTREAM_SENDER_TAG, "Frame %d needs %d fragments, but the reader did not use extended acks yet. Cancelling it", sender->currentFrame.frameNumber, loop->nbPackets);
+            ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
+            sender->currentFrameCbWasCalled = 1;
+            loop->nbPackets = 0;
+        }
+        sender->currentFrameNbFragments = loop->nbPackets;
 
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "New frame has size %d (=%d packets)", sendSize, nbPackets);
+        /* Select the redundancy of the frame (flush frames are retried until acknowledged) */
+        loop->frameRedundancy = ARSTREAM_SENDER_REDUNDANCY_NONE;
+        if (sender->currentFrame.isHighPriority == 0)
+        {
+            loop->frameRedundancy = ARSTREAM_Sender_GetFrameRedundancy (sender, &(loop->fecBlockSize), &(loop->fecNbParity));
+        }
+        if ((loop->frameRedundancy == ARSTREAM_SENDER_REDUNDANCY_FEC) &&
+            ((loop->fragmentInfos.frameFlags & ARSTREAM_NETWORK_HEADERS_FLAG_NALU_ALIGNED) != 0))
+        {
+            // Parity fragments protect fixed size fragments, fall back to duplicates (as for legacy readers)
+            loop->frameRedundancy = ARSTREAM_SENDER_REDUNDANCY_DUPLICATE;
+        }
+        loop->parityToSend = ((loop->frameRedundancy == ARSTREAM_SENDER_REDUNDANCY_FEC) && (loop->nbPackets > 0)) ? 1 : 0;
+        {
+            uint32_t firstPassBytes = loop->sendSize + (loop->nbPackets * ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE);
+            if (loop->frameRedundancy == ARSTREAM_SENDER_REDUNDANCY_DUPLICATE)
+            {
+                firstPassBytes *= 2;
+            }
+            else if (loop->parityToSend == 1)
+            {
+                firstPassBytes += ARSTREAM_Fec_GetNbParityFragments (loop->nbPackets, loop->fecBlockSize, loop->fecNbParity) * (sender->maxFragmentSize + ARSTREAM_NETWORK_HEADERS_DATA_OVERHEAD_MAX_SIZE);
+            }
+            // No else : no redundancy
+            ARSTREAM_Sender_PacingNewFrame (sender, &(loop->pacing), firstPassBytes);
         }
-        ARSAL_Mutex_Unlock (&(sender->ackMutex));
-        /* END OF NEW FRAME BLOCK */
 
-        /* Flag all non-ack packets as "packet to send" */
-        ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
-        ARSAL_Mutex_Lock (&(sender->ackMutex));
-        ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->packetsToSend));
-        for (cnt = 0; cnt < nbPackets; cnt++)
+        loop->fragmentInfos.fragmentNumber = 0;
+        loop->sendStartIndex = 0;
+        loop->fragmentInfos.fragmentsPerFrame = loop->nbPackets;
+        loop->headerSize = ARSTREAM_NetworkHeaders_DataHeaderWrite (loop->sendFragment, &(loop->fragmentInfos));
+
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "New frame has size %d (=%d packets)", loop->sendSize, loop->nbPackets);
+    }
+
+    /* Stop sending the current frame once it missed its deadline */
+    if ((sender->currentFrameCbWasCalled == 0) &&
+        (loop->firstFrame == 0) &&
+        (ARSTREAM_Sender_GetMsBeforeDeadline (&(sender->currentFrame)) <= 0))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Frame %d missed its deadline, cancelling it", sender->currentFrame.frameNumber);
+        ARNETWORK_Manager_FlushInputBuffer (sender->manager, sender->dataBufferID);
+        ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
+        sender->currentFrameCbWasCalled = 1;
+        sender->congestionNbDropped++;
+        loop->parityToSend = 0;
+    }
+    bitrateChanged = ARSTREAM_Sender_UpdateCongestion (sender, &bitrateLossRate, &bitrateRttMs);
+    bitrateCallback = sender->bitrateCallback;
+    bitrateTarget = sender->targetBitrate;
+    ARSAL_Mutex_Unlock (&(sender->ackMutex));
+    /* END OF NEW FRAME BLOCK */
+
+    /* Publish the new target bitrate outside of the locks, so the callback can use the sender API */
+    if ((bitrateChanged == 1) &&
+        (bitrateCallback != NULL))
+    {
+        bitrateCallback (bitrateTarget, bitrateLossRate, bitrateRttMs, sender->custom);
+    }
+
+    /* Flag all non-ack packets which are overdue as "packet to send" */
+    ARSAL_Mutex_Lock (&(sender->ackMutex));
+    ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+    ARSTREAM_NetworkHeaders_AckPacketReset (&(sender->packetsToSend));
+    {
+        struct timespec now;
+        ARSTREAM_NetworkHeaders_AckPacket_t notAcked;
+        int rto = ARSTREAM_Sender_GetRetransmissionTimeout (sender);
+        ARSAL_Time_GetTime (&now);
+        loop->nextRetryMs = rto;
+        if (sender->currentFrameCbWasCalled == 0)
         {
-            if (0 == ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(sender->ackPacket), cnt))
+            ARSTREAM_NetworkHeaders_AckPacketSetMissingFlags (&notAcked, &(sender->ackPacket), loop->nbPackets);
+        }
+        else
+        {
+            // Frame is acknowledged or cancelled, nothing more to send
+            ARSTREAM_NetworkHeaders_AckPacketReset (&notAcked);
+        }
+        // Only visit the fragments which are not acknowledged yet
+        for (cnt = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&notAcked, 0);
+             cnt >= 0;
+             cnt = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&notAcked, cnt + 1))
+        {
+            ARSTREAM_Sender_FragmentStatus_t *status = &(sender->fragmentsStatus [cnt]);
+            int elapsed;
+            if (status->nbPending > 0)
+            {
+                // Fragment still waiting in the network queue
+                continue;
+            }
+            elapsed = (status->wasSent == 0) ? rto : ARSAL_Time_ComputeTimespecMsTimeDiff (&(status->lastSentTime), &now);
+            if (elapsed >= rto)
             {
                 ARSTREAM_NetworkHeaders_AckPacketSetFlag (&(sender->packetsToSend), cnt);
             }
+            else if ((rto - elapsed) < loop->nextRetryMs)
+            {
+                loop->nextRetryMs = rto - elapsed;
+            }
+        }
+        if (sender->currentFrameCbWasCalled == 0)
+        {
+            // Wake up in time to drop the frame at its deadline
+            int msBeforeDeadline = ARSTREAM_Sender_GetMsBeforeDeadline (&(sender->currentFrame));
+            if (msBeforeDeadline < loop->nextRetryMs)
+            {
+                loop->nextRetryMs = msBeforeDeadline;
+            }
+        }
+        if (loop->nextRetryMs < 1)
+        {
+            loop->nextRetryMs = 1;
         }
+    }
 
-        /* Send all "packets to send" */
-        for (cnt = 0; cnt < nbPackets; cnt++)
+    /* Send all "packets to send" */
+    isPaced = 0;
+    isOverBudget = 0;
+    isPreempted = 0;
+    firstPassIsOverBudget = 0;
+    // Resume an interrupted pass, so the first fragments can not starve the others
+    startIndex = loop->sendStartIndex;
+    for (cnt = ARSTREAM_Sender_NextFragmentToSend (sender, startIndex, -1);
+         cnt >= 0;
+         cnt = ARSTREAM_Sender_NextFragmentToSend (sender, startIndex, cnt))
+    {
+        if (ARSTREAM_Sender_IsPreempted (sender) == 1)
+        {
+            // A flush frame is waiting, and will cancel the current frame :
+            // stop the burst now, and pop the flush frame on the next step
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Frame %d preempted by a flush frame", sender->currentFrame.frameNumber);
+            ARSTREAM_Stats_Add (&(sender->stats.nbFramesPreempted), 1);
+            isPreempted = 1;
+            break;
+        }
+        if (ARSTREAM_Sender_PacingCanSend (&(loop->pacing)) == 0)
+        {
+            // Token bucket is empty : the remaining fragments are still not sent,
+            // so they will be flagged again on the next loop
+            isPaced = 1;
+            loop->sendStartIndex = cnt;
+            break;
+        }
+        if ((maxFragments > 0) &&
+            (nbSentInStep >= maxFragments))
+        {
+            // Same for the step budget. The first send pass of the fragments
+            // continues on the next step, while the retries keep their timer
+            isOverBudget = 1;
+            firstPassIsOverBudget = (sender->fragmentsStatus [cnt].nbSendPasses == 0) ? 1 : 0;
+            loop->sendStartIndex = cnt;
+            break;
+        }
+        nbSentInStep++;
+        int nbSend = (loop->frameRedundancy == ARSTREAM_SENDER_REDUNDANCY_DUPLICATE) ? 2 : 1;
+        int sendIndex;
+        int isRetransmission;
+        ARSTREAM_Sender_FragmentLayout_t *layout = &(sender->fragmentsLayout [cnt]);
+        int currFragmentSize = layout->size;
+        uint8_t *fragment = NULL;
+        int doDataCopy = 0;
+        loop->fragmentInfos.fragmentNumber = cnt;
+        loop->fragmentInfos.fragmentOffset = layout->offset;
+        loop->fragmentInfos.naluFlags = layout->naluFlags;
+        fragment = ARSTREAM_Sender_GetPrebuiltFragment (sender, &(loop->fragmentInfos), currFragmentSize);
+        loop->numbersOfFragmentsSentForCurrentFrame ++;
+        sender->congestionNbSent++;
+        if (fragment == NULL)
+        {
+            // Prebuilt storage is still in use, build the fragment in the
+            // scratch buffer, and let the network copy it
+            ARSTREAM_Sender_WriteFragmentHeader (sender, loop->sendFragment, &(loop->fragmentInfos));
+            memcpy (&(loop->sendFragment)[loop->headerSize], &(sender->currentFrame.frameBuffer)[layout->offset], currFragmentSize);
+            ARSTREAM_Sender_SealFragment (sender, loop->sendFragment, &(loop->fragmentInfos), loop->headerSize, currFragmentSize);
+            fragment = loop->sendFragment;
+            doDataCopy = 1;
+        }
+        isRetransmission = (sender->fragmentsStatus [cnt].nbSendPasses > 0) ? 1 : 0;
+        sender->fragmentsStatus [cnt].nbSendPasses++;
+        sender->fragmentsStatus [cnt].wasSent = 0;
+        for (sendIndex = 0; sendIndex < nbSend; sendIndex++)
         {
-            if (ARSTREAM_NetworkHeaders_AckPacketFlagIsSet (&(sender->packetsToSend), cnt))
+            eARNETWORK_ERROR netError = ARNETWORK_OK;
+            ARSTREAM_Sender_NetworkCallbackParam_t *cbParams = ARSTREAM_Sender_AllocCallbackParam (sender);
+            if (cbParams == NULL)
             {
-                eARNETWORK_ERROR netError = ARNETWORK_OK;
-                uint32_t maxFragSize = sender->maxFragmentSize;
-                numbersOfFragmentsSentForCurrentFrame ++;
-                int currFragmentSize = (cnt == nbPackets-1) ? lastFragmentSize : maxFragSize;
-                header->fragmentNumber = cnt;
-                header->fragmentsPerFrame = nbPackets;
-                memcpy (&sendFragment[sizeof (ARSTREAM_NetworkHeaders_DataHeader_t)], &(sender->currentFrame.frameBuffer)[maxFragSize*cnt], currFragmentSize);
-                ARSTREAM_Sender_NetworkCallbackParam_t *cbParams = malloc (sizeof (ARSTREAM_Sender_NetworkCallbackParam_t));
-                cbParams->sender = sender;
-                cbParams->fragmentIndex = cnt;
-                cbParams->frameNumber = sender->packetsToSend.frameNumber;
-                ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
-                netError = ARNETWORK_Manager_SendData (sender->manager, sender->dataBufferID, sendFragment, currFragmentSize + sizeof (ARSTREAM_NetworkHeaders_DataHeader_t), (void *)cbParams, ARSTREAM_Sender_NetworkCallback, 1);
-                if (netError != ARNETWORK_OK)
-                {
-                    ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error occurred during sending of the fragment ; error: %d : %s", netError, ARNETWORK_Error_ToString(netError));
-                }
-                if (sender->currentFrame.isHighPriority == 0)
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Unable to allocate network callback params for fragment %d", cnt);
+                continue;
+            }
+            cbParams->sender = sender;
+            cbParams->fragmentIndex = cnt;
+            cbParams->frameNumber = sender->packetsToSend.frameNumber;
+            cbParams->isPrebuiltFragment = (doDataCopy == 0) ? 1 : 0;
+            cbParams->isParityFragment = 0;
+            if (doDataCopy == 0)
+            {
+                sender->fragmentsInFlight [cnt]++;
+                sender->nbFragmentsInFlight++;
+            }
+            sender->fragmentsStatus [cnt].nbPending++;
+            ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+            netError = ARNETWORK_Manager_SendData (sender->manager, sender->dataBufferID, fragment, currFragmentSize + loop->headerSize + loop->tagSize, (void *)cbParams, ARSTREAM_Sender_NetworkCallback, doDataCopy);
+            ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
+            loop->pacing.tokens -= currFragmentSize + loop->headerSize + loop->tagSize;
+            if (netError != ARNETWORK_OK)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error occurred during sending of the fragment ; error: %d : %s", netError, ARNETWORK_Error_ToString(netError));
+                ARSTREAM_Sender_ReleasePrebuiltFragment (sender, cbParams);
+                ARSTREAM_Sender_FragmentCellDone (sender, cbParams, 0);
+                ARSTREAM_Sender_FreeCallbackParam (sender, cbParams);
+            }
+            else if (sendIndex > 0)
+            {
+                ARSTREAM_Stats_Add (&(sender->stats.nbFragmentsDuplicated), 1);
+            }
+            else
+            {
+                ARSTREAM_Stats_Add ((isRetransmission == 1) ? &(sender->stats.nbFragmentsRetransmitted) : &(sender->stats.nbFragmentsSent), 1);
+                if (loop->firstSendWasAccounted == 0)
                 {
-                    ARSTREAM_Sender_NetworkCallbackParam_t *cbParams = malloc (sizeof (ARSTREAM_Sender_NetworkCallbackParam_t));
-                    cbParams->sender = sender;
-                    cbParams->fragmentIndex = cnt;
-                    cbParams->frameNumber = sender->packetsToSend.frameNumber;
-                    netError = ARNETWORK_Manager_SendData (sender->manager, sender->dataBufferID, sendFragment, currFragmentSize + sizeof (ARSTREAM_NetworkHeaders_DataHeader_t), (void *)cbParams, ARSTREAM_Sender_NetworkCallback, 1);
-                    if (netError != ARNETWORK_OK)
-                    {
-                        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error occurred during sending of the fragment ; error: %d : %s", netError, ARNETWORK_Error_ToString(netError));
-                    }
+                    loop->firstSendWasAccounted = 1;
+                    ARSTREAM_Stats_AddLatency (sender->stats.firstSendLatency, ARSTREAM_SENDER_STATS_LATENCY_NB_BUCKETS, &(sender->currentFrame.queueTime));
                 }
-                ARSAL_Mutex_Lock (&(sender->packetsToSendMutex));
             }
         }
-        ARSAL_Mutex_Unlock (&(sender->ackMutex));
-        ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
     }
-    /* END OF PROCESS LOOP */
+    if ((isPaced == 0) &&
+        (isOverBudget == 0))
+    {
+        loop->sendStartIndex = 0;
+    }
+
+    /* Send the parity fragments along with the first send of the frame */
+    if ((loop->parityToSend == 1) &&
+        (isPaced == 0) &&
+        (isOverBudget == 0) &&
+        (isPreempted == 0))
+    {
+        loop->parityToSend = 0;
+        ARSTREAM_Sender_SendParityFragments (sender, loop->sendFragment, &(loop->fragmentInfos), loop->nbPackets, loop->lastFragmentSize, loop->fecBlockSize, loop->fecNbParity);
+        loop->pacing.tokens -= ARSTREAM_Fec_GetNbParityFragments (loop->nbPackets, loop->fecBlockSize, loop->fecNbParity) * (sender->maxFragmentSize + loop->headerSize + loop->tagSize);
+    }
+
+    /* Wake up as soon as the token bucket allows to send the remaining fragments */
+    if (isPaced == 1)
+    {
+        int pacingWaitMs = ARSTREAM_Sender_PacingGetWaitMs (&(loop->pacing));
+        loop->nextRetryMs = (pacingWaitMs < loop->nextRetryMs) ? pacingWaitMs : loop->nextRetryMs;
+    }
+    if ((firstPassIsOverBudget == 1) ||
+        (isPreempted == 1))
+    {
+        loop->nextRetryMs = 0;
+    }
+    ARSAL_Mutex_Unlock (&(sender->packetsToSendMutex));
+    ARSAL_Mutex_Unlock (&(sender->ackMutex));
+
+    return loop->nextRetryMs;
+}
+
+void ARSTREAM_Sender_EndDataLoop (ARSTREAM_Sender_t *sender)
+{
+    ARSTREAM_Sender_DataLoop_t *loop = &(sender->dataLoop);
 
-    if (sender->currentFrameCbWasCalled == 0 && firstFrame == 0)
+    if (sender->currentFrameCbWasCalled == 0 && loop->firstFrame == 0)
     {
 #ifdef DEBUG
         ARSTREAM_NetworkHeaders_AckPacketDump ("Cancel frame:", &(sender->ackPacket));
-        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Receiver acknowledged %d of %d packets", ARSTREAM_NetworkHeaders_AckPacketCountSet (&(sender->ackPacket), nbPackets), nbPackets);
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Receiver acknowledged %d of %d packets", ARSTREAM_NetworkHeaders_AckPacketCountSet (&(sender->ackPacket), loop->nbPackets), loop->nbPackets);
 #endif
         ARSTREAM_Sender_CallCallback (sender, ARSTREAM_SENDER_STATUS_FRAME_CANCEL, sender->currentFrame.frameBuffer, sender->currentFrame.frameSize);
     }
 
+    /* Drop all network cells, as they reference sender memory */
+    ARNETWORK_Manager_FlushInputBuffer (sender->manager, sender->dataBufferID);
+
     ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Sender thread ended");
     sender->dataThreadStarted = 0;
+}
+
+
+
+void* ARSTREAM_Sender_RunDataThread (void *ARSTREAM_Sender_t_Param)
+{
+    /* Local declarations */
+    ARSTREAM_Sender_t *sender = (ARSTREAM_Sender_t *)ARSTREAM_Sender_t_Param;
+    int waitMs;
 
-    if(sendFragment)
+    /* Parameters check */
+    if (sender == NULL)
     {
-        free(sendFragment);
-        sendFragment = NULL;
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error while starting %s, bad parameters", __FUNCTION__);
+        return (void *)0;
     }
 
+    ARSTREAM_Thread_ApplyConfig (&(sender->threadConfigs [ARSTREAM_THREAD_DATA]));
+    ARSTREAM_Sender_StartDataLoop (sender);
+    waitMs = sender->maxRetryTimeMs;
+    while ((waitMs = ARSTREAM_Sender_StepDataLoop (sender, waitMs, 0)) >= 0);
+    ARSTREAM_Sender_EndDataLoop (sender);
+
     return (void *)0;
 }
 
-
-void* ARSTREAM_Sender_RunAckThread (void *ARSTREAM_Sender_t_Param)
+void ARSTREAM_Sender_StartAckLoop (ARSTREAM_Sender_t *sender)
 {
-    ARSTREAM_NetworkHeaders_AckPacket_t recvPacket;
-    int recvSize;
-    ARSTREAM_Sender_t *sender = (ARSTREAM_Sender_t *)ARSTREAM_Sender_t_Param;
-
     ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Ack thread running");
     sender->ackThreadStarted = 1;
+}
 
-    ARSTREAM_NetworkHeaders_AckPacketReset (&recvPacket);
+int ARSTREAM_Sender_StepAckLoop (ARSTREAM_Sender_t *sender, int waitMs, int maxAcks)
+{
+    uint8_t recvData [ARSTREAM_NETWORK_HEADERS_ACK_PACKET_MAX_NETWORK_SIZE];
+    int recvSize;
+    int nbAcks = 0;
 
-    while (sender->threadsShouldStop == 0)
+    while ((sender->threadsShouldStop == 0) &&
+           (nbAcks < maxAcks))
     {
-        eARNETWORK_ERROR err = ARNETWORK_Manager_ReadDataWithTimeout (sender->manager, sender->ackBufferID, (uint8_t *)&recvPacket, sizeof (recvPacket), &recvSize, 1000);
+        eARNETWORK_ERROR err;
+        int readWaitMs = (nbAcks == 0) ? waitMs : 0;
+        if (sender->ackImpairment != NULL)
+        {
+            err = ARSTREAM_Impairment_ReadData (sender->ackImpairment, sender->manager, sender->ackBufferID, recvData, sizeof (recvData), &recvSize, readWaitMs);
+        }
+        else if (readWaitMs > 0)
+        {
+            err = ARNETWORK_Manager_ReadDataWithTimeout (sender->manager, sender->ackBufferID, recvData, sizeof (recvData), &recvSize, readWaitMs);
+        }
+        else
+        {
+            err = ARNETWORK_Manager_TryReadData (sender->manager, sender->ackBufferID, recvData, sizeof (recvData), &recvSize);
+        }
         if (ARNETWORK_OK != err)
         {
             if (ARNETWORK_ERROR_BUFFER_EMPTY != err)
             {
                 ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Error while reading ACK data: %s", ARNETWORK_Error_ToString (err));
             }
+            break;
         }
-        else if (recvSize != sizeof (recvPacket))
+        ARSTREAM_Sender_ProcessAckData (sender, recvData, recvSize);
+        nbAcks++;
+    }
+
+    return (sender->threadsShouldStop == 0) ? nbAcks : -1;
+}
+
+void ARSTREAM_Sender_EndAckLoop (ARSTREAM_Sender_t *sender)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Ack thread ended");
+    sender->ackThreadStarted = 0;
+}
+
+void* ARSTREAM_Sender_RunAckThread (void *ARSTREAM_Sender_t_Param)
+{
+    ARSTREAM_Sender_t *sender = (ARSTREAM_Sender_t *)ARSTREAM_Sender_t_Param;
+
+    ARSTREAM_Thread_ApplyConfig (&(sender->threadConfigs [ARSTREAM_THREAD_ACK]));
+    ARSTREAM_Sender_StartAckLoop (sender);
+    while (ARSTREAM_Sender_StepAckLoop (sender, 1000, 1) >= 0);
+    ARSTREAM_Sender_EndAckLoop (sender);
+
+    return (void *)0;
+}
+
+int ARSTREAM_Sender_OnTimer (ARSTREAM_Sender_t *sender)
+{
+    int retVal = -1;
+    if (sender != NULL)
+    {
+        uint32_t previousFrameNumber = sender->dataLoop.lastPoppedFrameNumber;
+        ARSTREAM_Sender_StartEventLoops (sender);
+        retVal = ARSTREAM_Sender_StepDataLoop (sender, 0, 0);
+        if (retVal < 0)
         {
-            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_SENDER_TAG, "Read %d octets, expected %d", recvSize, sizeof (recvPacket));
+            ARSTREAM_Sender_EndEventLoops (sender);
         }
         else
         {
-            /* Switch recvPacket endianness */
-            recvPacket.frameNumber = dtohs (recvPacket.frameNumber);
-            recvPacket.highPacketsAck = dtohll (recvPacket.highPacketsAck);
-            recvPacket.lowPacketsAck = dtohll (recvPacket.lowPacketsAck);
-
-            /* Apply recvPacket to sender->ackPacket if frame numbers are the same */
-            ARSAL_Mutex_Lock (&(sender->ackMutex));
-            if (sender->ackPacket.frameNumber == recvPacket.frameNumber)
-            {
-                ARSTREAM_NetworkHeaders_AckPacketSetFlags (&(sender->ackPacket), &recvPacket);
-                if ((sender->currentFrameCbWasCalled == 0) &&
-                    (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&(sender->ackPacket), sender->currentFrameNbFragments) == 1))
-                {
-                    ARSTREAM_Sender_FrameWasAck (sender);
-                }
-            }
-            else if (ARSTREAM_NetworkHeaders_AckPacketAllFlagsSet (&recvPacket, sender->maxNumberOfFragment) == 1)
+            if (sender->dataLoop.lastPoppedFrameNumber != previousFrameNumber)
             {
-                ARSTREAM_Sender_SendLateAck (sender, recvPacket.frameNumber);
+                // Acks for the new frame are expected soon
+                sender->ackPollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
             }
-            ARSAL_Mutex_Unlock (&(sender->ackMutex));
+            sender->dataLoop.nextStepMs = retVal;
+            ARSAL_Time_GetTime (&(sender->dataLoop.lastStepTime));
+            retVal = 0;
         }
     }
+    return retVal;
+}
 
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_SENDER_TAG, "Ack thread ended");
-    sender->ackThreadStarted = 0;
-    return (void *)0;
+int ARSTREAM_Sender_ProcessAcks (ARSTREAM_Sender_t *sender)
+{
+    int retVal = -1;
+    if (sender != NULL)
+    {
+        ARSTREAM_Sender_StartEventLoops (sender);
+        retVal = ARSTREAM_Sender_StepAckLoop (sender, 0, INT32_MAX);
+        if (retVal < 0)
+        {
+            ARSTREAM_Sender_EndEventLoops (sender);
+        }
+        else if (retVal > 0)
+        {
+            sender->ackPollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+            retVal = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        }
+        else
+        {
+            // Back off exponentially while no ack is received
+            retVal = sender->ackPollDelayMs;
+            sender->ackPollDelayMs = ARSTREAM_StreamTasks_NextPollDelay (sender->ackPollDelayMs, ARSTREAM_STREAM_TASKS_SENDER_ACK_POLL_MAX_MS);
+        }
+    }
+    return retVal;
+}
+
+int ARSTREAM_Sender_GetNextTimeout (ARSTREAM_Sender_t *sender)
+{
+    int retVal = 0;
+    // Due now if the data loop never ran, if a new frame is queued, or if the sender is stopping
+    if ((sender != NULL) &&
+        (sender->threadsShouldStop == 0) &&
+        (sender->dataThreadStarted == 1) &&
+        (__atomic_load_n (&(sender->nextFramesReadIndex), __ATOMIC_ACQUIRE) == __atomic_load_n (&(sender->nextFramesWriteIndex), __ATOMIC_ACQUIRE)))
+    {
+        struct timespec now;
+        ARSAL_Time_GetTime (&now);
+        retVal = sender->dataLoop.nextStepMs - ARSAL_Time_ComputeTimespecMsTimeDiff (&(sender->dataLoop.lastStepTime), &now);
+        retVal = (retVal < 0) ? 0 : retVal;
+    }
+    return retVal;
+}
+
+void ARSTREAM_Sender_SetWakeupCallback (ARSTREAM_Sender_t *sender, ARSTREAM_StreamTasks_WakeupCallback_t callback, void *custom)
+{
+    sender->wakeupCustom = custom;
+    sender->wakeupCallback = callback;
 }
 
 float ARSTREAM_Sender_GetEstimatedEfficiency (ARSTREAM_Sender_t *sender)
@@ -1090,6 +3486,16 @@ float ARSTREAM_Sender_GetEstimatedEfficiency (ARSTREAM_Sender_t *sender)
     return retVal;
 }
 
+uint32_t ARSTREAM_Sender_GetTargetBitrate (ARSTREAM_Sender_t *sender)
+{
+    uint32_t ret = 0;
+    if (sender != NULL)
+    {
+        ret = __atomic_load_n (&(sender->targetBitrate), __ATOMIC_RELAXED);
+    }
+    return ret;
+}
+
 void* ARSTREAM_Sender_GetCustom (ARSTREAM_Sender_t *sender)
 {
     void *ret = NULL;
@@ -1099,3 +3505,28 @@ void* ARSTREAM_Sender_GetCustom (ARSTREAM_Sender_t *sender)
     }
     return ret;
 }
+
+uint32_t ARSTREAM_Sender_GetCallbackParamsPoolMisses (ARSTREAM_Sender_t *sender)
+{
+    uint32_t ret = 0;
+    if (sender != NULL)
+    {
+        ret = __sync_fetch_and_add (&(sender->cbParamsPoolMisses), 0);
+    }
+    return ret;
+}
+
+eARSTREAM_ERROR ARSTREAM_Sender_GetStats (ARSTREAM_Sender_t *sender, ARSTREAM_Sender_Stats_t *stats)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_OK;
+    if ((sender == NULL) ||
+        (stats == NULL))
+    {
+        retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+    else
+    {
+        ARSTREAM_Stats_Snapshot (stats, &(sender->stats), sizeof (ARSTREAM_Sender_Stats_t));
+    }
+    return retVal;
+}
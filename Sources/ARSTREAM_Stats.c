@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Stats.c
+ * @brief Lock-free statistics counters of the stream senders and readers
+ * @date 10/15/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+
+/*
+ * Private Headers
+ */
+#include "ARSTREAM_Stats.h"
+
+/*
+ * ARSDK Headers
+ */
+#include <libARSAL/ARSAL_Time.h>
+
+/*
+ * Macros
+ */
+
+/*
+ * Types
+ */
+
+/*
+ * Internal functions declarations
+ */
+
+/*
+ * Internal functions implementation
+ */
+
+/*
+ * Implementation
+ */
+void ARSTREAM_Stats_Add (uint32_t *counter, uint32_t value)
+{
+    __atomic_fetch_add (counter, value, __ATOMIC_RELAXED);
+}
+
+void ARSTREAM_Stats_AddToHistogram (uint32_t *histogram, int nbBuckets, uint32_t value)
+{
+    uint32_t bucket = (value < (uint32_t)nbBuckets) ? value : (uint32_t)(nbBuckets - 1);
+    __atomic_fetch_add (&histogram [bucket], 1, __ATOMIC_RELAXED);
+}
+
+void ARSTREAM_Stats_AddLatency (uint32_t *histogram, int nbBuckets, struct timespec *start)
+{
+    struct timespec now;
+    int32_t latencyMs;
+    uint32_t bucket = 0;
+    ARSAL_Time_GetTime (&now);
+    latencyMs = ARSAL_Time_ComputeTimespecMsTimeDiff (start, &now);
+    // Bucket n holds [2^(n-1), 2^n[ ms, so its index is the number of significant bits of the latency
+    if (latencyMs > 0)
+    {
+        bucket = 32 - __builtin_clz ((uint32_t)latencyMs);
+    }
+    ARSTREAM_Stats_AddToHistogram (histogram, nbBuckets, bucket);
+}
+
+void ARSTREAM_Stats_Snapshot (void *dst, void *src, int size)
+{
+    uint32_t *dstCounters = (uint32_t *)dst;
+    uint32_t *srcCounters = (uint32_t *)src;
+    int nbCounters = size / (int)sizeof (uint32_t);
+    int index;
+    for (index = 0; index < nbCounters; index++)
+    {
+        dstCounters [index] = __atomic_load_n (&srcCounters [index], __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Stats.h
+ * @brief Lock-free statistics counters of the stream senders and readers
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_STATS_PRIVATE_H_
+#define _ARSTREAM_STATS_PRIVATE_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ * Private Headers
+ */
+
+/*
+ * ARSDK Headers
+ */
+
+/*
+ * Macros
+ */
+
+/*
+ * Types
+ */
+
+/* Statistics layout :
+ * The public statistics structures (ARSTREAM_Sender_Stats_t and
+ * ARSTREAM_Reader_Stats_t) only hold uint32_t counters, so they can be
+ * handled as arrays of counters. Each counter is updated with a relaxed
+ * atomic add by the thread which sees the event, and read with a relaxed
+ * atomic load by the snapshot. No lock is ever taken.
+ *
+ * Latency histograms use power of two buckets : bucket 0 counts the
+ * latencies under 1 ms, bucket n the latencies within [2^(n-1), 2^n[ ms,
+ * and the last bucket all the longer latencies.
+ */
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Adds a value to a counter
+ * @param counter The counter to update
+ * @param value The value to add
+ */
+void ARSTREAM_Stats_Add (uint32_t *counter, uint32_t value);
+
+/**
+ * @brief Accounts a value in a linear histogram
+ * @param histogram The histogram to update
+ * @param nbBuckets The number of buckets of the histogram. The last bucket also counts all larger values
+ * @param value The value to account (bucket index)
+ */
+void ARSTREAM_Stats_AddToHistogram (uint32_t *histogram, int nbBuckets, uint32_t value);
+
+/**
+ * @brief Accounts the time elapsed since a start time in a latency histogram
+ * @param histogram The histogram to update
+ * @param nbBuckets The number of buckets of the histogram
+ * @param start The start time, on the ARSAL_Time_GetTime() clock
+ */
+void ARSTREAM_Stats_AddLatency (uint32_t *histogram, int nbBuckets, struct timespec *start);
+
+/**
+ * @brief Copies statistics counters
+ * @param dst The destination counters
+ * @param src The counters to read
+ * @param size The size of the statistics structure, in bytes
+ */
+void ARSTREAM_Stats_Snapshot (void *dst, void *src, int size);
+
+#endif /* _ARSTREAM_STATS_PRIVATE_H_ */
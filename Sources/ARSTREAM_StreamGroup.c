@@ -0,0 +1,660 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_StreamGroup.c
+ * @brief Runs many stream senders/readers on a fixed number of threads
+ * @date 10/14/2026
+ */
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Private Headers
+ */
+
+#include "ARSTREAM_StreamTasks.h"
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARStream/ARSTREAM_StreamGroup.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Time.h>
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM_STREAM_GROUP_TAG "ARSTREAM_StreamGroup"
+
+/**
+ * Number of fragments (or ack packets) that a loop of weight 1 can process each time it is picked by a worker
+ */
+#define ARSTREAM_STREAM_GROUP_QUANTUM (8)
+
+/**
+ * Each stream has a data loop and an acknowledge loop
+ */
+#define ARSTREAM_STREAM_GROUP_NB_TASKS_PER_STREAM (2)
+
+/**
+ * Sets *PTR to VAL if PTR is not null
+ */
+#define SET_WITH_CHECK(PTR,VAL)                 \
+    do                                          \
+    {                                           \
+        if (PTR != NULL)                        \
+        {                                       \
+            *PTR = VAL;                         \
+        }                                       \
+    } while (0)
+
+/*
+ * Types
+ */
+
+typedef enum {
+    ARSTREAM_STREAM_GROUP_TASK_SENDER_DATA = 0,
+    ARSTREAM_STREAM_GROUP_TASK_SENDER_ACK,
+    ARSTREAM_STREAM_GROUP_TASK_READER_DATA,
+    ARSTREAM_STREAM_GROUP_TASK_READER_ACK,
+} eARSTREAM_STREAM_GROUP_TASK;
+
+typedef enum {
+    ARSTREAM_STREAM_GROUP_TASK_STATE_FREE = 0, // Unused task storage
+    ARSTREAM_STREAM_GROUP_TASK_STATE_IDLE, // Can be picked by a worker
+    ARSTREAM_STREAM_GROUP_TASK_STATE_BUSY, // Being started or run by a worker
+} eARSTREAM_STREAM_GROUP_TASK_STATE;
+
+typedef struct {
+    ARSTREAM_StreamGroup_t *group;
+    eARSTREAM_STREAM_GROUP_TASK type;
+    eARSTREAM_STREAM_GROUP_TASK_STATE state;
+    ARSTREAM_Sender_t *sender; // NULL for the reader tasks
+    ARSTREAM_Reader_t *reader; // NULL for the sender tasks
+    int budget; // Fragments processed per step (weight * quantum)
+    int isWoken; // Boolean-like (0/1) flag, active if the stream has new work for the task
+    int hasTimeout; // Boolean-like (0/1) flag, active if the task must run at nextRunTime
+    struct timespec nextRunTime;
+    int pollDelayMs; // Delay before the next read of the network buffer if the current one is empty
+    int maxPollDelayMs; // 0 for the tasks which do not poll a network buffer
+} ARSTREAM_StreamGroup_Task_t;
+
+struct ARSTREAM_StreamGroup_t {
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond; // Signaled when a task is woken, or when the group is stopped
+    ARSTREAM_StreamGroup_Task_t *tasks;
+    int nbTasks;
+    int nbUsedTasks;
+    int nextTaskIndex; // Round robin position
+    int shouldStop;
+    int nbWorkers;
+};
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief ARSTREAM_StreamTasks_WakeupCallback_t of the group tasks
+ * @param custom The ARSTREAM_StreamGroup_Task_t to wake up
+ */
+static void ARSTREAM_StreamGroup_WakeupCallback (void *custom);
+
+/**
+ * @brief Makes a task which polls a network buffer read it again at the minimum rate
+ * @param task The task
+ * @warning Must be called with the group mutex locked
+ */
+static void ARSTREAM_StreamGroup_ResetPolling (ARSTREAM_StreamGroup_Task_t *task);
+
+/**
+ * @brief Reserves a pair of tasks for a new stream
+ * @param group The group
+ * @param weight The weight of the stream
+ * @return The first task of the pair (the second one follows it), or NULL if the group is full or stopped
+ * @warning Must be called with the group mutex locked
+ */
+static ARSTREAM_StreamGroup_Task_t* ARSTREAM_StreamGroup_ReserveTasks (ARSTREAM_StreamGroup_t *group, int weight);
+
+/**
+ * @brief Gives the tasks of a new stream to the workers
+ * @param group The group
+ * @param tasks The tasks returned by ARSTREAM_StreamGroup_ReserveTasks()
+ */
+static void ARSTREAM_StreamGroup_ActivateTasks (ARSTREAM_StreamGroup_t *group, ARSTREAM_StreamGroup_Task_t *tasks);
+
+/**
+ * @brief Picks the next task to run, in round robin order
+ * @param group The group
+ * @param waitMs Time before the next task is due, ARSTREAM_STREAM_TASKS_NO_TIMEOUT if no task has a timeout
+ * @return The task to run, or NULL if no task is due
+ * @warning Must be called with the group mutex locked
+ */
+static ARSTREAM_StreamGroup_Task_t* ARSTREAM_StreamGroup_PickTask (ARSTREAM_StreamGroup_t *group, int *waitMs);
+
+/**
+ * @brief Runs one step of a task
+ * @param task The task
+ * @param[out] isIdle Set to 1 if the task polls a network buffer and found it empty, else set to 0
+ * @return The time before the next step is needed, in ms (ARSTREAM_STREAM_TASKS_NO_TIMEOUT if only a wakeup needs it)
+ * @return -1 if the stream is stopped and the loop of the task was ended
+ * @note The caller replaces the returned time with the poll delay of the task when isIdle is set
+ */
+static int ARSTREAM_StreamGroup_RunTask (ARSTREAM_StreamGroup_Task_t *task, int *isIdle);
+
+/*
+ * Internal functions implementation
+ */
+
+static void ARSTREAM_StreamGroup_WakeupCallback (void *custom)
+{
+    ARSTREAM_StreamGroup_Task_t *task = (ARSTREAM_StreamGroup_Task_t *)custom;
+    if (task != NULL)
+    {
+        ARSTREAM_StreamGroup_t *group = task->group;
+        // The other task of the stream is the one polling the network : a new frame, an ack
+        // request or a stop means that traffic is expected (or that the loop must end) soon
+        ARSTREAM_StreamGroup_Task_t *pollingTask = &(group->tasks [(task - group->tasks) ^ 1]);
+        ARSAL_Mutex_Lock (&(group->mutex));
+        task->isWoken = 1;
+        ARSTREAM_StreamGroup_ResetPolling (pollingTask);
+        ARSAL_Cond_Broadcast (&(group->cond));
+        ARSAL_Mutex_Unlock (&(group->mutex));
+    }
+}
+
+static void ARSTREAM_StreamGroup_ResetPolling (ARSTREAM_StreamGroup_Task_t *task)
+{
+    if (task->maxPollDelayMs > 0)
+    {
+        task->pollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        task->isWoken = 1;
+    }
+}
+
+static ARSTREAM_StreamGroup_Task_t* ARSTREAM_StreamGroup_ReserveTasks (ARSTREAM_StreamGroup_t *group, int weight)
+{
+    ARSTREAM_StreamGroup_Task_t *retTasks = NULL;
+    int i;
+    if (group->shouldStop == 0)
+    {
+        for (i = 0; (i < group->nbTasks) && (retTasks == NULL); i += ARSTREAM_STREAM_GROUP_NB_TASKS_PER_STREAM)
+        {
+            // Both tasks of a stream are freed together, once both loops ended
+            if ((group->tasks [i].state == ARSTREAM_STREAM_GROUP_TASK_STATE_FREE) &&
+                (group->tasks [i+1].state == ARSTREAM_STREAM_GROUP_TASK_STATE_FREE))
+            {
+                retTasks = &(group->tasks [i]);
+            }
+        }
+    }
+    for (i = 0; (retTasks != NULL) && (i < ARSTREAM_STREAM_GROUP_NB_TASKS_PER_STREAM); i++)
+    {
+        // Busy until the stream loops are started
+        retTasks [i].state = ARSTREAM_STREAM_GROUP_TASK_STATE_BUSY;
+        retTasks [i].sender = NULL;
+        retTasks [i].reader = NULL;
+        retTasks [i].budget = weight * ARSTREAM_STREAM_GROUP_QUANTUM;
+        retTasks [i].isWoken = 1;
+        retTasks [i].hasTimeout = 0;
+        retTasks [i].pollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+        retTasks [i].maxPollDelayMs = 0;
+        group->nbUsedTasks++;
+    }
+    return retTasks;
+}
+
+static void ARSTREAM_StreamGroup_ActivateTasks (ARSTREAM_StreamGroup_t *group, ARSTREAM_StreamGroup_Task_t *tasks)
+{
+    int i;
+    ARSAL_Mutex_Lock (&(group->mutex));
+    for (i = 0; i < ARSTREAM_STREAM_GROUP_NB_TASKS_PER_STREAM; i++)
+    {
+        tasks [i].state = ARSTREAM_STREAM_GROUP_TASK_STATE_IDLE;
+    }
+    ARSAL_Cond_Broadcast (&(group->cond));
+    ARSAL_Mutex_Unlock (&(group->mutex));
+}
+
+static ARSTREAM_StreamGroup_Task_t* ARSTREAM_StreamGroup_PickTask (ARSTREAM_StreamGroup_t *group, int *waitMs)
+{
+    ARSTREAM_StreamGroup_Task_t *retTask = NULL;
+    struct timespec now;
+    int i;
+    *waitMs = ARSTREAM_STREAM_TASKS_NO_TIMEOUT;
+    ARSAL_Time_GetTime (&now);
+    for (i = 0; (i < group->nbTasks) && (retTask == NULL); i++)
+    {
+        int index = (group->nextTaskIndex + i) % group->nbTasks;
+        ARSTREAM_StreamGroup_Task_t *task = &(group->tasks [index]);
+        if (task->state != ARSTREAM_STREAM_GROUP_TASK_STATE_IDLE)
+        {
+            continue;
+        }
+        if (task->isWoken == 1)
+        {
+            retTask = task;
+        }
+        else if (task->hasTimeout == 1)
+        {
+            int msBeforeRun = ARSAL_Time_ComputeTimespecMsTimeDiff (&now, &(task->nextRunTime));
+            if (msBeforeRun <= 0)
+            {
+                retTask = task;
+            }
+            else if (msBeforeRun < *waitMs)
+            {
+                *waitMs = msBeforeRun;
+            }
+        }
+        // No else : task waits for a wakeup
+
+        if (retTask != NULL)
+        {
+            group->nextTaskIndex = (index + 1) % group->nbTasks;
+        }
+    }
+    return retTask;
+}
+
+static int ARSTREAM_StreamGroup_RunTask (ARSTREAM_StreamGroup_Task_t *task, int *isIdle)
+{
+    int retVal = -1;
+    int nbProcessed;
+    *isIdle = 0;
+    switch (task->type)
+    {
+    case ARSTREAM_STREAM_GROUP_TASK_SENDER_DATA:
+        retVal = ARSTREAM_Sender_StepDataLoop (task->sender, 0, task->budget);
+        if (retVal < 0)
+        {
+            ARSTREAM_Sender_SetWakeupCallback (task->sender, NULL, NULL);
+            ARSTREAM_Sender_EndDataLoop (task->sender);
+        }
+        break;
+    case ARSTREAM_STREAM_GROUP_TASK_SENDER_ACK:
+        nbProcessed = ARSTREAM_Sender_StepAckLoop (task->sender, 0, task->budget);
+        if (nbProcessed < 0)
+        {
+            ARSTREAM_Sender_EndAckLoop (task->sender);
+            retVal = -1;
+        }
+        else
+        {
+            // Run again immediately if the budget was not enough to empty the network buffer
+            retVal = (nbProcessed >= task->budget) ? 0 : ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+            *isIdle = (nbProcessed == 0) ? 1 : 0;
+        }
+        break;
+    case ARSTREAM_STREAM_GROUP_TASK_READER_DATA:
+        nbProcessed = ARSTREAM_Reader_StepDataLoop (task->reader, 0, task->budget);
+        if (nbProcessed < 0)
+        {
+            ARSTREAM_Reader_EndDataLoop (task->reader);
+            retVal = -1;
+        }
+        else
+        {
+            retVal = (nbProcessed >= task->budget) ? 0 : ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+            *isIdle = (nbProcessed == 0) ? 1 : 0;
+        }
+        break;
+    case ARSTREAM_STREAM_GROUP_TASK_READER_ACK:
+        retVal = ARSTREAM_Reader_StepAckLoop (task->reader);
+        if (retVal < 0)
+        {
+            ARSTREAM_Reader_SetWakeupCallback (task->reader, NULL, NULL);
+            ARSTREAM_Reader_EndAckLoop (task->reader);
+        }
+        break;
+    default:
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_STREAM_GROUP_TAG, "Unknown task type %d", task->type);
+        break;
+    }
+    return retVal;
+}
+
+/*
+ * Implementation
+ */
+
+ARSTREAM_StreamGroup_t* ARSTREAM_StreamGroup_New (int maxNbStreams, eARSTREAM_ERROR *error)
+{
+    ARSTREAM_StreamGroup_t *retGroup = NULL;
+    int mutexWasInit = 0;
+    int condWasInit = 0;
+    int tasksArrayWasCreated = 0;
+    eARSTREAM_ERROR internalError = ARSTREAM_OK;
+    /* ARGS Check */
+    if (maxNbStreams <= 0)
+    {
+        SET_WITH_CHECK (error, ARSTREAM_ERROR_BAD_PARAMETERS);
+        return retGroup;
+    }
+
+    /* Alloc new group */
+    retGroup = malloc (sizeof (ARSTREAM_StreamGroup_t));
+    if (retGroup == NULL)
+    {
+        internalError = ARSTREAM_ERROR_ALLOC;
+    }
+
+    /* Setup internal mutexes/conditions */
+    if (internalError == ARSTREAM_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init (&(retGroup->mutex));
+        if (mutexInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            mutexWasInit = 1;
+        }
+    }
+    if (internalError == ARSTREAM_OK)
+    {
+        int condInitRet = ARSAL_Cond_Init (&(retGroup->cond));
+        if (condInitRet != 0)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            condWasInit = 1;
+        }
+    }
+
+    /* Allocate tasks storage */
+    if (internalError == ARSTREAM_OK)
+    {
+        retGroup->nbTasks = maxNbStreams * ARSTREAM_STREAM_GROUP_NB_TASKS_PER_STREAM;
+        retGroup->tasks = calloc (retGroup->nbTasks, sizeof (ARSTREAM_StreamGroup_Task_t));
+        if (retGroup->tasks == NULL)
+        {
+            internalError = ARSTREAM_ERROR_ALLOC;
+        }
+        else
+        {
+            tasksArrayWasCreated = 1;
+        }
+    }
+
+    /* Setup internal variables */
+    if (internalError == ARSTREAM_OK)
+    {
+        int i;
+        for (i = 0; i < retGroup->nbTasks; i++)
+        {
+            retGroup->tasks [i].group = retGroup;
+            retGroup->tasks [i].state = ARSTREAM_STREAM_GROUP_TASK_STATE_FREE;
+        }
+        retGroup->nbUsedTasks = 0;
+        retGroup->nextTaskIndex = 0;
+        retGroup->shouldStop = 0;
+        retGroup->nbWorkers = 0;
+    }
+
+    if ((internalError != ARSTREAM_OK) &&
+        (retGroup != NULL))
+    {
+        if (mutexWasInit == 1)
+        {
+            ARSAL_Mutex_Destroy (&(retGroup->mutex));
+        }
+        if (condWasInit == 1)
+        {
+            ARSAL_Cond_Destroy (&(retGroup->cond));
+        }
+        if (tasksArrayWasCreated == 1)
+        {
+            free (retGroup->tasks);
+        }
+        free (retGroup);
+        retGroup = NULL;
+    }
+
+    SET_WITH_CHECK (error, internalError);
+    return retGroup;
+}
+
+eARSTREAM_ERROR ARSTREAM_StreamGroup_AddSender (ARSTREAM_StreamGroup_t *group, ARSTREAM_Sender_t *sender, int weight)
+{
+    ARSTREAM_StreamGroup_Task_t *tasks = NULL;
+    if ((group == NULL) ||
+        (sender == NULL) ||
+        (weight < 1) ||
+        (weight > ARSTREAM_STREAM_GROUP_MAX_WEIGHT))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    ARSAL_Mutex_Lock (&(group->mutex));
+    tasks = ARSTREAM_StreamGroup_ReserveTasks (group, weight);
+    ARSAL_Mutex_Unlock (&(group->mutex));
+    if (tasks == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_STREAM_GROUP_TAG, "Unable to add a sender, the group is full or stopped");
+        return ARSTREAM_ERROR_BUSY;
+    }
+
+    tasks [0].type = ARSTREAM_STREAM_GROUP_TASK_SENDER_DATA;
+    tasks [0].sender = sender;
+    tasks [1].type = ARSTREAM_STREAM_GROUP_TASK_SENDER_ACK;
+    tasks [1].sender = sender;
+    tasks [1].maxPollDelayMs = ARSTREAM_STREAM_TASKS_SENDER_ACK_POLL_MAX_MS;
+    ARSTREAM_Sender_SetWakeupCallback (sender, ARSTREAM_StreamGroup_WakeupCallback, &(tasks [0]));
+    ARSTREAM_Sender_StartDataLoop (sender);
+    ARSTREAM_Sender_StartAckLoop (sender);
+    ARSTREAM_StreamGroup_ActivateTasks (group, tasks);
+    return ARSTREAM_OK;
+}
+
+eARSTREAM_ERROR ARSTREAM_StreamGroup_AddReader (ARSTREAM_StreamGroup_t *group, ARSTREAM_Reader_t *reader, int weight)
+{
+    ARSTREAM_StreamGroup_Task_t *tasks = NULL;
+    if ((group == NULL) ||
+        (reader == NULL) ||
+        (weight < 1) ||
+        (weight > ARSTREAM_STREAM_GROUP_MAX_WEIGHT))
+    {
+        return ARSTREAM_ERROR_BAD_PARAMETERS;
+    }
+
+    ARSAL_Mutex_Lock (&(group->mutex));
+    tasks = ARSTREAM_StreamGroup_ReserveTasks (group, weight);
+    ARSAL_Mutex_Unlock (&(group->mutex));
+    if (tasks == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_STREAM_GROUP_TAG, "Unable to add a reader, the group is full or stopped");
+        return ARSTREAM_ERROR_BUSY;
+    }
+
+    tasks [0].type = ARSTREAM_STREAM_GROUP_TASK_READER_DATA;
+    tasks [0].reader = reader;
+    tasks [0].maxPollDelayMs = ARSTREAM_STREAM_TASKS_READER_DATA_POLL_MAX_MS;
+    tasks [1].type = ARSTREAM_STREAM_GROUP_TASK_READER_ACK;
+    tasks [1].reader = reader;
+    ARSTREAM_Reader_SetWakeupCallback (reader, ARSTREAM_StreamGroup_WakeupCallback, &(tasks [1]));
+    ARSTREAM_Reader_StartDataLoop (reader);
+    ARSTREAM_Reader_StartAckLoop (reader);
+    ARSTREAM_StreamGroup_ActivateTasks (group, tasks);
+    return ARSTREAM_OK;
+}
+
+void* ARSTREAM_StreamGroup_RunWorkerThread (void *ARSTREAM_StreamGroup_t_Param)
+{
+    ARSTREAM_StreamGroup_t *group = (ARSTREAM_StreamGroup_t *)ARSTREAM_StreamGroup_t_Param;
+
+    /* Parameters check */
+    if (group == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_STREAM_GROUP_TAG, "Error while starting %s, bad parameters", __FUNCTION__);
+        return (void *)0;
+    }
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_STREAM_GROUP_TAG, "Worker thread running");
+    ARSAL_Mutex_Lock (&(group->mutex));
+    group->nbWorkers++;
+    // Keep running the streams until they are stopped, so their loops are always ended
+    while ((group->shouldStop == 0) ||
+           (group->nbUsedTasks > 0))
+    {
+        int waitMs;
+        ARSTREAM_StreamGroup_Task_t *task = ARSTREAM_StreamGroup_PickTask (group, &waitMs);
+        if (task != NULL)
+        {
+            int nextRunMs;
+            int isIdle;
+            task->state = ARSTREAM_STREAM_GROUP_TASK_STATE_BUSY;
+            task->isWoken = 0;
+            ARSAL_Mutex_Unlock (&(group->mutex));
+
+            nextRunMs = ARSTREAM_StreamGroup_RunTask (task, &isIdle);
+
+            ARSAL_Mutex_Lock (&(group->mutex));
+            if ((nextRunMs >= 0) &&
+                (task->maxPollDelayMs > 0))
+            {
+                if ((isIdle == 1) &&
+                    (task->isWoken == 0))
+                {
+                    // Back off exponentially while the network buffer stays empty
+                    nextRunMs = task->pollDelayMs;
+                    task->pollDelayMs = ARSTREAM_StreamTasks_NextPollDelay (task->pollDelayMs, task->maxPollDelayMs);
+                }
+                else if (isIdle == 0)
+                {
+                    task->pollDelayMs = ARSTREAM_STREAM_TASKS_POLL_MIN_MS;
+                }
+                // No else : woken while running, the delay was reset and the task runs again now
+            }
+            if (nextRunMs < 0)
+            {
+                task->state = ARSTREAM_STREAM_GROUP_TASK_STATE_FREE;
+                group->nbUsedTasks--;
+                // Wake up the workers waiting for the last tasks to end
+                ARSAL_Cond_Broadcast (&(group->cond));
+            }
+            else
+            {
+                task->state = ARSTREAM_STREAM_GROUP_TASK_STATE_IDLE;
+                task->hasTimeout = (nextRunMs != ARSTREAM_STREAM_TASKS_NO_TIMEOUT) ? 1 : 0;
+                if (task->hasTimeout == 1)
+                {
+                    ARSAL_Time_GetTime (&(task->nextRunTime));
+                    task->nextRunTime.tv_sec += nextRunMs / 1000;
+                    task->nextRunTime.tv_nsec += (nextRunMs % 1000) * 1000000;
+                    if (task->nextRunTime.tv_nsec >= 1000000000)
+                    {
+                        task->nextRunTime.tv_sec++;
+                        task->nextRunTime.tv_nsec -= 1000000000;
+                    }
+                }
+            }
+        }
+        else if (waitMs == ARSTREAM_STREAM_TASKS_NO_TIMEOUT)
+        {
+            ARSAL_Cond_Wait (&(group->cond), &(group->mutex));
+        }
+        else
+        {
+            ARSAL_Cond_Timedwait (&(group->cond), &(group->mutex), waitMs);
+        }
+    }
+    group->nbWorkers--;
+    ARSAL_Mutex_Unlock (&(group->mutex));
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSTREAM_STREAM_GROUP_TAG, "Worker thread ended");
+
+    return (void *)0;
+}
+
+void ARSTREAM_StreamGroup_Stop (ARSTREAM_StreamGroup_t *group)
+{
+    if (group != NULL)
+    {
+        int i;
+        ARSAL_Mutex_Lock (&(group->mutex));
+        group->shouldStop = 1;
+        for (i = 0; i < group->nbTasks; i++)
+        {
+            if (group->tasks [i].state != ARSTREAM_STREAM_GROUP_TASK_STATE_FREE)
+            {
+                ARSTREAM_StreamGroup_ResetPolling (&(group->tasks [i]));
+            }
+        }
+        ARSAL_Cond_Broadcast (&(group->cond));
+        ARSAL_Mutex_Unlock (&(group->mutex));
+    }
+}
+
+eARSTREAM_ERROR ARSTREAM_StreamGroup_Delete (ARSTREAM_StreamGroup_t **group)
+{
+    eARSTREAM_ERROR retVal = ARSTREAM_ERROR_BAD_PARAMETERS;
+    if ((group != NULL) &&
+        (*group != NULL))
+    {
+        int canDelete = 0;
+        ARSAL_Mutex_Lock (&((*group)->mutex));
+        if (((*group)->nbWorkers == 0) &&
+            ((*group)->nbUsedTasks == 0))
+        {
+            canDelete = 1;
+        }
+        ARSAL_Mutex_Unlock (&((*group)->mutex));
+
+        if (canDelete == 1)
+        {
+            ARSAL_Mutex_Destroy (&((*group)->mutex));
+            ARSAL_Cond_Destroy (&((*group)->cond));
+            free ((*group)->tasks);
+            free (*group);
+            *group = NULL;
+            retVal = ARSTREAM_OK;
+        }
+        else
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_STREAM_GROUP_TAG, "Stop the streams and call ARSTREAM_StreamGroup_Stop, then join the workers before calling this function");
+            retVal = ARSTREAM_ERROR_BUSY;
+        }
+    }
+    return retVal;
+}
@@ -0,0 +1,210 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_StreamTasks.h
+ * @brief Loops of the senders and readers, split into steps which can be run by any thread
+ * @date 10/14/2026
+ */
+
+#ifndef _ARSTREAM_STREAM_TASKS_PRIVATE_H_
+#define _ARSTREAM_STREAM_TASKS_PRIVATE_H_
+
+/*
+ * System Headers
+ */
+#include <inttypes.h>
+
+/*
+ * Private Headers
+ */
+
+/*
+ * ARSDK Headers
+ */
+#include <libARStream/ARSTREAM_Sender.h>
+#include <libARStream/ARSTREAM_Reader.h>
+
+/*
+ * Macros
+ */
+
+/**
+ * Returned by the step functions which wait for an event instead of a timeout
+ */
+#define ARSTREAM_STREAM_TASKS_NO_TIMEOUT (INT32_MAX)
+
+/**
+ * Time between two reads of a network buffer which just gave data, when the loop is not run by its own thread
+ * This time is doubled after each empty read, up to the read timeout of the loop when run by its own thread
+ */
+#define ARSTREAM_STREAM_TASKS_POLL_MIN_MS (2)
+
+/**
+ * Maximum time between two reads of the ack buffer of an idle sender (ARSTREAM_Sender_RunAckThread() read timeout)
+ */
+#define ARSTREAM_STREAM_TASKS_SENDER_ACK_POLL_MAX_MS (1000)
+
+/**
+ * Maximum time between two reads of the data buffer of an idle reader (ARSTREAM_Reader_RunDataThread() read timeout)
+ */
+#define ARSTREAM_STREAM_TASKS_READER_DATA_POLL_MAX_MS (500)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Callback called when a loop which is not run by its own thread has new work to do
+ * @param custom The custom pointer given with the callback
+ * @warning Called from the thread which created the work (e.g. the ARSTREAM_Sender_SendNewFrame() caller)
+ */
+typedef void (*ARSTREAM_StreamTasks_WakeupCallback_t) (void *custom);
+
+/*
+ * Functions declarations
+ */
+
+/**
+ * @brief Gets the poll delay to use after an empty read of a network buffer
+ * @param pollDelayMs The delay used before the empty read
+ * @param maxPollDelayMs The maximum delay
+ * @return The doubled delay, capped to maxPollDelayMs
+ */
+static inline int ARSTREAM_StreamTasks_NextPollDelay (int pollDelayMs, int maxPollDelayMs)
+{
+    return (2 * pollDelayMs < maxPollDelayMs) ? 2 * pollDelayMs : maxPollDelayMs;
+}
+
+/**
+ * @brief Marks the data loop of a sender as running
+ * @param sender The sender
+ */
+void ARSTREAM_Sender_StartDataLoop (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Runs one step of the data loop of a sender : takes a new frame if available, then sends the fragments which are due
+ * @param sender The sender
+ * @param waitMs Maximum time to wait for a new frame (0 to never wait)
+ * @param maxFragments Maximum number of fragments to send during this step (0 for no limit)
+ * @return The time before the next step is needed, in ms (0 if fragments are still due), if no new frame arrives
+ * @return -1 if the sender is stopping (call ARSTREAM_Sender_EndDataLoop())
+ */
+int ARSTREAM_Sender_StepDataLoop (ARSTREAM_Sender_t *sender, int waitMs, int maxFragments);
+
+/**
+ * @brief Ends the data loop of a sender : cancels the current frame and drops the network cells
+ * @param sender The sender
+ */
+void ARSTREAM_Sender_EndDataLoop (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Marks the acknowledge loop of a sender as running
+ * @param sender The sender
+ */
+void ARSTREAM_Sender_StartAckLoop (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Runs one step of the acknowledge loop of a sender : reads and applies the ack packets
+ * @param sender The sender
+ * @param waitMs Maximum time to wait for a first ack packet (0 to never wait)
+ * @param maxAcks Maximum number of ack packets to read during this step
+ * @return The number of ack packets read
+ * @return -1 if the sender is stopping (call ARSTREAM_Sender_EndAckLoop())
+ */
+int ARSTREAM_Sender_StepAckLoop (ARSTREAM_Sender_t *sender, int waitMs, int maxAcks);
+
+/**
+ * @brief Ends the acknowledge loop of a sender
+ * @param sender The sender
+ */
+void ARSTREAM_Sender_EndAckLoop (ARSTREAM_Sender_t *sender);
+
+/**
+ * @brief Sets the callback called when a new frame is queued, or when the sender is stopped
+ * @param sender The sender
+ * @param callback The callback (NULL to remove it)
+ * @param custom Custom pointer given to the callback
+ * @warning Must be called before the sender is used
+ */
+void ARSTREAM_Sender_SetWakeupCallback (ARSTREAM_Sender_t *sender, ARSTREAM_StreamTasks_WakeupCallback_t callback, void *custom);
+
+/**
+ * @brief Marks the data loop of a reader as running
+ * @param reader The reader
+ */
+void ARSTREAM_Reader_StartDataLoop (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Runs one step of the data loop of a reader : reads and reassembles the fragments, then updates the ack packet
+ * @param reader The reader
+ * @param waitMs Maximum time to wait for a first fragment (0 to never wait)
+ * @param maxFragments Maximum number of fragments to read during this step
+ * @return The number of fragments read
+ * @return -1 if the reader is stopping (call ARSTREAM_Reader_EndDataLoop())
+ */
+int ARSTREAM_Reader_StepDataLoop (ARSTREAM_Reader_t *reader, int waitMs, int maxFragments);
+
+/**
+ * @brief Ends the data loop of a reader : gives the frames in progress back
+ * @param reader The reader
+ */
+void ARSTREAM_Reader_EndDataLoop (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Marks the acknowledge loop of a reader as running
+ * @param reader The reader
+ */
+void ARSTREAM_Reader_StartAckLoop (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Runs one step of the acknowledge loop of a reader : sends the ack packet if it is due, without waiting
+ * @param reader The reader
+ * @return The time before the next step is needed, in ms (ARSTREAM_STREAM_TASKS_NO_TIMEOUT if only a new ack request needs it)
+ * @return -1 if the reader is stopping (call ARSTREAM_Reader_EndAckLoop())
+ */
+int ARSTREAM_Reader_StepAckLoop (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Ends the acknowledge loop of a reader
+ * @param reader The reader
+ */
+void ARSTREAM_Reader_EndAckLoop (ARSTREAM_Reader_t *reader);
+
+/**
+ * @brief Sets the callback called when an ack packet send is requested, or when the reader is stopped
+ * @param reader The reader
+ * @param callback The callback (NULL to remove it)
+ * @param custom Custom pointer given to the callback
+ * @warning Must be called before the reader is used
+ */
+void ARSTREAM_Reader_SetWakeupCallback (ARSTREAM_Reader_t *reader, ARSTREAM_StreamTasks_WakeupCallback_t callback, void *custom);
+
+#endif /* _ARSTREAM_STREAM_TASKS_PRIVATE_H_ */
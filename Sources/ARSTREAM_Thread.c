@@ -0,0 +1,168 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Thread.c
+ * @brief Scheduling configuration of the ARSTREAM threads
+ * @date 10/15/2026
+ */
+
+/* Needed for the CPU affinity functions of glibc */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <config.h>
+
+/*
+ * System Headers
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARStream/ARSTREAM_Thread.h>
+#include <libARSAL/ARSAL_Print.h>
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM_THREAD_TAG "ARSTREAM_Thread"
+
+/*
+ * Implementation
+ */
+
+void ARSTREAM_ThreadConfig_Default (ARSTREAM_ThreadConfig_t *config)
+{
+    if (config != NULL)
+    {
+        memset (config, 0, sizeof (ARSTREAM_ThreadConfig_t));
+    }
+}
+
+int ARSTREAM_Thread_ApplyConfig (const ARSTREAM_ThreadConfig_t *config)
+{
+    int retVal = 0;
+    if (config == NULL)
+    {
+        return -1;
+    }
+
+    if (config->name [0] != '\0')
+    {
+        char name [ARSTREAM_THREAD_NAME_MAX_LENGTH];
+        strncpy (name, config->name, ARSTREAM_THREAD_NAME_MAX_LENGTH - 1);
+        name [ARSTREAM_THREAD_NAME_MAX_LENGTH - 1] = '\0';
+#if defined(__linux__)
+        prctl (PR_SET_NAME, name, 0, 0, 0);
+#elif defined(__APPLE__)
+        pthread_setname_np (name);
+#endif
+    }
+
+    if (config->cpuAffinityMask != 0)
+    {
+#if defined(__linux__)
+        cpu_set_t cpus;
+        int cpu;
+        CPU_ZERO (&cpus);
+        for (cpu = 0; (cpu < 64) && (cpu < CPU_SETSIZE); cpu++)
+        {
+            if ((config->cpuAffinityMask & ((uint64_t)1 << cpu)) != 0)
+            {
+                CPU_SET (cpu, &cpus);
+            }
+        }
+        /* pid 0 is the calling thread */
+        if (sched_setaffinity (0, sizeof (cpus), &cpus) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSTREAM_THREAD_TAG, "Unable to set the affinity of thread %s to 0x%llx : %s", config->name, (unsigned long long)config->cpuAffinityMask, strerror (errno));
+            retVal = -1;
+        }
+#else
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSTREAM_THREAD_TAG, "CPU affinity is not supported on this platform");
+        retVal = -1;
+#endif
+    }
+
+    if (config->realtimePriority > 0)
+    {
+        struct sched_param param;
+        int err;
+        memset (&param, 0, sizeof (param));
+        param.sched_priority = config->realtimePriority;
+        err = pthread_setschedparam (pthread_self (), SCHED_FIFO, &param);
+        if (err != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSTREAM_THREAD_TAG, "Unable to set the SCHED_FIFO priority %d of thread %s : %s", config->realtimePriority, config->name, strerror (err));
+            retVal = -1;
+        }
+    }
+
+    return retVal;
+}
+
+int ARSTREAM_Thread_Create (pthread_t *thread, const ARSTREAM_ThreadConfig_t *config, void *(*routine) (void *), void *arg)
+{
+    pthread_attr_t attr;
+    int retVal;
+
+    if ((config == NULL) ||
+        (config->stackSize == 0))
+    {
+        return pthread_create (thread, NULL, routine, arg);
+    }
+
+    retVal = pthread_attr_init (&attr);
+    if (retVal == 0)
+    {
+        retVal = pthread_attr_setstacksize (&attr, config->stackSize);
+        if (retVal == 0)
+        {
+            retVal = pthread_create (thread, &attr, routine, arg);
+        }
+        else
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSTREAM_THREAD_TAG, "Invalid stack size %zu : %s", config->stackSize, strerror (retVal));
+        }
+        pthread_attr_destroy (&attr);
+    }
+    return retVal;
+}
@@ -0,0 +1,325 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_AckBench.c
+ * @brief Micro-benchmark of the ack bitmap operations
+ * @date 10/15/2026
+ *
+ * Each iteration does what the sender data loop does with the acks of a frame : build the bitmap of
+ * the fragments which are not acknowledged, walk through it, and count its flags. The reference
+ * implementation does it flag by flag through non inlined functions which check their range on each
+ * call, as the data loop did before the word operations were added to ARSTREAM_NetworkHeaders.
+ * The acks are drawn from a seeded generator, so that two runs with the same arguments time the
+ * same bitmaps.
+ */
+
+/*
+ * System Headers
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "../../../Sources/ARSTREAM_NetworkHeaders.h"
+
+/*
+ * Macros
+ */
+
+#define DEFAULT_NB_ITERATIONS (200000)
+#define DEFAULT_SEED (1)
+
+/* Number of different ack bitmaps used by each case, so that the branches can not be learnt */
+#define NB_ACK_PATTERNS (64)
+
+#define __TAG__ "ARSTREAM_AckBench"
+
+/*
+ * Globals
+ */
+
+static const int nbFragmentsSweep [] = { 16, 128, 512, 1024 };
+static const int ackPercentSweep [] = { 0, 50, 95 };
+
+static char *appName;
+
+/* Results are accumulated here, so that the compiler can not drop the timed loops */
+static volatile uint64_t sink;
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Print the parameters of the application
+ */
+void ARSTREAM_AckBench_printUsage ();
+
+/**
+ * @brief Reference : tests a flag, with range checks
+ */
+static int __attribute__ ((noinline)) ARSTREAM_AckBench_RefFlagIsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag);
+
+/**
+ * @brief Reference : sets a flag, with range checks
+ */
+static void __attribute__ ((noinline)) ARSTREAM_AckBench_RefSetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag);
+
+/**
+ * @brief Reference implementation of one iteration
+ * @return The checksum of the iteration (number of fragments to send, and sum of their indexes)
+ */
+static uint64_t ARSTREAM_AckBench_RefIteration (ARSTREAM_NetworkHeaders_AckPacket_t *ack, int nbFragments);
+
+/**
+ * @brief Word operations implementation of one iteration
+ * @return The checksum of the iteration, which must match the one of the reference implementation
+ */
+static uint64_t ARSTREAM_AckBench_WordIteration (ARSTREAM_NetworkHeaders_AckPacket_t *ack, int nbFragments);
+
+/**
+ * @brief Gets the time elapsed between two timespec, in nanoseconds
+ */
+static double ARSTREAM_AckBench_ElapsedNs (struct timespec *start, struct timespec *end);
+
+/*
+ * Internal functions implementation
+ */
+
+void ARSTREAM_AckBench_printUsage ()
+{
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s [-n iterations] [-s seed] [-o out.csv]", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        -n : number of iterations of each case (default %d)", DEFAULT_NB_ITERATIONS);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        -s : seed of the ack generator (default %d)", DEFAULT_SEED);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        -o : CSV output file (default stdout)");
+}
+
+static int ARSTREAM_AckBench_RefFlagIsSet (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag)
+{
+    int retVal = 0;
+    if ((flag >= 0) &&
+        (flag < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME))
+    {
+        retVal = (int)((packet->packetsAck [flag / 64] >> (flag % 64)) & 1ull);
+    }
+    return retVal;
+}
+
+static void ARSTREAM_AckBench_RefSetFlag (ARSTREAM_NetworkHeaders_AckPacket_t *packet, int flag)
+{
+    if ((flag >= 0) &&
+        (flag < ARSTREAM_NETWORK_HEADERS_MAX_FRAGMENTS_PER_FRAME))
+    {
+        packet->packetsAck [flag / 64] |= (1ull << (flag % 64));
+    }
+}
+
+static uint64_t ARSTREAM_AckBench_RefIteration (ARSTREAM_NetworkHeaders_AckPacket_t *ack, int nbFragments)
+{
+    ARSTREAM_NetworkHeaders_AckPacket_t toSend;
+    uint64_t indexSum = 0;
+    uint64_t count = 0;
+    int cnt;
+    memset (&toSend, 0, sizeof (toSend));
+    for (cnt = 0; cnt < nbFragments; cnt++)
+    {
+        if (ARSTREAM_AckBench_RefFlagIsSet (ack, cnt) == 0)
+        {
+            ARSTREAM_AckBench_RefSetFlag (&toSend, cnt);
+        }
+    }
+    for (cnt = 0; cnt < nbFragments; cnt++)
+    {
+        if (ARSTREAM_AckBench_RefFlagIsSet (&toSend, cnt) == 1)
+        {
+            indexSum += cnt;
+        }
+    }
+    for (cnt = 0; cnt < nbFragments; cnt++)
+    {
+        count += ARSTREAM_AckBench_RefFlagIsSet (&toSend, cnt);
+    }
+    return (count << 32) + indexSum;
+}
+
+static uint64_t ARSTREAM_AckBench_WordIteration (ARSTREAM_NetworkHeaders_AckPacket_t *ack, int nbFragments)
+{
+    ARSTREAM_NetworkHeaders_AckPacket_t toSend;
+    uint64_t indexSum = 0;
+    uint64_t count;
+    int cnt;
+    ARSTREAM_NetworkHeaders_AckPacketSetMissingFlags (&toSend, ack, nbFragments);
+    for (cnt = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&toSend, 0);
+         cnt >= 0;
+         cnt = ARSTREAM_NetworkHeaders_AckPacketNextFlagSet (&toSend, cnt + 1))
+    {
+        indexSum += cnt;
+    }
+    count = ARSTREAM_NetworkHeaders_AckPacketCountSet (&toSend, nbFragments);
+    return (count << 32) + indexSum;
+}
+
+static double ARSTREAM_AckBench_ElapsedNs (struct timespec *start, struct timespec *end)
+{
+    return ((double)(end->tv_sec - start->tv_sec) * 1e9) + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_AckBench_Main (int argc, char *argv[])
+{
+    int retVal = 0;
+    int opt;
+    int nbIterations = DEFAULT_NB_ITERATIONS;
+    unsigned int seed = DEFAULT_SEED;
+    char *outPath = NULL;
+    FILE *out = stdout;
+    ARSTREAM_NetworkHeaders_AckPacket_t *acks = NULL;
+    size_t sizeIndex;
+    size_t percentIndex;
+
+    appName = argv[0];
+    while ((opt = getopt (argc, argv, "n:s:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            nbIterations = atoi (optarg);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul (optarg, NULL, 10);
+            break;
+        case 'o':
+            outPath = optarg;
+            break;
+        default:
+            ARSTREAM_AckBench_printUsage ();
+            return 1;
+        }
+    }
+    if (nbIterations <= 0)
+    {
+        ARSTREAM_AckBench_printUsage ();
+        return 1;
+    }
+
+    acks = malloc (NB_ACK_PATTERNS * sizeof (ARSTREAM_NetworkHeaders_AckPacket_t));
+    if (acks == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to allocate the ack patterns");
+        return 1;
+    }
+    if (outPath != NULL)
+    {
+        out = fopen (outPath, "w");
+        if (out == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to open %s", outPath);
+            free (acks);
+            return 1;
+        }
+    }
+
+    fprintf (out, "nbFragments,ackPercent,refNsPerOp,wordNsPerOp,speedup,match\n");
+    for (sizeIndex = 0; sizeIndex < sizeof (nbFragmentsSweep) / sizeof (nbFragmentsSweep [0]); sizeIndex++)
+    {
+        for (percentIndex = 0; percentIndex < sizeof (ackPercentSweep) / sizeof (ackPercentSweep [0]); percentIndex++)
+        {
+            int nbFragments = nbFragmentsSweep [sizeIndex];
+            int ackPercent = ackPercentSweep [percentIndex];
+            unsigned int caseSeed = seed;
+            struct timespec start, end;
+            double refNs, wordNs;
+            int match = 1;
+            int pattern;
+            int iter;
+            int cnt;
+
+            /* Same acks for both implementations */
+            for (pattern = 0; pattern < NB_ACK_PATTERNS; pattern++)
+            {
+                ARSTREAM_NetworkHeaders_AckPacketReset (&acks [pattern]);
+                for (cnt = 0; cnt < nbFragments; cnt++)
+                {
+                    if ((int)(rand_r (&caseSeed) % 100) < ackPercent)
+                    {
+                        ARSTREAM_NetworkHeaders_AckPacketSetFlag (&acks [pattern], cnt);
+                    }
+                }
+                if (ARSTREAM_AckBench_RefIteration (&acks [pattern], nbFragments) != ARSTREAM_AckBench_WordIteration (&acks [pattern], nbFragments))
+                {
+                    match = 0;
+                }
+            }
+
+            clock_gettime (CLOCK_MONOTONIC, &start);
+            for (iter = 0; iter < nbIterations; iter++)
+            {
+                sink += ARSTREAM_AckBench_RefIteration (&acks [iter % NB_ACK_PATTERNS], nbFragments);
+            }
+            clock_gettime (CLOCK_MONOTONIC, &end);
+            refNs = ARSTREAM_AckBench_ElapsedNs (&start, &end) / nbIterations;
+
+            clock_gettime (CLOCK_MONOTONIC, &start);
+            for (iter = 0; iter < nbIterations; iter++)
+            {
+                sink += ARSTREAM_AckBench_WordIteration (&acks [iter % NB_ACK_PATTERNS], nbFragments);
+            }
+            clock_gettime (CLOCK_MONOTONIC, &end);
+            wordNs = ARSTREAM_AckBench_ElapsedNs (&start, &end) / nbIterations;
+
+            if (match == 0)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Results differ for %d fragments, %d%% acked", nbFragments, ackPercent);
+                retVal = 1;
+            }
+            fprintf (out, "%d,%d,%.1f,%.1f,%.2f,%d\n", nbFragments, ackPercent, refNs, wordNs, (wordNs > 0.) ? refNs / wordNs : 0., match);
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose (out);
+    }
+    free (acks);
+    return retVal;
+}
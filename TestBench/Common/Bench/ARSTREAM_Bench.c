@@ -0,0 +1,893 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_Bench.c
+ * @brief Loopback throughput / latency benchmark of the ARSTREAM_Sender and ARSTREAM_Reader
+ * @date 10/15/2026
+ *
+ * The sender and the reader run in the same process, each one on its own ARNETWORK_Manager_t.
+ * The data fragments are read by the reader through an ARSTREAM_Impairment_t (loss rate of the run,
+ * plus the optionnal impairment description), and the acks optionnally through another one.
+ * Frames sizes are replayed from a trace, and the impairments are seeded, so that two runs of the
+ * benchmark with the same arguments send the same frames at the same times, and lose the same packets.
+ */
+
+/*
+ * System Headers
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARStream/ARSTREAM_Reader.h>
+#include <libARStream/ARSTREAM_Sender.h>
+
+#include "../ARSTREAM_TB_Config.h"
+#include "../Impairment/ARSTREAM_TB_Impairment.h"
+
+/*
+ * Macros
+ */
+
+#define ACK_BUFFER_ID (13)
+#define DATA_BUFFER_ID (125)
+
+#define BENCH_IP "127.0.0.1"
+#define SENDER_PORT (54321)
+#define READER_PORT (43210)
+
+#define BENCH_PING_DELAY (0) // Use default value
+#define BENCH_RECV_TIMEOUT_SEC (1)
+
+#define NB_BUFFERS (64)
+
+#define DEFAULT_FPS (30)
+#define DEFAULT_NB_FRAMES (1000)
+#define DEFAULT_SEED (1)
+
+#define I_FRAME_EVERY_N (30)
+
+/* Synthetic trace, used when no trace file is given */
+#define FRAME_MIN_SIZE (2000)
+#define FRAME_MAX_SIZE (40000)
+#define SYNTHETIC_TRACE_NB_FRAMES (300)
+
+/* Each frame starts with its index in the run, to match the reader frames with the sender frames */
+#define FRAME_HEADER_SIZE (sizeof (uint32_t))
+
+#define MAX_SWEEP_VALUES (16)
+
+#define DRAIN_TIME_MS (1000) // Time given to the last frames to be delivered before stopping a run
+
+#define __TAG__ "ARSTREAM_Bench"
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Frames sizes replayed by each run
+ */
+typedef struct {
+    uint32_t *sizes;
+    uint8_t *isFlush;
+    int nbFrames;
+    int capacity;
+} ARSTREAM_Bench_Trace_t;
+
+/**
+ * @brief State of one run of the benchmark
+ */
+typedef struct {
+    /* Parameters */
+    uint32_t fragmentSize;
+    uint32_t maxNbFragments;
+    float lossPercent;
+    int nbFrames;
+    ARSTREAM_Impairment_Params_t dataImpairmentParams;
+    ARSTREAM_Impairment_Params_t ackImpairmentParams;
+    const uint8_t *encryptionKey; /**< NULL for a clear stream */
+
+    /* Sender side (written by the main thread and the sender callback) */
+    uint8_t *buffers [NB_BUFFERS];
+    int bufferIsFree [NB_BUFFERS];
+    int nextBuffer;
+    struct timespec *sendTimes;
+    int nbQueued;
+    struct timespec firstSendTime;
+
+    /* Reader side (written by the reader data thread only) */
+    uint8_t *received;
+    uint32_t *latenciesUs;
+    int nbLatencies;
+    uint64_t receivedBytes;
+    struct timespec lastReceptionTime;
+} ARSTREAM_Bench_Run_t;
+
+/*
+ * Globals
+ */
+
+static int stillRunning = 1;
+
+static char *appName;
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Print the parameters of the application
+ */
+void ARSTREAM_Bench_printUsage ();
+
+/**
+ * @brief Parses a comma separated list of numbers
+ * @param arg The list to parse
+ * @param[out] values Array which will hold the values
+ * @return The number of values, or -1 if the list is invalid or too long
+ */
+static int ARSTREAM_Bench_ParseList (const char *arg, float values [MAX_SWEEP_VALUES]);
+
+/**
+ * @brief Adds a frame to a trace
+ * @return 0 on success, -1 on allocation failure
+ */
+static int ARSTREAM_Bench_TraceAdd (ARSTREAM_Bench_Trace_t *trace, uint32_t size, int isFlush);
+
+/**
+ * @brief Loads a trace file
+ * Each non empty line which does not start with '#' holds a frame size, optionally followed by 1 if
+ * the frame flushes the previous ones (I-Frame). This is the format written by the "-t" option of
+ * the MP4Sender testbench.
+ * @return 0 on success, -1 on error
+ */
+static int ARSTREAM_Bench_LoadTrace (const char *path, ARSTREAM_Bench_Trace_t *trace);
+
+/**
+ * @brief Fills a trace with random sizes between FRAME_MIN_SIZE and FRAME_MAX_SIZE
+ * @return 0 on success, -1 on allocation failure
+ */
+static int ARSTREAM_Bench_MakeSyntheticTrace (ARSTREAM_Bench_Trace_t *trace, unsigned int seed);
+
+/**
+ * @brief Creates a network manager with its wifi backend on the loopback interface
+ * @param[out] alManager Pointer which will hold the backend, to give back to ARSTREAM_Bench_DeleteNetwork
+ * @return The new manager, or NULL on error
+ */
+static ARNETWORK_Manager_t* ARSTREAM_Bench_NewNetwork (int sendingPort, int receivingPort, ARNETWORK_IOBufferParam_t *inParams, ARNETWORK_IOBufferParam_t *outParams, ARNETWORKAL_Manager_t **alManager);
+
+/**
+ * @brief Deletes a network manager created by ARSTREAM_Bench_NewNetwork
+ */
+static void ARSTREAM_Bench_DeleteNetwork (ARNETWORK_Manager_t **manager, ARNETWORKAL_Manager_t **alManager);
+
+/**
+ * @see ARSTREAM_Sender.h
+ */
+void ARSTREAM_Bench_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom);
+
+/**
+ * @see ARSTREAM_Reader.h
+ */
+void ARSTREAM_Bench_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom);
+
+/**
+ * @brief Replays the trace through the sender at the given frame rate
+ */
+static void ARSTREAM_Bench_ReplayTrace (ARSTREAM_Bench_Run_t *run, ARSTREAM_Sender_t *sender, ARSTREAM_Bench_Trace_t *trace, int fps);
+
+/**
+ * @brief Runs the benchmark for one set of parameters, and writes its CSV line
+ * @return 0 on success, 1 on error
+ */
+static int ARSTREAM_Bench_Run (ARSTREAM_Bench_Run_t *run, ARSTREAM_Bench_Trace_t *trace, int fps, FILE *out);
+
+/*
+ * Internal functions implementation
+ */
+
+void ARSTREAM_Bench_printUsage ()
+{
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s [-t trace] [-n frames] [-r fps] [-f sizes] [-c counts] [-l losses] [-i data] [-a ack] [-s seed] [-k key] [-o out.csv]", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        trace -> frame sizes file (one \"size [flush]\" per line), random sizes if not given");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        frames -> number of frames sent by each run, the trace is looped (default %d)", DEFAULT_NB_FRAMES);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        fps -> frame rate of the replay (default %d)", DEFAULT_FPS);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        sizes -> comma separated fragment sizes to sweep (default %d)", ARSTREAM_TB_FRAG_SIZE);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        counts -> comma separated max number of fragments to sweep (default %d)", ARSTREAM_TB_MAX_NB_FRAG);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        losses -> comma separated data loss percentages to sweep, override the data impairment loss (default 0)");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        data -> impairment of the data path, e.g. \"ge=2:25:60,jitter=10\" (see ARSTREAM_TB_Impairment.h)");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        ack -> impairment of the ack path");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        seed -> seed of the synthetic trace, and default seed of the impairments (default %d)", DEFAULT_SEED);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        key -> %d hex digits stream encryption key, clear stream if not given", 2 * ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        out.csv -> output file, stdout if not given");
+}
+
+static int ARSTREAM_Bench_ParseList (const char *arg, float values [MAX_SWEEP_VALUES])
+{
+    int nbValues = 0;
+    const char *current = arg;
+    char *end = NULL;
+    while (*current != '\0')
+    {
+        if (nbValues >= MAX_SWEEP_VALUES)
+        {
+            return -1;
+        }
+        values [nbValues] = strtof (current, &end);
+        if ((end == current) ||
+            (values [nbValues] < 0.f))
+        {
+            return -1;
+        }
+        nbValues++;
+        current = end;
+        if (*current == ',')
+        {
+            current++;
+        }
+        else if (*current != '\0')
+        {
+            return -1;
+        }
+    }
+    return nbValues;
+}
+
+static int ARSTREAM_Bench_ParseKey (const char *arg, uint8_t key [ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE])
+{
+    int index;
+    unsigned int byte;
+    if (strlen (arg) != 2 * ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE)
+    {
+        return -1;
+    }
+    for (index = 0; index < ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE; index++)
+    {
+        if ((isxdigit ((unsigned char)arg [2 * index]) == 0) ||
+            (isxdigit ((unsigned char)arg [2 * index + 1]) == 0) ||
+            (sscanf (&arg [2 * index], "%2x", &byte) != 1))
+        {
+            return -1;
+        }
+        key [index] = (uint8_t)byte;
+    }
+    return 0;
+}
+
+static int ARSTREAM_Bench_TraceAdd (ARSTREAM_Bench_Trace_t *trace, uint32_t size, int isFlush)
+{
+    if (trace->nbFrames >= trace->capacity)
+    {
+        int newCapacity = (trace->capacity > 0) ? 2 * trace->capacity : 256;
+        uint32_t *newSizes = realloc (trace->sizes, newCapacity * sizeof (uint32_t));
+        if (newSizes == NULL)
+        {
+            return -1;
+        }
+        trace->sizes = newSizes;
+        uint8_t *newIsFlush = realloc (trace->isFlush, newCapacity * sizeof (uint8_t));
+        if (newIsFlush == NULL)
+        {
+            return -1;
+        }
+        trace->isFlush = newIsFlush;
+        trace->capacity = newCapacity;
+    }
+    trace->sizes [trace->nbFrames] = (size < FRAME_HEADER_SIZE) ? FRAME_HEADER_SIZE : size;
+    trace->isFlush [trace->nbFrames] = (isFlush != 0) ? 1 : 0;
+    trace->nbFrames++;
+    return 0;
+}
+
+static int ARSTREAM_Bench_LoadTrace (const char *path, ARSTREAM_Bench_Trace_t *trace)
+{
+    char line [128];
+    int retVal = 0;
+    FILE *traceFile = fopen (path, "r");
+    if (traceFile == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to open trace %s : %s", path, strerror (errno));
+        return -1;
+    }
+    while ((retVal == 0) &&
+           (fgets (line, sizeof (line), traceFile) != NULL))
+    {
+        unsigned int size;
+        int isFlush = 0;
+        if ((line [0] == '#') ||
+            (sscanf (line, "%u %d", &size, &isFlush) < 1))
+        {
+            continue;
+        }
+        retVal = ARSTREAM_Bench_TraceAdd (trace, size, isFlush);
+    }
+    fclose (traceFile);
+    if ((retVal == 0) &&
+        (trace->nbFrames == 0))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Trace %s holds no frame", path);
+        retVal = -1;
+    }
+    return retVal;
+}
+
+static int ARSTREAM_Bench_MakeSyntheticTrace (ARSTREAM_Bench_Trace_t *trace, unsigned int seed)
+{
+    int retVal = 0;
+    int i;
+    for (i = 0; (retVal == 0) && (i < SYNTHETIC_TRACE_NB_FRAMES); i++)
+    {
+        uint32_t size = FRAME_MIN_SIZE + (rand_r (&seed) % (FRAME_MAX_SIZE - FRAME_MIN_SIZE + 1));
+        retVal = ARSTREAM_Bench_TraceAdd (trace, size, ((i % I_FRAME_EVERY_N) == 0) ? 1 : 0);
+    }
+    return retVal;
+}
+
+static ARNETWORK_Manager_t* ARSTREAM_Bench_NewNetwork (int sendingPort, int receivingPort, ARNETWORK_IOBufferParam_t *inParams, ARNETWORK_IOBufferParam_t *outParams, ARNETWORKAL_Manager_t **alManager)
+{
+    ARNETWORK_Manager_t *manager = NULL;
+    eARNETWORK_ERROR error = ARNETWORK_OK;
+    eARNETWORKAL_ERROR specificError = ARNETWORKAL_OK;
+
+    *alManager = ARNETWORKAL_Manager_New (&specificError);
+    if (specificError == ARNETWORKAL_OK)
+    {
+        specificError = ARNETWORKAL_Manager_InitWifiNetwork (*alManager, BENCH_IP, sendingPort, receivingPort, BENCH_RECV_TIMEOUT_SEC);
+    }
+
+    if (specificError == ARNETWORKAL_OK)
+    {
+        manager = ARNETWORK_Manager_New (*alManager, 1, inParams, 1, outParams, BENCH_PING_DELAY, NULL, NULL, &error);
+    }
+    else
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARNETWORKAL init : %s", ARNETWORKAL_Error_ToString (specificError));
+        ARNETWORKAL_Manager_Delete (alManager);
+        return NULL;
+    }
+
+    if ((manager == NULL) ||
+        (error != ARNETWORK_OK))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARNETWORK_Manager_New call : %s", ARNETWORK_Error_ToString (error));
+        ARNETWORK_Manager_Delete (&manager);
+        ARNETWORKAL_Manager_CloseWifiNetwork (*alManager);
+        ARNETWORKAL_Manager_Delete (alManager);
+    }
+    return manager;
+}
+
+static void ARSTREAM_Bench_DeleteNetwork (ARNETWORK_Manager_t **manager, ARNETWORKAL_Manager_t **alManager)
+{
+    ARNETWORK_Manager_Delete (manager);
+    ARNETWORKAL_Manager_CloseWifiNetwork (*alManager);
+    ARNETWORKAL_Manager_Delete (alManager);
+}
+
+void ARSTREAM_Bench_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom)
+{
+    ARSTREAM_Bench_Run_t *run = (ARSTREAM_Bench_Run_t *)custom;
+    int i;
+    frameSize = frameSize;
+    if ((status != ARSTREAM_SENDER_STATUS_FRAME_SENT) &&
+        (status != ARSTREAM_SENDER_STATUS_FRAME_CANCEL))
+    {
+        return;
+    }
+    for (i = 0; i < NB_BUFFERS; i++)
+    {
+        if (run->buffers [i] == framePointer)
+        {
+            __atomic_store_n (&(run->bufferIsFree [i]), 1, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void ARSTREAM_Bench_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom)
+{
+    ARSTREAM_Bench_Run_t *run = (ARSTREAM_Bench_Run_t *)custom;
+    struct timespec now;
+    uint32_t index;
+    numberOfSkippedFrames = numberOfSkippedFrames;
+    isFlushFrame = isFlushFrame;
+
+    if ((frameSize < FRAME_HEADER_SIZE) ||
+        (ARSTREAM_Reader_FrameIsPartial (frame) == 1))
+    {
+        return;
+    }
+    memcpy (&index, framePointer, FRAME_HEADER_SIZE);
+    if ((index >= (uint32_t)run->nbFrames) ||
+        (run->received [index] == 1))
+    {
+        return;
+    }
+
+    ARSAL_Time_GetTime (&now);
+    run->received [index] = 1;
+    run->latenciesUs [run->nbLatencies] = (uint32_t)((now.tv_sec - run->sendTimes [index].tv_sec) * 1000000 + (now.tv_nsec - run->sendTimes [index].tv_nsec) / 1000);
+    run->nbLatencies++;
+    run->receivedBytes += frameSize;
+    run->lastReceptionTime = now;
+}
+
+static void ARSTREAM_Bench_ReplayTrace (ARSTREAM_Bench_Run_t *run, ARSTREAM_Sender_t *sender, ARSTREAM_Bench_Trace_t *trace, int fps)
+{
+    struct timespec nextFrameTime;
+    int i;
+    clock_gettime (CLOCK_MONOTONIC, &nextFrameTime);
+    ARSAL_Time_GetTime (&(run->firstSendTime));
+
+    for (i = 0; i < run->nbFrames; i++)
+    {
+        uint32_t frameSize = trace->sizes [i % trace->nbFrames];
+        int isFlush = trace->isFlush [i % trace->nbFrames];
+        uint8_t *buffer = NULL;
+        int bufferIndex = -1;
+        int nbTests;
+
+        for (nbTests = 0; (buffer == NULL) && (nbTests < NB_BUFFERS); nbTests++)
+        {
+            if (__atomic_load_n (&(run->bufferIsFree [run->nextBuffer]), __ATOMIC_ACQUIRE) == 1)
+            {
+                bufferIndex = run->nextBuffer;
+                buffer = run->buffers [bufferIndex];
+            }
+            run->nextBuffer = (run->nextBuffer + 1) % NB_BUFFERS;
+        }
+
+        if (buffer != NULL)
+        {
+            eARSTREAM_ERROR err;
+            int nbPrevious;
+            uint32_t index = (uint32_t)i;
+            memcpy (buffer, &index, FRAME_HEADER_SIZE);
+            run->bufferIsFree [bufferIndex] = 0;
+            ARSAL_Time_GetTime (&(run->sendTimes [i]));
+            err = ARSTREAM_Sender_SendNewFrame (sender, buffer, frameSize, isFlush, &nbPrevious);
+            if (err == ARSTREAM_OK)
+            {
+                run->nbQueued++;
+            }
+            else
+            {
+                // Frame too large for this fragmentation, or queue full
+                __atomic_store_n (&(run->bufferIsFree [bufferIndex]), 1, __ATOMIC_RELEASE);
+            }
+        }
+
+        nextFrameTime.tv_nsec += 1000000000 / fps;
+        while (nextFrameTime.tv_nsec >= 1000000000)
+        {
+            nextFrameTime.tv_nsec -= 1000000000;
+            nextFrameTime.tv_sec++;
+        }
+        while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrameTime, NULL) == EINTR);
+    }
+}
+
+static int ARSTREAM_Bench_CompareLatencies (const void *a, const void *b)
+{
+    uint32_t la = *(const uint32_t *)a;
+    uint32_t lb = *(const uint32_t *)b;
+    return (la > lb) - (la < lb);
+}
+
+static int64_t ARSTREAM_Bench_Percentile (ARSTREAM_Bench_Run_t *run, int perThousand)
+{
+    int index;
+    if (run->nbLatencies == 0)
+    {
+        return -1;
+    }
+    /* Nearest rank : ceil (n * p) - 1 */
+    index = (int)(((int64_t)run->nbLatencies * perThousand + 999) / 1000) - 1;
+    if (index < 0)
+    {
+        index = 0;
+    }
+    return run->latenciesUs [index];
+}
+
+static int ARSTREAM_Bench_Run (ARSTREAM_Bench_Run_t *run, ARSTREAM_Bench_Trace_t *trace, int fps, FILE *out)
+{
+    int retVal = 0;
+    int i;
+    uint32_t maxFrameSize = FRAME_HEADER_SIZE;
+    eARSTREAM_ERROR err;
+    ARNETWORK_IOBufferParam_t dataParams;
+    ARNETWORK_IOBufferParam_t ackParams;
+    ARNETWORKAL_Manager_t *senderAlManager = NULL;
+    ARNETWORKAL_Manager_t *readerAlManager = NULL;
+    ARNETWORK_Manager_t *senderManager = NULL;
+    ARNETWORK_Manager_t *readerManager = NULL;
+    ARSTREAM_Sender_t *sender = NULL;
+    ARSTREAM_Reader_t *reader = NULL;
+    ARSTREAM_Impairment_t *dataImpairment = NULL;
+    ARSTREAM_Impairment_t *ackImpairment = NULL;
+    ARSTREAM_Impairment_Counters_t dataImpairmentCounters;
+    ARSTREAM_Sender_Stats_t senderStats;
+    struct rusage usageStart, usageEnd;
+    pthread_t senderNetSend, senderNetRead, readerNetSend, readerNetRead;
+    pthread_t senderData, senderAck, readerData, readerAck;
+
+    /* Allocations */
+    for (i = 0; i < trace->nbFrames; i++)
+    {
+        if (trace->sizes [i] > maxFrameSize)
+        {
+            maxFrameSize = trace->sizes [i];
+        }
+    }
+    run->sendTimes = calloc (run->nbFrames, sizeof (struct timespec));
+    run->received = calloc (run->nbFrames, sizeof (uint8_t));
+    run->latenciesUs = calloc (run->nbFrames, sizeof (uint32_t));
+    if ((run->sendTimes == NULL) ||
+        (run->received == NULL) ||
+        (run->latenciesUs == NULL))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to allocate the run arrays");
+        retVal = 1;
+    }
+    for (i = 0; (retVal == 0) && (i < NB_BUFFERS); i++)
+    {
+        run->buffers [i] = malloc (maxFrameSize);
+        run->bufferIsFree [i] = 1;
+        if (run->buffers [i] == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to allocate the frame buffers");
+            retVal = 1;
+        }
+        else
+        {
+            memset (run->buffers [i], i, maxFrameSize);
+        }
+    }
+
+    /* Networks */
+    if (retVal == 0)
+    {
+        ARSTREAM_Sender_InitStreamDataBuffer (&dataParams, DATA_BUFFER_ID, run->fragmentSize, run->maxNbFragments);
+        ARSTREAM_Sender_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+        senderManager = ARSTREAM_Bench_NewNetwork (READER_PORT, SENDER_PORT, &dataParams, &ackParams, &senderAlManager);
+        ackImpairment = ARSTREAM_Impairment_New (&(run->ackImpairmentParams), ackParams.dataCopyMaxSize, &err);
+        ARSTREAM_Reader_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+        ARSTREAM_Reader_InitStreamDataBuffer (&dataParams, DATA_BUFFER_ID, run->fragmentSize, run->maxNbFragments);
+        readerManager = ARSTREAM_Bench_NewNetwork (SENDER_PORT, READER_PORT, &ackParams, &dataParams, &readerAlManager);
+        dataImpairment = ARSTREAM_Impairment_New (&(run->dataImpairmentParams), dataParams.dataCopyMaxSize, &err);
+        if ((senderManager == NULL) ||
+            (readerManager == NULL) ||
+            (dataImpairment == NULL) ||
+            (ackImpairment == NULL))
+        {
+            if (senderManager != NULL)
+            {
+                ARSTREAM_Bench_DeleteNetwork (&senderManager, &senderAlManager);
+            }
+            if (readerManager != NULL)
+            {
+                ARSTREAM_Bench_DeleteNetwork (&readerManager, &readerAlManager);
+            }
+            retVal = 1;
+        }
+    }
+
+    /* Streams */
+    if (retVal == 0)
+    {
+        pthread_create (&senderNetSend, NULL, ARNETWORK_Manager_SendingThreadRun, senderManager);
+        pthread_create (&senderNetRead, NULL, ARNETWORK_Manager_ReceivingThreadRun, senderManager);
+        pthread_create (&readerNetSend, NULL, ARNETWORK_Manager_SendingThreadRun, readerManager);
+        pthread_create (&readerNetRead, NULL, ARNETWORK_Manager_ReceivingThreadRun, readerManager);
+
+        reader = ARSTREAM_Reader_NewWithFramePool (readerManager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_Bench_FrameReadyCallback, 0, run->fragmentSize, ARSTREAM_READER_MAX_ACK_INTERVAL_DEFAULT, run, &err);
+        if (reader == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Reader_NewWithFramePool call : %s", ARSTREAM_Error_ToString (err));
+            retVal = 1;
+        }
+        else
+        {
+            sender = ARSTREAM_Sender_New (senderManager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_Bench_FrameUpdateCallback, NB_BUFFERS, run->fragmentSize, run->maxNbFragments, run, &err);
+            if (sender == NULL)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Sender_New call : %s", ARSTREAM_Error_ToString (err));
+                ARSTREAM_Reader_Delete (&reader);
+                retVal = 1;
+            }
+        }
+
+        if (retVal == 0)
+        {
+            ARSTREAM_Reader_SetDataImpairment (reader, dataImpairment);
+            ARSTREAM_Sender_SetAckImpairment (sender, ackImpairment);
+            if (run->encryptionKey != NULL)
+            {
+                ARSTREAM_Reader_SetEncryptionKey (reader, run->encryptionKey, ARSTREAM_READER_ENCRYPTION_KEY_SIZE);
+                ARSTREAM_Sender_SetEncryptionKey (sender, run->encryptionKey, ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE);
+            }
+            pthread_create (&readerData, NULL, ARSTREAM_Reader_RunDataThread, reader);
+            pthread_create (&readerAck, NULL, ARSTREAM_Reader_RunAckThread, reader);
+            pthread_create (&senderData, NULL, ARSTREAM_Sender_RunDataThread, sender);
+            pthread_create (&senderAck, NULL, ARSTREAM_Sender_RunAckThread, sender);
+
+            getrusage (RUSAGE_SELF, &usageStart);
+            ARSTREAM_Bench_ReplayTrace (run, sender, trace, fps);
+            usleep (1000 * DRAIN_TIME_MS);
+            getrusage (RUSAGE_SELF, &usageEnd);
+
+            ARSTREAM_Sender_GetStats (sender, &senderStats);
+            ARSTREAM_Impairment_GetCounters (dataImpairment, &dataImpairmentCounters);
+
+            ARSTREAM_Sender_StopSender (sender);
+            ARSTREAM_Reader_StopReader (reader);
+            pthread_join (senderAck, NULL);
+            pthread_join (senderData, NULL);
+            pthread_join (readerAck, NULL);
+            pthread_join (readerData, NULL);
+            ARSTREAM_Sender_Delete (&sender);
+            ARSTREAM_Reader_Delete (&reader);
+        }
+
+        ARNETWORK_Manager_Stop (senderManager);
+        ARNETWORK_Manager_Stop (readerManager);
+        pthread_join (senderNetRead, NULL);
+        pthread_join (senderNetSend, NULL);
+        pthread_join (readerNetRead, NULL);
+        pthread_join (readerNetSend, NULL);
+        ARSTREAM_Bench_DeleteNetwork (&senderManager, &senderAlManager);
+        ARSTREAM_Bench_DeleteNetwork (&readerManager, &readerAlManager);
+    }
+
+    if (dataImpairment != NULL)
+    {
+        ARSTREAM_Impairment_Delete (&dataImpairment);
+    }
+    if (ackImpairment != NULL)
+    {
+        ARSTREAM_Impairment_Delete (&ackImpairment);
+    }
+
+    /* Report */
+    if (retVal == 0)
+    {
+        int64_t cpuUs = ((int64_t)(usageEnd.ru_utime.tv_sec - usageStart.ru_utime.tv_sec) + (usageEnd.ru_stime.tv_sec - usageStart.ru_stime.tv_sec)) * 1000000 +
+            (usageEnd.ru_utime.tv_usec - usageStart.ru_utime.tv_usec) + (usageEnd.ru_stime.tv_usec - usageStart.ru_stime.tv_usec);
+        int32_t durationMs = ARSAL_Time_ComputeTimespecMsTimeDiff (&(run->firstSendTime), &(run->lastReceptionTime));
+        qsort (run->latenciesUs, run->nbLatencies, sizeof (uint32_t), ARSTREAM_Bench_CompareLatencies);
+        fprintf (out, "%u,%u,%.2f,%d,%d,%d,%lld,%lld,%lld,%.1f,%.1f,%u,%u,%u\n",
+                 run->fragmentSize, run->maxNbFragments, run->lossPercent,
+                 run->nbFrames, run->nbQueued, run->nbLatencies,
+                 (long long)ARSTREAM_Bench_Percentile (run, 500),
+                 (long long)ARSTREAM_Bench_Percentile (run, 990),
+                 (long long)ARSTREAM_Bench_Percentile (run, 999),
+                 (durationMs > 0) ? (8.f * run->receivedBytes) / durationMs : 0.f,
+                 (run->nbQueued > 0) ? (float)cpuUs / run->nbQueued : 0.f,
+                 senderStats.nbFragmentsSent, senderStats.nbFragmentsRetransmitted,
+                 dataImpairmentCounters.nbPacketsLost);
+        fflush (out);
+    }
+
+    for (i = 0; i < NB_BUFFERS; i++)
+    {
+        free (run->buffers [i]);
+    }
+    free (run->sendTimes);
+    free (run->received);
+    free (run->latenciesUs);
+
+    return retVal;
+}
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_Bench_Main (int argc, char *argv[])
+{
+    int retVal = 0;
+    int opt;
+    char *tracePath = NULL;
+    char *outPath = NULL;
+    char *dataImpairment = "";
+    char *ackImpairment = "";
+    ARSTREAM_Impairment_Params_t dataImpairmentParams;
+    ARSTREAM_Impairment_Params_t ackImpairmentParams;
+    int nbFrames = DEFAULT_NB_FRAMES;
+    int fps = DEFAULT_FPS;
+    unsigned int seed = DEFAULT_SEED;
+    float fragmentSizes [MAX_SWEEP_VALUES] = {ARSTREAM_TB_FRAG_SIZE};
+    int nbFragmentSizes = 1;
+    float fragmentCounts [MAX_SWEEP_VALUES] = {ARSTREAM_TB_MAX_NB_FRAG};
+    int nbFragmentCounts = 1;
+    float losses [MAX_SWEEP_VALUES] = {0.f};
+    int nbLosses = 0;
+    uint8_t encryptionKey [ARSTREAM_SENDER_ENCRYPTION_KEY_SIZE];
+    int isEncrypted = 0;
+    ARSTREAM_Bench_Trace_t trace = {0};
+    FILE *out = stdout;
+    int sizeIndex, countIndex, lossIndex;
+
+    appName = argv[0];
+    while ((opt = getopt (argc, argv, "t:n:r:f:c:l:i:a:s:k:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            tracePath = optarg;
+            break;
+        case 'n':
+            nbFrames = atoi (optarg);
+            break;
+        case 'r':
+            fps = atoi (optarg);
+            break;
+        case 'f':
+            nbFragmentSizes = ARSTREAM_Bench_ParseList (optarg, fragmentSizes);
+            break;
+        case 'c':
+            nbFragmentCounts = ARSTREAM_Bench_ParseList (optarg, fragmentCounts);
+            break;
+        case 'l':
+            nbLosses = ARSTREAM_Bench_ParseList (optarg, losses);
+            break;
+        case 'i':
+            dataImpairment = optarg;
+            break;
+        case 'a':
+            ackImpairment = optarg;
+            break;
+        case 's':
+            seed = (unsigned int)strtoul (optarg, NULL, 0);
+            break;
+        case 'k':
+            if (ARSTREAM_Bench_ParseKey (optarg, encryptionKey) != 0)
+            {
+                retVal = 1;
+            }
+            isEncrypted = 1;
+            break;
+        case 'o':
+            outPath = optarg;
+            break;
+        default:
+            retVal = 1;
+            break;
+        }
+    }
+    if ((retVal != 0) ||
+        (optind != argc) ||
+        (nbFrames <= 0) ||
+        (fps <= 0) ||
+        (nbFragmentSizes <= 0) ||
+        (nbFragmentCounts <= 0) ||
+        (nbLosses < 0) ||
+        (ARSTREAM_TB_Impairment_ParseParams (dataImpairment, &dataImpairmentParams) != 0) ||
+        (ARSTREAM_TB_Impairment_ParseParams (ackImpairment, &ackImpairmentParams) != 0))
+    {
+        ARSTREAM_Bench_printUsage ();
+        return 1;
+    }
+
+    if (nbLosses == 0)
+    {
+        losses [0] = dataImpairmentParams.lossPercent;
+        nbLosses = 1;
+    }
+    if (strstr (dataImpairment, "seed=") == NULL)
+    {
+        dataImpairmentParams.seed = seed;
+    }
+    if (strstr (ackImpairment, "seed=") == NULL)
+    {
+        ackImpairmentParams.seed = seed + 1;
+    }
+
+    if (tracePath != NULL)
+    {
+        retVal = ARSTREAM_Bench_LoadTrace (tracePath, &trace);
+    }
+    else
+    {
+        retVal = ARSTREAM_Bench_MakeSyntheticTrace (&trace, seed);
+    }
+    if (retVal != 0)
+    {
+        free (trace.sizes);
+        free (trace.isFlush);
+        return 1;
+    }
+
+    if (outPath != NULL)
+    {
+        out = fopen (outPath, "w");
+        if (out == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to open %s : %s", outPath, strerror (errno));
+            free (trace.sizes);
+            free (trace.isFlush);
+            return 1;
+        }
+    }
+
+    fprintf (out, "fragmentSize,maxNbFragments,lossPercent,nbFrames,nbFramesQueued,nbFramesReceived,latencyP50Us,latencyP99Us,latencyP999Us,goodputKbps,cpuUsPerFrame,nbFragmentsSent,nbFragmentsRetransmitted,nbFragmentsLost\n");
+
+    stillRunning = 1;
+    for (sizeIndex = 0; (retVal == 0) && (sizeIndex < nbFragmentSizes); sizeIndex++)
+    {
+        for (countIndex = 0; (retVal == 0) && (countIndex < nbFragmentCounts); countIndex++)
+        {
+            for (lossIndex = 0; (retVal == 0) && (stillRunning == 1) && (lossIndex < nbLosses); lossIndex++)
+            {
+                ARSTREAM_Bench_Run_t run;
+                memset (&run, 0, sizeof (run));
+                run.fragmentSize = (uint32_t)fragmentSizes [sizeIndex];
+                run.maxNbFragments = (uint32_t)fragmentCounts [countIndex];
+                run.lossPercent = losses [lossIndex];
+                run.nbFrames = nbFrames;
+                run.dataImpairmentParams = dataImpairmentParams;
+                run.dataImpairmentParams.lossPercent = losses [lossIndex];
+                run.ackImpairmentParams = ackImpairmentParams;
+                run.encryptionKey = (isEncrypted == 1) ? encryptionKey : NULL;
+                retVal = ARSTREAM_Bench_Run (&run, &trace, fps, out);
+            }
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose (out);
+    }
+    free (trace.sizes);
+    free (trace.isFlush);
+
+    return retVal;
+}
+
+void ARSTREAM_Bench_Stop ()
+{
+    stillRunning = 0;
+}
@@ -0,0 +1,334 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_CryptoCheck.c
+ * @brief Known answer tests of the stream encryption
+ * @date 10/15/2026
+ *
+ * ARSTREAM_Crypto implements ChaCha20-Poly1305 itself, so its output is checked against the AEAD
+ * test vector of RFC 8439 (section 2.8.2). The rejection checks and the round trips use buffers
+ * drawn from a seeded generator, so that two runs check the same data.
+ */
+
+/*
+ * System Headers
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "../../../Sources/ARSTREAM_Crypto.h"
+
+/*
+ * Macros
+ */
+
+#define DEFAULT_SEED (1)
+
+/* Round trips are checked for all the sizes up to this one (several 64 bytes ChaCha20 blocks) */
+#define ROUND_TRIP_MAX_SIZE (300)
+#define ROUND_TRIP_AAD_SIZE (13)
+
+#define __TAG__ "ARSTREAM_CryptoCheck"
+
+/*
+ * Globals
+ */
+
+static char *appName;
+
+/* RFC 8439, section 2.8.2 */
+static const uint8_t rfcNonce [ARSTREAM_CRYPTO_NONCE_SIZE] = {
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+};
+
+static const uint8_t rfcAad [] = {
+    0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+};
+
+static const char rfcPlaintext [] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+static const uint8_t rfcCiphertext [] = {
+    0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+    0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+    0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+    0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+    0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+    0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+    0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+    0x61, 0x16,
+};
+
+static const uint8_t rfcTag [ARSTREAM_CRYPTO_TAG_SIZE] = {
+    0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91,
+};
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Print the parameters of the application
+ */
+void ARSTREAM_CryptoCheck_printUsage ();
+
+/**
+ * @brief Loads the key of the RFC 8439 test vector (0x80 to 0x9f)
+ */
+static void ARSTREAM_CryptoCheck_SetRfcKey (ARSTREAM_Crypto_Key_t *key);
+
+/**
+ * @brief Seals the RFC 8439 test vector, and compares the result with the expected ciphertext and tag
+ * @return 0 on success, 1 on mismatch
+ */
+static int ARSTREAM_CryptoCheck_RfcSeal ();
+
+/**
+ * @brief Opens the RFC 8439 test vector, and compares the result with the expected plaintext
+ * @return 0 on success, 1 on error
+ */
+static int ARSTREAM_CryptoCheck_RfcOpen ();
+
+/**
+ * @brief Changes each byte of the ciphertext, of the associated data and of the tag of the RFC 8439
+ * test vector in turn, and checks that ARSTREAM_Crypto_Open() rejects each of them, leaving the buffer untouched
+ * @return 0 on success, 1 if a changed buffer was accepted
+ */
+static int ARSTREAM_CryptoCheck_RejectChangedBytes ();
+
+/**
+ * @brief Seals and opens random buffers of every size up to ROUND_TRIP_MAX_SIZE
+ * @return 0 on success, 1 on error
+ */
+static int ARSTREAM_CryptoCheck_RoundTrips (unsigned int seed);
+
+/*
+ * Internal functions implementation
+ */
+
+void ARSTREAM_CryptoCheck_printUsage ()
+{
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s [-s seed]", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        seed -> seed of the round trip buffers (default %d)", DEFAULT_SEED);
+}
+
+static void ARSTREAM_CryptoCheck_SetRfcKey (ARSTREAM_Crypto_Key_t *key)
+{
+    uint8_t keyData [ARSTREAM_CRYPTO_KEY_SIZE];
+    int i;
+    for (i = 0; i < ARSTREAM_CRYPTO_KEY_SIZE; i++)
+    {
+        keyData [i] = (uint8_t)(0x80 + i);
+    }
+    ARSTREAM_Crypto_SetKey (key, keyData);
+}
+
+static int ARSTREAM_CryptoCheck_RfcSeal ()
+{
+    ARSTREAM_Crypto_Key_t key;
+    uint8_t data [sizeof (rfcCiphertext)];
+    uint8_t tag [ARSTREAM_CRYPTO_TAG_SIZE];
+    int retVal = 0;
+
+    ARSTREAM_CryptoCheck_SetRfcKey (&key);
+    memcpy (data, rfcPlaintext, sizeof (data));
+    ARSTREAM_Crypto_Seal (&key, rfcNonce, rfcAad, sizeof (rfcAad), data, sizeof (data), tag);
+    if (memcmp (data, rfcCiphertext, sizeof (data)) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : wrong ciphertext");
+        retVal = 1;
+    }
+    if (memcmp (tag, rfcTag, sizeof (tag)) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : wrong tag");
+        retVal = 1;
+    }
+    return retVal;
+}
+
+static int ARSTREAM_CryptoCheck_RfcOpen ()
+{
+    ARSTREAM_Crypto_Key_t key;
+    uint8_t data [sizeof (rfcCiphertext)];
+    int retVal = 0;
+
+    ARSTREAM_CryptoCheck_SetRfcKey (&key);
+    memcpy (data, rfcCiphertext, sizeof (data));
+    if (ARSTREAM_Crypto_Open (&key, rfcNonce, rfcAad, sizeof (rfcAad), data, sizeof (data), rfcTag) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : valid buffer rejected");
+        retVal = 1;
+    }
+    else if (memcmp (data, rfcPlaintext, sizeof (data)) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : wrong plaintext");
+        retVal = 1;
+    }
+    // No else : vector is opened
+    return retVal;
+}
+
+static int ARSTREAM_CryptoCheck_RejectChangedBytes ()
+{
+    ARSTREAM_Crypto_Key_t key;
+    uint8_t data [sizeof (rfcCiphertext)];
+    uint8_t sealedData [sizeof (rfcCiphertext)];
+    uint8_t aad [sizeof (rfcAad)];
+    uint8_t tag [ARSTREAM_CRYPTO_TAG_SIZE];
+    uint8_t *changed [3] = { data, aad, tag };
+    int changedSize [3] = { sizeof (data), sizeof (aad), sizeof (tag) };
+    const char *changedName [3] = { "ciphertext", "associated data", "tag" };
+    int part;
+    int index;
+    int retVal = 0;
+
+    ARSTREAM_CryptoCheck_SetRfcKey (&key);
+    for (part = 0; part < 3; part++)
+    {
+        for (index = 0; index < changedSize [part]; index++)
+        {
+            memcpy (data, rfcCiphertext, sizeof (data));
+            memcpy (aad, rfcAad, sizeof (aad));
+            memcpy (tag, rfcTag, sizeof (tag));
+            changed [part][index] ^= 0x01;
+            memcpy (sealedData, data, sizeof (data));
+            if (ARSTREAM_Crypto_Open (&key, rfcNonce, aad, sizeof (aad), data, sizeof (data), tag) == 0)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : changed byte %d of the %s was accepted", index, changedName [part]);
+                retVal = 1;
+            }
+            else if (memcmp (data, sealedData, sizeof (data)) != 0)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "RFC 8439 vector : rejected buffer was modified");
+                retVal = 1;
+            }
+            // No else : changed byte is rejected
+        }
+    }
+    return retVal;
+}
+
+static int ARSTREAM_CryptoCheck_RoundTrips (unsigned int seed)
+{
+    ARSTREAM_Crypto_Key_t key;
+    uint8_t keyData [ARSTREAM_CRYPTO_KEY_SIZE];
+    uint8_t nonce [ARSTREAM_CRYPTO_NONCE_SIZE];
+    uint8_t aad [ROUND_TRIP_AAD_SIZE];
+    uint8_t plain [ROUND_TRIP_MAX_SIZE];
+    uint8_t data [ROUND_TRIP_MAX_SIZE + ARSTREAM_CRYPTO_TAG_SIZE];
+    int size;
+    int i;
+    int retVal = 0;
+
+    for (size = 0; (retVal == 0) && (size <= ROUND_TRIP_MAX_SIZE); size++)
+    {
+        for (i = 0; i < ARSTREAM_CRYPTO_KEY_SIZE; i++)
+        {
+            keyData [i] = (uint8_t)rand_r (&seed);
+        }
+        for (i = 0; i < ARSTREAM_CRYPTO_NONCE_SIZE; i++)
+        {
+            nonce [i] = (uint8_t)rand_r (&seed);
+        }
+        for (i = 0; i < ROUND_TRIP_AAD_SIZE; i++)
+        {
+            aad [i] = (uint8_t)rand_r (&seed);
+        }
+        for (i = 0; i < size; i++)
+        {
+            plain [i] = (uint8_t)rand_r (&seed);
+        }
+        ARSTREAM_Crypto_SetKey (&key, keyData);
+
+        /* The tag directly follows the data, as in the fragments */
+        memcpy (data, plain, size);
+        ARSTREAM_Crypto_Seal (&key, nonce, aad, sizeof (aad), data, size, &data [size]);
+        if ((size > 0) &&
+            (memcmp (data, plain, size) == 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Round trip of %d bytes : buffer was not encrypted", size);
+            retVal = 1;
+        }
+        else if (ARSTREAM_Crypto_Open (&key, nonce, aad, sizeof (aad), data, size, &data [size]) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Round trip of %d bytes : valid buffer rejected", size);
+            retVal = 1;
+        }
+        else if (memcmp (data, plain, size) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Round trip of %d bytes : wrong plaintext", size);
+            retVal = 1;
+        }
+        // No else : round trip is valid
+    }
+    return retVal;
+}
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_CryptoCheck_Main (int argc, char *argv[])
+{
+    int retVal = 0;
+    int opt;
+    unsigned int seed = DEFAULT_SEED;
+
+    appName = argv[0];
+    while ((opt = getopt (argc, argv, "s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            seed = (unsigned int)strtoul (optarg, NULL, 10);
+            break;
+        default:
+            ARSTREAM_CryptoCheck_printUsage ();
+            return 1;
+        }
+    }
+
+    retVal |= ARSTREAM_CryptoCheck_RfcSeal ();
+    retVal |= ARSTREAM_CryptoCheck_RfcOpen ();
+    retVal |= ARSTREAM_CryptoCheck_RejectChangedBytes ();
+    retVal |= ARSTREAM_CryptoCheck_RoundTrips (seed);
+
+    fprintf (stdout, "%s\n", (retVal == 0) ? "All checks passed" : "Some checks failed");
+    return retVal;
+}
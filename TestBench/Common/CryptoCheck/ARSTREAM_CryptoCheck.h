@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_CryptoCheck.h
+ * @brief Header file for the known answer tests of the stream encryption
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_CRYPTOCHECK_H_
+#define _ARSTREAM_CRYPTOCHECK_H_
+
+/**
+ * @brief Check entry point
+ *
+ * Seals and opens the AEAD test vector of RFC 8439 (section 2.8.2) with ARSTREAM_Crypto, and compares
+ * the results with the expected ciphertext and tag. Then checks that a single changed byte of the
+ * ciphertext, of the associated data or of the tag makes ARSTREAM_Crypto_Open() reject the buffer, and
+ * that buffers of all sizes around the block boundaries go through a seal / open round trip.
+ *
+ * @param argc Argument count of the main function
+ * @param argv Arguments values of the main function
+ * @return The "main" return value (non zero if any check failed)
+ */
+int ARSTREAM_CryptoCheck_Main (int argc, char *argv[]);
+
+#endif /* _ARSTREAM_CRYPTOCHECK_H_ */
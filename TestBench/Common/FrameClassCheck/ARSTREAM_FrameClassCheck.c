@@ -0,0 +1,490 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_FrameClassCheck.c
+ * @brief Loopback check of the non-reference frames drops
+ * @date 10/15/2026
+ *
+ * The sender only drops non-reference frames when the link really falls behind. A round trip time
+ * longer than the frame interval is not a reason to do so : the previous frame is then never
+ * acknowledged when the next one is popped, while the link carries all the frames. This check
+ * delays the acks (through an ARSTREAM_Impairment_t on the sender ack buffer) to get such a round
+ * trip time, sends a low bitrate stream, and counts the frames of each class received by the reader.
+ */
+
+/*
+ * System Headers
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARStream/ARSTREAM_Reader.h>
+#include <libARStream/ARSTREAM_Sender.h>
+
+#include "../ARSTREAM_TB_Config.h"
+
+/*
+ * Macros
+ */
+
+#define ACK_BUFFER_ID (13)
+#define DATA_BUFFER_ID (125)
+
+#define CHECK_IP "127.0.0.1"
+#define SENDER_PORT (54323)
+#define READER_PORT (43212)
+
+#define CHECK_PING_DELAY (0) // Use default value
+#define CHECK_RECV_TIMEOUT_SEC (1)
+
+#define SENDER_QUEUE_SIZE (16)
+
+#define DEFAULT_FPS (30)
+#define DEFAULT_NB_FRAMES (300)
+#define DEFAULT_ACK_DELAY_MS (100)
+
+#define I_FRAME_EVERY_N (30)
+
+/* 2000 bytes frames at 30 fps are 480 kbps, which the loopback carries without any backlog */
+#define FRAME_SIZE (2000)
+
+/* Each frame starts with its index in the run, to match the reader frames with the sender frames */
+#define FRAME_HEADER_SIZE (sizeof (uint32_t))
+
+/* Minimum percentage of the frames of each class which must reach the reader */
+#define MIN_RECEIVED_PERCENT (95)
+
+#define DRAIN_TIME_MS (1000) // Time given to the last frames to be delivered before stopping
+
+#define __TAG__ "ARSTREAM_FrameClassCheck"
+
+/*
+ * Types
+ */
+
+/**
+ * @brief State of the check
+ */
+typedef struct {
+    int nbFrames;
+    uint8_t *frames; /**< nbFrames buffers of FRAME_SIZE bytes, so that no buffer is reused while the sender holds it */
+    eARSTREAM_SENDER_FRAME_CLASS *classes;
+    int nbQueued [ARSTREAM_SENDER_FRAME_CLASS_MAX];
+    int nbCancelled [ARSTREAM_SENDER_FRAME_CLASS_MAX]; /**< Written by the sender callback */
+    uint8_t *received; /**< Written by the reader data thread */
+    int nbReceived [ARSTREAM_SENDER_FRAME_CLASS_MAX]; /**< Written by the reader data thread */
+} ARSTREAM_FrameClassCheck_t;
+
+/*
+ * Globals
+ */
+
+static char *appName;
+
+static const char *classNames [ARSTREAM_SENDER_FRAME_CLASS_MAX] = { "I", "P", "non-reference" };
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Print the parameters of the application
+ */
+void ARSTREAM_FrameClassCheck_printUsage ();
+
+/**
+ * @brief Creates a network manager with its wifi backend on the loopback interface
+ * @param[out] alManager Pointer which will hold the backend, to give back to ARSTREAM_FrameClassCheck_DeleteNetwork
+ * @return The new manager, or NULL on error
+ */
+static ARNETWORK_Manager_t* ARSTREAM_FrameClassCheck_NewNetwork (int sendingPort, int receivingPort, ARNETWORK_IOBufferParam_t *inParams, ARNETWORK_IOBufferParam_t *outParams, ARNETWORKAL_Manager_t **alManager);
+
+/**
+ * @brief Deletes a network manager created by ARSTREAM_FrameClassCheck_NewNetwork
+ */
+static void ARSTREAM_FrameClassCheck_DeleteNetwork (ARNETWORK_Manager_t **manager, ARNETWORKAL_Manager_t **alManager);
+
+/**
+ * @see ARSTREAM_Sender.h
+ */
+void ARSTREAM_FrameClassCheck_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom);
+
+/**
+ * @see ARSTREAM_Reader.h
+ */
+void ARSTREAM_FrameClassCheck_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom);
+
+/**
+ * @brief Sends all the frames of the check at the given frame rate
+ */
+static void ARSTREAM_FrameClassCheck_SendFrames (ARSTREAM_FrameClassCheck_t *check, ARSTREAM_Sender_t *sender, int fps);
+
+/**
+ * @brief Runs the sender and the reader on the loopback interface
+ * @return 0 on success, 1 on error
+ */
+static int ARSTREAM_FrameClassCheck_Run (ARSTREAM_FrameClassCheck_t *check, int fps, int ackDelayMs);
+
+/*
+ * Internal functions implementation
+ */
+
+void ARSTREAM_FrameClassCheck_printUsage ()
+{
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s [-n frames] [-r fps] [-d delay]", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        frames -> number of frames to send (default %d)", DEFAULT_NB_FRAMES);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        fps -> frame rate (default %d)", DEFAULT_FPS);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        delay -> delay of the acks in ms, must be longer than the frame interval (default %d)", DEFAULT_ACK_DELAY_MS);
+}
+
+static ARNETWORK_Manager_t* ARSTREAM_FrameClassCheck_NewNetwork (int sendingPort, int receivingPort, ARNETWORK_IOBufferParam_t *inParams, ARNETWORK_IOBufferParam_t *outParams, ARNETWORKAL_Manager_t **alManager)
+{
+    ARNETWORK_Manager_t *manager = NULL;
+    eARNETWORK_ERROR error = ARNETWORK_OK;
+    eARNETWORKAL_ERROR specificError = ARNETWORKAL_OK;
+
+    *alManager = ARNETWORKAL_Manager_New (&specificError);
+    if (specificError == ARNETWORKAL_OK)
+    {
+        specificError = ARNETWORKAL_Manager_InitWifiNetwork (*alManager, CHECK_IP, sendingPort, receivingPort, CHECK_RECV_TIMEOUT_SEC);
+    }
+
+    if (specificError == ARNETWORKAL_OK)
+    {
+        manager = ARNETWORK_Manager_New (*alManager, 1, inParams, 1, outParams, CHECK_PING_DELAY, NULL, NULL, &error);
+    }
+    else
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARNETWORKAL init : %s", ARNETWORKAL_Error_ToString (specificError));
+        ARNETWORKAL_Manager_Delete (alManager);
+        return NULL;
+    }
+
+    if ((manager == NULL) ||
+        (error != ARNETWORK_OK))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARNETWORK_Manager_New call : %s", ARNETWORK_Error_ToString (error));
+        ARNETWORK_Manager_Delete (&manager);
+        ARNETWORKAL_Manager_CloseWifiNetwork (*alManager);
+        ARNETWORKAL_Manager_Delete (alManager);
+    }
+    return manager;
+}
+
+static void ARSTREAM_FrameClassCheck_DeleteNetwork (ARNETWORK_Manager_t **manager, ARNETWORKAL_Manager_t **alManager)
+{
+    ARNETWORK_Manager_Delete (manager);
+    ARNETWORKAL_Manager_CloseWifiNetwork (*alManager);
+    ARNETWORKAL_Manager_Delete (alManager);
+}
+
+void ARSTREAM_FrameClassCheck_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom)
+{
+    ARSTREAM_FrameClassCheck_t *check = (ARSTREAM_FrameClassCheck_t *)custom;
+    uint32_t index;
+    frameSize = frameSize;
+    if ((status != ARSTREAM_SENDER_STATUS_FRAME_CANCEL) ||
+        (framePointer == NULL))
+    {
+        return;
+    }
+    memcpy (&index, framePointer, FRAME_HEADER_SIZE);
+    if (index < (uint32_t)check->nbFrames)
+    {
+        __atomic_add_fetch (&(check->nbCancelled [check->classes [index]]), 1, __ATOMIC_RELAXED);
+    }
+}
+
+void ARSTREAM_FrameClassCheck_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom)
+{
+    ARSTREAM_FrameClassCheck_t *check = (ARSTREAM_FrameClassCheck_t *)custom;
+    uint32_t index;
+    numberOfSkippedFrames = numberOfSkippedFrames;
+    isFlushFrame = isFlushFrame;
+
+    if ((frameSize < FRAME_HEADER_SIZE) ||
+        (ARSTREAM_Reader_FrameIsPartial (frame) == 1))
+    {
+        return;
+    }
+    memcpy (&index, framePointer, FRAME_HEADER_SIZE);
+    if ((index >= (uint32_t)check->nbFrames) ||
+        (check->received [index] == 1))
+    {
+        return;
+    }
+    check->received [index] = 1;
+    check->nbReceived [check->classes [index]]++;
+}
+
+static void ARSTREAM_FrameClassCheck_SendFrames (ARSTREAM_FrameClassCheck_t *check, ARSTREAM_Sender_t *sender, int fps)
+{
+    struct timespec nextFrameTime;
+    int i;
+    clock_gettime (CLOCK_MONOTONIC, &nextFrameTime);
+
+    for (i = 0; i < check->nbFrames; i++)
+    {
+        uint8_t *buffer = &(check->frames [i * FRAME_SIZE]);
+        uint32_t index = (uint32_t)i;
+        eARSTREAM_ERROR err;
+        int nbPrevious;
+
+        memcpy (buffer, &index, FRAME_HEADER_SIZE);
+        err = ARSTREAM_Sender_SendNewFrameWithDeadline (sender, buffer, FRAME_SIZE, check->classes [i], NULL, &nbPrevious);
+        if (err == ARSTREAM_OK)
+        {
+            check->nbQueued [check->classes [i]]++;
+        }
+        else
+        {
+            ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Unable to queue frame %d : %s", i, ARSTREAM_Error_ToString (err));
+        }
+
+        nextFrameTime.tv_nsec += 1000000000 / fps;
+        while (nextFrameTime.tv_nsec >= 1000000000)
+        {
+            nextFrameTime.tv_nsec -= 1000000000;
+            nextFrameTime.tv_sec++;
+        }
+        while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrameTime, NULL) == EINTR);
+    }
+}
+
+static int ARSTREAM_FrameClassCheck_Run (ARSTREAM_FrameClassCheck_t *check, int fps, int ackDelayMs)
+{
+    int retVal = 0;
+    eARSTREAM_ERROR err;
+    ARNETWORK_IOBufferParam_t dataParams;
+    ARNETWORK_IOBufferParam_t ackParams;
+    ARNETWORKAL_Manager_t *senderAlManager = NULL;
+    ARNETWORKAL_Manager_t *readerAlManager = NULL;
+    ARNETWORK_Manager_t *senderManager = NULL;
+    ARNETWORK_Manager_t *readerManager = NULL;
+    ARSTREAM_Sender_t *sender = NULL;
+    ARSTREAM_Reader_t *reader = NULL;
+    ARSTREAM_Impairment_Params_t ackImpairmentParams;
+    ARSTREAM_Impairment_t *ackImpairment = NULL;
+    pthread_t senderNetSend, senderNetRead, readerNetSend, readerNetRead;
+    pthread_t senderData, senderAck, readerData, readerAck;
+
+    /* Networks */
+    ARSTREAM_Sender_InitStreamDataBuffer (&dataParams, DATA_BUFFER_ID, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG);
+    ARSTREAM_Sender_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+    senderManager = ARSTREAM_FrameClassCheck_NewNetwork (READER_PORT, SENDER_PORT, &dataParams, &ackParams, &senderAlManager);
+    ARSTREAM_Impairment_DefaultParams (&ackImpairmentParams);
+    ackImpairmentParams.delayMs = ackDelayMs;
+    ackImpairment = ARSTREAM_Impairment_New (&ackImpairmentParams, ackParams.dataCopyMaxSize, &err);
+    ARSTREAM_Reader_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+    ARSTREAM_Reader_InitStreamDataBuffer (&dataParams, DATA_BUFFER_ID, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG);
+    readerManager = ARSTREAM_FrameClassCheck_NewNetwork (SENDER_PORT, READER_PORT, &ackParams, &dataParams, &readerAlManager);
+    if ((senderManager == NULL) ||
+        (readerManager == NULL) ||
+        (ackImpairment == NULL))
+    {
+        if (senderManager != NULL)
+        {
+            ARSTREAM_FrameClassCheck_DeleteNetwork (&senderManager, &senderAlManager);
+        }
+        if (readerManager != NULL)
+        {
+            ARSTREAM_FrameClassCheck_DeleteNetwork (&readerManager, &readerAlManager);
+        }
+        if (ackImpairment != NULL)
+        {
+            ARSTREAM_Impairment_Delete (&ackImpairment);
+        }
+        return 1;
+    }
+
+    /* Streams */
+    pthread_create (&senderNetSend, NULL, ARNETWORK_Manager_SendingThreadRun, senderManager);
+    pthread_create (&senderNetRead, NULL, ARNETWORK_Manager_ReceivingThreadRun, senderManager);
+    pthread_create (&readerNetSend, NULL, ARNETWORK_Manager_SendingThreadRun, readerManager);
+    pthread_create (&readerNetRead, NULL, ARNETWORK_Manager_ReceivingThreadRun, readerManager);
+
+    reader = ARSTREAM_Reader_NewWithFramePool (readerManager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_FrameClassCheck_FrameReadyCallback, 0, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_READER_MAX_ACK_INTERVAL_DEFAULT, check, &err);
+    if (reader == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Reader_NewWithFramePool call : %s", ARSTREAM_Error_ToString (err));
+        retVal = 1;
+    }
+    else
+    {
+        sender = ARSTREAM_Sender_New (senderManager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_FrameClassCheck_FrameUpdateCallback, SENDER_QUEUE_SIZE, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG, check, &err);
+        if (sender == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Sender_New call : %s", ARSTREAM_Error_ToString (err));
+            ARSTREAM_Reader_Delete (&reader);
+            retVal = 1;
+        }
+    }
+
+    if (retVal == 0)
+    {
+        ARSTREAM_Sender_SetAckImpairment (sender, ackImpairment);
+        pthread_create (&readerData, NULL, ARSTREAM_Reader_RunDataThread, reader);
+        pthread_create (&readerAck, NULL, ARSTREAM_Reader_RunAckThread, reader);
+        pthread_create (&senderData, NULL, ARSTREAM_Sender_RunDataThread, sender);
+        pthread_create (&senderAck, NULL, ARSTREAM_Sender_RunAckThread, sender);
+
+        ARSTREAM_FrameClassCheck_SendFrames (check, sender, fps);
+        usleep (1000 * (DRAIN_TIME_MS + ackDelayMs));
+
+        ARSTREAM_Sender_StopSender (sender);
+        ARSTREAM_Reader_StopReader (reader);
+        pthread_join (senderAck, NULL);
+        pthread_join (senderData, NULL);
+        pthread_join (readerAck, NULL);
+        pthread_join (readerData, NULL);
+        ARSTREAM_Sender_Delete (&sender);
+        ARSTREAM_Reader_Delete (&reader);
+    }
+
+    ARNETWORK_Manager_Stop (senderManager);
+    ARNETWORK_Manager_Stop (readerManager);
+    pthread_join (senderNetRead, NULL);
+    pthread_join (senderNetSend, NULL);
+    pthread_join (readerNetRead, NULL);
+    pthread_join (readerNetSend, NULL);
+    ARSTREAM_FrameClassCheck_DeleteNetwork (&senderManager, &senderAlManager);
+    ARSTREAM_FrameClassCheck_DeleteNetwork (&readerManager, &readerAlManager);
+    ARSTREAM_Impairment_Delete (&ackImpairment);
+    return retVal;
+}
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_FrameClassCheck_Main (int argc, char *argv[])
+{
+    int retVal = 0;
+    int opt;
+    int fps = DEFAULT_FPS;
+    int ackDelayMs = DEFAULT_ACK_DELAY_MS;
+    int frameClass;
+    int i;
+    ARSTREAM_FrameClassCheck_t check;
+
+    memset (&check, 0, sizeof (check));
+    check.nbFrames = DEFAULT_NB_FRAMES;
+
+    appName = argv[0];
+    while ((opt = getopt (argc, argv, "n:r:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            check.nbFrames = atoi (optarg);
+            break;
+        case 'r':
+            fps = atoi (optarg);
+            break;
+        case 'd':
+            ackDelayMs = atoi (optarg);
+            break;
+        default:
+            ARSTREAM_FrameClassCheck_printUsage ();
+            return 1;
+        }
+    }
+    if ((check.nbFrames <= 0) ||
+        (fps <= 0) ||
+        (ackDelayMs <= 1000 / fps))
+    {
+        ARSTREAM_FrameClassCheck_printUsage ();
+        return 1;
+    }
+
+    check.frames = malloc (check.nbFrames * FRAME_SIZE);
+    check.classes = malloc (check.nbFrames * sizeof (eARSTREAM_SENDER_FRAME_CLASS));
+    check.received = calloc (check.nbFrames, sizeof (uint8_t));
+    if ((check.frames == NULL) ||
+        (check.classes == NULL) ||
+        (check.received == NULL))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to allocate the frames");
+        retVal = 1;
+    }
+
+    if (retVal == 0)
+    {
+        /* One I-Frame every I_FRAME_EVERY_N frames, then alternating P and non-reference frames */
+        memset (check.frames, 0x55, check.nbFrames * FRAME_SIZE);
+        for (i = 0; i < check.nbFrames; i++)
+        {
+            if ((i % I_FRAME_EVERY_N) == 0)
+            {
+                check.classes [i] = ARSTREAM_SENDER_FRAME_CLASS_I;
+            }
+            else if ((i % 2) == 0)
+            {
+                check.classes [i] = ARSTREAM_SENDER_FRAME_CLASS_P;
+            }
+            else
+            {
+                check.classes [i] = ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE;
+            }
+        }
+        retVal = ARSTREAM_FrameClassCheck_Run (&check, fps, ackDelayMs);
+    }
+
+    if (retVal == 0)
+    {
+        for (frameClass = 0; frameClass < ARSTREAM_SENDER_FRAME_CLASS_MAX; frameClass++)
+        {
+            int minReceived = (check.nbQueued [frameClass] * MIN_RECEIVED_PERCENT) / 100;
+            fprintf (stdout, "%s frames : %d queued, %d cancelled, %d received\n", classNames [frameClass], check.nbQueued [frameClass], check.nbCancelled [frameClass], check.nbReceived [frameClass]);
+            if (check.nbReceived [frameClass] < minReceived)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Only %d of the %d %s frames were received with a %d ms ack delay at %d fps", check.nbReceived [frameClass], check.nbQueued [frameClass], classNames [frameClass], ackDelayMs, fps);
+                retVal = 1;
+            }
+        }
+    }
+
+    free (check.frames);
+    free (check.classes);
+    free (check.received);
+    return retVal;
+}
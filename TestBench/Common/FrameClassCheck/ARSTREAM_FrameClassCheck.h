@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_FrameClassCheck.h
+ * @brief Header file for the loopback check of the non-reference frames drops
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_FRAMECLASSCHECK_H_
+#define _ARSTREAM_FRAMECLASSCHECK_H_
+
+/**
+ * @brief Check entry point
+ *
+ * Runs an ARSTREAM_Sender_t and an ARSTREAM_Reader_t in the same process, over two ARNETWORK_Manager_t
+ * connected through 127.0.0.1, with the acks delayed so that the round trip time is longer than the
+ * frame interval. A low bitrate stream is sent, with half of its frames as
+ * ARSTREAM_SENDER_FRAME_CLASS_NON_REFERENCE frames. Such a link is healthy : the check fails if the
+ * reader does not get almost all the frames of each class.
+ *
+ * @param argc Argument count of the main function
+ * @param argv Arguments values of the main function
+ * @return The "main" return value (non zero if too many frames were dropped)
+ */
+int ARSTREAM_FrameClassCheck_Main (int argc, char *argv[]);
+
+#endif /* _ARSTREAM_FRAMECLASSCHECK_H_ */
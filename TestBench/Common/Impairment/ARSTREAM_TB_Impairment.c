@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_TB_Impairment.c
+ * @brief Network impairment configuration helpers of the testbenches
+ * @date 10/15/2026
+ */
+
+/*
+ * System Headers
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "ARSTREAM_TB_Impairment.h"
+
+/*
+ * Macros
+ */
+
+#define __TAG__ "ARSTREAM_TB_Impairment"
+
+#define MAX_DESCRIPTION_SIZE (256)
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_TB_Impairment_ParseParams (const char *description, ARSTREAM_Impairment_Params_t *params)
+{
+    char copy [MAX_DESCRIPTION_SIZE];
+    char *item;
+    char *savePtr = NULL;
+    int retVal = 0;
+
+    ARSTREAM_Impairment_DefaultParams (params);
+    if (strlen (description) >= sizeof (copy))
+    {
+        return -1;
+    }
+    strcpy (copy, description);
+
+    for (item = strtok_r (copy, ",", &savePtr); (retVal == 0) && (item != NULL); item = strtok_r (NULL, ",", &savePtr))
+    {
+        if ((sscanf (item, "loss=%f", &(params->lossPercent)) != 1) &&
+            (sscanf (item, "ge=%f:%f:%f", &(params->goodToBadPercent), &(params->badToGoodPercent), &(params->badStateLossPercent)) != 3) &&
+            (sscanf (item, "dup=%f", &(params->duplicatePercent)) != 1) &&
+            (sscanf (item, "reorder=%f:%d", &(params->reorderPercent), &(params->reorderDelayMs)) != 2) &&
+            (sscanf (item, "delay=%d", &(params->delayMs)) != 1) &&
+            (sscanf (item, "jitter=%d", &(params->jitterMs)) != 1) &&
+            (sscanf (item, "rate=%" SCNu32, &(params->bandwidthKbps)) != 1) &&
+            (sscanf (item, "queue=%d", &(params->maxQueuedPackets)) != 1) &&
+            (sscanf (item, "seed=%" SCNu32, &(params->seed)) != 1))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Invalid impairment item \"%s\"", item);
+            retVal = -1;
+        }
+    }
+    return retVal;
+}
+
+ARSTREAM_Impairment_t* ARSTREAM_TB_Impairment_NewFromEnv (const char *envName, int maxPacketSize)
+{
+    ARSTREAM_Impairment_Params_t params;
+    ARSTREAM_Impairment_t *impairment = NULL;
+    eARSTREAM_ERROR err;
+    const char *description = getenv (envName);
+    if ((description == NULL) ||
+        (description [0] == '\0'))
+    {
+        return NULL;
+    }
+    if (ARSTREAM_TB_Impairment_ParseParams (description, &params) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Ignoring invalid %s=\"%s\"", envName, description);
+        return NULL;
+    }
+    impairment = ARSTREAM_Impairment_New (&params, maxPacketSize, &err);
+    if (impairment == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Impairment_New call : %s", ARSTREAM_Error_ToString (err));
+    }
+    else
+    {
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Impairment %s=\"%s\"", envName, description);
+    }
+    return impairment;
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_TB_Impairment.h
+ * @brief Network impairment configuration helpers of the testbenches
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_TB_IMPAIRMENT_H_
+#define _ARSTREAM_TB_IMPAIRMENT_H_
+
+#include <libARStream/ARSTREAM_Impairment.h>
+
+/**
+ * @brief Environment variable holding the impairment of the data path (read by the reader testbenches)
+ */
+#define ARSTREAM_TB_DATA_IMPAIRMENT_ENV "ARSTREAM_TB_DATA_IMPAIRMENT"
+
+/**
+ * @brief Environment variable holding the impairment of the ack path (read by the sender testbenches)
+ */
+#define ARSTREAM_TB_ACK_IMPAIRMENT_ENV "ARSTREAM_TB_ACK_IMPAIRMENT"
+
+/**
+ * @brief Parses an impairment description
+ *
+ * The description is a comma separated list of key=value items, all optionnal :
+ * - loss=P : uniform loss percentage
+ * - ge=PGB:PBG:PL : Gilbert-Elliott bursty loss (good to bad %, bad to good %, loss % in the bad state)
+ * - dup=P : duplication percentage
+ * - reorder=P:MS : reordering percentage, and delay of the reordered packets
+ * - delay=MS, jitter=MS : constant delay, and maximum random jitter
+ * - rate=KBPS : bandwidth cap
+ * - queue=N : maximum number of held back packets
+ * - seed=N : seed of the random draws
+ *
+ * For example "ge=2:25:60,jitter=10,seed=42"
+ *
+ * @param[in] description The description to parse
+ * @param[out] params The parameters (reset to ARSTREAM_Impairment_DefaultParams() before parsing)
+ * @return 0 on success, -1 if the description is invalid
+ */
+int ARSTREAM_TB_Impairment_ParseParams (const char *description, ARSTREAM_Impairment_Params_t *params);
+
+/**
+ * @brief Creates an impairment from the description held in an environment variable
+ * @param[in] envName Name of the environment variable
+ * @param[in] maxPacketSize Size of the largest packet of the impaired buffer
+ * @return The new impairment, or NULL if the variable is not set or invalid
+ */
+ARSTREAM_Impairment_t* ARSTREAM_TB_Impairment_NewFromEnv (const char *envName, int maxPacketSize);
+
+#endif /* _ARSTREAM_TB_IMPAIRMENT_H_ */
@@ -45,8 +45,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdio.h>
-#include <arpa/inet.h>
-#include <errno.h>
+#include <time.h>
 
 /*
  * ARSDK Headers
@@ -56,6 +55,9 @@
 #include <libARStream/ARSTREAM_Sender.h>
 
 #include "../ARSTREAM_TB_Config.h"
+#include "../Impairment/ARSTREAM_TB_Impairment.h"
+#include "../Thread/ARSTREAM_TB_Thread.h"
+#include "../MP4Source/ARSTREAM_MP4Source.h"
 
 /*
  * Macros
@@ -100,18 +102,11 @@ float ARSTREAM_MP4Sender_PercentOk = 0.0;
 static int nbSent = 0;
 static int nbOk = 0;
 
-static int currentBufferIndex = 0;
-static uint8_t *multiBuffer[NB_BUFFERS];
-static uint32_t multiBufferSize[NB_BUFFERS];
-static int multiBufferIsFree[NB_BUFFERS];
-
 static char *appName;
 
-static FILE *mp4File;
-static int mp4NbFrames;
+static ARSTREAM_MP4Source_t *mp4Source;
 static int mp4CurrentFrame;
-static uint32_t *framesOffsetArray;
-static uint32_t *framesSizeArray;
+static float speedFactor = 1.f;
 
 /*
  * Internal functions declarations
@@ -122,33 +117,14 @@ static uint32_t *framesSizeArray;
  */
 void ARSTREAM_MP4SenderTb_printUsage ();
 
-/**
- * @brief Initializes the multi buffers of the testbench
- * @param maxsize Maximum size of a frame in the current mp4 file
- */
-void ARSTREAM_MP4SenderTb_initMultiBuffers (int maxsize);
-
 /**
  * @see ARSTREAM_Sender.h
  */
 void ARSTREAM_MP4SenderTb_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom);
 
-/**
- * @brief Gets a free buffer pointer
- * @param[in] buffer the buffer to mark as free
- */
-void ARSTREAM_MP4SenderTb_SetBufferFree (uint8_t *buffer);
-
-/**
- * @brief Gets a free buffer pointer
- * @param[out] retSize Pointer where to store the size of the next free buffer (or 0 if there is no free buffer)
- * @return Pointer to the next free buffer, or NULL if there is no free buffer
- */
-uint8_t* ARSTREAM_MP4SenderTb_GetNextFreeBuffer (uint32_t *retSize);
-
 /**
  * @brief File reader thread function
- * This function reads frames periodically from the given mp4 file, and sends them through the ARSTREAM_Sender_t
+ * This function sends the frames of the mp4 file through the ARSTREAM_Sender_t, at speedFactor times the real time
  * @param ARSTREAM_Sender_t_Param A valid ARSTREAM_Sender_t, casted as a (void *), which will be used by the thread
  * @return No meaningful value : (void *)0
  *
@@ -165,29 +141,32 @@ void* fileReaderThread (void *ARSTREAM_Sender_t_Param);
 int ARSTREAM_MP4SenderTb_StartStreamTest (const char *fpath, ARNETWORK_Manager_t *manager);
 
 /**
- * @brief Opens the file for reading + get the largest frame size
- * @param path Path of the mp4 file
- * @return the size of the largest frame in the file
+ * @brief Get the "next" frame from the mp4 source
+ * @param[out] nextFrameSize size of the frame
+ * @param[out] isIFrame pointer to an int which will hold this boolean-like flag
+ * @return pointer to the frame, in the mapped file
+ *
+ * @note After reading the last frame from the file, this function goes back to the beginning
  */
-int ARSTREAM_MP4SenderTb_OpenStreamFile (const char *path);
+uint8_t* ARSTREAM_MP4SenderTb_GetNextFrame (uint32_t *nextFrameSize, int *isIFrame);
 
 /**
- * @brief Get the "next" frame from file
- * @param nextFrame buffer in which to store nextFrame
- * @param nextFrameSize size of the nextFrame buffer
- * @param isIFrame pointer to an int which will hold this boolean-like flag
- * @return actual data size of the nextFrame
- *
- * @note After reading the last frame from the file, this function goes back to the beginning
+ * @brief Tells if a frame should be sent as an I-Frame
+ * Uses the sync samples table of the file if any, or flags one frame every I_FRAME_EVERY_N
+ * @param index Index of the frame
+ * @param isSyncFrame Sync flag given by the mp4 source
+ * @return 1 if the frame should be flushed, 0 otherwise
  */
-uint32_t ARSTREAM_MP4SenderTb_GetNextFrame (uint8_t *nextFrame, int nextFrameSize, int *isIFrame);
+int ARSTREAM_MP4SenderTb_IsIFrame (int index, int isSyncFrame);
 
 /**
- * @brief seeks the global mp4File to the given atom
- * @param atomName 4CC of the atom to seek
- * @return size of the atom (-1 means failure)
+ * @brief Writes the frames sizes of a mp4 file to a trace file, for the loopback benchmark
+ * Each line of the trace holds a frame size, followed by 1 if the frame would be sent as an I-Frame by this testbench
+ * @param mp4Path Path of the mp4 file
+ * @param tracePath Path of the trace file to write
+ * @return The "main" return value
  */
-int ARSTREAM_MP4SenderTb_JumpToAtom (const char *atomName);
+int ARSTREAM_MP4SenderTb_DumpTrace (const char *mp4Path, const char *tracePath);
 
 /*
  * Internal functions implementation
@@ -195,36 +174,27 @@ int ARSTREAM_MP4SenderTb_JumpToAtom (const char *atomName);
 
 void ARSTREAM_MP4SenderTb_printUsage ()
 {
-    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s file [ip]", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s file [ip [speed]]", appName);
     ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        file -> mp4 file to read from");
     ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        ip -> optionnal, ip of the stream reader");
-}
-
-void ARSTREAM_MP4SenderTb_initMultiBuffers (int maxsize)
-{
-    int buffIndex;
-    for (buffIndex = 0; buffIndex < NB_BUFFERS; buffIndex++)
-    {
-        multiBuffer[buffIndex] = malloc (maxsize);
-        multiBufferSize[buffIndex] = maxsize;
-        multiBufferIsFree[buffIndex] = 1;
-    }
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        speed -> optionnal, replay speed factor (default 1, e.g. 10 for 10 times the real time)");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "   or : %s -t file trace", appName);
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        trace -> writes the frames sizes of file to trace, for ARSTREAM_Bench");
 }
 
 void ARSTREAM_MP4SenderTb_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, uint8_t *framePointer, uint32_t frameSize, void *custom)
 {
+    framePointer = framePointer;
     custom = custom;
     switch (status)
     {
     case ARSTREAM_SENDER_STATUS_FRAME_SENT:
-        ARSTREAM_MP4SenderTb_SetBufferFree (framePointer);
         ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Successfully sent a frame of size %u", frameSize);
         nbSent++;
         nbOk++;
         ARSTREAM_MP4Sender_PercentOk = (100.f * nbOk) / (1.f * nbSent);
         break;
     case ARSTREAM_SENDER_STATUS_FRAME_CANCEL:
-        ARSTREAM_MP4SenderTb_SetBufferFree (framePointer);
         ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Cancelled a frame of size %u", frameSize);
         nbSent++;
         ARSTREAM_MP4Sender_PercentOk = (100.f * nbOk) / (1.f * nbSent);
@@ -235,57 +205,22 @@ void ARSTREAM_MP4SenderTb_FrameUpdateCallback (eARSTREAM_SENDER_STATUS status, u
     }
 }
 
-void ARSTREAM_MP4SenderTb_SetBufferFree (uint8_t *buffer)
-{
-    int i;
-    for (i = 0; i < NB_BUFFERS; i++)
-    {
-        if (multiBuffer[i] == buffer)
-        {
-            multiBufferIsFree[i] = 1;
-        }
-    }
-}
-
-uint8_t* ARSTREAM_MP4SenderTb_GetNextFreeBuffer (uint32_t *retSize)
-{
-    uint8_t *retBuffer = NULL;
-    int nbtest = 0;
-    if (retSize == NULL)
-    {
-        return NULL;
-    }
-    do
-    {
-        if (multiBufferIsFree[currentBufferIndex] == 1)
-        {
-            retBuffer = multiBuffer[currentBufferIndex];
-            *retSize = multiBufferSize[currentBufferIndex];
-        }
-        currentBufferIndex = (currentBufferIndex + 1) % NB_BUFFERS;
-        nbtest++;
-    } while (retBuffer == NULL && nbtest < NB_BUFFERS);
-    return retBuffer;
-}
-
 void* fileReaderThread (void *ARSTREAM_Sender_t_Param)
 {
 
-    uint8_t cnt = 0;
     uint32_t frameSize = 0;
-    uint32_t frameCapacity = 0;
     uint8_t *nextFrameAddr;
     ARSTREAM_Sender_t *sender = (ARSTREAM_Sender_t *)ARSTREAM_Sender_t_Param;
-    srand (time (NULL));
+    long intervalNs = (long)((1000000.f * TIME_BETWEEN_FRAMES_MS) / speedFactor);
+    struct timespec nextFrameTime;
+    clock_gettime (CLOCK_MONOTONIC, &nextFrameTime);
     ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Encoder thread running");
     while (stillRunning)
     {
         int flush;
-        nextFrameAddr = ARSTREAM_MP4SenderTb_GetNextFreeBuffer (&frameCapacity);
-        frameSize = ARSTREAM_MP4SenderTb_GetNextFrame (nextFrameAddr, frameCapacity, &flush);
-        cnt++;
+        nextFrameAddr = ARSTREAM_MP4SenderTb_GetNextFrame (&frameSize, &flush);
 
-        if (frameSize != 0)
+        if (nextFrameAddr != NULL)
         {
             int nbPrevious = 0;
             eARSTREAM_ERROR res = ARSTREAM_Sender_SendNewFrame (sender, nextFrameAddr, frameSize, flush, &nbPrevious);
@@ -309,7 +244,14 @@ void* fileReaderThread (void *ARSTREAM_Sender_t_Param)
             ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Could not get a new encoded frame");
         }
 
-        usleep (1000 * TIME_BETWEEN_FRAMES_MS);
+        /* Absolute deadlines, so that the sending time does not slow down fast replays */
+        nextFrameTime.tv_nsec += intervalNs;
+        while (nextFrameTime.tv_nsec >= 1000000000)
+        {
+            nextFrameTime.tv_nsec -= 1000000000;
+            nextFrameTime.tv_sec++;
+        }
+        clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrameTime, NULL);
     }
     ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Encoder thread ended");
     return (void *)0;
@@ -320,17 +262,34 @@ int ARSTREAM_MP4SenderTb_StartStreamTest (const char *fpath, ARNETWORK_Manager_t
     int retVal = 0;
     eARSTREAM_ERROR err;
     ARSTREAM_Sender_t *sender;
-    ARSTREAM_MP4SenderTb_initMultiBuffers (ARSTREAM_MP4SenderTb_OpenStreamFile (fpath));
+    mp4Source = ARSTREAM_MP4Source_Open (fpath);
+    if (mp4Source == NULL)
+    {
+        return 1;
+    }
+    mp4CurrentFrame = 0;
     sender = ARSTREAM_Sender_New (manager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_MP4SenderTb_FrameUpdateCallback, NB_BUFFERS, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG, NULL, &err);
     if (sender == NULL)
     {
         ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Sender_New call : %s", ARSTREAM_Error_ToString(err));
+        ARSTREAM_MP4Source_Close (&mp4Source);
         return 1;
     }
 
+    ARNETWORK_IOBufferParam_t ackParams;
+    ARSTREAM_Sender_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+    ARSTREAM_Impairment_t *impairment = ARSTREAM_TB_Impairment_NewFromEnv (ARSTREAM_TB_ACK_IMPAIRMENT_ENV, ackParams.dataCopyMaxSize);
+    ARSTREAM_Sender_SetAckImpairment (sender, impairment);
+
+    ARSTREAM_ThreadConfig_t dataThreadConfig, ackThreadConfig;
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_DATA_THREAD_ENV, "ars_snd_data", &dataThreadConfig);
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_ACK_THREAD_ENV, "ars_snd_ack", &ackThreadConfig);
+    ARSTREAM_Sender_SetThreadConfig (sender, ARSTREAM_THREAD_DATA, &dataThreadConfig);
+    ARSTREAM_Sender_SetThreadConfig (sender, ARSTREAM_THREAD_ACK, &ackThreadConfig);
+
     pthread_t streamsend, streamread;
-    pthread_create (&streamsend, NULL, ARSTREAM_Sender_RunDataThread, sender);
-    pthread_create (&streamread, NULL, ARSTREAM_Sender_RunAckThread, sender);
+    ARSTREAM_Thread_Create (&streamsend, &dataThreadConfig, ARSTREAM_Sender_RunDataThread, sender);
+    ARSTREAM_Thread_Create (&streamread, &ackThreadConfig, ARSTREAM_Sender_RunAckThread, sender);
 
     /* USER CODE */
 
@@ -346,235 +305,66 @@ int ARSTREAM_MP4SenderTb_StartStreamTest (const char *fpath, ARNETWORK_Manager_t
     pthread_join (streamsend, NULL);
 
     ARSTREAM_Sender_Delete (&sender);
-
-    return retVal;
-}
-
-int ARSTREAM_MP4SenderTb_OpenStreamFile (const char *path)
-{
-    int res = 1;
-    int greatest = 0;
-    mp4File = fopen (path, "rb");
-    if (NULL == mp4File)
+    if (impairment != NULL)
     {
-        perror ("Open error");
-        exit (1);
+        ARSTREAM_Impairment_Delete (&impairment);
     }
+    /* The frames are unmapped only once the sender is done with them */
+    ARSTREAM_MP4Source_Close (&mp4Source);
 
-    /* Jump to stsz atom */
-    res = ARSTREAM_MP4SenderTb_JumpToAtom ("moov");
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("trak");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("mdia");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("minf");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("stbl");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("stsz");
-    }
-
-    /* Read nbFrames + all frames sizes */
-    if (res != -1)
-    {
-        uint8_t *data = malloc (res);
-        res = fread (data, 1, res, mp4File);
-        uint32_t neNbFrames = *(uint32_t *)&data[8];
-        mp4NbFrames = ntohl (neNbFrames);
-        framesSizeArray = malloc (mp4NbFrames * sizeof (uint32_t));
-        memcpy (framesSizeArray, &data[12], mp4NbFrames * sizeof (uint32_t));
-        int i;
-        for (i = 0; i < mp4NbFrames; i++)
-        {
-            framesSizeArray [i] = ntohl (framesSizeArray [i]);
-            if (framesSizeArray [i] > greatest)
-            {
-                greatest = framesSizeArray [i];
-            }
-        }
-        free (data);
-    }
-
-    /* Rewind file */
-    rewind (mp4File);
-
-    /* Jump to stco atom */
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("moov");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("trak");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("mdia");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("minf");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("stbl");
-    }
-    if (res != -1)
-    {
-        res = ARSTREAM_MP4SenderTb_JumpToAtom ("stco");
-    }
-
-    /* Read nbFrames + all frames sizes */
-    if (res != -1)
-    {
-        uint8_t *data = malloc (res);
-        res = fread (data, 1, res, mp4File);
-        framesOffsetArray = malloc (mp4NbFrames * sizeof (uint32_t));
-        memcpy (framesOffsetArray, &data[8], mp4NbFrames * sizeof (uint32_t));
-        int i;
-        for (i = 0; i < mp4NbFrames; i++)
-        {
-            framesOffsetArray [i] = ntohl (framesOffsetArray [i]);
-        }
-        free (data);
-    }
-
-    mp4CurrentFrame = 0;
-    return greatest;
+    return retVal;
 }
 
-uint32_t ARSTREAM_MP4SenderTb_GetNextFrame (uint8_t *nextFrame, int nextFrameSize, int *isIFrame)
+uint8_t* ARSTREAM_MP4SenderTb_GetNextFrame (uint32_t *nextFrameSize, int *isIFrame)
 {
-    uint32_t nextSize = framesSizeArray [mp4CurrentFrame];
-    uint32_t nextOffset = framesOffsetArray [mp4CurrentFrame];
-
-    *isIFrame = 0;
-
-    if (nextSize <= nextFrameSize)
-    {
-        fseek (mp4File, nextOffset, SEEK_SET);
-        int readRes = fread (nextFrame, 1, nextSize, mp4File);
-        if (readRes != nextSize)
-        {
-            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Fread error: %s", strerror(errno));
-        }
-    }
-    else
-    {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "GetNextFrame error ... this is pretty bad !");
-        return 0;
-    }
+    int isSyncFrame = 0;
+    uint8_t *nextFrame = ARSTREAM_MP4Source_GetFrame (mp4Source, mp4CurrentFrame, nextFrameSize, &isSyncFrame);
+    *isIFrame = ARSTREAM_MP4SenderTb_IsIFrame (mp4CurrentFrame, isSyncFrame);
 
     mp4CurrentFrame++;
-    if (mp4CurrentFrame >= mp4NbFrames)
+    if (mp4CurrentFrame >= ARSTREAM_MP4Source_GetNbFrames (mp4Source))
     {
         mp4CurrentFrame = 0;
     }
-
-    *isIFrame = ((mp4CurrentFrame % I_FRAME_EVERY_N) == 1) ? 1 : 0;
-
-    return nextSize;
-}
-
-
-/**
- * Read from a file functions
- * Note : fptr MUST be a valid file pointer
- */
-static void read_uint32 (FILE *fptr, uint32_t *dest)
-{
-    uint32_t locValue = 0;
-    if (1 != fread (&locValue, sizeof (locValue), 1, fptr))
-    {
-        fprintf (stderr, "Error reading a uint32_t\n");
-    }
-    *dest = ntohl (locValue);
+    return nextFrame;
 }
 
-static void read_uint64 (FILE *fptr, uint64_t *dest)
+int ARSTREAM_MP4SenderTb_IsIFrame (int index, int isSyncFrame)
 {
-    uint64_t retValue = 0;
-    uint32_t locValue = 0;
-    if (1 != fread (&locValue, sizeof (locValue), 1, fptr))
-    {
-        fprintf (stderr, "Error reading low value of a uint64_t\n");
-        return;
-    }
-    retValue = (uint64_t)(ntohl (locValue));
-    if (1 != fread (&locValue, sizeof (locValue), 1, fptr))
+    if (ARSTREAM_MP4Source_HasSyncTable (mp4Source) == 1)
     {
-        fprintf (stderr, "Error reading a high value of a uint64_t\n");
+        return isSyncFrame;
     }
-    retValue += ((uint64_t)(ntohl (locValue))) << 32;
-    *dest = retValue;
+    return ((index % I_FRAME_EVERY_N) == 0) ? 1 : 0;
 }
 
-void read_4cc (FILE *fptr, char dest[5])
+int ARSTREAM_MP4SenderTb_DumpTrace (const char *mp4Path, const char *tracePath)
 {
-    if (1 != fread (dest, 4, 1, fptr))
-    {
-        fprintf (stderr, "Error reading a 4cc\n");
-    }
-}
-
-int ARSTREAM_MP4SenderTb_JumpToAtom (const char *atomName)
-{
-    uint32_t atomSize = 0;
-    char fourCCTag [5] = {0};
-    uint64_t wideAtomSize = 0;
-    int found = 0;
-    FILE *streamFile = mp4File;
-    if (NULL == streamFile)
-    {
-        return 0;
-    }
-
-    read_uint32 (streamFile, &atomSize);
-    read_4cc (streamFile, fourCCTag);
-    if (0 == atomSize)
+    int i;
+    FILE *traceFile;
+    mp4Source = ARSTREAM_MP4Source_Open (mp4Path);
+    if (mp4Source == NULL)
     {
-        read_uint64 (streamFile, &wideAtomSize);
+        return 1;
     }
-    else
+    traceFile = fopen (tracePath, "w");
+    if (NULL == traceFile)
     {
-        wideAtomSize = atomSize;
+        perror ("Open error");
+        ARSTREAM_MP4Source_Close (&mp4Source);
+        return 1;
     }
-    if (0 == strncmp (fourCCTag, atomName, 4))
+    fprintf (traceFile, "# Frames sizes of %s\n", mp4Path);
+    for (i = 0; i < ARSTREAM_MP4Source_GetNbFrames (mp4Source); i++)
     {
-        found = 1;
+        uint32_t frameSize = 0;
+        int isSyncFrame = 0;
+        ARSTREAM_MP4Source_GetFrame (mp4Source, i, &frameSize, &isSyncFrame);
+        fprintf (traceFile, "%u %d\n", frameSize, ARSTREAM_MP4SenderTb_IsIFrame (i, isSyncFrame));
     }
-
-    while (0 == found &&
-           !feof (streamFile))
-    {
-        fseek (streamFile, wideAtomSize - 8, SEEK_CUR);
-
-        read_uint32 (streamFile, &atomSize);
-        read_4cc (streamFile, fourCCTag);
-        if (0 == atomSize)
-        {
-            read_uint64 (streamFile, &wideAtomSize);
-        }
-        else
-        {
-            wideAtomSize = atomSize;
-        }
-        if (0 == strncmp (fourCCTag, atomName, 4))
-        {
-            found = 1;
-        }
-    }
-    return wideAtomSize;
+    fclose (traceFile);
+    ARSTREAM_MP4Source_Close (&mp4Source);
+    return 0;
 }
 
 /*
@@ -591,6 +381,12 @@ int ARSTREAM_MP4Sender_TestBenchMain (int argc, char *argv[])
         return 1;
     }
 
+    if ((argc == 4) &&
+        (0 == strcmp (argv[1], "-t")))
+    {
+        return ARSTREAM_MP4SenderTb_DumpTrace (argv[2], argv[3]);
+    }
+
     char *fpath = argv[1];
 
     char *ip = __IP;
@@ -600,6 +396,16 @@ int ARSTREAM_MP4Sender_TestBenchMain (int argc, char *argv[])
         ip = argv[2];
     }
 
+    if (argc >= 4)
+    {
+        speedFactor = atof (argv[3]);
+        if (speedFactor <= 0.f)
+        {
+            ARSTREAM_MP4SenderTb_printUsage ();
+            return 1;
+        }
+    }
+
     int nbInBuff = 1;
     ARNETWORK_IOBufferParam_t inParams;
     ARSTREAM_Sender_InitStreamDataBuffer (&inParams, DATA_BUFFER_ID, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG);
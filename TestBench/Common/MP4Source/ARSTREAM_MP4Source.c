@@ -0,0 +1,523 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_MP4Source.c
+ * @brief Memory mapped frame source reading the video track of a mp4 file
+ * @date 10/15/2026
+ */
+
+/*
+ * System Headers
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "ARSTREAM_MP4Source.h"
+
+/*
+ * Macros
+ */
+
+#define __TAG__ "ARSTREAM_MP4Source"
+
+#define ATOM_HEADER_SIZE (8)
+#define ATOM_LARGE_HEADER_SIZE (16)
+
+/* Size of the stream prefetched ahead of the current frame */
+#define READ_AHEAD_SIZE (8 * 1024 * 1024)
+
+/*
+ * Types
+ */
+
+/**
+ * @brief An atom of the mapped file
+ */
+typedef struct {
+    const uint8_t *payload;
+    uint64_t size; // Payload size
+} ARSTREAM_MP4Source_Atom_t;
+
+struct ARSTREAM_MP4Source_t {
+    uint8_t *map;
+    uint64_t mapSize;
+    long pageSize;
+
+    int nbFrames;
+    uint64_t *frameOffsets;
+    uint32_t *frameSizes;
+    uint8_t *frameIsSync;
+    uint32_t maxFrameSize;
+    int hasSyncTable;
+
+    uint64_t readAheadEnd; // End of the prefetched range
+};
+
+/*
+ * Internal functions declarations
+ */
+
+/**
+ * @brief Reads big endian values from the mapped file
+ */
+static uint32_t ARSTREAM_MP4Source_ReadU32 (const uint8_t *ptr);
+static uint64_t ARSTREAM_MP4Source_ReadU64 (const uint8_t *ptr);
+
+/**
+ * @brief Gets the next atom of a container
+ * @param[in,out] cursor Position in the container, moved after the atom
+ * @param end End of the container
+ * @param[out] type The 4cc of the atom
+ * @param[out] atom The atom
+ * @return 1 if an atom was read, 0 at the end of the container (or for a truncated atom)
+ */
+static int ARSTREAM_MP4Source_NextAtom (const uint8_t **cursor, const uint8_t *end, char type [4], ARSTREAM_MP4Source_Atom_t *atom);
+
+/**
+ * @brief Finds the first atom of a type in a container
+ * @return 1 if the atom was found, 0 otherwise
+ */
+static int ARSTREAM_MP4Source_FindAtom (const ARSTREAM_MP4Source_Atom_t *container, const char *type, ARSTREAM_MP4Source_Atom_t *atom);
+
+/**
+ * @brief Finds the sample table (stbl) of the first video track of the moov atom
+ * The first track is used if no track has a video handler
+ * @return 1 if a sample table was found, 0 otherwise
+ */
+static int ARSTREAM_MP4Source_FindVideoSampleTable (const ARSTREAM_MP4Source_Atom_t *moov, ARSTREAM_MP4Source_Atom_t *stbl);
+
+/**
+ * @brief Builds the frames tables from a sample table
+ * @return 0 on success, -1 on error
+ */
+static int ARSTREAM_MP4Source_ReadSampleTable (ARSTREAM_MP4Source_t *source, const ARSTREAM_MP4Source_Atom_t *stbl);
+
+/**
+ * @brief Prefetches the stream which follows a frame
+ */
+static void ARSTREAM_MP4Source_ReadAhead (ARSTREAM_MP4Source_t *source, uint64_t frameOffset);
+
+/*
+ * Internal functions implementation
+ */
+
+static uint32_t ARSTREAM_MP4Source_ReadU32 (const uint8_t *ptr)
+{
+    return ((uint32_t)ptr [0] << 24) | ((uint32_t)ptr [1] << 16) | ((uint32_t)ptr [2] << 8) | (uint32_t)ptr [3];
+}
+
+static uint64_t ARSTREAM_MP4Source_ReadU64 (const uint8_t *ptr)
+{
+    return ((uint64_t)ARSTREAM_MP4Source_ReadU32 (ptr) << 32) | ARSTREAM_MP4Source_ReadU32 (&ptr [4]);
+}
+
+static int ARSTREAM_MP4Source_NextAtom (const uint8_t **cursor, const uint8_t *end, char type [4], ARSTREAM_MP4Source_Atom_t *atom)
+{
+    const uint8_t *start = *cursor;
+    uint64_t available = end - start;
+    uint64_t atomSize;
+    uint64_t headerSize = ATOM_HEADER_SIZE;
+
+    if (available < ATOM_HEADER_SIZE)
+    {
+        return 0;
+    }
+    atomSize = ARSTREAM_MP4Source_ReadU32 (start);
+    memcpy (type, &start [4], 4);
+    if (atomSize == 1)
+    {
+        /* 64 bits size */
+        if (available < ATOM_LARGE_HEADER_SIZE)
+        {
+            return 0;
+        }
+        atomSize = ARSTREAM_MP4Source_ReadU64 (&start [8]);
+        headerSize = ATOM_LARGE_HEADER_SIZE;
+    }
+    else if (atomSize == 0)
+    {
+        /* Atom extends to the end of its container */
+        atomSize = available;
+    }
+    if ((atomSize < headerSize) ||
+        (atomSize > available))
+    {
+        return 0;
+    }
+    atom->payload = start + headerSize;
+    atom->size = atomSize - headerSize;
+    *cursor = start + atomSize;
+    return 1;
+}
+
+static int ARSTREAM_MP4Source_FindAtom (const ARSTREAM_MP4Source_Atom_t *container, const char *type, ARSTREAM_MP4Source_Atom_t *atom)
+{
+    const uint8_t *cursor = container->payload;
+    const uint8_t *end = container->payload + container->size;
+    char atomType [4];
+    while (ARSTREAM_MP4Source_NextAtom (&cursor, end, atomType, atom) == 1)
+    {
+        if (memcmp (atomType, type, 4) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int ARSTREAM_MP4Source_FindVideoSampleTable (const ARSTREAM_MP4Source_Atom_t *moov, ARSTREAM_MP4Source_Atom_t *stbl)
+{
+    const uint8_t *cursor = moov->payload;
+    const uint8_t *end = moov->payload + moov->size;
+    ARSTREAM_MP4Source_Atom_t trak, mdia, hdlr, minf, trackStbl;
+    char atomType [4];
+    int found = 0;
+
+    while (ARSTREAM_MP4Source_NextAtom (&cursor, end, atomType, &trak) == 1)
+    {
+        if ((memcmp (atomType, "trak", 4) != 0) ||
+            (ARSTREAM_MP4Source_FindAtom (&trak, "mdia", &mdia) == 0) ||
+            (ARSTREAM_MP4Source_FindAtom (&mdia, "minf", &minf) == 0) ||
+            (ARSTREAM_MP4Source_FindAtom (&minf, "stbl", &trackStbl) == 0))
+        {
+            continue;
+        }
+        if (found == 0)
+        {
+            /* Fallback to the first track */
+            *stbl = trackStbl;
+            found = 1;
+        }
+        /* hdlr : version/flags (4), pre_defined (4), handler_type (4) */
+        if ((ARSTREAM_MP4Source_FindAtom (&mdia, "hdlr", &hdlr) == 1) &&
+            (hdlr.size >= 12) &&
+            (memcmp (&hdlr.payload [8], "vide", 4) == 0))
+        {
+            *stbl = trackStbl;
+            break;
+        }
+    }
+    return found;
+}
+
+static int ARSTREAM_MP4Source_ReadSampleTable (ARSTREAM_MP4Source_t *source, const ARSTREAM_MP4Source_Atom_t *stbl)
+{
+    ARSTREAM_MP4Source_Atom_t stsz, stsc, stco, stss;
+    int isCo64 = 0;
+    uint32_t constantSize;
+    uint32_t nbChunks;
+    uint32_t nbStscEntries = 0;
+    uint32_t stscIndex = 0;
+    uint32_t chunk;
+    int frame = 0;
+    int i;
+
+    /* stsz : version/flags (4), sample_size (4), sample_count (4), [entry_size (4)] */
+    if ((ARSTREAM_MP4Source_FindAtom (stbl, "stsz", &stsz) == 0) ||
+        (stsz.size < 12))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "No stsz atom");
+        return -1;
+    }
+    constantSize = ARSTREAM_MP4Source_ReadU32 (&stsz.payload [4]);
+    source->nbFrames = (int)ARSTREAM_MP4Source_ReadU32 (&stsz.payload [8]);
+    if ((source->nbFrames <= 0) ||
+        ((constantSize == 0) &&
+         (stsz.size < 12 + 4 * (uint64_t)source->nbFrames)))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Invalid stsz atom");
+        return -1;
+    }
+
+    /* stco / co64 : version/flags (4), entry_count (4), chunk_offset (4 or 8) */
+    if (ARSTREAM_MP4Source_FindAtom (stbl, "stco", &stco) == 0)
+    {
+        if (ARSTREAM_MP4Source_FindAtom (stbl, "co64", &stco) == 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "No stco or co64 atom");
+            return -1;
+        }
+        isCo64 = 1;
+    }
+    nbChunks = (stco.size >= 8) ? ARSTREAM_MP4Source_ReadU32 (&stco.payload [4]) : 0;
+    if ((nbChunks == 0) ||
+        (stco.size < 8 + (uint64_t)nbChunks * ((isCo64 == 1) ? 8 : 4)))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Invalid chunk offsets atom");
+        return -1;
+    }
+
+    /* stsc : version/flags (4), entry_count (4), {first_chunk, samples_per_chunk, sample_description_index} (12).
+     * Without stsc, each chunk holds one frame */
+    if (ARSTREAM_MP4Source_FindAtom (stbl, "stsc", &stsc) == 1)
+    {
+        nbStscEntries = (stsc.size >= 8) ? ARSTREAM_MP4Source_ReadU32 (&stsc.payload [4]) : 0;
+        if (stsc.size < 8 + (uint64_t)nbStscEntries * 12)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Invalid stsc atom");
+            return -1;
+        }
+    }
+
+    source->frameOffsets = malloc (source->nbFrames * sizeof (uint64_t));
+    source->frameSizes = malloc (source->nbFrames * sizeof (uint32_t));
+    source->frameIsSync = malloc (source->nbFrames * sizeof (uint8_t));
+    if ((source->frameOffsets == NULL) ||
+        (source->frameSizes == NULL) ||
+        (source->frameIsSync == NULL))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to allocate the frames tables");
+        return -1;
+    }
+
+    for (i = 0; i < source->nbFrames; i++)
+    {
+        source->frameSizes [i] = (constantSize != 0) ? constantSize : ARSTREAM_MP4Source_ReadU32 (&stsz.payload [12 + 4 * i]);
+        if (source->frameSizes [i] > source->maxFrameSize)
+        {
+            source->maxFrameSize = source->frameSizes [i];
+        }
+    }
+
+    /* Frames offsets : the frames of a chunk are contiguous */
+    for (chunk = 0; (chunk < nbChunks) && (frame < source->nbFrames); chunk++)
+    {
+        uint64_t offset = (isCo64 == 1) ? ARSTREAM_MP4Source_ReadU64 (&stco.payload [8 + 8 * chunk]) : ARSTREAM_MP4Source_ReadU32 (&stco.payload [8 + 4 * chunk]);
+        uint32_t framesInChunk = 1;
+        uint32_t j;
+        if (nbStscEntries > 0)
+        {
+            /* first_chunk is 1-based */
+            while ((stscIndex + 1 < nbStscEntries) &&
+                   (ARSTREAM_MP4Source_ReadU32 (&stsc.payload [8 + 12 * (stscIndex + 1)]) <= chunk + 1))
+            {
+                stscIndex++;
+            }
+            framesInChunk = ARSTREAM_MP4Source_ReadU32 (&stsc.payload [8 + 12 * stscIndex + 4]);
+        }
+        for (j = 0; (j < framesInChunk) && (frame < source->nbFrames); j++)
+        {
+            /* Written so that a crafted 64 bits offset can not wrap the check */
+            if ((offset > source->mapSize) ||
+                (source->frameSizes [frame] > source->mapSize - offset))
+            {
+                break;
+            }
+            source->frameOffsets [frame] = offset;
+            offset += source->frameSizes [frame];
+            frame++;
+        }
+        if (j < framesInChunk)
+        {
+            break;
+        }
+    }
+    if (frame < source->nbFrames)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Only %d of the %d frames are in the file (truncated file ?)", frame, source->nbFrames);
+        source->nbFrames = frame;
+    }
+    if (source->nbFrames == 0)
+    {
+        return -1;
+    }
+
+    /* stss : version/flags (4), entry_count (4), sample_number (4, 1-based). Without stss, all frames are sync frames */
+    if (ARSTREAM_MP4Source_FindAtom (stbl, "stss", &stss) == 1)
+    {
+        uint32_t nbSync = (stss.size >= 8) ? ARSTREAM_MP4Source_ReadU32 (&stss.payload [4]) : 0;
+        uint32_t k;
+        source->hasSyncTable = 1;
+        memset (source->frameIsSync, 0, source->nbFrames);
+        for (k = 0; (k < nbSync) && (8 + 4 * (uint64_t)(k + 1) <= stss.size); k++)
+        {
+            uint32_t sample = ARSTREAM_MP4Source_ReadU32 (&stss.payload [8 + 4 * k]);
+            if ((sample >= 1) &&
+                (sample <= (uint32_t)source->nbFrames))
+            {
+                source->frameIsSync [sample - 1] = 1;
+            }
+        }
+    }
+    else
+    {
+        source->hasSyncTable = 0;
+        memset (source->frameIsSync, 1, source->nbFrames);
+    }
+    return 0;
+}
+
+static void ARSTREAM_MP4Source_ReadAhead (ARSTREAM_MP4Source_t *source, uint64_t frameOffset)
+{
+    uint64_t start, end;
+    if (frameOffset < source->readAheadEnd - ((source->readAheadEnd > READ_AHEAD_SIZE) ? READ_AHEAD_SIZE : source->readAheadEnd))
+    {
+        /* Jump backwards (loop) : restart the prefetch */
+        source->readAheadEnd = 0;
+    }
+    if (frameOffset + (READ_AHEAD_SIZE / 2) < source->readAheadEnd)
+    {
+        /* Still enough prefetched data */
+        return;
+    }
+    start = (frameOffset > source->readAheadEnd) ? frameOffset : source->readAheadEnd;
+    start -= start % source->pageSize;
+    end = frameOffset + READ_AHEAD_SIZE;
+    if (end > source->mapSize)
+    {
+        end = source->mapSize;
+    }
+    if (end > start)
+    {
+        madvise (source->map + start, end - start, MADV_WILLNEED);
+    }
+    source->readAheadEnd = end;
+}
+
+/*
+ * Implementation
+ */
+
+ARSTREAM_MP4Source_t* ARSTREAM_MP4Source_Open (const char *path)
+{
+    ARSTREAM_MP4Source_t *source;
+    ARSTREAM_MP4Source_Atom_t file, moov, stbl;
+    struct stat fileStat;
+    int fd;
+
+    source = calloc (1, sizeof (ARSTREAM_MP4Source_t));
+    if (source == NULL)
+    {
+        return NULL;
+    }
+    source->map = MAP_FAILED;
+    source->pageSize = sysconf (_SC_PAGESIZE);
+
+    fd = open (path, O_RDONLY);
+    if (fd < 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to open %s : %s", path, strerror (errno));
+        ARSTREAM_MP4Source_Close (&source);
+        return NULL;
+    }
+    if ((fstat (fd, &fileStat) == 0) &&
+        (fileStat.st_size > 0))
+    {
+        source->mapSize = (uint64_t)fileStat.st_size;
+        source->map = mmap (NULL, source->mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close (fd);
+    if (source->map == MAP_FAILED)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unable to map %s : %s", path, strerror (errno));
+        ARSTREAM_MP4Source_Close (&source);
+        return NULL;
+    }
+    /* The frames are read in order : let the kernel read ahead, and drop the pages once read */
+    madvise (source->map, source->mapSize, MADV_SEQUENTIAL);
+
+    file.payload = source->map;
+    file.size = source->mapSize;
+    if ((ARSTREAM_MP4Source_FindAtom (&file, "moov", &moov) == 0) ||
+        (ARSTREAM_MP4Source_FindVideoSampleTable (&moov, &stbl) == 0))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "No track found in %s", path);
+        ARSTREAM_MP4Source_Close (&source);
+        return NULL;
+    }
+    if (ARSTREAM_MP4Source_ReadSampleTable (source, &stbl) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "No frame found in %s", path);
+        ARSTREAM_MP4Source_Close (&source);
+        return NULL;
+    }
+    return source;
+}
+
+void ARSTREAM_MP4Source_Close (ARSTREAM_MP4Source_t **source)
+{
+    if ((source != NULL) &&
+        (*source != NULL))
+    {
+        if ((*source)->map != MAP_FAILED)
+        {
+            munmap ((*source)->map, (*source)->mapSize);
+        }
+        free ((*source)->frameOffsets);
+        free ((*source)->frameSizes);
+        free ((*source)->frameIsSync);
+        free (*source);
+        *source = NULL;
+    }
+}
+
+int ARSTREAM_MP4Source_GetNbFrames (ARSTREAM_MP4Source_t *source)
+{
+    return source->nbFrames;
+}
+
+uint32_t ARSTREAM_MP4Source_GetMaxFrameSize (ARSTREAM_MP4Source_t *source)
+{
+    return source->maxFrameSize;
+}
+
+int ARSTREAM_MP4Source_HasSyncTable (ARSTREAM_MP4Source_t *source)
+{
+    return source->hasSyncTable;
+}
+
+uint8_t* ARSTREAM_MP4Source_GetFrame (ARSTREAM_MP4Source_t *source, int index, uint32_t *frameSize, int *isSyncFrame)
+{
+    if ((index < 0) ||
+        (index >= source->nbFrames))
+    {
+        return NULL;
+    }
+    ARSTREAM_MP4Source_ReadAhead (source, source->frameOffsets [index]);
+    *frameSize = source->frameSizes [index];
+    if (isSyncFrame != NULL)
+    {
+        *isSyncFrame = source->frameIsSync [index];
+    }
+    return source->map + source->frameOffsets [index];
+}
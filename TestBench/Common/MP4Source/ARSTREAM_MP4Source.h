@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_MP4Source.h
+ * @brief Memory mapped frame source reading the video track of a mp4 file
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_MP4SOURCE_H_
+#define _ARSTREAM_MP4SOURCE_H_
+
+#include <inttypes.h>
+
+/**
+ * @brief An ARSTREAM_MP4Source_t gives the frames of the video track of a mp4 file
+ *
+ * The whole file is mapped in memory, so the frames are pointers into the mdat atom : they can be given
+ * as is to ARSTREAM_Sender_SendNewFrame(), without any copy, and stay valid until the source is closed.
+ * The pages of the next frames are prefetched with madvise(), so that the sender does not wait for the disk.
+ *
+ * The frames are located with the stsz, stsc and stco (or co64, for files larger than 4GB) atoms of the
+ * first video track, and the sync frames with its stss atom.
+ *
+ * @note The frames are read-only, the sender never writes to the frames it sends
+ * @note The file is mapped as a whole, so files larger than a few GB need a 64 bits platform
+ */
+typedef struct ARSTREAM_MP4Source_t ARSTREAM_MP4Source_t;
+
+/**
+ * @brief Opens a mp4 file
+ * @param path Path of the file
+ * @return The new source, or NULL if the file can not be mapped, or has no usable video track
+ */
+ARSTREAM_MP4Source_t* ARSTREAM_MP4Source_Open (const char *path);
+
+/**
+ * @brief Closes a mp4 source
+ * @param source Pointer to the source to close. Set to NULL
+ * @warning The frames given by the source must not be used anymore (the sender which sends them must be deleted before)
+ */
+void ARSTREAM_MP4Source_Close (ARSTREAM_MP4Source_t **source);
+
+/**
+ * @brief Gets the number of frames of the source
+ */
+int ARSTREAM_MP4Source_GetNbFrames (ARSTREAM_MP4Source_t *source);
+
+/**
+ * @brief Gets the size of the largest frame of the source
+ */
+uint32_t ARSTREAM_MP4Source_GetMaxFrameSize (ARSTREAM_MP4Source_t *source);
+
+/**
+ * @brief Checks if the file tells which frames are sync frames (stss atom)
+ * @return 1 if ARSTREAM_MP4Source_GetFrame() gives the sync frames, 0 if every frame is reported as a sync frame
+ */
+int ARSTREAM_MP4Source_HasSyncTable (ARSTREAM_MP4Source_t *source);
+
+/**
+ * @brief Gets a frame of the source
+ * The pages of the frames which follow are prefetched, so the frames should be read in increasing order.
+ * @param source The source
+ * @param index Index of the frame, from 0 to ARSTREAM_MP4Source_GetNbFrames() - 1
+ * @param[out] frameSize Pointer which will hold the size of the frame
+ * @param[out] isSyncFrame Optionnal pointer which will hold 1 for a sync (I) frame, 0 otherwise
+ * @return A pointer to the frame, or NULL if index is out of range
+ */
+uint8_t* ARSTREAM_MP4Source_GetFrame (ARSTREAM_MP4Source_t *source, int index, uint32_t *frameSize, int *isSyncFrame);
+
+#endif /* _ARSTREAM_MP4SOURCE_H_ */
@@ -52,6 +52,8 @@
 #include <libARStream/ARSTREAM_Reader.h>
 
 #include "../ARSTREAM_TB_Config.h"
+#include "../Impairment/ARSTREAM_TB_Impairment.h"
+#include "../Thread/ARSTREAM_TB_Thread.h"
 
 /*
  * Macros
@@ -66,7 +68,7 @@
 #define FRAME_MIN_SIZE (2000)
 #define FRAME_MAX_SIZE (40000)
 
-#define NB_BUFFERS (3)
+#define NB_HELD_FRAMES (0) // Frames are written to the output file during the callback
 
 #define __TAG__ "ARSTREAM_Reader_TB"
 
@@ -100,16 +102,11 @@ static int running;
 ARSAL_Sem_t closeSem;
 static ARNETWORK_Manager_t *g_Manager = NULL;
 static ARSTREAM_Reader_t *g_Reader = NULL;
-
-static int currentBufferIndex = 0;
-static uint8_t *multiBuffer[NB_BUFFERS];
-static uint32_t multiBufferSize[NB_BUFFERS];
-static int multiBufferIsFree[NB_BUFFERS];
+static ARSTREAM_Impairment_t *g_Impairment = NULL;
+static ARSTREAM_Recorder_t *g_Recorder = NULL;
 
 static char *appName;
 
-static FILE *outFile;
-
 /*
  * Internal functions declarations
  */
@@ -119,37 +116,10 @@ static FILE *outFile;
  */
 void ARSTREAM_ReaderTb_printUsage ();
 
-/**
- * @brief Initializes the multi buffers of the testbench
- * @param initialSize Initial size of the buffers
- */
-void ARSTREAM_ReaderTb_initMultiBuffers (int initialSize);
-
-/**
- * @brief Realloc a buffer to a new size
- * @param id The index of the buffer to reallocate
- * @param newSize The new size of the buffer
- */
-void reallocBuffer (int id, int newSize);
-
 /**
  * @see ARSTREAM_Reader.h
  */
-uint8_t* ARSTREAM_ReaderTb_FrameCompleteCallback (eARSTREAM_READER_CAUSE cause, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, uint32_t *newBufferCapacity, void *custom);
-
-/**
- * @brief Gets a free buffer pointer
- * @param[in] buffer the buffer to mark as free
- */
-void ARSTREAM_ReaderTb_SetBufferFree (uint8_t *buffer);
-
-/**
- * @brief Gets a free buffer pointer
- * @param[out] retSize Pointer where to store the size of the next free buffer (or 0 if there is no free buffer)
- * @param[in] reallocToDouble Set to non-zero to realloc the buffer to the double of its previous size
- * @return Pointer to the next free buffer, or NULL if there is no free buffer
- */
-uint8_t* ARSTREAM_ReaderTb_GetNextFreeBuffer (uint32_t *retSize, int reallocToDouble);
+void ARSTREAM_ReaderTb_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom);
 
 /**
  * @brief Stream entry point
@@ -166,149 +136,81 @@ void ARSTREAM_ReaderTb_printUsage ()
 {
     ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Usage : %s [ip] [outFile]", appName);
     ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        ip -> optionnal, ip of the stream sender");
-    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        outFile -> optionnal (ip must be provided), output file for received stream");
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "        outFile -> optionnal (ip must be provided), output file for received stream (and its frame index, outFile.idx)");
 }
 
-void ARSTREAM_ReaderTb_initMultiBuffers (int initialSize)
+void ARSTREAM_ReaderTb_FrameReadyCallback (ARSTREAM_Reader_Frame_t *frame, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, void *custom)
 {
-    int buffIndex;
-    for (buffIndex = 0; buffIndex < NB_BUFFERS; buffIndex++)
-    {
-        reallocBuffer (buffIndex, initialSize);
-        multiBufferIsFree[buffIndex] = 1;
-    }
-}
-
-void reallocBuffer (int id, int newSize)
-{
-    multiBuffer [id] = realloc (multiBuffer [id], newSize);
-    multiBufferSize [id] = newSize;
-}
-
-uint8_t* ARSTREAM_ReaderTb_FrameCompleteCallback (eARSTREAM_READER_CAUSE cause, uint8_t *framePointer, uint32_t frameSize, int numberOfSkippedFrames, int isFlushFrame, uint32_t *newBufferCapacity, void *buffer)
-{
-    uint8_t *retVal = NULL;
     struct timespec now;
     int dt;
-    buffer = buffer;
-    switch (cause)
+    frame = frame;
+    custom = custom;
+    ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Got a complete frame of size %d, at address %p (isFlush : %d)", frameSize, framePointer, isFlushFrame);
+    if (isFlushFrame != 0)
+    nbRead++;
+    if (numberOfSkippedFrames != 0)
     {
-    case ARSTREAM_READER_CAUSE_FRAME_COMPLETE:
-        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Got a complete frame of size %d, at address %p (isFlush : %d)", frameSize, framePointer, isFlushFrame);
-        if (isFlushFrame != 0)
-        nbRead++;
-        if (numberOfSkippedFrames != 0)
-        {
-            ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Skipped %d frames", numberOfSkippedFrames);
-            if (numberOfSkippedFrames > 0)
-            {
-                nbSkipped += numberOfSkippedFrames;
-                nbSkippedSinceLast += numberOfSkippedFrames;
-            }
-        }
-        ARSTREAM_Reader_PercentOk = (100.f * nbRead) / (1.f * (nbRead + nbSkipped));
-        if (outFile != NULL)
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Skipped %d frames", numberOfSkippedFrames);
+        if (numberOfSkippedFrames > 0)
         {
-            fwrite (framePointer, 1, frameSize, outFile);
+            nbSkipped += numberOfSkippedFrames;
+            nbSkippedSinceLast += numberOfSkippedFrames;
         }
-        ARSAL_Time_GetTime(&now);
-        dt = ARSAL_Time_ComputeTimespecMsTimeDiff(&lastRecv, &now);
-        lastDt [currentIndexInDt] = dt;
-        currentIndexInDt ++;
-        currentIndexInDt %= NB_FRAMES_FOR_AVERAGE;
-        lastRecv.tv_sec = now.tv_sec;
-        lastRecv.tv_nsec = now.tv_nsec;
-        ARSTREAM_ReaderTb_SetBufferFree (framePointer);
-        retVal = ARSTREAM_ReaderTb_GetNextFreeBuffer (newBufferCapacity, 0);
-        break;
-
-    case ARSTREAM_READER_CAUSE_FRAME_TOO_SMALL:
-        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Current buffer is to small for frame !");
-        retVal = ARSTREAM_ReaderTb_GetNextFreeBuffer (newBufferCapacity, 1);
-        break;
-
-    case ARSTREAM_READER_CAUSE_COPY_COMPLETE:
-        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Copy complete in new buffer, freeing this one");
-        ARSTREAM_ReaderTb_SetBufferFree (framePointer);
-        break;
-
-    case ARSTREAM_READER_CAUSE_CANCEL:
-        ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Reader is closing");
-        ARSTREAM_ReaderTb_SetBufferFree (framePointer);
-        break;
-
-    default:
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Unknown cause (probably a bug !)");
-        break;
     }
-    return retVal;
-}
-
-void ARSTREAM_ReaderTb_SetBufferFree (uint8_t *buffer)
-{
-    int i;
-    for (i = 0; i < NB_BUFFERS; i++)
-    {
-        if (multiBuffer[i] == buffer)
-        {
-            multiBufferIsFree[i] = 1;
-        }
-    }
-}
-
-uint8_t* ARSTREAM_ReaderTb_GetNextFreeBuffer (uint32_t *retSize, int reallocToDouble)
-{
-    uint8_t *retBuffer = NULL;
-    int nbtest = 0;
-    if (retSize == NULL)
-    {
-        return NULL;
-    }
-    do
-    {
-        if (multiBufferIsFree[currentBufferIndex] == 1)
-        {
-            if (reallocToDouble != 0)
-            {
-                reallocBuffer (currentBufferIndex, 2* multiBufferSize [currentBufferIndex]);
-            }
-            retBuffer = multiBuffer[currentBufferIndex];
-            *retSize = multiBufferSize[currentBufferIndex];
-        }
-        currentBufferIndex = (currentBufferIndex + 1) % NB_BUFFERS;
-        nbtest++;
-    } while (retBuffer == NULL && nbtest < NB_BUFFERS);
-    return retBuffer;
+    ARSTREAM_Reader_PercentOk = (100.f * nbRead) / (1.f * (nbRead + nbSkipped));
+    ARSAL_Time_GetTime(&now);
+    dt = ARSAL_Time_ComputeTimespecMsTimeDiff(&lastRecv, &now);
+    lastDt [currentIndexInDt] = dt;
+    currentIndexInDt ++;
+    currentIndexInDt %= NB_FRAMES_FOR_AVERAGE;
+    lastRecv.tv_sec = now.tv_sec;
+    lastRecv.tv_nsec = now.tv_nsec;
 }
 
 int ARSTREAM_ReaderTb_StartStreamTest (ARNETWORK_Manager_t *manager, const char *outPath)
 {
     int retVal = 0;
 
-    uint8_t *firstFrame;
-    uint32_t firstFrameSize;
     eARSTREAM_ERROR err;
-    if (NULL != outPath)
-    {
-        outFile = fopen (outPath, "wb");
-    }
-    else
-    {
-        outFile = NULL;
-    }
-    ARSTREAM_ReaderTb_initMultiBuffers (FRAME_MAX_SIZE);
     ARSAL_Sem_Init (&closeSem, 0, 0);
-    firstFrame = ARSTREAM_ReaderTb_GetNextFreeBuffer (&firstFrameSize, 0);
-    g_Reader = ARSTREAM_Reader_New (manager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_ReaderTb_FrameCompleteCallback, firstFrame, firstFrameSize, ARSTREAM_TB_FRAG_SIZE, NULL, &err);
+    g_Reader = ARSTREAM_Reader_NewWithFramePool (manager, DATA_BUFFER_ID, ACK_BUFFER_ID, ARSTREAM_ReaderTb_FrameReadyCallback, NB_HELD_FRAMES, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_READER_MAX_ACK_INTERVAL_DEFAULT, NULL, &err);
     if (g_Reader == NULL)
     {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Reader_New call : %s", ARSTREAM_Error_ToString(err));
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Reader_NewWithFramePool call : %s", ARSTREAM_Error_ToString(err));
         return 1;
     }
 
+    ARNETWORK_IOBufferParam_t dataParams;
+    ARSTREAM_Reader_InitStreamDataBuffer (&dataParams, DATA_BUFFER_ID, ARSTREAM_TB_FRAG_SIZE, ARSTREAM_TB_MAX_NB_FRAG);
+    g_Impairment = ARSTREAM_TB_Impairment_NewFromEnv (ARSTREAM_TB_DATA_IMPAIRMENT_ENV, dataParams.dataCopyMaxSize);
+    ARSTREAM_Reader_SetDataImpairment (g_Reader, g_Impairment);
+
+    pthread_t recorderThread;
+    if (NULL != outPath)
+    {
+        ARSTREAM_Recorder_Params_t recorderParams;
+        ARSTREAM_Recorder_DefaultParams (&recorderParams);
+        g_Recorder = ARSTREAM_Recorder_New (outPath, &recorderParams, &err);
+        if (g_Recorder == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Error during ARSTREAM_Recorder_New call : %s", ARSTREAM_Error_ToString(err));
+        }
+        else
+        {
+            ARSTREAM_Reader_SetRecorder (g_Reader, g_Recorder);
+            pthread_create (&recorderThread, NULL, ARSTREAM_Recorder_RunThread, g_Recorder);
+        }
+    }
+
+    ARSTREAM_ThreadConfig_t dataThreadConfig, ackThreadConfig;
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_DATA_THREAD_ENV, "ars_rcv_data", &dataThreadConfig);
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_ACK_THREAD_ENV, "ars_rcv_ack", &ackThreadConfig);
+    ARSTREAM_Reader_SetThreadConfig (g_Reader, ARSTREAM_THREAD_DATA, &dataThreadConfig);
+    ARSTREAM_Reader_SetThreadConfig (g_Reader, ARSTREAM_THREAD_ACK, &ackThreadConfig);
+
     pthread_t streamsend, streamread;
-    pthread_create (&streamsend, NULL, ARSTREAM_Reader_RunDataThread, g_Reader);
-    pthread_create (&streamread, NULL, ARSTREAM_Reader_RunAckThread, g_Reader);
+    ARSTREAM_Thread_Create (&streamsend, &dataThreadConfig, ARSTREAM_Reader_RunDataThread, g_Reader);
+    ARSTREAM_Thread_Create (&streamread, &ackThreadConfig, ARSTREAM_Reader_RunAckThread, g_Reader);
 
     /* USER CODE */
 
@@ -324,6 +226,16 @@ int ARSTREAM_ReaderTb_StartStreamTest (ARNETWORK_Manager_t *manager, const char
     pthread_join (streamsend, NULL);
 
     ARSTREAM_Reader_Delete (&g_Reader);
+    if (g_Recorder != NULL)
+    {
+        ARSTREAM_Recorder_Stop (g_Recorder);
+        pthread_join (recorderThread, NULL);
+        ARSTREAM_Recorder_Delete (&g_Recorder);
+    }
+    if (g_Impairment != NULL)
+    {
+        ARSTREAM_Impairment_Delete (&g_Impairment);
+    }
 
     ARSAL_Sem_Destroy (&closeSem);
 
@@ -52,6 +52,8 @@
 #include <libARStream/ARSTREAM_Sender.h>
 
 #include "../ARSTREAM_TB_Config.h"
+#include "../Impairment/ARSTREAM_TB_Impairment.h"
+#include "../Thread/ARSTREAM_TB_Thread.h"
 
 /*
  * Macros
@@ -329,9 +331,20 @@ int ARSTREAM_SenderTb_StartStreamTest (ARNETWORK_Manager_t *manager)
         return 1;
     }
 
+    ARNETWORK_IOBufferParam_t ackParams;
+    ARSTREAM_Sender_InitStreamAckBuffer (&ackParams, ACK_BUFFER_ID);
+    ARSTREAM_Impairment_t *impairment = ARSTREAM_TB_Impairment_NewFromEnv (ARSTREAM_TB_ACK_IMPAIRMENT_ENV, ackParams.dataCopyMaxSize);
+    ARSTREAM_Sender_SetAckImpairment (g_Sender, impairment);
+
+    ARSTREAM_ThreadConfig_t dataThreadConfig, ackThreadConfig;
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_DATA_THREAD_ENV, "ars_snd_data", &dataThreadConfig);
+    ARSTREAM_TB_Thread_ConfigFromEnv (ARSTREAM_TB_ACK_THREAD_ENV, "ars_snd_ack", &ackThreadConfig);
+    ARSTREAM_Sender_SetThreadConfig (g_Sender, ARSTREAM_THREAD_DATA, &dataThreadConfig);
+    ARSTREAM_Sender_SetThreadConfig (g_Sender, ARSTREAM_THREAD_ACK, &ackThreadConfig);
+
     pthread_t streamsend, streamread;
-    pthread_create (&streamsend, NULL, ARSTREAM_Sender_RunDataThread, g_Sender);
-    pthread_create (&streamread, NULL, ARSTREAM_Sender_RunAckThread, g_Sender);
+    ARSTREAM_Thread_Create (&streamsend, &dataThreadConfig, ARSTREAM_Sender_RunDataThread, g_Sender);
+    ARSTREAM_Thread_Create (&streamread, &ackThreadConfig, ARSTREAM_Sender_RunAckThread, g_Sender);
 
     /* USER CODE */
 
@@ -347,6 +360,10 @@ int ARSTREAM_SenderTb_StartStreamTest (ARNETWORK_Manager_t *manager)
     pthread_join (streamsend, NULL);
 
     ARSTREAM_Sender_Delete (&g_Sender);
+    if (impairment != NULL)
+    {
+        ARSTREAM_Impairment_Delete (&impairment);
+    }
 
     return retVal;
 }
@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_TB_Thread.c
+ * @brief Thread configuration helpers of the testbenches
+ * @date 10/15/2026
+ */
+
+/*
+ * System Headers
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * ARSDK Headers
+ */
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "ARSTREAM_TB_Thread.h"
+
+/*
+ * Macros
+ */
+
+#define __TAG__ "ARSTREAM_TB_Thread"
+
+#define MAX_DESCRIPTION_SIZE (256)
+
+/*
+ * Implementation
+ */
+
+int ARSTREAM_TB_Thread_ParseConfig (const char *description, ARSTREAM_ThreadConfig_t *config)
+{
+    char copy [MAX_DESCRIPTION_SIZE];
+    char *item;
+    char *savePtr = NULL;
+    int retVal = 0;
+
+    if (strlen (description) >= sizeof (copy))
+    {
+        return -1;
+    }
+    strcpy (copy, description);
+
+    for (item = strtok_r (copy, ",", &savePtr); (retVal == 0) && (item != NULL); item = strtok_r (NULL, ",", &savePtr))
+    {
+        if ((sscanf (item, "cpus=%" SCNi64, (int64_t *)&(config->cpuAffinityMask)) != 1) &&
+            (sscanf (item, "prio=%d", &(config->realtimePriority)) != 1) &&
+            (sscanf (item, "name=%15s", config->name) != 1) &&
+            (sscanf (item, "stack=%zu", &(config->stackSize)) != 1))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Invalid thread configuration item \"%s\"", item);
+            retVal = -1;
+        }
+    }
+    return retVal;
+}
+
+void ARSTREAM_TB_Thread_ConfigFromEnv (const char *envName, const char *defaultName, ARSTREAM_ThreadConfig_t *config)
+{
+    const char *description = getenv (envName);
+    ARSTREAM_ThreadConfig_Default (config);
+    strncpy (config->name, defaultName, ARSTREAM_THREAD_NAME_MAX_LENGTH - 1);
+    if ((description == NULL) ||
+        (description [0] == '\0'))
+    {
+        return;
+    }
+    if (ARSTREAM_TB_Thread_ParseConfig (description, config) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, __TAG__, "Ignoring invalid %s=\"%s\"", envName, description);
+        ARSTREAM_ThreadConfig_Default (config);
+        strncpy (config->name, defaultName, ARSTREAM_THREAD_NAME_MAX_LENGTH - 1);
+        return;
+    }
+    ARSAL_PRINT (ARSAL_PRINT_WARNING, __TAG__, "Thread configuration %s=\"%s\"", envName, description);
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSTREAM_TB_Thread.h
+ * @brief Thread configuration helpers of the testbenches
+ * @date 10/15/2026
+ */
+
+#ifndef _ARSTREAM_TB_THREAD_H_
+#define _ARSTREAM_TB_THREAD_H_
+
+#include <libARStream/ARSTREAM_Thread.h>
+
+/**
+ * @brief Environment variable holding the configuration of the stream data threads
+ */
+#define ARSTREAM_TB_DATA_THREAD_ENV "ARSTREAM_TB_DATA_THREAD"
+
+/**
+ * @brief Environment variable holding the configuration of the stream ack threads
+ */
+#define ARSTREAM_TB_ACK_THREAD_ENV "ARSTREAM_TB_ACK_THREAD"
+
+/**
+ * @brief Parses a thread configuration description
+ *
+ * The description is a comma separated list of key=value items, all optionnal :
+ * - cpus=MASK : CPU affinity mask (decimal, or hexadecimal with 0x)
+ * - prio=N : SCHED_FIFO priority
+ * - name=NAME : thread name (at most 15 characters)
+ * - stack=BYTES : stack size
+ *
+ * For example "cpus=0x8,prio=50"
+ *
+ * @param[in] description The description to parse
+ * @param[in,out] config The configuration to update
+ * @return 0 on success, -1 if the description is invalid
+ */
+int ARSTREAM_TB_Thread_ParseConfig (const char *description, ARSTREAM_ThreadConfig_t *config);
+
+/**
+ * @brief Gets a thread configuration from the description held in an environment variable
+ * @param[in] envName Name of the environment variable
+ * @param[in] defaultName Name of the thread if the description does not give one
+ * @param[out] config The configuration (only the name is set if the variable is not set or invalid)
+ */
+void ARSTREAM_TB_Thread_ConfigFromEnv (const char *envName, const char *defaultName, ARSTREAM_ThreadConfig_t *config);
+
+#endif /* _ARSTREAM_TB_THREAD_H_ */